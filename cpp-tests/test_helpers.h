@@ -13,6 +13,8 @@
 #include <regex>
 #include <fstream>
 #include <filesystem>
+#include <cstdlib>
+#include <unistd.h>
 
 #define TEST_ASSERT(condition, message) \
     do { \
@@ -54,3 +56,35 @@ private:
     std::string path_;
     std::ofstream stream_;
 };
+
+// Runs a shell command that sets up a test fixture. A failing command ends
+// the test right away instead of surfacing later as an unrelated assertion.
+inline void run_checked(const std::string &cmd) {
+    const int rc = std::system(cmd.c_str());
+    if (rc != 0) {
+        std::cerr << "FAIL: `" << cmd << "` exited with status " << rc << std::endl;
+        std::exit(1);
+    }
+}
+
+// git -C repo args, with its output discarded; see run_checked.
+inline void git(const std::string &repo, const std::string &args) {
+    run_checked("git -C " + repo + " " + args + " >/dev/null 2>&1");
+}
+
+inline void write_file(const std::string &path, const std::string &content) {
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream f(path, std::ios::binary); f << content;
+}
+
+// A fresh repository at /tmp/nv_<name>_<pid> with a committer configured;
+// init_args go to git init (e.g. "--object-format=sha256").
+inline std::string init_test_repo(const std::string &name, const std::string &init_args = "") {
+    const std::string dir = "/tmp/nv_" + name + "_" + std::to_string(::getpid());
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    git(dir, "init -q" + (init_args.empty() ? std::string() : " " + init_args));
+    git(dir, "config user.name 'Test'");
+    git(dir, "config user.email 'test@example.com'");
+    return dir;
+}
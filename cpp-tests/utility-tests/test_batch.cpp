@@ -0,0 +1,180 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/analyzers.h"
+#include "next_version/batch.h"
+
+using namespace nv;
+
+static std::string init_repo(const std::string &name, int commits) {
+    const std::string dir = init_test_repo("batch_" + name);
+    write_file(dir + "/VERSION", "1.2.3\n");
+    write_file(dir + "/src/main.c", "int main(void) { return 0; }\n");
+    git(dir, "add -A");
+    git(dir, "commit -q -m base");
+    git(dir, "tag v1.2.3");
+    for (int i = 0; i < commits; ++i) {
+        write_file(dir + "/src/opt" + std::to_string(i) + ".c",
+                   "static struct option opts[] = {\n  {\"flag-" + std::to_string(i) + "\", 0, 0, 'f'},\n};\n");
+        write_file(dir + "/doc/notes.md", "security fix " + std::to_string(i) + "\n");
+        git(dir, "add -A");
+        git(dir, "commit -q -m 'feat: option " + std::to_string(i) + "'");
+    }
+    return dir;
+}
+
+static bool test_parse() {
+    Options defaults;
+    defaults.nativeGit = true;
+    defaults.onlyPaths = "src";
+    defaults.batchFile = "-";
+    BatchJob job;
+    TEST_ASSERT(parseBatchJob(" { \"id\" : \"a\\\"b\", \"repo\":\"/r\\u00e9\\ud83d\\ude00\", \"base\":\"v1\", \"no_cache\":true,"
+                              " \"native_git\":false, \"rename_threshold\":70 } ", defaults, job),
+                "a job parses: " << job.error);
+    TEST_ASSERT(job.id == "\"a\\\"b\"", "the id is kept as written, got " << job.id);
+    TEST_ASSERT(job.opts.repoRoot == "/r\xc3\xa9\xf0\x9f\x98\x80", "escapes are decoded");
+    TEST_ASSERT(job.opts.baseRef == "v1" && job.opts.noCache && !job.opts.nativeGit && job.opts.renameThreshold == 70,
+                "fields are applied");
+    TEST_ASSERT(job.opts.onlyPaths == "src" && job.opts.batchFile.empty(), "other options come from the defaults");
+    TEST_ASSERT(parseBatchJob("{\"id\":7}", defaults, job) && job.id == "7" && job.opts.nativeGit, "a number id");
+    TEST_ASSERT(parseBatchJob("{}", defaults, job) && job.id.empty(), "an empty job");
+
+    const std::pair<const char *, const char *> bad[] = {
+        {"{\"repo\":1}", "\"repo\" expects a string"},
+        {"{\"native_git\":\"yes\"}", "\"native_git\" expects true or false"},
+        {"{\"rename_threshold\":101}", "percentage"},
+        {"{\"rename_threshold\":5.5}", "percentage"},
+        {"{\"jobs\":2}", "unknown field \"jobs\""},
+        {"{\"repo\":{\"path\":\"x\"}}", "nested"},
+        {"{\"repo\":\"x\"} {}", "text after"},
+        {"{\"repo\":\"x\"", "expected ','"},
+        {"{\"repo\":\"x\\q\"}", "bad escape"},
+        {"{\"repo\":\"\\udc00\"}", "unpaired surrogate"},
+        {"[]", "expected '{'"},
+    };
+    for (const auto &[text, why] : bad) {
+        TEST_ASSERT(!parseBatchJob(text, defaults, job), text << " is not a job");
+        TEST_ASSERT(job.error.find(why) != std::string::npos, text << ": error \"" << job.error << "\"");
+    }
+    TEST_PASS("job lines parse over the command line's options");
+    return true;
+}
+
+// Each result line is what a run of its own gives, whatever the number of workers.
+static bool test_results(const std::string &a, const std::string &b) {
+    std::ostringstream input;
+    input << "{\"id\":1,\"repo\":\"" << a << "\"}\n";
+    input << "\n";
+    input << "{\"id\":2,\"repo\":\"" << b << "\",\"base\":\"HEAD~1\"}\n";
+    input << "not json\n";
+    input << "{\"id\":3,\"repo\":\"" << a << "\",\"only_paths\":\"doc\"}\n";
+    input << "{\"id\":4,\"repo\":\"" << b << "\",\"native_git\":true}\n";
+    Options defaults;
+    defaults.noCache = true;
+
+    std::set<std::string> expected;
+    BatchJob job;
+    std::istringstream lines(input.str());
+    std::size_t line = 0;
+    for (std::string text; std::getline(lines, text);) {
+        ++line;
+        if (text.empty()) continue;
+        job.line = line;
+        if (!parseBatchJob(text, defaults, job)) {
+            expected.insert(formatBatchError(job));
+            continue;
+        }
+        job.opts.jobs = 1;
+        const ConfigValues cfg = loadConfigValues(job.opts.repoRoot);
+        expected.insert(formatBatchResult(job, analyzeRange(job.opts, cfg), cfg));
+    }
+    TEST_ASSERT(expected.size() == 5, "four jobs and one error");
+
+    for (unsigned workers : {1u, 3u}) {
+        std::istringstream in(input.str());
+        std::ostringstream out;
+        BatchOptions batch;
+        batch.workers = workers;
+        batch.perRepo = 2;
+        const int rc = runBatch(in, out, defaults, batch);
+        std::set<std::string> got;
+        std::istringstream results(out.str());
+        for (std::string text; std::getline(results, text);) got.insert(text);
+        TEST_ASSERT(rc == 1, "a line that is not a job fails the batch");
+        TEST_ASSERT(got == expected, workers << " workers: results differ:\n" << out.str());
+    }
+    TEST_ASSERT(expected.begin()->find("\"suggestion\":") != std::string::npos, "results carry the suggestion");
+    TEST_PASS("batch results match single runs");
+    return true;
+}
+
+// No more than perRepo jobs of one repository run at once, while other
+// repositories' jobs fill the remaining workers.
+static bool test_admission() {
+    std::mutex mutex;
+    std::map<std::string, int> running;
+    int busiest = 0, widest = 0, total = 0;
+    std::ostringstream input;
+    for (int i = 0; i < 24; ++i) input << "{\"repo\":\"/tmp/repo" << i % 3 << "\",\"id\":" << i << "}\n";
+    BatchOptions batch;
+    batch.workers = 4;
+    batch.perRepo = 1;
+    batch.analyze = [&](const Options &opts, const ConfigValues &) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busiest = std::max(busiest, ++running[opts.repoRoot]);
+            widest = std::max(widest, ++total);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::lock_guard<std::mutex> lock(mutex);
+        --running[opts.repoRoot];
+        --total;
+        return AnalysisResult {};
+    };
+    std::istringstream in(input.str());
+    std::ostringstream out;
+    TEST_ASSERT(runBatch(in, out, Options {}, batch) == 0, "every job ran");
+    const std::string results = out.str();
+    TEST_ASSERT(std::count(results.begin(), results.end(), '\n') == 24, "one line per job");
+    TEST_ASSERT(busiest == 1, busiest << " jobs ran at once on one repository");
+    TEST_ASSERT(widest >= 2 && widest <= 3, widest << " jobs ran at once on three repositories");
+
+    batch.perRepo = 4;
+    busiest = widest = 0;
+    std::istringstream again(input.str());
+    out.str({});
+    TEST_ASSERT(runBatch(again, out, Options {}, batch) == 0 && widest <= 4, "never more than the workers");
+    TEST_PASS("jobs are admitted per repository");
+    return true;
+}
+
+int main() {
+    std::cout << "Running batch tests..." << std::endl;
+    const std::string a = init_repo("a", 3);
+    const std::string b = init_repo("b", 2);
+    bool ok = test_parse();
+    ok &= test_results(a, b);
+    ok &= test_admission();
+    std::filesystem::remove_all(a);
+    std::filesystem::remove_all(b);
+    return ok ? 0 : 1;
+}
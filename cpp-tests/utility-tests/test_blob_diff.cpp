@@ -0,0 +1,184 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
+#include <cstdint>
+#include "../test_helpers.h"
+#include "next_version/blob_diff.h"
+#include "next_version/git_helpers.h"
+#include "next_version/range_snapshot.h"
+
+using namespace nv;
+
+// Small deterministic generator so failures reproduce.
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+// C-like text with indentation, blank lines, braces and repeated lines, the
+// material the slider and funcname heuristics care about.
+static std::string code_like(Lcg &rng, int functions) {
+    static const char *bodies[] = {"    return 0;\n", "    int x = 1;\n", "    x++;\n", "\n", "    }\n",
+                                   "    if (x) {\n", "        call();\n", "    // note\n", "\tlog(\"%d\", x);\n"};
+    std::string s;
+    for (int f = 0; f < functions; ++f) {
+        s += "int func" + std::to_string(f) + "(int a)\n{\n";
+        const unsigned n = 2 + rng.next(8);
+        for (unsigned i = 0; i < n; ++i) s += bodies[rng.next(9)];
+        s += "}\n\n";
+    }
+    return s;
+}
+
+static std::string mutate(Lcg &rng, const std::string &text, bool whitespaceOnly) {
+    std::vector<std::string> lines;
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        const auto nl = text.find('\n', pos);
+        const auto end = nl == std::string::npos ? text.size() : nl + 1;
+        lines.push_back(text.substr(pos, end - pos));
+        pos = end;
+    }
+    const unsigned edits = 1 + rng.next(6);
+    for (unsigned e = 0; e < edits && !lines.empty(); ++e) {
+        const std::size_t at = rng.next(static_cast<unsigned>(lines.size()));
+        switch (whitespaceOnly ? 3 : rng.next(4)) {
+            case 0: lines.erase(lines.begin() + static_cast<std::ptrdiff_t>(at)); break;
+            case 1: lines.insert(lines.begin() + static_cast<std::ptrdiff_t>(at), "    added" + std::to_string(rng.next(3)) + "();\n"); break;
+            case 2: lines[at] = "    changed" + std::to_string(rng.next(100)) + ";\n"; break;
+            default: lines[at] = "  " + lines[at]; break;
+        }
+    }
+    std::string out;
+    for (const auto &l : lines) out += l;
+    return out;
+}
+
+static bool test_hunk_spans() {
+    BlobDiff d;
+    const std::string a = "one\ntwo\nthree\nfour\n", b = "one\n2\nthree\nfour\nfive";
+    diffBlobs(a, b, {}, d);
+    TEST_ASSERT(d.hunks.size() == 2, "two hunks expected, got " << d.hunks.size());
+    TEST_ASSERT(d.hunks[0].oldBegin == 1 && d.hunks[0].oldCount == 1 && d.hunks[0].newBegin == 1 && d.hunks[0].newCount == 1,
+                "replacement span");
+    TEST_ASSERT(d.hunks[1].oldBegin == 4 && d.hunks[1].oldCount == 0 && d.hunks[1].newCount == 1, "append span");
+    TEST_ASSERT(d.newLines.line(4) == "five", "spans point into the new buffer");
+    TEST_ASSERT(d.insertions == 2 && d.deletions == 1, "counts");
+
+    std::string text;
+    appendUnifiedHunks(d, text);
+    TEST_ASSERT(text == "@@ -2 +2 @@ one\n-two\n+2\n@@ -4,0 +5 @@ four\n+five\n\\ No newline at end of file\n",
+                "unified=0 rendering: " << text);
+
+    diffBlobs("a b\n\tc\n", "ab\nc   \n", BlobDiffOptions{true, DiffAlgorithm::Myers}, d);
+    TEST_ASSERT(d.hunks.empty(), "-w ignores whitespace-only edits");
+    diffBlobs("", "x\n", {}, d);
+    TEST_ASSERT(d.hunks.size() == 1 && d.insertions == 1, "diff against an empty blob");
+    TEST_PASS("hunk spans over blob buffers");
+    return true;
+}
+
+// Replaying the hunks on the old lines must produce the new text.
+static bool replays(const BlobDiff &d, const std::string &expected) {
+    std::string out;
+    std::size_t oldPos = 0;
+    for (const auto &h : d.hunks) {
+        for (; oldPos < h.oldBegin; ++oldPos) out.append(d.oldLines.line(oldPos));
+        for (std::size_t i = 0; i < h.newCount; ++i) out.append(d.newLines.line(h.newBegin + i));
+        oldPos += h.oldCount;
+    }
+    for (; oldPos < d.oldLines.size(); ++oldPos) out.append(d.oldLines.line(oldPos));
+    return out == expected;
+}
+
+static bool test_algorithms_replay() {
+    Lcg rng {42};
+    for (int round = 0; round < 200; ++round) {
+        const std::string a = code_like(rng, 1 + static_cast<int>(rng.next(6)));
+        const std::string b = mutate(rng, a, false);
+        for (auto algo : {DiffAlgorithm::Myers, DiffAlgorithm::Histogram}) {
+            BlobDiff d;
+            diffBlobs(a, b, BlobDiffOptions{false, algo}, d);
+            TEST_ASSERT(replays(d, b), "round " << round << (algo == DiffAlgorithm::Myers ? " myers" : " histogram"));
+        }
+    }
+    TEST_PASS("myers and histogram hunks replay to the new blob");
+    return true;
+}
+
+// Target commit with text edits, whitespace-only edits, funcname contexts,
+// quoted and spaced names, binaries, renames, copies and a type change.
+static std::string init_repo() {
+    const std::string dir = init_test_repo("blob_diff");
+    Lcg rng {7};
+    std::vector<std::string> bases;
+    for (int i = 0; i < 24; ++i) {
+        bases.push_back(code_like(rng, 2 + i % 7));
+        write_file(dir + "/src/file" + std::to_string(i) + (i % 3 ? ".cpp" : ".h"), bases.back());
+    }
+    write_file(dir + "/docs/sp ace.md", "alpha\nbeta\n");
+    write_file(dir + "/docs/t\xc3\xa4st.md", "umlaut\n");
+    write_file(dir + "/noeol.txt", "last line");
+    write_file(dir + "/data.bin", std::string("\0\1\2", 3));
+    write_file(dir + "/moved.cpp", "a file that only moves\n");
+    write_file(dir + "/kind", "file to become a link\n");
+    git(dir, "add -A");
+    git(dir, "commit -q -m base");
+    git(dir, "tag v1");
+
+    for (int i = 0; i < 24; ++i) {
+        write_file(dir + "/src/file" + std::to_string(i) + (i % 3 ? ".cpp" : ".h"), mutate(rng, bases[static_cast<std::size_t>(i)], i % 5 == 0));
+    }
+    write_file(dir + "/docs/sp ace.md", "alpha\ngamma\n");
+    write_file(dir + "/docs/t\xc3\xa4st.md", "umlaut changed\n");
+    write_file(dir + "/docs/new file.md", "");
+    write_file(dir + "/noeol.txt", "last line\n");
+    write_file(dir + "/data.bin", std::string("\0\1\3", 3));
+    git(dir, "mv moved.cpp src/moved_here.cpp");
+    write_file(dir + "/src/copy.h", bases[0]);
+    git(dir, "rm -q kind");
+    run_checked("ln -s noeol.txt " + dir + "/kind");
+    git(dir, "add -A");
+    git(dir, "commit -q -m target");
+    return dir;
+}
+
+static bool test_matches_git(const std::string &repo) {
+    const char *pathspecs[] = {"", "src", "docs,noeol.txt"};
+    for (const char *ps : pathspecs) {
+        for (bool ws : {false, true}) {
+            const std::string label = std::string("pathspec '") + ps + "'" + (ws ? " -w" : "");
+            RangeSnapshot viaGit = collectRangeSnapshot(repo, "v1", "HEAD", ps, ws, SnapshotAll, false);
+            RangeSnapshot native = collectRangeSnapshot(repo, "v1", "HEAD", ps, ws, SnapshotAll, true);
+            TEST_ASSERT(native.native, label << ": native path should be taken");
+            TEST_ASSERT(native.diff == viaGit.diff, label << ": patch differs\n--- native\n" << native.diff << "--- git\n" << viaGit.diff);
+            TEST_ASSERT(native.cliDiffText() == viaGit.cliDiffText(), label << ": CLI patch differs");
+            const FileChangeStats a = computeFileChangeStats(native), b = computeFileChangeStats(viaGit);
+            TEST_ASSERT(a.insertions == b.insertions && a.deletions == b.deletions, label << ": line stats differ");
+        }
+    }
+    TEST_PASS("native patches are byte-identical to git diff --unified=0");
+    return true;
+}
+
+int main() {
+    std::cout << "Running blob diff tests..." << std::endl;
+    bool ok = test_hunk_spans();
+    ok &= test_algorithms_replay();
+#ifdef NEXT_VERSION_HAVE_ZLIB
+    const std::string repo = init_repo();
+    ok &= test_matches_git(repo);
+#endif
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/case_fold.h"
+
+using namespace nv;
+
+static std::vector<SimdLevel> levels() {
+    std::vector<SimdLevel> out {SimdLevel::Scalar};
+    if (detectSimdLevel() != SimdLevel::Scalar) out.push_back(SimdLevel::Ssse3);
+    if (detectSimdLevel() == SimdLevel::Avx2) out.push_back(SimdLevel::Avx2);
+    return out;
+}
+
+// Every byte value, at every offset within a vector and for lengths around
+// the vector widths, folds like tolower in the "C" locale.
+static bool test_every_byte() {
+    std::string text;
+    for (int r = 0; r < 3; ++r) {
+        for (unsigned c = 0; c < 256; ++c) text += static_cast<char>(c);
+    }
+    std::string want(text);
+    for (char &c : want) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    for (SimdLevel level : levels()) {
+        for (std::size_t start = 0; start < 40; ++start) {
+            for (std::size_t n : {std::size_t(0), std::size_t(1), std::size_t(15), std::size_t(16), std::size_t(31),
+                                  std::size_t(33), std::size_t(64), text.size() - start}) {
+                std::string got(n, '\0');
+                foldAscii(text.data() + start, n, got.data(), level);
+                TEST_ASSERT(got == want.substr(start, n), simdLevelName(level) << ": offset " << start << ", length " << n);
+            }
+        }
+    }
+    TEST_PASS("every byte folds like tolower");
+    return true;
+}
+
+// A shadow built chunk by chunk equals the shadow of the whole text, and
+// assign() starts over.
+static bool test_streamed_shadow() {
+    std::string text;
+    std::uint64_t state = 3;
+    for (int i = 0; i < 5000; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        text += static_cast<char>(state >> 56);
+    }
+    FoldedText whole;
+    const std::string want(whole.assign(text));
+    TEST_ASSERT(want.size() == text.size(), "offsets are kept");
+    FoldedText streamed;
+    for (std::size_t pos = 0, step = 1; pos < text.size(); pos += step, step = step * 3 % 97 + 1) {
+        const std::string_view chunk = std::string_view(text).substr(pos, step);
+        const std::string_view folded = streamed.append(chunk);
+        TEST_ASSERT(folded == std::string_view(want).substr(pos, chunk.size()), "chunk at " << pos);
+    }
+    TEST_ASSERT(streamed.view() == want, "streamed shadow equals the whole one");
+    TEST_ASSERT(streamed.assign("CLI-Breaking") == "cli-breaking" && streamed.view().size() == 12, "assign replaces");
+    TEST_PASS("shadows fold chunk by chunk");
+    return true;
+}
+
+int main() {
+    std::cout << "Running case fold tests..." << std::endl;
+    bool ok = test_every_byte();
+    ok &= test_streamed_shadow();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "../test_helpers.h"
+#include "next_version/commit_log.h"
+#include "next_version/task_graph.h"
+
+using namespace nv;
+
+static constexpr PatternSet kAll = (PatternSet(1) << static_cast<unsigned>(Pattern::Count)) - 1;
+
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+static bool sameCounts(const PatternCounts &a, const PatternCounts &b) { return a.hits == b.hits; }
+
+// Each commit is counted on its own, so a phrase split over two commits
+// is not a match, and the per-commit hits add up to the totals.
+static bool test_per_commit_counts() {
+    const std::string log = std::string("fix: BREAKING:") + '\0' + "CLI flags renamed" + '\0' +
+                            "security fix for CVE-2024-1234\n\nBREAKING CHANGE: drop --old" + '\0' + "docs" + '\0';
+    CommitLogScanner scanner(kAll);
+    scanner.feed(log);
+    TEST_ASSERT(scanner.commits() == 4, "four records, got " << scanner.commits());
+    TEST_ASSERT(scanner.totals()[Pattern::CliBreakingCommit] == 0, "BREAKING and CLI are in different commits");
+    TEST_ASSERT(scanner.hits().size() == 1 && scanner.hits()[0].commit == 2, "only the third commit matches");
+    TEST_ASSERT(scanner.totals()[Pattern::GeneralBreaking] == 1 && scanner.totals()[Pattern::SecurityOrCve] == 2, "third commit counts");
+
+    PatternCounts whole;
+    PatternMatcher::get().count("fix: BREAKING: CLI flags renamed", kAll, whole);
+    TEST_ASSERT(whole[Pattern::CliBreakingCommit] == 1, "the same text in one commit matches");
+    TEST_ASSERT(sameCounts(countCommitLog(log, kAll), scanner.totals()), "countCommitLog gives the scanner totals");
+    TEST_ASSERT(countCommitLog("security", kAll)[Pattern::SecurityWord] == 1, "a record without its NUL still counts");
+    TEST_PASS("commit messages are counted one by one");
+    return true;
+}
+
+// Batches of whole records and any pool size give the same hits and totals.
+static bool test_batches_and_pools() {
+    const char *pieces[] = {"security ", "CVE-2023-44487 ", "BREAKING: ", "CLI ", "API ", "fix ", "\n", "crash ",
+                            "vulnerabilities ", "cli-breaking ", "major ", "token leak "};
+    Lcg rng {5};
+    std::string log;
+    for (int c = 0; c < 20000; ++c) {
+        for (unsigned i = 0, n = rng.next(12); i < n; ++i) log += pieces[rng.next(static_cast<unsigned>(std::size(pieces)))];
+        log += '\0';
+    }
+    CommitLogScanner expected(kAll);
+    expected.feed(log);
+    PatternCounts sum;
+    for (const auto &h : expected.hits()) sum += h.counts;
+    TEST_ASSERT(sameCounts(sum, expected.totals()) && expected.commits() == 20000, "hits add up to the totals");
+
+    for (unsigned workers : {0u, 1u, 4u}) {
+        std::unique_ptr<ThreadPool> pool;
+        if (workers) pool = std::make_unique<ThreadPool>(workers);
+        CommitLogScanner scanner(kAll);
+        std::string_view rest = log;
+        while (!rest.empty()) {
+            std::size_t cut = rest.find('\0', rng.next(200000));
+            cut = cut == std::string_view::npos ? rest.size() : cut + 1;
+            scanner.feed(rest.substr(0, cut), pool.get());
+            rest.remove_prefix(cut);
+        }
+        bool same = scanner.hits().size() == expected.hits().size();
+        for (std::size_t i = 0; same && i < scanner.hits().size(); ++i) {
+            same = scanner.hits()[i].commit == expected.hits()[i].commit && sameCounts(scanner.hits()[i].counts, expected.hits()[i].counts);
+        }
+        TEST_ASSERT(same && sameCounts(scanner.totals(), expected.totals()), workers << " workers: hits differ");
+    }
+    TEST_PASS("batching and threads do not change the counts");
+    return true;
+}
+
+// With ids, each record starts with its commit id, which is kept and not scanned.
+static bool test_commit_ids() {
+    const std::string a(40, 'a'), b(40, 'b'), c(40, 'c');
+    const std::string plain = std::string("BREAKING CHANGE: drop --old") + '\0' + "docs" + '\0' + "security fix" + '\0';
+    const std::string withIds = a + " BREAKING CHANGE: drop --old" + '\0' + b + " docs" + '\0' + c + " security fix" + '\0';
+    CommitLogScanner expected(kAll);
+    expected.feed(plain);
+    CommitLogScanner scanner(kAll, true);
+    scanner.feed(withIds);
+    TEST_ASSERT(scanner.ids().size() == 3 && scanner.ids()[0].hex() == a && scanner.ids()[2].hex() == c, "ids are kept in order");
+    TEST_ASSERT(sameCounts(scanner.totals(), expected.totals()), "ids do not change the counts");
+    TEST_ASSERT(scanner.hits().size() == expected.hits().size() && scanner.hits()[1].commit == 2, "hits name the same commits");
+    TEST_ASSERT(expected.ids().empty(), "no ids unless asked for");
+    TEST_PASS("commit ids are split off the records");
+    return true;
+}
+
+int main() {
+    std::cout << "Running commit log tests..." << std::endl;
+    bool ok = test_per_commit_counts();
+    ok &= test_batches_and_pools();
+    ok &= test_commit_ids();
+    return ok ? 0 : 1;
+}
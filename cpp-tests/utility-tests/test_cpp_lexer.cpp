@@ -0,0 +1,167 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/analyzers.h"
+#include "next_version/cpp_lexer.h"
+#include "next_version/task_graph.h"
+
+using namespace nv;
+
+using Tokens = std::vector<std::pair<CppTokenKind, std::string>>;
+
+static Tokens lex(CppLexer &lexer, std::string_view line) {
+    std::vector<CppToken> tokens;
+    lexer.lexLine(line, tokens);
+    Tokens out;
+    for (const CppToken &t : tokens) out.emplace_back(t.kind, std::string(t.text));
+    return out;
+}
+
+static std::string show(const Tokens &tokens) {
+    std::string s;
+    for (const auto &[kind, text] : tokens) s += std::to_string(static_cast<int>(kind)) + ":" + text + " ";
+    return s;
+}
+
+static bool test_tokens() {
+    using K = CppTokenKind;
+    CppLexer lexer;
+    const Tokens got = lex(lexer, "x=u8R\"d(a\")d\"+L'\\''-1.5e+3f/a::b; // c");
+    const Tokens want = {{K::Identifier, "x"}, {K::Punct, "="}, {K::String, "u8R\"d(a\")d\""}, {K::Punct, "+"},
+                         {K::Char, "L'\\''"}, {K::Punct, "-"}, {K::Number, "1.5e+3f"}, {K::Punct, "/"},
+                         {K::Identifier, "a"}, {K::Punct, "::"}, {K::Identifier, "b"}, {K::Punct, ";"},
+                         {K::Comment, "// c"}};
+    TEST_ASSERT(got == want, "got " << show(got));
+    TEST_ASSERT(lexer.inCode(), "a line comment without a backslash ends with the line");
+    const Tokens numbers = lex(lexer, "0x1'000 .5 a.b");
+    TEST_ASSERT(numbers.size() == 5 && numbers[0].second == "0x1'000" && numbers[1].second == ".5" && numbers[3].second == ".",
+                "got " << show(numbers));
+    TEST_PASS("identifiers, literals with prefixes, pp-numbers and punctuation");
+    return true;
+}
+
+// Comments and literals that stay open carry over to the next line.
+static bool test_multiline_state() {
+    using K = CppTokenKind;
+    CppLexer lexer;
+    TEST_ASSERT(lex(lexer, "a /* --b").back() == std::make_pair(K::Comment, std::string("/* --b")), "open block comment");
+    TEST_ASSERT(!lexer.inCode(), "still in the comment");
+    Tokens t = lex(lexer, "c */ d");
+    TEST_ASSERT(t.size() == 2 && t[0] == std::make_pair(K::Comment, std::string("c */")) && t[1].second == "d", "got " << show(t));
+
+    t = lex(lexer, "s = R\"x(line )\" one");
+    TEST_ASSERT(!lexer.inCode() && t.back().first == K::String, "open raw string");
+    t = lex(lexer, "case 1: )x\"; e");
+    TEST_ASSERT(t.size() == 3 && t[0] == std::make_pair(K::String, std::string("case 1: )x\"")), "got " << show(t));
+
+    lex(lexer, "p(\"a \\");
+    TEST_ASSERT(!lexer.inCode(), "a literal spliced with a backslash goes on");
+    t = lex(lexer, "b\");");
+    TEST_ASSERT(t.size() == 3 && t[0].first == K::String, "got " << show(t));
+    lex(lexer, "p(\"unterminated");
+    TEST_ASSERT(lexer.inCode(), "an unterminated literal ends with its line");
+    lex(lexer, "// x \\");
+    t = lex(lexer, "still a comment");
+    TEST_ASSERT(t.size() == 1 && t[0].first == K::Comment, "got " << show(t));
+    lex(lexer, "/*");
+    lexer.reset();
+    TEST_ASSERT(lexer.inCode() && lex(lexer, "*/").size() == 2, "reset goes back to code");
+    TEST_PASS("block comments, raw strings and spliced lines span lines");
+    return true;
+}
+
+static std::string patch(const std::vector<std::string> &removed, const std::vector<std::string> &added) {
+    std::string s = "diff --git a/cli.c b/cli.c\n--- a/cli.c\n+++ b/cli.c\n";
+    s += "@@ -1," + std::to_string(removed.size()) + " +1," + std::to_string(added.size()) + " @@\n";
+    for (const auto &l : removed) s += "-" + l + "\n";
+    for (const auto &l : added) s += "+" + l + "\n";
+    return s;
+}
+
+static CliResults scan(const std::string &text) {
+    CliScanner cli;
+    cli.feed(text);
+    return cli.finish();
+}
+
+// What the line regexes got wrong: code that looks like options, statements
+// that look like prototypes, and labels in comments.
+static bool test_cli_detectors() {
+    CliResults r = scan(patch({"  --count;", "  x = -y;", "  return compute(a, b);", "  else run(c);", "  // in case of: errors",
+                               "  obj.reset(a);", "  /* --old"}, {"  int z;"}));
+    TEST_ASSERT(!r.apiBreaking && r.removedShortCount == 0 && !r.breakingCliChanges, "no API, short option or case removal");
+    TEST_ASSERT(r.removedLongCount == 1, "only --old from the comment, got " << r.removedLongCount);
+    TEST_ASSERT(r.manualRemovedLongCount == 1, "--count is in code, like the shell analyzer counts it");
+
+    r = scan(patch({"static const char *", "describe(const Opt &o,", "         int width);"}, {}));
+    TEST_ASSERT(r.apiBreaking, "a prototype over three lines");
+    r = scan(patch({"bool operator==(const A &) const;"}, {}));
+    TEST_ASSERT(r.apiBreaking, "an operator");
+    r = scan(patch({"#define F(x) g(x);", "void f() { x(); }"}, {}));
+    TEST_ASSERT(!r.apiBreaking, "a macro and a definition");
+
+    r = scan(patch({"  if (!strcmp(arg, \"--verbose\")) usage(\"-v\");", "  case 'a': case 'b':"}, {"  case 'a':"}));
+    TEST_ASSERT(r.manualRemovedLongCount == 0 && r.removedLongCount == 1, "a quoted option is not a manual one");
+    TEST_ASSERT(r.removedShortCount == 2, "a short option in a literal, got " << r.removedShortCount);
+    TEST_ASSERT(r.breakingCliChanges, "case 'b' is removed");
+    r = scan(patch({"  case 'a': case 'b':"}, {"  case 'b': case /* x */ 'a' :"}));
+    TEST_ASSERT(!r.breakingCliChanges, "both labels are re-added");
+    r = scan(patch({}, {"  static_assert(check(\"--dry-run\")); // --help", "  run(--level); // --verbose",
+                        "  /* --debug */ run(--trace);", "  \"--x\" --y"}));
+    TEST_ASSERT(r.addedLongCount == 5, "options in literals and comments, got " << r.addedLongCount);
+    TEST_ASSERT(r.manualAddedLongCount == 2, "a quoted option or a comment line is not manual, got " << r.manualAddedLongCount);
+    TEST_PASS("CLI detectors skip comments, literals and code lookalikes");
+    return true;
+}
+
+// A comment open across a batch boundary or a parallel range gives the
+// same results as one sequential feed; a new hunk closes it.
+static bool test_batches() {
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        text += patch({"/* --gone-" + std::to_string(i), "   x(\"--fake\"); */", "void g" + std::to_string(i % 7) + "(int);"},
+                      {"\"--new-" + std::to_string(i) + "\" /* unterminated"});
+    }
+    const CliResults want = scan(text);
+    TEST_ASSERT(want.removedLongCount == 3001 && want.manualRemovedLongCount == 0, "--fake is in a comment");
+    TEST_ASSERT(want.addedLongCount == 3000 && want.manualAddedLongCount == 0, "every hunk starts in code");
+    TEST_ASSERT(want.apiBreaking, "g is removed");
+    ThreadPool pool(3);
+    for (std::size_t cut : {std::size_t(50), std::size_t(70001)}) {
+        CliScanner cli;
+        std::string_view rest = text;
+        while (!rest.empty()) {
+            std::size_t end = rest.find('\n', std::min(rest.size() - 1, cut));
+            end = end == std::string_view::npos ? rest.size() : end + 1;
+            cli.feed(rest.substr(0, end), &pool);
+            rest.remove_prefix(end);
+        }
+        const CliResults got = cli.finish();
+        TEST_ASSERT(got.removedLongCount == want.removedLongCount && got.addedLongCount == want.addedLongCount &&
+                    got.manualRemovedLongCount == want.manualRemovedLongCount &&
+                    got.manualAddedLongCount == want.manualAddedLongCount && got.apiBreaking == want.apiBreaking,
+                    "batches of " << cut << " bytes differ");
+    }
+    TEST_PASS("lexer state carries across batches and ranges");
+    return true;
+}
+
+int main() {
+    std::cout << "Running C/C++ lexer tests..." << std::endl;
+    bool ok = test_tokens();
+    ok &= test_multiline_state();
+    ok &= test_cli_detectors();
+    ok &= test_batches();
+    return ok ? 0 : 1;
+}
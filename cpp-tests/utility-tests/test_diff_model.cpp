@@ -0,0 +1,161 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/diff_model.h"
+
+using namespace nv;
+
+static const std::string kPatch =
+    "diff --git a/src/cli.cpp b/src/cli.cpp\n"
+    "index 1111111..2222222 100644\n"
+    "--- a/src/cli.cpp\n"
+    "+++ b/src/cli.cpp\n"
+    "@@ -10,2 +10 @@ int main()\n"
+    "---dry-run is gone\n"
+    "-  case 'n':\n"
+    "+++count\n"
+    "@@ -40 +39,0 @@\n"
+    "-old\n"
+    "diff --git a/README b/README\n"
+    "similarity index 90%\n"
+    "rename from README\n"
+    "rename to README.md\n"
+    "--- a/README\n"
+    "+++ b/README.md\n"
+    "@@ -1 +1 @@\n"
+    "-a\n"
+    "\\ No newline at end of file\n"
+    "+b\n"
+    "\\ No newline at end of file\n";
+
+using Kinds = std::vector<std::pair<PatchLineKind, std::string>>;
+
+static Kinds kinds(const DiffModel &m) {
+    Kinds out;
+    for (const PatchLine &l : m.lines()) out.emplace_back(l.kind, std::string(m.line(l)));
+    return out;
+}
+
+static bool test_structure() {
+    DiffModel m;
+    m.parse(kPatch);
+    using K = PatchLineKind;
+    const std::vector<K> expected = {K::Header, K::Header, K::Header, K::Header, K::Hunk, K::Removed, K::Removed,
+                                     K::Added, K::Hunk, K::Removed, K::Header, K::Header, K::Header, K::Header,
+                                     K::Header, K::Header, K::Hunk, K::Removed, K::Note, K::Added, K::Note};
+    TEST_ASSERT(m.lines().size() == expected.size(), "line count " << m.lines().size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        TEST_ASSERT(m.lines()[i].kind == expected[i], "kind of line " << i << " \"" << m.line(m.lines()[i]) << "\"");
+    }
+    TEST_ASSERT(m.files().size() == 2 && m.files()[0].lineCount == 10 && m.files()[1].firstLine == 10, "file records");
+    TEST_ASSERT(m.files()[0].hunkCount == 2 && m.files()[1].firstHunk == 2 && m.files()[1].hunkCount == 1, "file hunks");
+    TEST_ASSERT(m.hunks()[0].firstLine == 4 && m.hunks()[0].lineCount == 4 && m.hunks()[2].lineCount == 5, "hunk records");
+    TEST_ASSERT(m.lines()[17].file == 1, "line file index");
+    TEST_ASSERT(m.addedLines() == std::vector<std::uint32_t>({7, 19}), "added line index");
+    TEST_ASSERT(m.content(m.lines()[7]) == "++count" && m.content(m.lines()[4]) == "@@ -10,2 +10 @@ int main()", "content");
+    for (const PatchLine &l : m.lines()) {
+        const std::string_view s = m.line(l);
+        TEST_ASSERT(s.data() >= kPatch.data() && s.data() + s.size() <= kPatch.data() + kPatch.size(), "lines view the text");
+    }
+    TEST_PASS("files, hunks and lines of a patch");
+    return true;
+}
+
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+// Line-aligned batches classify every line as the whole text does, and the
+// file and hunk open at a cut continue in the next batch.
+static bool test_batches() {
+    std::string patch;
+    for (int i = 0; i < 20; ++i) patch += kPatch;
+    DiffModel whole;
+    whole.parse(patch);
+    const Kinds expected = kinds(whole);
+    for (std::uint64_t seed = 1; seed <= 50; ++seed) {
+        Lcg rng {seed};
+        DiffModel m;
+        Kinds got;
+        std::size_t files = 0, hunks = 0;
+        std::string_view rest = patch;
+        while (!rest.empty()) {
+            std::size_t cut = rest.find('\n', rng.next(300));
+            cut = cut == std::string_view::npos ? rest.size() : cut + 1;
+            m.parse(rest.substr(0, cut));
+            rest.remove_prefix(cut);
+            for (auto &k : kinds(m)) got.push_back(std::move(k));
+            for (const PatchFile &f : m.files()) files += !f.continued;
+            for (const PatchHunk &h : m.hunks()) hunks += m.lines()[h.firstLine].kind == PatchLineKind::Hunk && h.lineCount;
+        }
+        TEST_ASSERT(got == expected, "seed " << seed << ": batches classify differently");
+        TEST_ASSERT(files == whole.files().size() && hunks == whole.hunks().size(), "seed " << seed << ": " << files << " files, " << hunks << " hunks");
+    }
+    TEST_PASS("batch cuts do not change the model");
+    return true;
+}
+
+// Ranges tile the lines, start only at a file or hunk start, and their texts
+// add up to the whole patch.
+static bool test_ranges() {
+    std::string patch;
+    for (int i = 0; i < 20; ++i) patch += kPatch;
+    DiffModel m;
+    m.parse(patch);
+    for (std::size_t bytes : {std::size_t(0), std::size_t(1), std::size_t(100), std::size_t(1000), patch.size()}) {
+        const std::vector<PatchRange> ranges = m.ranges(bytes);
+        std::string joined;
+        std::size_t next = 0;
+        for (const PatchRange &r : ranges) {
+            TEST_ASSERT(r.firstLine == next && r.endLine > r.firstLine, bytes << ": ranges tile the lines");
+            const PatchLine &l = m.lines()[r.firstLine];
+            TEST_ASSERT(r.firstLine == 0 || l.kind == PatchLineKind::Hunk || m.line(l).substr(0, 5) == "diff ",
+                        bytes << ": range starts at \"" << m.line(l) << "\"");
+            joined += m.text(r);
+            next = r.endLine;
+        }
+        TEST_ASSERT(next == m.lines().size() && joined == patch, bytes << ": ranges cover the patch");
+        if (bytes == 0) TEST_ASSERT(ranges.size() == 20 * 5, "every file and hunk start is a cut");
+        if (bytes == patch.size()) TEST_ASSERT(ranges.size() == 1, "one range when nothing reaches the size");
+    }
+    TEST_PASS("ranges cut at file and hunk starts");
+    return true;
+}
+
+static bool test_bare_lines() {
+    DiffModel m;
+    m.parse("-  {\"dry-run\", no_argument},\n+  case 'x':\n context\n--- header\nplain");
+    using K = PatchLineKind;
+    TEST_ASSERT(kinds(m) == Kinds({{K::Removed, "-  {\"dry-run\", no_argument},"}, {K::Added, "+  case 'x':"},
+                                   {K::Context, " context"}, {K::Header, "--- header"}, {K::Header, "plain"}}),
+                "lines outside hunks are classified by their marker");
+    TEST_ASSERT(m.files().size() == 1 && !m.files()[0].continued, "bare lines belong to one file");
+    m.reset();
+    m.parse("");
+    TEST_ASSERT(m.lines().empty() && m.files().empty(), "empty text");
+    TEST_PASS("bare diff lines");
+    return true;
+}
+
+int main() {
+    std::cout << "Running diff model tests..." << std::endl;
+    bool ok = test_structure();
+    ok &= test_batches();
+    ok &= test_ranges();
+    ok &= test_bare_lines();
+    return ok ? 0 : 1;
+}
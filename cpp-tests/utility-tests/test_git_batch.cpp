@@ -0,0 +1,97 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
+#include "../test_helpers.h"
+#include "next_version/git_batch.h"
+#include "next_version/git_helpers.h"
+
+using namespace nv;
+
+static std::string init_repo() {
+    const std::string dir = init_test_repo("git_batch");
+    write_file(dir + "/src/a.cpp", "int a(){return 1;}\n");
+    git(dir, "add .");
+    git(dir, "commit -m 'init' -q");
+    git(dir, "tag -a v1.0.0 -m 'Release v1.0.0'");
+    {
+        std::ofstream f(dir + "/src/a.cpp", std::ios::app); f << "int b(){return 2;}\n";
+    }
+    git(dir, "commit -am 'second' -q");
+    return dir;
+}
+
+static std::string rev_parse(const std::string &repo, const std::string &rev) {
+    std::string out;
+    runGitCapture({"rev-parse", "-q", "--verify", rev}, repo, out);
+    return trim(out);
+}
+
+static bool test_ref_resolution(const std::string &repo) {
+    GitBatch batch(repo);
+    const int before = gitInvocationCount();
+    const std::string head = batch.resolveCommit("HEAD");
+    const std::string parent = batch.resolve("HEAD~1");
+    const std::string tagged = batch.resolveCommit("v1.0.0");
+    const std::string missing = batch.resolve("no-such-ref");
+    const int used = gitInvocationCount() - before;
+    TEST_ASSERT(head == rev_parse(repo, "HEAD^{commit}"), "HEAD should match rev-parse");
+    TEST_ASSERT(parent == rev_parse(repo, "HEAD~1"), "HEAD~1 should match rev-parse");
+    TEST_ASSERT(tagged == parent, "annotated tag should peel to the first commit");
+    TEST_ASSERT(missing.empty(), "unknown refs should not resolve");
+    TEST_ASSERT(used == 1, "all lookups should share one coprocess, used " << used);
+    TEST_PASS("GitBatch ref resolution");
+    return true;
+}
+
+static bool test_object_reads(const std::string &repo) {
+    GitBatch batch(repo);
+    GitObjectInfo tag = batch.info("v1.0.0");
+    TEST_ASSERT(tag.found && tag.type == "tag", "v1.0.0 should be an annotated tag object");
+    GitObjectInfo tree = batch.info("HEAD^{tree}");
+    TEST_ASSERT(tree.found && tree.type == "tree", "HEAD^{tree} should be a tree");
+
+    GitObjectInfo blob;
+    std::string data;
+    TEST_ASSERT(batch.contents("HEAD:src/a.cpp", blob, data), "blob contents should be readable");
+    TEST_ASSERT(blob.type == "blob" && blob.size == data.size(), "size should match payload");
+    TEST_ASSERT(data == "int a(){return 1;}\nint b(){return 2;}\n", "blob payload should match the file");
+
+    // The stream stays in sync after a miss and after a payload
+    std::string none;
+    GitObjectInfo absent;
+    TEST_ASSERT(!batch.contents("HEAD:src/missing.cpp", absent, none), "missing path should fail");
+    TEST_ASSERT(none.empty(), "missing objects should not produce data");
+    TEST_ASSERT(batch.info("HEAD~1:src/a.cpp").size == 19, "older blob should be readable afterwards");
+
+    // Names that would break the line protocol are rejected up front
+    TEST_ASSERT(!batch.info("HEAD\ninfo HEAD").found, "newlines must be rejected");
+    TEST_ASSERT(batch.info("HEAD").found, "stream should still be usable");
+    TEST_PASS("GitBatch object reads");
+    return true;
+}
+
+static bool test_not_a_repository() {
+    GitBatch batch("/non/existent/path");
+    TEST_ASSERT(batch.resolveCommit("HEAD").empty(), "nothing resolves outside a repository");
+    TEST_ASSERT(!batch.info("HEAD").found, "repeated lookups keep failing cleanly");
+    TEST_PASS("GitBatch outside a repository");
+    return true;
+}
+
+int main() {
+    std::cout << "Running git batch tests..." << std::endl;
+    const std::string repo = init_repo();
+    bool ok = true;
+    ok &= test_ref_resolution(repo);
+    ok &= test_object_reads(repo);
+    ok &= test_not_a_repository();
+    return ok ? 0 : 1;
+}
@@ -206,6 +206,52 @@ void test_process_operations() {
     std::cout << "✓ Process operations tests passed" << std::endl;
 }
 
+void test_direct_spawn() {
+    std::cout << "Testing direct process spawning..." << std::endl;
+    
+    // stdout and stderr are captured separately, exit status is preserved
+    ProcessResult split;
+    int rc = runProcess({"sh", "-c", "echo out; echo err >&2; exit 3"}, split);
+    if (rc != 3 || split.out != "out\n" || split.err != "err\n") {
+        std::cerr << "FAIL: Expected rc=3, out='out', err='err', got rc=" << rc
+                  << " out='" << split.out << "' err='" << split.err << "'" << std::endl;
+        exit(1);
+    }
+    
+    // Arguments are passed verbatim, no shell quoting involved
+    ProcessResult verbatim;
+    runProcess({"printf", "%s|", "a b", "it's", "$HOME"}, verbatim);
+    if (verbatim.out != "a b|it's|$HOME|") {
+        std::cerr << "FAIL: Expected verbatim arguments, got " << verbatim.out << std::endl;
+        exit(1);
+    }
+    
+    // Output larger than any single pipe read is captured completely
+    ProcessResult big;
+    runProcess({"head", "-c", "1048576", "/dev/zero"}, big);
+    if (big.out.size() != 1048576) {
+        std::cerr << "FAIL: Expected 1 MiB of output, got " << big.out.size() << std::endl;
+        exit(1);
+    }
+    
+    // Missing executables report 127 without a shell
+    ProcessResult missing;
+    if (runProcess({"nonexistent_command_12345"}, missing) != 127) {
+        std::cerr << "FAIL: Expected exit code 127 for missing executable" << std::endl;
+        exit(1);
+    }
+    
+    // Git failures keep their diagnostics on stderr
+    ProcessResult gitErr;
+    int gitRc = runGitCapture({"rev-parse", "--verify", "no-such-ref-12345"}, ".", gitErr);
+    if (gitRc == 0 || gitErr.err.empty()) {
+        std::cerr << "FAIL: Expected failing rev-parse with stderr output" << std::endl;
+        exit(1);
+    }
+    
+    std::cout << "✓ Direct spawn tests passed" << std::endl;
+}
+
 void test_edge_cases() {
     std::cout << "Testing edge cases..." << std::endl;
     
@@ -251,6 +297,7 @@ int main() {
     test_git_operations();
     test_path_classification();
     test_process_operations();
+    test_direct_spawn();
     test_edge_cases();
     
     std::cout << "All git helpers tests passed!" << std::endl;
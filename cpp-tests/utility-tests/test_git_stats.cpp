@@ -15,8 +15,8 @@
 
 using namespace nv;
 
-static bool init_repo_with_changes(std::string &dir, std::string &baseRef) {
-    dir = std::string("/tmp/nv_git_stats_") + std::to_string(::getpid());
+static bool init_repo_with_changes(std::string &dir, std::string &baseRef, const std::string &name = "nv_git_stats_") {
+    dir = std::string("/tmp/") + name + std::to_string(::getpid());
     std::filesystem::create_directories(dir + "/src");
     std::string cmd;
     cmd = "git -C " + dir + " init"; std::system(cmd.c_str());
@@ -60,10 +60,32 @@ static bool test_file_change_stats_counts() {
     return true;
 }
 
+static bool test_range_snapshot_shared() {
+    std::string repo, base;
+    init_repo_with_changes(repo, base, "nv_range_snapshot_");
+    FileChangeStats legacy = computeFileChangeStats(repo, base, "HEAD", "", false);
+    const int before = gitInvocationCount();
+    RangeSnapshot snap = collectRangeSnapshot(repo, base, "HEAD", "", false);
+    const int used = gitInvocationCount() - before;
+    TEST_ASSERT(used <= 4, "snapshot should need at most four git invocations, used " << used);
+    FileChangeStats s = computeFileChangeStats(snap);
+    TEST_ASSERT(s.addedFiles == legacy.addedFiles && s.modifiedFiles == legacy.modifiedFiles
+                && s.deletedFiles == legacy.deletedFiles && s.newTestFiles == legacy.newTestFiles
+                && s.insertions == legacy.insertions && s.deletions == legacy.deletions,
+                "snapshot stats should match per-call stats");
+    TEST_ASSERT(s.modifiedFiles == 2, "expected README.md and src/a.cpp to be modified");
+    TEST_ASSERT(snap.cliDiffText().find("src/a.cpp") != std::string::npos, "CLI diff should include C++ sources");
+    TEST_ASSERT(snap.cliDiffText().find("README.md") == std::string::npos, "CLI diff should exclude docs by default");
+    TEST_ASSERT(snap.log.find("add files") != std::string::npos, "log should contain commit subjects");
+    TEST_PASS("collectRangeSnapshot shares one fetch across analyzers");
+    return true;
+}
+
 int main() {
     std::cout << "Running git stats tests..." << std::endl;
     bool ok = true;
     ok &= test_file_change_stats_counts();
+    ok &= test_range_snapshot_shared();
     return ok ? 0 : 1;
 }
 
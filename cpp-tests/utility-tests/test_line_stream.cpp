@@ -0,0 +1,251 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <algorithm>
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include "../test_helpers.h"
+#include "next_version/analyzers.h"
+#include "next_version/git_helpers.h"
+#include "next_version/line_stream.h"
+#include "next_version/range_snapshot.h"
+#include "next_version/result_cache.h"
+#include "next_version/security_tokens.h"
+
+using namespace nv;
+
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+// Reader over a string that returns short, uneven reads like a pipe does.
+static ReadFn reader_over(const std::string &text, Lcg &rng) {
+    return [&text, &rng, pos = std::size_t(0)](char *dst, std::size_t n) mutable {
+        const std::size_t take = std::min({n, text.size() - pos, static_cast<std::size_t>(1 + rng.next(40))});
+        std::copy_n(text.data() + pos, take, dst);
+        pos += take;
+        return take;
+    };
+}
+
+static bool test_batches_are_line_aligned() {
+    Lcg rng {3};
+    for (char delim : {'\n', '\0'}) {
+        for (int round = 0; round < 50; ++round) {
+            std::string text;
+            const unsigned lines = rng.next(200);
+            for (unsigned i = 0; i < lines; ++i) text += std::string(rng.next(i % 17 == 0 ? 90 : 12), 'a' + static_cast<char>(i % 26)) + delim;
+            if (round % 3 == 0) text += "no delimiter at the end";
+            std::string joined;
+            std::size_t batches = 0;
+            bool aligned = true;
+            LineStreamOptions opts {16, 3};
+            opts.delimiter = delim;
+            const LineStreamStats st = streamLines(reader_over(text, rng), [&](std::string_view b) {
+                joined.append(b);
+                ++batches;
+                if (b.back() != delim && joined.size() != text.size()) aligned = false;
+            }, opts);
+            TEST_ASSERT(joined == text, "round " << round << ": batches must reassemble the input");
+            TEST_ASSERT(aligned, "round " << round << ": only the last batch may end without a delimiter");
+            TEST_ASSERT(st.bytes == text.size() && st.batches == batches, "round " << round << ": stats");
+        }
+    }
+    TEST_PASS("batches are line-aligned and lossless");
+    return true;
+}
+
+static bool test_memory_is_bounded() {
+    std::string text;
+    for (int i = 0; text.size() < (8u << 20); ++i) text += "+line " + std::to_string(i) + " of a long patch\n";
+    std::size_t pos = 0;
+    std::size_t seen = 0;
+    const LineStreamStats st = streamLines([&](char *dst, std::size_t n) {
+        const std::size_t take = std::min(n, text.size() - pos);
+        std::copy_n(text.data() + pos, take, dst);
+        pos += take;
+        return take;
+    }, [&](std::string_view b) { seen += b.size(); }, LineStreamOptions{64 * 1024, 4});
+    TEST_ASSERT(seen == text.size(), "every byte consumed");
+    TEST_ASSERT(st.ringBytes <= 4 * 64 * 1024, "ring grew to " << st.ringBytes << " bytes for an 8 MiB stream");
+    TEST_ASSERT(st.batches >= 8u * 16u, "input should arrive in many batches, got " << st.batches);
+    TEST_PASS("ring memory stays at chunkCount * chunkSize");
+    return true;
+}
+
+static bool test_consumer_exception() {
+    Lcg rng {5};
+    std::string text;
+    for (int i = 0; i < 500; ++i) text += "line\n";
+    bool thrown = false;
+    try {
+        streamLines(reader_over(text, rng), [](std::string_view) { throw std::runtime_error("stop"); }, LineStreamOptions{32, 2});
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    TEST_ASSERT(thrown, "the consumer's exception reaches the caller");
+    TEST_PASS("consumer exceptions are rethrown after the reader stops");
+    return true;
+}
+
+static std::string init_repo() {
+    const std::string dir = init_test_repo("line_stream");
+    write_file(dir + "/src/cli.cpp",
+               "static struct option opts[] = {\n  {\"verbose\", 0, 0, 'v'},\n  {\"output\", 1, 0, 'o'},\n};\n"
+               "switch (c) {\ncase 'v': break;\ncase 'o': break;\n}\nint parse(int argc, char **argv);\n");
+    write_file(dir + "/docs/notes.md", "Notes\n");
+    std::string old;
+    for (int i = 0; i < 40; ++i) old += "line " + std::to_string(i) + " of the guide\n";
+    write_file(dir + "/docs/old.md", old);
+    write_file(dir + "/assets/logo.bin", std::string("\x89PNG\0\0\x01", 7));
+    git(dir, "add -A");
+    git(dir, "commit -q -m base");
+    git(dir, "tag v1");
+
+    write_file(dir + "/src/cli.cpp",
+               "static struct option opts[] = {\n  {\"verbose\", 0, 0, 'v'},\n  {\"format\", 1, 0, 'f'},\n};\n"
+               "switch (c) {\ncase 'v': break;\ncase 'f': break;\n}\n// SECURITY: bounds check\n");
+    std::string notes = "Notes\n";
+    for (int i = 0; i < 3000; ++i) notes += "entry " + std::to_string(i) + ": fixed a crash, CVE-2024-" + std::to_string(1000 + i) + " buffer overflow\n";
+    notes += "API BREAKING: removed option --output\n";
+    write_file(dir + "/docs/notes.md", notes);
+    git(dir, "mv docs/old.md docs/moved.md");
+    write_file(dir + "/docs/moved.md", old + "see --verbose, a security fix\n");
+    write_file(dir + "/assets/logo.bin", std::string("\x89PNG\0\0\x02", 7));
+    write_file(dir + "/src/extra.h", "// removed option --output\nint parse_extra(int argc, char **argv);\n");
+    git(dir, "add -A");
+    git(dir, "commit -q -m 'security: BREAKING CHANGE to the CLI'");
+    return dir;
+}
+
+static bool same(const CliResults &a, const CliResults &b) {
+    return a.cliChanges == b.cliChanges && a.breakingCliChanges == b.breakingCliChanges && a.apiBreaking == b.apiBreaking &&
+           a.manualCliChanges == b.manualCliChanges && a.removedShortCount == b.removedShortCount &&
+           a.removedLongCount == b.removedLongCount && a.addedLongCount == b.addedLongCount &&
+           a.manualAddedLongCount == b.manualAddedLongCount && a.manualRemovedLongCount == b.manualRemovedLongCount;
+}
+
+static bool same(const SecurityResults &a, const SecurityResults &b) {
+    return a.securityKeywordsCommits == b.securityKeywordsCommits && a.securityPatternsDiff == b.securityPatternsDiff &&
+           a.cvePatterns == b.cvePatterns && a.memorySafetyIssues == b.memorySafetyIssues && a.crashFixes == b.crashFixes;
+}
+
+static bool same(const KeywordResults &a, const KeywordResults &b) {
+    return a.hasCliBreaking == b.hasCliBreaking && a.hasApiBreaking == b.hasApiBreaking &&
+           a.hasGeneralBreaking == b.hasGeneralBreaking && a.totalSecurity == b.totalSecurity &&
+           a.removedOptionsKeywords == b.removedOptionsKeywords;
+}
+
+// Streamed patches, fed to the scanners in small line-aligned batches, give the
+// same results as the analyzers over the stored snapshot.
+static bool test_streamed_analysis(const std::string &repo) {
+    for (const char *paths : {"", "src", "docs,src"}) {
+        for (bool native : {false, true}) {
+            const std::string label = std::string("pathspec '") + paths + "'" + (native ? " native" : "");
+            const RangeSnapshot stored = collectRangeSnapshot(repo, "v1", "HEAD", paths, false, SnapshotAll, native);
+            const CliResults cli = analyzeCliOptions(stored);
+            const SecurityResults sec = analyzeSecurity(stored);
+            const KeywordResults kw = analyzeKeywords(stored);
+
+            KeywordScanner kwScanner;
+            CliScanner cliScanner;
+            SecurityScanner secScanner;
+            CommitLogScanner logScanner(KeywordScanner::logPatterns | SecurityScanner::logPatterns);
+            std::string diffText, cliText, logText;
+            DiffSinks sinks;
+            sinks.diff = [&](std::string_view b) { diffText.append(b); secScanner.feed(b); kwScanner.feed(b); };
+            sinks.cliDiff = [&](std::string_view b) { cliText.append(b); cliScanner.feed(b); };
+            sinks.log = [&](std::string_view b) { logText.append(b); logScanner.feed(b); };
+            const RangeSnapshot streamed = collectRangeSnapshot(repo, "v1", "HEAD", paths, false, SnapshotAll, native, 50, sinks);
+            TEST_ASSERT(streamed.diff.empty() && streamed.cliDiff.empty() && streamed.log.empty(), label << ": streamed parts are not stored");
+            TEST_ASSERT(diffText == stored.diff && cliText == stored.cliDiffText() && logText == stored.log, label << ": streamed text differs");
+            TEST_ASSERT(same(cliScanner.finish(), cli), label << ": CLI results differ");
+            TEST_ASSERT(same(secScanner.finish(logScanner.totals()), sec), label << ": security results differ");
+            TEST_ASSERT(same(kwScanner.finish(logScanner.totals()), kw), label << ": keyword results differ");
+
+            // Arbitrary line-aligned cuts must not change any count.
+            Lcg rng {11};
+            KeywordScanner kwSplit;
+            SecurityScanner secSplit(true);
+            std::string_view rest = stored.diff;
+            while (!rest.empty()) {
+                std::size_t cut = std::min(rest.size(), static_cast<std::size_t>(1 + rng.next(4000)));
+                cut = rest.find('\n', cut - 1);
+                cut = cut == std::string_view::npos ? rest.size() : cut + 1;
+                kwSplit.feed(rest.substr(0, cut));
+                secSplit.feed(rest.substr(0, cut));
+                rest.remove_prefix(cut);
+            }
+            TEST_ASSERT(same(kwSplit.finish(stored.log), kw), label << ": keyword counts depend on batch cuts");
+            TEST_ASSERT(same(secSplit.finish(stored.log), analyzeSecurity(stored, true)), label << ": added-only counts depend on batch cuts");
+        }
+    }
+    TEST_PASS("streamed analysis matches the stored snapshot");
+    return true;
+}
+
+// Native patches handed over a blob pair at a time give the same results and
+// line stats, both when every pair is scanned and when every pair comes from
+// the cache.
+static bool test_pair_analysis(const std::string &repo) {
+    const std::string file = repo + "/.git/next-version/pairs";
+    for (const char *paths : {"", "src", "docs,src"}) {
+        for (bool ws : {false, true}) {
+            std::filesystem::remove(file);
+            const std::string label = std::string("pathspec '") + paths + "'" + (ws ? " -w" : "");
+            const RangeSnapshot stored = collectRangeSnapshot(repo, "v1", "HEAD", paths, ws, SnapshotAll, true);
+            TEST_ASSERT(stored.native, label << ": the snapshot is native");
+            for (int pass = 0; pass < 2; ++pass) {
+                PairCache cache(PairCache::pathFor(repo));
+                KeywordScanner kwScanner;
+                CliScanner cliScanner;
+                SecurityScanner secScanner;
+                DiffSinks sinks;
+                sinks.diff = [&](std::string_view b) {
+                    PatternCounts hits;
+                    countPatterns(b, KeywordScanner::diffPatterns | SecurityScanner::diffPatterns, hits);
+                    kwScanner.add(hits);
+                    secScanner.add(hits);
+                };
+                sinks.cliDiff = [&](std::string_view b) { cliScanner.feed(b); };
+                PairScanner pairs(cache, kwScanner, secScanner, cliScanner);
+                pairs.attach(sinks);
+                const RangeSnapshot snap = collectRangeSnapshot(repo, "v1", "HEAD", paths, ws, SnapshotAll, true, 50, sinks);
+                const std::string run = label + (pass ? " from the cache" : " scanned");
+                TEST_ASSERT(pass == 0 ? cache.hits() == 0 && cache.misses() > 0 : cache.misses() == 0 && cache.hits() > 0,
+                            run << ": " << cache.hits() << " hits, " << cache.misses() << " misses");
+                TEST_ASSERT(same(cliScanner.finish(), analyzeCliOptions(stored)), run << ": CLI results differ");
+                TEST_ASSERT(same(secScanner.finish(stored.log), analyzeSecurity(stored)), run << ": security results differ");
+                TEST_ASSERT(same(kwScanner.finish(stored.log), analyzeKeywords(stored)), run << ": keyword results differ");
+                const FileChangeStats a = computeFileChangeStats(snap), b = computeFileChangeStats(stored);
+                TEST_ASSERT(a.insertions == b.insertions && a.deletions == b.deletions, run << ": line stats differ");
+                TEST_ASSERT(cache.save(), run << ": the cache is saved");
+            }
+        }
+    }
+    TEST_PASS("pair-at-a-time analysis matches the whole patches");
+    return true;
+}
+
+int main() {
+    std::cout << "Running line stream tests..." << std::endl;
+    bool ok = test_batches_are_line_aligned();
+    ok &= test_memory_is_bounded();
+    ok &= test_consumer_exception();
+    const std::string repo = init_repo();
+    ok &= test_streamed_analysis(repo);
+    ok &= test_pair_analysis(repo);
+    return ok ? 0 : 1;
+}
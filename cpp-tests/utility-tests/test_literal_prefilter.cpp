@@ -0,0 +1,113 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/literal_prefilter.h"
+
+using namespace nv;
+
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+static std::vector<SimdLevel> levels() {
+    std::vector<SimdLevel> out {SimdLevel::Scalar};
+    if (detectSimdLevel() != SimdLevel::Scalar) out.push_back(SimdLevel::Ssse3);
+    if (detectSimdLevel() == SimdLevel::Avx2) out.push_back(SimdLevel::Avx2);
+    return out;
+}
+
+static std::vector<bool> candidates(const LiteralPrefilter &pf, const std::string &text, SimdLevel level) {
+    std::vector<bool> out(text.size(), false);
+    std::uint32_t mask = 0;
+    for (std::size_t pos = 0; (pos = pf.nextBlock(text, pos, mask, level)) != std::string::npos; pos += LiteralPrefilter::kBlock) {
+        for (unsigned i = 0; i < 32; ++i) {
+            if (mask >> i & 1) out.at(pos + i) = true;
+        }
+    }
+    return out;
+}
+
+static bool startsWithIcase(const std::string &text, std::size_t pos, const std::string &w) {
+    if (text.size() - pos < w.size()) return false;
+    for (std::size_t i = 0; i < w.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(text[pos + i])) != w[i]) return false;
+    }
+    return true;
+}
+
+// No word start is ever missed, at any length and alignment, and every
+// level reports exactly the positions the scalar lookup does.
+static bool test_no_missed_starts() {
+    const std::vector<std::string> words = {"security", "cve", "breaking", "oob", "use", "vulnerabilit", "tls", "segfault", "xss"};
+    const LiteralPrefilter pf(words);
+    const char *pieces[] = {"Security", "CVE", "breaking", "OoB", "use", "vulnerabilit", "tls", "segfault", "xss",
+                            "sec", "cv", "the ", "and ", "e", "s", "\n", " ", "-", "_", "\x80", "\xff", "@", "["};
+    Lcg rng {9};
+    std::size_t hits = 0, flagged = 0, total = 0;
+    for (int round = 0; round < 3000; ++round) {
+        std::string text;
+        const unsigned n = rng.next(round % 50 == 0 ? 400 : 30);
+        for (unsigned i = 0; i < n; ++i) text += pieces[rng.next(static_cast<unsigned>(std::size(pieces)))];
+        const std::vector<bool> scalar = candidates(pf, text, SimdLevel::Scalar);
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            bool start = false;
+            for (const auto &w : words) start |= startsWithIcase(text, i, w);
+            TEST_ASSERT(!start || scalar[i], "round " << round << ": start at " << i << " missed in \"" << text << "\"");
+            hits += start;
+            flagged += scalar[i];
+        }
+        total += text.size();
+        for (SimdLevel level : levels()) {
+            TEST_ASSERT(candidates(pf, text, level) == scalar, simdLevelName(level) << " differs from scalar in round " << round);
+        }
+    }
+    TEST_ASSERT(hits > 1000, "the texts should contain plenty of words, got " << hits);
+    std::cout << "  " << flagged << " candidates for " << hits << " starts in " << total << " bytes" << std::endl;
+    TEST_PASS("prefilter keeps every word start on every level");
+    return true;
+}
+
+// Ordinary prose without any of the words should rarely reach verification.
+static bool test_selectivity() {
+    const LiteralPrefilter pf({"security", "breaking", "overflow", "crash", "deadlock", "token", "exploit", "auth"});
+    std::string text;
+    for (int i = 0; i < 2000; ++i) text += "int parse_options(int argc, char **argv) { return count + offset; } // the quick brown fox\n";
+    std::size_t flagged = 0;
+    for (bool c : candidates(pf, text, detectSimdLevel())) flagged += c;
+    TEST_ASSERT(flagged * 20 < text.size(), flagged << " of " << text.size() << " positions flagged");
+    TEST_PASS("prefilter passes few positions of unrelated text");
+    return true;
+}
+
+static bool test_empty() {
+    const LiteralPrefilter none;
+    std::uint32_t mask = 0;
+    TEST_ASSERT(none.nextBlock(std::string(100, 'a'), 0, mask, detectSimdLevel()) == std::string::npos, "no words, no candidates");
+    const LiteralPrefilter pf({"security"});
+    TEST_ASSERT(pf.nextBlock("", 0, mask, detectSimdLevel()) == std::string::npos, "empty text");
+    TEST_ASSERT(pf.nextBlock("security", 0, mask, detectSimdLevel()) == 0 && (mask & 1), "word shorter than a block");
+    TEST_PASS("edge cases");
+    return true;
+}
+
+int main() {
+    std::cout << "Running literal prefilter tests (" << simdLevelName(detectSimdLevel()) << ")..." << std::endl;
+    bool ok = test_no_missed_starts();
+    ok &= test_selectivity();
+    ok &= test_empty();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/analyzers.h"
+#include "next_version/cpp_lexer.h"
+#include "next_version/pattern_registry.h"
+
+using namespace nv;
+
+// Single lines of 50 MB shaped to make a backtracking engine explore every
+// split of the line. Each input must be handled in linear time.
+static constexpr std::size_t kLineBytes = 50u << 20;
+
+#ifdef DEBUG
+static constexpr double kBudgetSeconds = 60.0;   // unoptimized, maybe sanitized
+#else
+static constexpr double kBudgetSeconds = 5.0;
+#endif
+
+static std::string repeat(const std::string &prefix, const std::string &unit, const std::string &suffix = "") {
+    std::string s;
+    s.reserve(kLineBytes + prefix.size() + suffix.size() + unit.size());
+    s += prefix;
+    while (s.size() < kLineBytes + prefix.size()) s += unit;
+    s += suffix;
+    return s;
+}
+
+template <class Fn>
+static double seconds(Fn &&fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool test_line_patterns() {
+    const std::string inputs[] = {
+        repeat("-x", "a"),                   // one identifier
+        repeat("-x", "int *f(a) "),          // declarations that never end in ';'
+        repeat("-x", "a -"),                 // short options that never end the line
+        repeat("", "--"),                    // long option prefixes without a name
+        repeat("", "case "),                 // case labels without a ':'
+        repeat("\"", "\\\" -x "),            // a literal of escaped quotes
+        repeat("R\"d(", ")d )"),             // a raw string missing its delimiter
+        repeat("{", "x", ")"),               // minified code with nothing to find
+    };
+    for (const auto &line : inputs) {
+        int found = 0;
+        const double t = seconds([&] {
+            found += patterns::ShortOption::search(line);
+            patterns::LongOption::forEach(line, [&](const auto &) { ++found; });
+            CppLexer lexer;
+            std::vector<CppToken> tokens;
+            lexer.lexLine(line, tokens);
+            found += static_cast<int>(tokens.size());
+        });
+        TEST_ASSERT(t < kBudgetSeconds, "line starting \"" << line.substr(0, 12) << "\" took " << t << " s");
+        std::cout << "  \"" << line.substr(0, 12) << "...\": " << t << " s, " << found << " matches and tokens" << std::endl;
+    }
+    TEST_PASS("line patterns and the lexer run in linear time on 50 MB lines");
+    return true;
+}
+
+static bool test_scanners() {
+    const std::string inputs[] = {
+        repeat("+", "BREAKING: "),                       // every BREAKING looks for CLI to the end of the line
+        repeat("-", "breaking  ", "cli"),
+        repeat("+#", " ", "security"),                   // one comment token far before SECURITY
+        repeat("+", "security# "),
+        repeat("-", "cve-2024-1"),
+        repeat("+", "segmentation "),
+        repeat("-x", "var a=function(b){return b--}; "),   // minified script
+    };
+    for (const auto &line : inputs) {
+        const double t = seconds([&] {
+            KeywordScanner keywords;
+            keywords.feed(line);
+            (void)keywords.finish(line);
+            SecurityScanner security(true);
+            security.feed(line);
+            (void)security.finish(line);
+            CliScanner cli;
+            cli.feed(line);
+            (void)cli.finish();
+        });
+        TEST_ASSERT(t < kBudgetSeconds, "line starting \"" << line.substr(0, 12) << "\" took " << t << " s");
+        std::cout << "  \"" << line.substr(0, 12) << "...\": " << t << " s" << std::endl;
+    }
+    CliScanner cli;
+    cli.feed(repeat("-", "--opt "));
+    cli.feed("+  {\"dry-run\", no_argument, 0, 'n'}, // --dry-run\n");
+    const CliResults r = cli.finish();
+    TEST_ASSERT(r.removedLongCount == 0 && r.addedLongCount == 1, "lines over the length limit are skipped");
+    TEST_PASS("analyzers run in linear time on 50 MB lines");
+    return true;
+}
+
+int main() {
+    std::cout << "Running long line tests..." << std::endl;
+    bool ok = test_line_patterns();
+    ok &= test_scanners();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,282 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <unistd.h>
+#include "../test_helpers.h"
+#include "next_version/git_batch.h"
+#include "next_version/git_helpers.h"
+#include "next_version/object_store.h"
+
+using namespace nv;
+
+// Commits that rewrite a mid-sized file a few lines at a time, so repacking produces delta chains.
+static void add_history(const std::string &dir, int from, int to) {
+    for (int c = from; c < to; ++c) {
+        {
+            std::ofstream f(dir + "/src/big.cpp");
+            for (int i = 0; i < 300; ++i) {
+                f << "int line_" << i << "(){ return " << (i % 17 == c % 17 ? c * 1000 + i : i) << "; }\n";
+            }
+        }
+        {
+            std::ofstream f(dir + "/notes_" + std::to_string(c % 3) + ".md");
+            f << "# Notes " << c << "\n\nRevision " << c << " of the notes.\n";
+        }
+        git(dir, "add -A");
+        git(dir, "commit -q -m 'revision " + std::to_string(c) + "'");
+    }
+}
+
+static std::string init_repo(const std::string &name, const std::string &format) {
+    const std::string dir = init_test_repo("object_store_" + name, "--object-format=" + format);
+    git(dir, "config gc.auto 0");
+    write_file(dir + "/src/nested/deeper/leaf.h", "#pragma once\n");
+    write_file(dir + "/empty.txt", "");
+    add_history(dir, 0, 6);
+    git(dir, "tag -a v1.0.0 -m 'Release v1.0.0'");
+    return dir;
+}
+
+// Every object git knows about must read back natively with the same type and bytes.
+static bool check_all_objects(const std::string &repo, const std::string &label, std::size_t hashSize) {
+    auto store = ObjectStore::open(repo);
+    TEST_ASSERT(store != nullptr, label << ": store should open");
+    TEST_ASSERT(store->hashSize() == hashSize, label << ": hash size " << store->hashSize());
+    std::string listing;
+    runGitCapture({"cat-file", "--batch-all-objects", "--batch-check"}, repo, listing);
+    GitBatch batch(repo);
+    std::istringstream in(listing);
+    std::string line;
+    int checked = 0;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string hex, type;
+        std::size_t size = 0;
+        fields >> hex >> type >> size;
+        const ObjectId id = ObjectId::fromHex(hex);
+        TEST_ASSERT(id.size == hashSize && id.hex() == hex, label << ": id round trip for " << hex);
+        TEST_ASSERT(store->contains(id), label << ": contains " << hex);
+        Object obj;
+        TEST_ASSERT(store->read(id, obj), label << ": read " << hex);
+        TEST_ASSERT(std::string(objectTypeName(obj.type())) == type, label << ": type of " << hex);
+        GitObjectInfo info;
+        std::string expected;
+        TEST_ASSERT(batch.contents(hex, info, expected), label << ": cat-file " << hex);
+        TEST_ASSERT(obj.data().size() == size && obj.data() == expected, label << ": payload of " << hex);
+        ++checked;
+    }
+    TEST_ASSERT(checked > 20, label << ": expected a populated repository, saw " << checked);
+    ObjectId missing = ObjectId::fromHex(std::string(hashSize * 2, 'e'));
+    Object none;
+    TEST_ASSERT(!store->contains(missing) && !store->read(missing, none), label << ": unknown id should miss");
+    TEST_PASS(label << " (" << checked << " objects)");
+    return true;
+}
+
+static int count_deltas(const std::string &repo) {
+    int deltas = 0;
+    for (const auto &e : std::filesystem::directory_iterator(repo + "/.git/objects/pack")) {
+        if (e.path().extension() != ".idx") continue;
+        std::string out;
+        runGitCapture({"verify-pack", "-v", e.path().string()}, repo, out);
+        std::istringstream in(out);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string oid, type, size, packed, offset, depth;
+            if (fields >> oid >> type >> size >> packed >> offset >> depth) ++deltas;
+        }
+    }
+    return deltas;
+}
+
+static bool test_sha1_layouts() {
+    const std::string repo = init_repo("sha1", "sha1");
+    bool ok = check_all_objects(repo, "loose objects", 20);
+
+    git(repo, "repack -a -d -f -q --depth=50 --window=50");
+    TEST_ASSERT(count_deltas(repo) > 0, "repack should produce OFS deltas");
+    ok &= check_all_objects(repo, "packed with OFS_DELTA", 20);
+
+    git(repo, "-c repack.useDeltaBaseOffset=false repack -a -d -f -q --depth=50 --window=50");
+    TEST_ASSERT(count_deltas(repo) > 0, "repack should produce REF deltas");
+    ok &= check_all_objects(repo, "packed with REF_DELTA", 20);
+
+    // A second pack plus loose objects, then a multi-pack-index over both packs
+    add_history(repo, 6, 9);
+    git(repo, "repack -d -q");
+    add_history(repo, 9, 10);
+    git(repo, "multi-pack-index write");
+    TEST_ASSERT(std::filesystem::exists(repo + "/.git/objects/pack/multi-pack-index"), "MIDX should be written");
+    ok &= check_all_objects(repo, "multi-pack-index + loose", 20);
+
+    // A tiny cache forces every chain to be rebuilt from its full base
+    auto store = ObjectStore::open(repo);
+    store->setDeltaBaseCacheLimit(1);
+    Object head;
+    const std::string headHex = trim([&] { std::string o; runGitCapture({"rev-parse", "HEAD:src/big.cpp"}, repo, o); return o; }());
+    TEST_ASSERT(store->read(ObjectId::fromHex(headHex), head), "read with tiny delta cache");
+    TEST_ASSERT(head.data().find("int line_299()") != std::string_view::npos, "blob content intact");
+    TEST_PASS("delta reads without cache");
+    return ok;
+}
+
+static bool test_sha256_layouts() {
+    const std::string repo = init_repo("sha256", "sha256");
+    std::string format;
+    runGitCapture({"rev-parse", "--show-object-format"}, repo, format);
+    if (trim(format) != "sha256") {
+        std::cout << "⚠️  git cannot create SHA-256 repositories here, skipping" << std::endl;
+        return true;
+    }
+    bool ok = check_all_objects(repo, "sha256 loose objects", 32);
+    git(repo, "repack -a -d -f -q --depth=50 --window=50");
+    ok &= check_all_objects(repo, "sha256 packed", 32);
+    add_history(repo, 6, 8);
+    git(repo, "repack -d -q");
+    git(repo, "multi-pack-index write");
+    ok &= check_all_objects(repo, "sha256 multi-pack-index", 32);
+    return ok;
+}
+
+static bool test_commit_and_tree_views() {
+    const std::string repo = init_repo("views", "sha1");
+    git(repo, "repack -a -d -q");
+    auto store = ObjectStore::open(repo + "/src/nested");   // discovery walks up like git does
+    TEST_ASSERT(store != nullptr, "store should open from a subdirectory");
+    auto rev = [&](const std::string &r) { std::string o; runGitCapture({"rev-parse", r}, repo, o); return trim(o); };
+
+    Object commit;
+    TEST_ASSERT(store->read(ObjectId::fromHex(rev("HEAD")), commit), "read HEAD commit");
+    TEST_ASSERT(commit.type() == ObjectType::Commit, "HEAD should be a commit");
+    CommitView view;
+    TEST_ASSERT(parseCommit(commit.data(), view), "commit should parse");
+    TEST_ASSERT(view.tree.hex() == rev("HEAD^{tree}"), "tree id should match");
+    TEST_ASSERT(view.parents.size() == 1 && view.parents[0].hex() == rev("HEAD~1"), "parent should match");
+    TEST_ASSERT(view.message == "revision 5\n", "message should view the payload");
+
+    Object tree;
+    TEST_ASSERT(store->read(view.tree, tree), "read root tree");
+    std::string names;
+    TreeIterator it(tree.data(), store->hashSize());
+    TreeEntry entry;
+    bool sawSrcTree = false;
+    while (it.next(entry)) {
+        names += std::string(entry.name) + "\n";
+        if (entry.name == "src") sawSrcTree = entry.isTree() && entry.oid.hex() == rev("HEAD:src");
+    }
+    std::string expected;
+    runGitCapture({"ls-tree", "--name-only", "HEAD"}, repo, expected);
+    TEST_ASSERT(!it.malformed() && names == expected, "tree entries should match ls-tree");
+    TEST_ASSERT(sawSrcTree, "src should be a subtree with the right id");
+
+    // Linked worktrees keep a .git file and share the main object directory
+    const std::string wt = repo + "_wt";
+    std::filesystem::remove_all(wt);
+    git(repo, "worktree add -q " + wt + " HEAD~1");
+    auto linked = ObjectStore::open(wt);
+    Object parent;
+    TEST_ASSERT(linked && linked->read(ObjectId::fromHex(rev("HEAD~1")), parent), "worktree store should read objects");
+    TEST_PASS("commit/tree views and repository discovery");
+    return true;
+}
+
+static std::uint32_t read_be32(const std::string &file, std::size_t at) {
+    std::ifstream f(file, std::ios::binary);
+    unsigned char b[4] = {};
+    f.seekg(static_cast<std::streamoff>(at));
+    f.read(reinterpret_cast<char *>(b), 4);
+    return std::uint32_t(b[0]) << 24 | std::uint32_t(b[1]) << 16 | std::uint32_t(b[2]) << 8 | b[3];
+}
+
+static void write_be32(const std::string &file, std::size_t at, std::uint32_t v) {
+    std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+    const char b[4] = {char(v >> 24), char(v >> 16), char(v >> 8), char(v)};
+    f.seekp(static_cast<std::streamoff>(at));
+    f.write(b, 4);
+}
+
+// A fanout table that decreases, or that counts more ids than the index
+// holds, gets the index dropped instead of searched out of bounds: a broken
+// multi-pack-index falls back to the .idx files, a broken .idx leaves its
+// objects to git.
+static bool test_corrupt_indexes() {
+    const std::string repo = init_repo("corrupt", "sha1");
+    const std::string packDir = repo + "/.git/objects/pack";
+    git(repo, "repack -a -d -q");
+    add_history(repo, 6, 8);
+    git(repo, "repack -d -q");
+    git(repo, "multi-pack-index write");
+    const std::string midx = packDir + "/multi-pack-index";
+
+    // The MIDX chunk table: 12-byte header, then (id, offset) entries of 12 bytes
+    std::size_t oidf = 0;
+    for (std::size_t entry = 12; read_be32(midx, entry) != 0 && !oidf; entry += 12) {
+        if (read_be32(midx, entry) == 0x4f494446) oidf = read_be32(midx, entry + 8);
+    }
+    TEST_ASSERT(oidf != 0, "the MIDX has a fanout chunk");
+    const std::uint32_t count = read_be32(midx, oidf + 4 * 255);
+    git(repo, "config core.multiPackIndex false");   // git lists the objects from the .idx files
+    write_be32(midx, oidf + 4 * 255, count + 1000);
+    bool ok = check_all_objects(repo, "MIDX counting more ids than it holds", 20);
+    write_be32(midx, oidf + 4 * 255, count);
+    write_be32(midx, oidf, 0xfffffff0u);
+    ok &= check_all_objects(repo, "MIDX with a decreasing fanout", 20);
+    std::filesystem::remove(midx);
+
+    // The pack index of a blob, with a fanout entry in the blob's bucket set past its end
+    std::string hex;
+    runGitCapture({"rev-parse", "HEAD:src/big.cpp"}, repo, hex);
+    const ObjectId id = ObjectId::fromHex(trim(hex));
+    std::string idx;
+    for (const auto &e : std::filesystem::directory_iterator(packDir)) {
+        if (e.path().extension() != ".idx") continue;
+        std::string out;
+        runGitCapture({"verify-pack", "-v", e.path().string()}, repo, out);
+        if (out.find(id.hex()) != std::string::npos) idx = e.path().string();
+    }
+    TEST_ASSERT(!idx.empty(), "the blob is packed");
+    const unsigned first = id.bytes[0];
+    write_be32(idx, 8 + 4 * (first == 255 ? 254 : first), 0xfffffff0u);
+    auto store = ObjectStore::open(repo);
+    Object obj;
+    TEST_ASSERT(store && !store->contains(id) && !store->read(id, obj), "a broken .idx is not searched");
+    std::filesystem::remove_all(repo);
+    TEST_PASS("broken fanout tables are not trusted");
+    return ok;
+}
+
+static bool test_not_a_repository() {
+    const std::string dir = std::string("/tmp/nv_object_store_plain_") + std::to_string(::getpid());
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    TEST_ASSERT(ObjectStore::open(dir) == nullptr, "plain directory should not open");
+    TEST_ASSERT(ObjectId::fromHex("xyz").empty() && ObjectId::fromHex(std::string(40, 'g')).empty(), "bad hex");
+    TEST_PASS("non-repository handling");
+    return true;
+}
+
+int main() {
+    std::cout << "Running object store tests..." << std::endl;
+#ifndef NEXT_VERSION_HAVE_ZLIB
+    std::cout << "⚠️  built without zlib, native object store disabled" << std::endl;
+    return 0;
+#else
+    bool ok = true;
+    ok &= test_sha1_layouts();
+    ok &= test_sha256_layouts();
+    ok &= test_commit_and_tree_views();
+    ok &= test_corrupt_indexes();
+    ok &= test_not_a_repository();
+    return ok ? 0 : 1;
+#endif
+}
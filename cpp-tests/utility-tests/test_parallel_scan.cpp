@@ -0,0 +1,127 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "../test_helpers.h"
+#include "next_version/analyzers.h"
+#include "next_version/task_graph.h"
+
+using namespace nv;
+
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+// Many small files plus one file with thousands of hunks, with lines the CLI,
+// keyword and security scanners all react to.
+static std::string makePatch() {
+    const char *removed[] = {"-  {\"opt-%\", required_argument, 0, 'o'}, // --opt-%", "-    case OPT_%:", "-void f%(int a);",
+                             "-  usage(\"-x \");", "---removed-% content", "-// REMOVED OPTION %"};
+    const char *added[] = {"+  {\"opt-%\", no_argument, 0, 'n'}, // --opt-%", "+    case OPT_%:", "+// SECURITY: fix overflow %",
+                           "+  printf(\"--quoted-%\");", "+++added-% content", "+abort(); // CVE-2024-1234 use after free",
+                           "+CLI-BREAKING %"};
+    auto fill = [](const char *line, unsigned n) {
+        std::string s(line);
+        for (auto at = s.find('%'); at != std::string::npos; at = s.find('%')) s.replace(at, 1, std::to_string(n));
+        return s + "\n";
+    };
+    Lcg rng {3};
+    std::string patch;
+    auto hunk = [&](unsigned at) {
+        const unsigned r = rng.next(4), a = rng.next(4);
+        patch += "@@ -" + std::to_string(at) + "," + std::to_string(r) + " +" + std::to_string(at) + "," + std::to_string(a) + " @@\n";
+        for (unsigned i = 0; i < r; ++i) patch += fill(removed[rng.next(6)], rng.next(500));
+        for (unsigned i = 0; i < a; ++i) patch += fill(added[rng.next(7)], rng.next(500));
+    };
+    for (unsigned f = 0; f < 400; ++f) {
+        const std::string name = "src/f" + std::to_string(f) + ".cpp";
+        patch += "diff --git a/" + name + " b/" + name + "\n--- a/" + name + "\n+++ b/" + name + "\n";
+        for (unsigned h = 0, n = 1 + rng.next(5); h < n; ++h) hunk(10 * h + 1);
+        if (f == 200) {
+            for (unsigned h = 0; h < 5000; ++h) hunk(10 * h + 100);
+        }
+    }
+    return patch;
+}
+
+static bool same(const CliResults &a, const CliResults &b) {
+    return a.cliChanges == b.cliChanges && a.breakingCliChanges == b.breakingCliChanges && a.apiBreaking == b.apiBreaking &&
+           a.manualCliChanges == b.manualCliChanges && a.removedShortCount == b.removedShortCount &&
+           a.removedLongCount == b.removedLongCount && a.addedLongCount == b.addedLongCount &&
+           a.manualAddedLongCount == b.manualAddedLongCount && a.manualRemovedLongCount == b.manualRemovedLongCount;
+}
+
+static bool same(const SecurityResults &a, const SecurityResults &b) {
+    return a.securityPatternsDiff == b.securityPatternsDiff && a.cvePatterns == b.cvePatterns &&
+           a.memorySafetyIssues == b.memorySafetyIssues && a.crashFixes == b.crashFixes;
+}
+
+static bool same(const KeywordResults &a, const KeywordResults &b) {
+    return a.hasCliBreaking == b.hasCliBreaking && a.hasApiBreaking == b.hasApiBreaking &&
+           a.totalSecurity == b.totalSecurity && a.removedOptionsKeywords == b.removedOptionsKeywords;
+}
+
+// Feeds the patch in line-aligned batches of about `batch` bytes.
+template <class Scanner>
+static void feedBatches(Scanner &scanner, const std::string &patch, std::size_t batch, ThreadPool *pool) {
+    std::string_view rest = patch;
+    while (!rest.empty()) {
+        std::size_t cut = rest.find('\n', std::min(rest.size() - 1, batch));
+        cut = cut == std::string_view::npos ? rest.size() : cut + 1;
+        scanner.feed(rest.substr(0, cut), pool);
+        rest.remove_prefix(cut);
+    }
+}
+
+// The results of a parallel scan are those of the sequential one, whatever
+// the number of workers and however the stream is batched.
+static bool test_parallel_matches_sequential() {
+    const std::string patch = makePatch();
+    CliScanner cli;
+    cli.feed(patch);
+    KeywordScanner kw;
+    kw.feed(patch);
+    SecurityScanner sec, secAdded(true);
+    sec.feed(patch);
+    secAdded.feed(patch);
+    const CliResults cliExpected = cli.finish();
+    TEST_ASSERT(cliExpected.removedLongCount > 100 && cliExpected.apiBreaking && cliExpected.removedShortCount > 0,
+                "the patch should give the CLI scanner work");
+    for (unsigned workers : {1u, 2u, 3u, 8u}) {
+        ThreadPool pool(workers);
+        for (std::size_t batch : {std::size_t(1) << 30, std::size_t(200000), std::size_t(7000)}) {
+            CliScanner cliPar;
+            KeywordScanner kwPar;
+            SecurityScanner secPar, secAddedPar(true);
+            feedBatches(cliPar, patch, batch, &pool);
+            feedBatches(kwPar, patch, batch, &pool);
+            feedBatches(secPar, patch, batch, &pool);
+            feedBatches(secAddedPar, patch, batch, &pool);
+            TEST_ASSERT(same(cliPar.finish(), cliExpected), workers << " workers, batch " << batch << ": CLI results differ");
+            TEST_ASSERT(same(kwPar.finish(""), kw.finish("")), workers << " workers, batch " << batch << ": keyword results differ");
+            TEST_ASSERT(same(secPar.finish(""), sec.finish("")), workers << " workers, batch " << batch << ": security results differ");
+            TEST_ASSERT(same(secAddedPar.finish(""), secAdded.finish("")), workers << " workers, batch " << batch << ": added-only results differ");
+        }
+    }
+    TEST_PASS("parallel scans match the sequential scan");
+    return true;
+}
+
+int main() {
+    std::cout << "Running parallel scan tests..." << std::endl;
+    bool ok = test_parallel_matches_sequential();
+    return ok ? 0 : 1;
+}
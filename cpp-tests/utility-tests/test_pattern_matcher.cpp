@@ -0,0 +1,148 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdint>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/pattern_matcher.h"
+#include "next_version/pattern_registry.h"
+
+using namespace nv;
+
+// The registry's regex for every pattern; the fused matcher's counts must not differ.
+static const std::vector<std::pair<Pattern, std::regex>> &oracle() {
+    static const std::vector<std::pair<Pattern, std::regex>> res = [] {
+        std::vector<std::pair<Pattern, std::regex>> out;
+        for (unsigned i = 0; i < static_cast<unsigned>(Pattern::Count); ++i) {
+            const auto p = static_cast<Pattern>(i);
+            out.emplace_back(p, std::regex(std::string(patterns::keywordSource(p)), std::regex::icase));
+        }
+        return out;
+    }();
+    return res;
+}
+
+static int regexCount(const std::string &text, const std::regex &re) {
+    return static_cast<int>(std::distance(std::sregex_iterator(text.begin(), text.end(), re), std::sregex_iterator()));
+}
+
+static constexpr PatternSet kAll = (PatternSet(1) << static_cast<unsigned>(Pattern::Count)) - 1;
+
+// Every level this CPU can run, scalar automaton included.
+static std::vector<SimdLevel> levels() {
+    std::vector<SimdLevel> out {SimdLevel::Scalar};
+    if (detectSimdLevel() != SimdLevel::Scalar) out.push_back(SimdLevel::Ssse3);
+    if (detectSimdLevel() == SimdLevel::Avx2) out.push_back(SimdLevel::Avx2);
+    return out;
+}
+
+// Reports the first pattern and level whose count differs from the regex.
+static bool agrees(const std::string &text, std::string &why) {
+    PatternCounts want;
+    for (const auto &[p, re] : oracle()) want[p] = regexCount(text, re);
+    for (SimdLevel level : levels()) {
+        PatternCounts got;
+        PatternMatcher::get().count(text, kAll, got, level);
+        for (const auto &[p, re] : oracle()) {
+            if (got[p] != want[p]) {
+                std::ostringstream ss;
+                ss << simdLevelName(level) << ", pattern " << static_cast<unsigned>(p) << ": got " << got[p] << ", regex " << want[p];
+                why = ss.str();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool test_hand_picked() {
+    const char *cases[] = {
+        "",
+        "CLI BREAKING, cli-breaking, ClIbReAkInG and cli  breaking",
+        "api breaking api-breaking xapibreaking",
+        "BREAKING: the CLI moved. BREAKING!! api, then the CLI and the cli\nCLI on the next line",
+        "BREAKING\n\n  -> cli removed\r cli",
+        "BREAKING CHANGE and BREAKING: major CHANGE here, BREAKINGCHANGE, breaking   change",
+        "breaking: nothing\nbreaking - big change\nBREAKING\tCHANGE",
+        "# SECURITY\n+// security fix\n-  /* SECURITY */\nx#SECURITY\n --SECURITY\n+#security\n+ -#SECURITY\n---SECURITY",
+        "#SECURITY #SECURITY# SECURITY // securitysecurity",
+        "removed option, REMOVED  OPTIONS, removedoption, removed\noptions",
+        "security vulnerability vulnerabilities vulnerabilit CVE-2024-1 cve 2024-12 CVE2024-3 CVE-202-1 cve--2024-1",
+        "overflow overflows auth author xss_ _xss tls/ssl expos exposed EXPOS",
+        "CVE-2024-1234 CVE-2024-12345678 CVE-2024-1234567 cve-2024-123 xCVE-2024-1234 CVE-2024-1234a CVE-2024-1234_",
+        "buffer overflow, buffer_overflow, buffer--overflow, bufferoverflow, use-after_free, use after  free, oob, OOB1",
+        "data race condition, race condition, data_race, out of bounds, out_of-bounds, deadlock",
+        "segfault segmentation   fault segmentation\nfault stack trace stack overflow fatal error core dump crashed crash",
+        "stack_trace stack  trace fatal\terror assert(x) abort() panic!",
+    };
+    for (const char *c : cases) {
+        std::string why;
+        TEST_ASSERT(agrees(c, why), "\"" << c << "\": " << why);
+    }
+    TEST_PASS("hand-picked cases match the regex counts");
+    return true;
+}
+
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+// Texts stitched from pattern fragments, separators and noise, so words meet
+// their neighbours in every arrangement the patterns care about.
+static bool test_random_fragments() {
+    const char *pieces[] = {
+        "cli", "CLI", "api", "Api", "breaking", "BREAKING", "change", "CHANGE", "major", "security", "SECURITY",
+        "removed", "option", "OPTIONS", "s", "vulnerabilit", "y", "ies", "cve", "CVE", "2024", "12345", "123",
+        "12345678", "1", "buffer", "overflow", "stack", "trace", "use", "after", "free", "out", "of", "bounds",
+        "oob", "segmentation", "fault", "segfault", "data", "race", "condition", "fatal", "error", "core", "dump",
+        "auth", "token", "expos", "xss", "tls", "leak", "crash", "x", "a1", "_",
+        "-", "-", " ", " ", "  ", "\n", "\r", "\t", "#", "//", "/*", "--", "+", ":", "!", ".", "\xc3\xa9",
+    };
+    const unsigned n = static_cast<unsigned>(std::size(pieces));
+    Lcg rng {42};
+    for (int round = 0; round < 4000; ++round) {
+        std::string text;
+        const unsigned len = rng.next(round % 10 == 0 ? 600 : 60);
+        for (unsigned i = 0; i < len; ++i) text += pieces[rng.next(n)];
+        std::string why;
+        TEST_ASSERT(agrees(text, why), "round " << round << " \"" << text << "\": " << why);
+    }
+    TEST_PASS("random fragment texts match the regex counts");
+    return true;
+}
+
+static bool test_pattern_subset() {
+    const std::string text = "BREAKING CHANGE: cli-breaking security fix for a buffer overflow\n# SECURITY\n";
+    PatternCounts all, some;
+    PatternMatcher::get().count(text, kAll, all);
+    PatternMatcher::get().count(text, patternBit(Pattern::CliBreaking) | patternBit(Pattern::MemorySafety), some);
+    TEST_ASSERT(some[Pattern::CliBreaking] == 1 && some[Pattern::MemorySafety] == 1, "selected patterns counted");
+    TEST_ASSERT(some[Pattern::GeneralBreaking] == 0 && some[Pattern::SecurityWord] == 0, "other patterns left alone");
+    TEST_ASSERT(all[Pattern::GeneralBreaking] == 1 && all[Pattern::SecurityWord] == 3 && all[Pattern::SecurityComment] == 1,
+                "full set counts everything");
+    // Counts accumulate across calls
+    PatternMatcher::get().count(text, kAll, all);
+    TEST_ASSERT(all[Pattern::SecurityWord] == 6, "second call adds to the counts");
+    TEST_PASS("only the requested patterns are counted");
+    return true;
+}
+
+int main() {
+    std::cout << "Running pattern matcher tests..." << std::endl;
+    bool ok = test_hand_picked();
+    ok &= test_random_fragments();
+    ok &= test_pattern_subset();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdint>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/pattern_registry.h"
+
+using namespace nv;
+
+// The patterns are usable in constant expressions.
+static_assert(patterns::SemverCore::match("1.20.0"));
+static_assert(!patterns::SemverCore::match("01.2.3"));
+static_assert(patterns::SemverFull::match("1.2.3-rc.1+build-7"));
+static_assert(!patterns::SemverFull::match("1.2.3-"));
+static_assert(patterns::LongOption::search("  {\"dry-run\", no_argument}, // --dry-run"));
+static_assert(patterns::ShortOption::search("-x"));
+static_assert(patterns::ShortOption::search("usage: prog [-x ]"));
+static_assert(!patterns::ShortOption::search("--x"));
+
+// What std::regex finds for the same source, as the list of whole matches
+// (or of group 1) in iteration order.
+static std::vector<std::string> regexMatches(const std::string &text, const std::regex &re, std::size_t group) {
+    std::vector<std::string> out;
+    for (auto it = std::sregex_iterator(text.begin(), text.end(), re); it != std::sregex_iterator(); ++it) {
+        out.push_back((*it)[static_cast<int>(group)].str());
+    }
+    return out;
+}
+
+template <class R>
+static std::vector<std::string> staticMatches(const std::string &text, std::size_t group) {
+    std::vector<std::string> out;
+    R::forEach(text, [&](const auto &m) { out.emplace_back(m[group]); });
+    return out;
+}
+
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+static std::string randomLine(Lcg &rng, const std::vector<const char *> &pieces, unsigned maxPieces) {
+    std::string line;
+    const unsigned n = rng.next(maxPieces);
+    for (unsigned i = 0; i < n; ++i) line += pieces[rng.next(static_cast<unsigned>(pieces.size()))];
+    return line;
+}
+
+// Diff lines stitched from fragments the CLI patterns care about.
+static bool test_line_patterns() {
+    const std::regex longOpt(R"(--[A-Za-z0-9][A-Za-z0-9\-]*)");
+    const std::regex shortOpt(R"((^|[^-])-[A-Za-z](\s|$))");
+    const std::vector<const char *> pieces = {
+        "-", "-", "--", "+", " ", " ", "\t", "\r", "int", "char", "*", "**", "_x", "foo", "Bar9", "(", ")", ";", ";",
+        "case", "case ", ":", "'a'", "x", "v", "help", "dry-run", "\"", "//", "/*", "0", "\xc3\xa9", ",", "{", "}",
+    };
+    Lcg rng {7};
+    for (int round = 0; round < 20000; ++round) {
+        std::string line(round % 3 == 0 ? "-" : "");
+        line += randomLine(rng, pieces, round % 20 == 0 ? 60 : 14);
+        TEST_ASSERT(staticMatches<patterns::LongOption>(line, 0) == regexMatches(line, longOpt, 0), "long options in \"" << line << "\"");
+        TEST_ASSERT(patterns::ShortOption::search(line) == std::regex_search(line, shortOpt), "short option in \"" << line << "\"");
+    }
+    TEST_PASS("line patterns agree with std::regex");
+    return true;
+}
+
+static bool test_semver_patterns() {
+    const std::regex core(R"((0|[1-9][0-9]*)\.(0|[1-9][0-9]*)\.(0|[1-9][0-9]*))");
+    const std::regex full(R"((0|[1-9][0-9]*)\.(0|[1-9][0-9]*)\.(0|[1-9][0-9]*)(\-[0-9A-Za-z-]+(\.[0-9A-Za-z-]+)*)?(\+[0-9A-Za-z-]+(\.[0-9A-Za-z-]+)*)?)");
+    const std::vector<const char *> pieces = {"0", "1", "12", "00", ".", ".", "-", "+", "rc", "alpha", "-", "x.y", "_", " "};
+    Lcg rng {11};
+    for (int round = 0; round < 20000; ++round) {
+        const std::string v = randomLine(rng, pieces, 12);
+        TEST_ASSERT(patterns::SemverCore::match(v) == std::regex_match(v, core), "core \"" << v << "\"");
+        TEST_ASSERT(patterns::SemverFull::match(v) == std::regex_match(v, full), "full \"" << v << "\"");
+    }
+    TEST_PASS("semver patterns agree with std::regex");
+    return true;
+}
+
+static bool test_keyword_sources() {
+    for (unsigned i = 0; i < static_cast<unsigned>(Pattern::Count); ++i) {
+        TEST_ASSERT(!patterns::keywordSource(static_cast<Pattern>(i)).empty(), "pattern " << i << " has a source");
+    }
+    TEST_PASS("every keyword pattern is registered");
+    return true;
+}
+
+int main() {
+    std::cout << "Running pattern registry tests..." << std::endl;
+    bool ok = test_line_patterns();
+    ok &= test_semver_patterns();
+    ok &= test_keyword_sources();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,600 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../test_helpers.h"
+#include "next_version/analysis.h"
+#include "next_version/analyzers.h"
+#include "next_version/result_cache.h"
+
+using namespace nv;
+namespace fs = std::filesystem;
+
+static ResultCacheKey makeKey(const std::string &target) {
+    ResultCacheKey key;
+    key.baseOid = "1111111111111111111111111111111111111111";
+    key.targetOid = target;
+    key.onlyPaths = "src/**";
+    key.configHash = hashConfigValues(ConfigValues {});
+    return key;
+}
+
+static RangeAnalysis makeValue(int n) {
+    RangeAnalysis v;
+    v.files = {{"ADDED_FILES", std::to_string(n)}, {"DIFF_SIZE", "120"}};
+    v.cli = {{"CLI_CHANGES", "true"}, {"MANUAL_ADDED_LONG_COUNT", "3"}};
+    v.security = {{"SECURITY_KEYWORDS", "0"}};
+    v.keywords = {{"HAS_API_BREAKING", "false"}, {"NOTE", std::string("a\0b\n", 4)}};
+    return v;
+}
+
+static bool sameValue(const RangeAnalysis &a, const RangeAnalysis &b) {
+    return a.files == b.files && a.cli == b.cli && a.security == b.security && a.keywords == b.keywords;
+}
+
+static std::vector<fs::path> entries(const fs::path &dir) {
+    std::vector<fs::path> out;
+    for (const auto &e : fs::directory_iterator(dir)) out.push_back(e.path());
+    return out;
+}
+
+static bool test_round_trip(const fs::path &dir) {
+    ResultCache cache(dir);
+    const ResultCacheKey key = makeKey("2222222222222222222222222222222222222222");
+    RangeAnalysis got;
+    TEST_ASSERT(!cache.load(key, got), "an empty cache misses");
+    TEST_ASSERT(cache.store(key, makeValue(1)), "store succeeds");
+    TEST_ASSERT(cache.load(key, got) && sameValue(got, makeValue(1)), "the stored analysis reads back");
+
+    ResultCacheKey other = key;
+    other.ignoreWhitespace = true;
+    TEST_ASSERT(!cache.load(other, got), "another option is another key");
+    other = key;
+    other.configHash = hashConfigValues(ConfigValues {.majorBonusThreshold = 9});
+    TEST_ASSERT(other.configHash != key.configHash && !cache.load(other, got), "another configuration is another key");
+    TEST_ASSERT(entries(dir).size() == 1, "one file per entry and no temporaries left");
+    TEST_PASS("entries round-trip under their own key only");
+    return true;
+}
+
+// Truncated, flipped or foreign files read as misses.
+static bool test_damaged_entries(const fs::path &dir) {
+    ResultCache cache(dir / "damaged");
+    const ResultCacheKey key = makeKey("3333333333333333333333333333333333333333");
+    cache.store(key, makeValue(2));
+    const fs::path path = entries(dir / "damaged").front();
+    std::ostringstream read;
+    read << std::ifstream(path, std::ios::binary).rdbuf();
+    const std::string data = read.str();
+    auto rewrite = [&](const std::string &bytes) { std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes; };
+    RangeAnalysis got;
+    for (std::size_t at : {std::size_t(0), std::size_t(5), data.size() / 2, data.size() - 1}) {
+        std::string bad = data;
+        bad[at] = static_cast<char>(bad[at] ^ 0x20);
+        rewrite(bad);
+        TEST_ASSERT(!cache.load(key, got), "byte " << at << " flipped");
+    }
+    rewrite(data.substr(0, data.size() - 3));
+    TEST_ASSERT(!cache.load(key, got), "truncated entry");
+    rewrite(data);
+    TEST_ASSERT(cache.load(key, got) && sameValue(got, makeValue(2)), "the intact entry still reads");
+    TEST_PASS("damaged entries are misses");
+    return true;
+}
+
+// Stores beyond the cap drop the least recently used entries; a hit counts as a use.
+static bool test_lru_cap() {
+    const fs::path dir = fs::path("/tmp") / ("nv_result_cache_lru_" + std::to_string(::getpid()));
+    fs::remove_all(dir);
+    ResultCache probe(dir);
+    probe.store(makeKey("targetX"), makeValue(0));
+    const std::uintmax_t entryBytes = fs::file_size(entries(dir).front());
+    fs::remove_all(dir);
+
+    ResultCache cache(dir, 4 * entryBytes);
+    const auto old = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    for (int i = 0; i < 4; ++i) {
+        cache.store(makeKey("target" + std::to_string(i)), makeValue(i));
+        // age the new entry so the order of use does not depend on the clock's resolution
+        for (const fs::path &p : entries(dir)) {
+            if (fs::last_write_time(p) > old + std::chrono::minutes(30)) fs::last_write_time(p, old + std::chrono::minutes(i));
+        }
+    }
+    RangeAnalysis got;
+    TEST_ASSERT(cache.load(makeKey("target0"), got), "all four fit");
+    cache.store(makeKey("target4"), makeValue(4));
+    TEST_ASSERT(entries(dir).size() == 4, "the fifth entry evicts one, left " << entries(dir).size());
+    TEST_ASSERT(cache.load(makeKey("target0"), got), "the entry just read survives");
+    TEST_ASSERT(cache.load(makeKey("target4"), got), "the new entry survives");
+    int left = 0;
+    for (int i = 1; i < 4; ++i) left += cache.load(makeKey("target" + std::to_string(i)), got);
+    TEST_ASSERT(left == 2, "one of the unused entries is gone");
+    fs::remove_all(dir);
+    TEST_PASS("the size cap evicts the least recently used entries");
+    return true;
+}
+
+// Threads storing the same entry each write a file of their own and rename
+// it into place, so a load only ever sees one whole entry.
+static bool test_concurrent_stores(const fs::path &dir) {
+    ResultCache cache(dir);
+    const ResultCacheKey key = makeKey("3333333333333333333333333333333333333333");
+    constexpr int kThreads = 4;
+    std::atomic<bool> bad{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int round = 0; round < 50; ++round) {
+                if (!cache.store(key, makeValue(t))) bad = true;
+                RangeAnalysis got;
+                if (!cache.load(key, got)) bad = true;
+            }
+        });
+    }
+    for (auto &th : threads) th.join();
+    TEST_ASSERT(!bad, "every store and load succeeds");
+    for (const fs::path &p : entries(dir)) {
+        TEST_ASSERT(p.string().find(".tmp.") == std::string::npos, "no temporary file is left: " << p);
+    }
+    TEST_PASS("concurrent stores of one entry never collide");
+    return true;
+}
+
+static bool test_repository_location() {
+    const std::string repo = init_test_repo("result_cache_repo");
+    fs::create_directories(repo + "/sub");
+    const ResultCache cache = ResultCache::forRepository(repo + "/sub");
+    TEST_ASSERT(cache.enabled() && cache.dir() == fs::path(repo) / ".git" / "next-version" / "cache", "got " << cache.dir());
+    TEST_ASSERT(!ResultCache::forRepository("/").enabled(), "no cache outside a repository");
+
+    RefResolution ref;
+    ResultCacheKey key;
+    TEST_ASSERT(!makeResultCacheKey(ref, Options {}, ConfigValues {}, key), "unresolved refs have no key");
+    ref.requestedBaseSha = "aa";
+    ref.targetSha = "bb";
+    TEST_ASSERT(makeResultCacheKey(ref, Options {}, ConfigValues {}, key) && key.baseOid == "aa", "requested base");
+    ref.effectiveBaseSha = "cc";
+    TEST_ASSERT(makeResultCacheKey(ref, Options {}, ConfigValues {}, key) && key.baseOid == "cc", "the merge-base wins");
+    fs::remove_all(repo);
+    TEST_PASS("the cache lives in the git directory and keys on resolved commits");
+    return true;
+}
+
+// --only-paths is relative to the directory git runs in, and diff.algorithm
+// shapes the patch text: a run from a subdirectory, or under another
+// algorithm, does not read back what a run at the top stored.
+static bool test_key_context() {
+    const std::string repo = init_test_repo("result_cache_prefix");
+    write_file(repo + "/VERSION", "1.0.0\n");
+    write_file(repo + "/src/a.c", "int a(void) { return 1; }\n");
+    git(repo, "add -A");
+    git(repo, "commit -q -m base");
+    git(repo, "tag v1.0.0");
+    write_file(repo + "/src/a.c", "int a(void) { return 2; }\n");
+    git(repo, "commit -q -am change");
+
+    auto run = [&](const std::string &root, bool noCache) {
+        Options opts;
+        opts.repoRoot = root;
+        opts.onlyPaths = "a.c";
+        opts.noCache = noCache;
+        opts.jobs = 1;
+        return analyzeRange(opts, loadConfigValues(root));
+    };
+    const AnalysisResult top = run(repo, false);
+    const AnalysisResult sub = run(repo + "/src", false);
+    const AnalysisResult fresh = run(repo + "/src", true);
+    TEST_ASSERT(top.suggestion == "none", "a.c is not a path at the top, got " << top.suggestion);
+    TEST_ASSERT(sub.suggestion == fresh.suggestion && sub.nextVersion == fresh.nextVersion && fresh.suggestion != "none",
+                "the subdirectory run got " << sub.suggestion << ", without the cache " << fresh.suggestion);
+
+    RefResolution ref;
+    ref.requestedBaseSha = "aa";
+    ref.targetSha = "bb";
+    Options opts;
+    opts.repoRoot = repo;
+    ResultCacheKey myers, histogram;
+    TEST_ASSERT(makeResultCacheKey(ref, opts, ConfigValues {}, myers), "a key");
+    git(repo, "config diff.algorithm histogram");
+    TEST_ASSERT(makeResultCacheKey(ref, opts, ConfigValues {}, histogram) && histogram.diffAlgorithm == "histogram",
+                "the algorithm is read");
+    TEST_ASSERT(myers.serialize() != histogram.serialize(), "the algorithm is part of the key");
+    fs::remove_all(repo);
+    TEST_PASS("keys carry the pathspec directory and the diff algorithm");
+    return true;
+}
+
+static PairFindings makeFindings(int n) {
+    PairFindings f;
+    f.shape.hasHunks = true;
+    f.shape.insertions = n;
+    f.shape.deletions = 2;
+    f.hits[Pattern::Crash] = n;
+    f.cli.addedLongFromStruct = {"--opt-" + std::to_string(n)};
+    f.cli.removedCases = {"OPT_A", "OPT_B"};
+    f.cli.removedShortCount = 2;
+    return f;
+}
+
+static bool sameFindings(const PairFindings &a, const PairFindings &b) {
+    return a.shape.hasHunks == b.shape.hasHunks && a.shape.binary == b.shape.binary && a.shape.insertions == b.shape.insertions &&
+           a.shape.deletions == b.shape.deletions && a.hits.hits == b.hits.hits &&
+           a.cli.addedLongFromStruct == b.cli.addedLongFromStruct && a.cli.removedCases == b.cli.removedCases &&
+           a.cli.removedShortCount == b.cli.removedShortCount && a.cli.apiBreaking == b.cli.apiBreaking;
+}
+
+static std::string pairKey(int n) {
+    TreeChange c;
+    c.oldOid = ObjectId::fromHex("1111111111111111111111111111111111111111");
+    c.newOid = ObjectId::fromHex(std::string(39, '2') + std::to_string(n % 10));
+    return PairCache::key(1, c, BlobDiffOptions {});
+}
+
+// Records survive a reopen, appended runs add to them, and a torn tail loses
+// only the records after it.
+static bool test_pair_cache(const fs::path &dir) {
+    const fs::path file = dir / "pairs";
+    PairFindings got;
+    {
+        PairCache cache(file);
+        TEST_ASSERT(!cache.find(pairKey(1), got), "an empty cache misses");
+        cache.add(pairKey(1), makeFindings(1));
+        TEST_ASSERT(cache.find(pairKey(1), got) && sameFindings(got, makeFindings(1)), "added findings read back at once");
+        TEST_ASSERT(cache.save(), "the first save writes the file");
+    }
+    {
+        PairCache cache(file);
+        TEST_ASSERT(cache.find(pairKey(1), got) && sameFindings(got, makeFindings(1)), "findings read back after a reopen");
+        cache.add(pairKey(2), makeFindings(2));
+        TEST_ASSERT(cache.save(), "a later save appends");
+    }
+    TreeChange added;
+    added.status = 'A';
+    added.oldOid = ObjectId::fromHex("1111111111111111111111111111111111111111");
+    TreeChange plain = added;
+    plain.oldOid = ObjectId {};
+    BlobDiffOptions ws;
+    ws.ignoreWhitespace = true;
+    TEST_ASSERT(PairCache::key(1, added, {}) == PairCache::key(1, plain, {}), "an added file has no old side");
+    TEST_ASSERT(PairCache::key(1, plain, {}) != PairCache::key(2, plain, {}) &&
+                PairCache::key(1, plain, {}) != PairCache::key(1, plain, ws), "the patch and the options are part of the key");
+
+    fs::resize_file(file, fs::file_size(file) - 3);
+    {
+        PairCache cache(file);
+        TEST_ASSERT(cache.find(pairKey(1), got), "records before a torn one still read");
+        TEST_ASSERT(!cache.find(pairKey(2), got), "the torn record is a miss");
+        cache.add(pairKey(3), makeFindings(3));
+        TEST_ASSERT(cache.save(), "a damaged file is rewritten");
+    }
+    PairCache cache(file);
+    TEST_ASSERT(cache.find(pairKey(1), got) && cache.find(pairKey(3), got) && sameFindings(got, makeFindings(3)),
+                "the rewrite keeps the records used and added");
+    TEST_PASS("pair findings persist and damage stays local");
+    return true;
+}
+
+// Once the file would outgrow the cap, it is rewritten with the records of
+// the last run only.
+static bool test_pair_cache_cap(const fs::path &dir) {
+    const fs::path file = dir / "pairs_cap";
+    {
+        PairCache cache(file);
+        for (int i = 0; i < 4; ++i) cache.add(pairKey(i), makeFindings(i));
+        cache.save();
+    }
+    const std::uintmax_t full = fs::file_size(file);
+    PairFindings got;
+    {
+        PairCache cache(file, full + 16);
+        TEST_ASSERT(cache.find(pairKey(0), got), "record 0 is there");
+        cache.add(pairKey(4), makeFindings(4));
+        cache.save();
+    }
+    PairCache cache(file);
+    TEST_ASSERT(fs::file_size(file) < full, "the file shrank to " << fs::file_size(file));
+    TEST_ASSERT(cache.find(pairKey(0), got) && cache.find(pairKey(4), got), "the used and the new record are kept");
+    TEST_ASSERT(!cache.find(pairKey(1), got) && !cache.find(pairKey(3), got), "unused records are dropped");
+    TEST_PASS("the pair cache cap drops records the last run did not use");
+    return true;
+}
+
+static ObjectId commitId(unsigned n) {
+    ObjectId id;
+    id.size = 20;
+    for (std::size_t i = 0; i < id.size; ++i) id.bytes[i] = static_cast<unsigned char>((n * 2654435761u) >> (i % 4 * 8));
+    id.bytes[19] = static_cast<unsigned char>(n);
+    id.bytes[18] = static_cast<unsigned char>(n >> 8);
+    return id;
+}
+
+static PatternCounts commitCounts(unsigned n) {
+    PatternCounts c;
+    c[Pattern::GeneralBreaking] = static_cast<int>(n % 3);
+    c[Pattern::SecurityWord] = static_cast<int>(n % 5);
+    return c;
+}
+
+static constexpr PatternSet kCommitPatterns = patternBit(Pattern::GeneralBreaking) | patternBit(Pattern::SecurityWord);
+
+// Entries survive reopening across appended blocks and the compaction past
+// kMaxBlocks; a damaged block or other patterns start the file over.
+static bool test_commit_cache(const fs::path &dir) {
+    const fs::path file = dir / "commits";
+    unsigned stored = 0;
+    for (std::size_t run = 0; run < CommitCache::kMaxBlocks + 2; ++run) {
+        CommitCache cache(file, kCommitPatterns);
+        TEST_ASSERT(cache.empty() == (run == 0), "run " << run << ": earlier runs are read back");
+        PatternCounts got;
+        for (unsigned n = 0; n < stored; ++n) {
+            TEST_ASSERT(cache.find(commitId(n), got) && got.hits == commitCounts(n).hits, "run " << run << ": commit " << n);
+        }
+        TEST_ASSERT(!cache.find(commitId(stored), got), "run " << run << ": an unknown commit is a miss");
+        for (unsigned i = 0; i < 50; ++i, ++stored) cache.add(commitId(stored), commitCounts(stored));
+        cache.add(commitId(0), commitCounts(1));   // already there, or added first
+        TEST_ASSERT(cache.save(), "run " << run << ": saved");
+    }
+    const auto compacted = fs::file_size(file);
+    {
+        CommitCache cache(file, kCommitPatterns);
+        PatternCounts got;
+        TEST_ASSERT(cache.find(commitId(0), got) && got.hits == commitCounts(0).hits, "the first entry wins");
+        TEST_ASSERT(cache.hits() == 1 && cache.misses() == 0, "hits are counted");
+    }
+    // Header, then the block the eight appended ones were merged into and the one appended after
+    TEST_ASSERT(compacted == 20 + stored * 28 + 2 * 12, "blocks were merged: " << compacted << " bytes");
+
+    // Damage the last byte (a block's checksum): the file is rewritten from what is still readable
+    {
+        std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(-1, std::ios::end);
+        f.put('\x5a');
+    }
+    {
+        CommitCache cache(file, kCommitPatterns);
+        PatternCounts got;
+        TEST_ASSERT(!cache.find(commitId(stored - 1), got), "a damaged block is not read");
+        cache.add(commitId(stored - 1), commitCounts(stored - 1));
+        TEST_ASSERT(cache.save(), "the damaged file is rewritten");
+    }
+    {
+        CommitCache cache(file, kCommitPatterns);
+        PatternCounts got;
+        TEST_ASSERT(cache.find(commitId(stored - 1), got) && got.hits == commitCounts(stored - 1).hits, "read after the rewrite");
+    }
+    {
+        CommitCache cache(file, patternBit(Pattern::SecurityWord));
+        PatternCounts got;
+        TEST_ASSERT(cache.empty() && !cache.find(commitId(0), got), "entries for other patterns are not read");
+        TEST_ASSERT(cache.save() && !fs::exists(file), "a stale file with nothing to add is removed");
+    }
+    TEST_ASSERT(!CommitCache(fs::path(), kCommitPatterns).enabled(), "no path, no cache");
+    TEST_PASS("commit counts are kept per commit id");
+    return true;
+}
+
+static ResultCacheKey sharedKey(unsigned n) {
+    char target[41];
+    std::snprintf(target, sizeof(target), "%040x", n);
+    return makeKey(target);
+}
+
+// Slot offsets of the table that hold a key, found by their non-zero tags.
+static std::vector<std::size_t> usedSlots(const fs::path &file) {
+    std::ostringstream read;
+    read << std::ifstream(file, std::ios::binary).rdbuf();
+    const std::string data = read.str();
+    std::vector<std::size_t> out;
+    for (std::size_t at = SharedCache::kSlotBytes; at + SharedCache::kSlotBytes <= data.size(); at += SharedCache::kSlotBytes) {
+        if (data.compare(at, 8, std::string(8, '\0')) != 0) out.push_back(at);
+    }
+    return out;
+}
+
+static void patchByte(const fs::path &file, std::size_t at, char value) {
+    std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(static_cast<std::streamoff>(at));
+    f.put(value);
+}
+
+// Entries written by one mapping read back through another; a damaged entry
+// or one left half-written reads as a miss, and the next store goes past it.
+static bool test_shared_cache(const fs::path &dir) {
+    TEST_ASSERT(!SharedCache(fs::path()).enabled(), "no directory, no table");
+    SharedCache writer(dir / "shm");
+    SharedCache reader(dir / "shm");
+    TEST_ASSERT(writer.enabled() && reader.enabled() && writer.file() == reader.file(), "both map the table");
+    RangeAnalysis got;
+    TEST_ASSERT(!reader.load(sharedKey(1), got), "an empty table misses");
+    TEST_ASSERT(writer.store(sharedKey(1), makeValue(1)), "store succeeds");
+    TEST_ASSERT(reader.load(sharedKey(1), got) && sameValue(got, makeValue(1)), "the other mapping reads it");
+    ResultCacheKey other = sharedKey(1);
+    other.firstParent = true;
+    TEST_ASSERT(!reader.load(other, got), "another option is another key");
+
+    const std::vector<std::size_t> slots = usedSlots(writer.file());
+    TEST_ASSERT(slots.size() == 1, "one slot taken, got " << slots.size());
+    patchByte(writer.file(), slots[0] + 24 + 40, '\x7f');
+    TEST_ASSERT(!reader.load(sharedKey(1), got), "a damaged entry is a miss");
+    patchByte(writer.file(), slots[0] + 8, '\x03');   // a writer that died midway
+    TEST_ASSERT(!reader.load(sharedKey(1), got), "an entry being written is a miss");
+    TEST_ASSERT(writer.store(sharedKey(1), makeValue(1)) && reader.load(sharedKey(1), got) && sameValue(got, makeValue(1)),
+                "the next store takes another slot");
+    TEST_ASSERT(usedSlots(writer.file()).size() == 2, "the odd slot is left alone");
+
+    RangeAnalysis big = makeValue(2);
+    big.keywords["NOTE"] = std::string(SharedCache::kSlotBytes, 'x');
+    TEST_ASSERT(!writer.store(sharedKey(2), big) && !reader.load(sharedKey(2), got), "an entry too big for a slot is not shared");
+
+    // More keys than slots: the newest always reads back, older ones read back right or not at all
+    const unsigned keys = 3 * SharedCache::kSlots;
+    for (unsigned n = 10; n < 10 + keys; ++n) {
+        writer.store(sharedKey(n), makeValue(static_cast<int>(n)));
+        TEST_ASSERT(reader.load(sharedKey(n), got) && sameValue(got, makeValue(static_cast<int>(n))), "key " << n << " just stored");
+    }
+    unsigned kept = 0;
+    for (unsigned n = 10; n < 10 + keys; ++n) {
+        if (!reader.load(sharedKey(n), got)) continue;
+        TEST_ASSERT(sameValue(got, makeValue(static_cast<int>(n))), "key " << n << " reads its own value");
+        ++kept;
+    }
+    std::cout << "  " << kept << " of " << keys << " keys kept in " << SharedCache::kSlots << " slots" << std::endl;
+    TEST_ASSERT(kept > SharedCache::kSlots / 2, "most slots stay in use");
+    TEST_PASS("the shared table round-trips across mappings");
+    return true;
+}
+
+// A table is only used when it is the user's own regular file of the exact
+// shape; whatever else sits at its name is left as it is.
+static bool test_shared_cache_files(const fs::path &dir) {
+    const fs::path file = SharedCache(dir / "shm").file();
+    const fs::path planted = dir / "planted";
+    fs::create_directories(planted);
+    const fs::path table = planted / file.filename();
+    const fs::path victim = dir / "victim";
+    write_file(victim.string(), "keep me\n");
+    fs::create_symlink(victim, table);
+    TEST_ASSERT(!SharedCache(planted).enabled(), "a link is not followed");
+    TEST_ASSERT(fs::file_size(victim) == 8 && fs::is_symlink(table), "the link's target is untouched");
+
+    fs::remove(table);
+    write_file(table.string(), "short");
+    TEST_ASSERT(!SharedCache(planted).enabled() && fs::file_size(table) == 5, "a file of another size is not resized");
+    fs::remove(table);
+    fs::copy_file(file, table);
+    patchByte(table, 4, 'X');
+    TEST_ASSERT(!SharedCache(planted).enabled(), "a file without the magic is not mapped");
+    fs::remove(table);
+    fs::create_directory(table);
+    TEST_ASSERT(!SharedCache(planted).enabled(), "a directory is not a table");
+    fs::remove(table);
+    TEST_ASSERT(SharedCache(planted).enabled() && fs::file_size(table) == fs::file_size(file), "a missing table is created");
+    for (const auto &e : fs::directory_iterator(planted)) {
+        TEST_ASSERT(e.path() == table, "no temporary file is left, found " << e.path());
+    }
+    TEST_PASS("only the user's own tables are mapped");
+    return true;
+}
+
+// A value whose every field tells which writer stored it, long enough that
+// writers overlap while copying it.
+static RangeAnalysis writerValue(int w) {
+    RangeAnalysis v = makeValue(w);
+    v.keywords["NOTE"] = std::string(3000, static_cast<char>('a' + w));
+    return v;
+}
+
+// Writers storing different values under one key at once, through mappings
+// of their own, never leave a record mixing two of them for a reader.
+static bool test_shared_cache_writers(const fs::path &dir) {
+    constexpr int kWriters = 4;
+    const ResultCacheKey key = sharedKey(7);
+    std::atomic<bool> stop {false};
+    std::atomic<unsigned> hits {0}, torn {0};
+    std::vector<std::thread> threads;
+    for (int w = 0; w < kWriters; ++w) {
+        threads.emplace_back([&, w] {
+            SharedCache cache(dir / "shm-writers");
+            const RangeAnalysis value = writerValue(w);
+            while (!stop.load()) {
+                cache.store(key, value);
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (int r = 0; r < 2; ++r) {
+        threads.emplace_back([&] {
+            SharedCache cache(dir / "shm-writers");
+            RangeAnalysis got;
+            for (unsigned round = 0; round < 20000; ++round) {
+                if (!cache.load(key, got)) continue;
+                ++hits;
+                const int w = std::stoi(got.files["ADDED_FILES"]);
+                if (w < 0 || w >= kWriters || !sameValue(got, writerValue(w))) ++torn;
+            }
+        });
+    }
+    for (std::size_t t = kWriters; t < threads.size(); ++t) threads[t].join();
+    stop = true;
+    for (int w = 0; w < kWriters; ++w) threads[static_cast<std::size_t>(w)].join();
+    std::cout << "  " << hits << " reads of a key " << kWriters << " writers kept storing" << std::endl;
+    TEST_ASSERT(torn == 0, torn << " reads mixed two writers' values");
+    TEST_ASSERT(hits > 0, "the readers found the key");
+    TEST_PASS("concurrent writers of one key never publish a mixed record");
+    return true;
+}
+
+// Processes storing and loading overlapping keys at once never read a torn
+// or foreign entry.
+static bool test_shared_cache_processes(const fs::path &dir) {
+    constexpr int kProcesses = 4;
+    constexpr unsigned kKeys = 64;
+    std::vector<pid_t> children;
+    for (int p = 0; p < kProcesses; ++p) {
+        const pid_t pid = ::fork();
+        if (pid == 0) {
+            SharedCache cache(dir / "shm-race");
+            RangeAnalysis got;
+            int bad = !cache.enabled();
+            for (unsigned round = 0; round < 3000 && !bad; ++round) {
+                const unsigned n = (round * 7 + static_cast<unsigned>(p) * 13) % kKeys;
+                if (cache.load(sharedKey(n), got)) bad = !sameValue(got, makeValue(static_cast<int>(n)));
+                else cache.store(sharedKey(n), makeValue(static_cast<int>(n)));
+                if (round % 5 == 0) cache.store(sharedKey(n), makeValue(static_cast<int>(n)));
+            }
+            ::_exit(bad);
+        }
+        children.push_back(pid);
+    }
+    bool clean = true;
+    for (pid_t pid : children) {
+        int status = 0;
+        clean &= ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    TEST_ASSERT(clean, "every process read back only whole entries of its own key");
+    SharedCache cache(dir / "shm-race");
+    RangeAnalysis got;
+    unsigned kept = 0;
+    for (unsigned n = 0; n < kKeys; ++n) kept += cache.load(sharedKey(n), got) && sameValue(got, makeValue(static_cast<int>(n)));
+    TEST_ASSERT(kept == kKeys, "every key is in the table after the race, got " << kept);
+    TEST_PASS("concurrent processes share the table safely");
+    return true;
+}
+
+int main() {
+    std::cout << "Running result cache tests..." << std::endl;
+    const fs::path dir = fs::path("/tmp") / ("nv_result_cache_" + std::to_string(::getpid()));
+    fs::remove_all(dir);
+    bool ok = test_round_trip(dir);
+    ok &= test_damaged_entries(dir);
+    ok &= test_concurrent_stores(dir);
+    ok &= test_lru_cap();
+    ok &= test_repository_location();
+    ok &= test_key_context();
+    fs::create_directories(dir);
+    ok &= test_pair_cache(dir);
+    ok &= test_pair_cache_cap(dir);
+    ok &= test_commit_cache(dir);
+    ok &= test_shared_cache(dir);
+    ok &= test_shared_cache_files(dir);
+    ok &= test_shared_cache_writers(dir);
+    ok &= test_shared_cache_processes(dir);
+    fs::remove_all(dir);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/security_tokens.h"
+
+using namespace nv;
+
+static constexpr PatternSet kSecurity = SecurityTokenScanner::kPatterns;
+
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+static std::vector<SimdLevel> levels() {
+    std::vector<SimdLevel> out {SimdLevel::Scalar};
+    if (detectSimdLevel() != SimdLevel::Scalar) out.push_back(SimdLevel::Ssse3);
+    if (detectSimdLevel() == SimdLevel::Avx2) out.push_back(SimdLevel::Avx2);
+    return out;
+}
+
+// The token scanner's counts must equal the fused matcher's on every level.
+static bool agrees(const std::string &text, PatternSet patterns, std::string &why) {
+    PatternCounts want;
+    PatternMatcher::get().count(text, patterns, want);
+    for (SimdLevel level : levels()) {
+        PatternCounts got;
+        SecurityTokenScanner::get().count(text, patterns, got, level);
+        if (got.hits != want.hits) {
+            std::ostringstream ss;
+            ss << simdLevelName(level) << ":";
+            for (unsigned p = 0; p < want.hits.size(); ++p) ss << " " << got.hits[p] << "/" << want.hits[p];
+            why = ss.str();
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test_hand_picked() {
+    const std::pair<const char *, int> cases[] = {
+        {"use after free, use-after-free, use_after_free, useafterfree, use afterfree, useafter-free", 6},
+        {"use  after free, use--after free, _use after free, use after free_, use after freed", 0},
+        {"Buffer_Overflow BUFFEROVERFLOW out-of-bounds OOB data race, racecondition deadlock2 deadlock", 7},
+        {"segmentation   fault, segmentation\tfault, Segmentation\nFault, segmentationfault, fatal-error", 3},
+        {"stack trace, stack overflow, stack  overflow, stack\ntrace", 5},
+        {"CVE-2024-1234 CVE-2024-1234567 CVE-2024-12345678 CVE-202-12345 xCVE-2024-1234 CVE-2024-1234_ cve-2023-44487", 3},
+        {"security token_leak token-leak expose expos vulns Vuln TLS/SSL 2fa auth", 8},
+    };
+    for (const auto &[text, total] : cases) {
+        std::string why;
+        TEST_ASSERT(agrees(text, kSecurity, why), "\"" << text << "\": " << why);
+        PatternCounts got;
+        SecurityTokenScanner::get().count(text, kSecurity, got);
+        int sum = 0;
+        for (int n : got.hits) sum += n;
+        TEST_ASSERT(sum == total, "\"" << text << "\": " << sum << " matches, expected " << total);
+    }
+    TEST_PASS("hand-picked phrases, separators and CVE numbers");
+    return true;
+}
+
+// Random sequences of words, phrase parts and separators.
+static bool test_random_fragments() {
+    const char *pieces[] = {"buffer", "overflow", "use", "after", "free", "useafter", "afterfree", "out", "of", "bounds", "oob",
+                            "CVE", "cve", "-", "_", " ", "  ", "\t", "\n", "2024", "12345", "1234567", "12345678",
+                            "segmentation", "fault", "stack", "trace", "fatal", "error", "core", "dump", "Security", "token",
+                            "x", "9", "expos", "expose", "deadlock", "race", "condition", "data", "\xc3\xa9", "CVE-2024-1234"};
+    Lcg rng {11};
+    for (int i = 0; i < 20000; ++i) {
+        std::string text;
+        for (unsigned k = 0, n = rng.next(14); k < n; ++k) text += pieces[rng.next(static_cast<unsigned>(std::size(pieces)))];
+        const PatternSet patterns = i % 3 ? kSecurity : PatternSet(rng.next(16)) << static_cast<unsigned>(Pattern::SecurityWord);
+        std::string why;
+        TEST_ASSERT(agrees(text, patterns, why), "\"" << text << "\": " << why);
+    }
+    TEST_PASS("random fragments match the fused matcher");
+    return true;
+}
+
+// countPatterns takes the token scanner for security-only sets and the
+// matcher otherwise; either way the counts are the matcher's.
+static bool test_count_patterns() {
+    const std::string text = "BREAKING CHANGE: removed options\n// SECURITY: fix use after free (CVE-2024-1234) and a crash";
+    const PatternSet all = (PatternSet(1) << static_cast<unsigned>(Pattern::Count)) - 1;
+    for (PatternSet patterns : {kSecurity, all, patternBit(Pattern::GeneralBreaking) | patternBit(Pattern::Crash)}) {
+        PatternCounts got, want;
+        countPatterns(text, patterns, got);
+        PatternMatcher::get().count(text, patterns, want);
+        TEST_ASSERT(got.hits == want.hits, "pattern set " << patterns << " differs");
+    }
+    TEST_PASS("countPatterns agrees with the matcher");
+    return true;
+}
+
+int main() {
+    std::cout << "Running security token scanner tests..." << std::endl;
+    bool ok = test_hand_picked();
+    ok &= test_random_fragments();
+    ok &= test_count_patterns();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <new>
+#include <set>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/analyzers.h"
+#include "next_version/symbol_pool.h"
+
+using namespace nv;
+
+// Every allocation of the process, so a test can count the ones of a call.
+static std::size_t gAllocations = 0;
+
+void *operator new(std::size_t n) {
+    ++gAllocations;
+    if (void *p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+struct Lcg {
+    std::uint64_t state;
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<unsigned>((state >> 33) % bound);
+    }
+};
+
+static std::string randomName(Lcg &rng) {
+    std::string s;
+    for (unsigned i = 0, n = rng.next(20); i < n; ++i) s += static_cast<char>('a' + rng.next(4));
+    return s;
+}
+
+static bool test_pool() {
+    SymbolPool pool;
+    std::map<std::string, Symbol> want;
+    Lcg rng {1};
+    for (int i = 0; i < 100000; ++i) {
+        const std::string name = randomName(rng);
+        const Symbol s = pool.intern(name);
+        const auto [it, added] = want.emplace(name, static_cast<Symbol>(want.size()));
+        TEST_ASSERT(s == it->second, "\"" << name << "\" is symbol " << s << ", expected " << it->second);
+    }
+    TEST_ASSERT(pool.size() == want.size(), "one symbol per distinct string");
+    for (const auto &[name, s] : want) TEST_ASSERT(pool.view(s) == name, "symbol " << s << " reads back");
+    TEST_PASS("symbols are dense and stable");
+    return true;
+}
+
+static bool test_sets() {
+    Lcg rng {2};
+    for (int round = 0; round < 200; ++round) {
+        SymbolSet a, b;
+        std::set<Symbol> ra, rb;
+        const unsigned range = 1 + rng.next(round % 2 ? 50 : 5000);
+        for (unsigned i = 0, n = rng.next(300); i < n; ++i) {
+            const Symbol s = rng.next(range);
+            TEST_ASSERT(a.insert(s) == ra.insert(s).second, "insert " << s);
+            if (rng.next(3)) b.insert(s), rb.insert(s);
+        }
+        for (unsigned i = 0, n = rng.next(20); i < n; ++i) {
+            const Symbol s = rng.next(range);
+            b.insert(s);
+            rb.insert(s);
+        }
+        TEST_ASSERT(a.size() == ra.size() && a.sorted() == std::vector<Symbol>(ra.begin(), ra.end()), "set contents");
+        for (Symbol s = 0; s < range; ++s) TEST_ASSERT(a.contains(s) == (ra.count(s) == 1), "contains " << s);
+        const bool missing = !std::includes(rb.begin(), rb.end(), ra.begin(), ra.end());
+        TEST_ASSERT(hasMissing(a, b) == missing, "round " << round << ": set difference");
+    }
+    TEST_PASS("symbol sets match std::set");
+    return true;
+}
+
+// A batch of option tables and switches that names the same few options over
+// and over: once the names are interned, scanning allocates nothing per match.
+static bool test_allocations() {
+    std::string patch = "diff --git a/cli.c b/cli.c\n--- a/cli.c\n+++ b/cli.c\n";
+    for (int h = 0; h < 2000; ++h) {
+        const std::string n = std::to_string(h % 40);
+        patch += "@@ -" + std::to_string(h * 10) + ",3 +" + std::to_string(h * 10) + ",3 @@\n";
+        patch += "-  {\"opt-" + n + "\", no_argument, 0, 'o'}, // --opt-" + n + "\n";
+        patch += "-    case OPT_" + n + ":\n";
+        patch += "-  if (!strcmp(arg, \"--opt-" + n + "\")) usage(\"-o\");\n";
+        patch += "+  {\"opt-" + n + "\", required_argument, 0, 'o'}, // --opt-" + n + "\n";
+        patch += "+    case OPT_" + n + ":\n";
+        patch += "+  if (!strcmp(arg, \"--opt-" + n + "\")) usage();\n";
+    }
+    CliScanner cli;
+    std::size_t before = gAllocations;
+    cli.feed(patch);
+    const std::size_t first = gAllocations - before;
+    before = gAllocations;
+    cli.feed(patch);
+    const std::size_t second = gAllocations - before;
+    const CliResults r = cli.finish();
+    std::cout << "  allocations: " << first << " for the first batch, " << second << " for the same batch again" << std::endl;
+    TEST_ASSERT(r.removedLongCount == 40 && r.manualAddedLongCount == 0 && !r.breakingCliChanges, "the options are found");
+    TEST_ASSERT(first < 1000, first << " allocations for 12000 matches");
+    TEST_ASSERT(second < 20, second << " allocations once every name is interned");
+    TEST_PASS("interned names do not allocate per match");
+    return true;
+}
+
+int main() {
+    std::cout << "Running symbol pool tests..." << std::endl;
+    bool ok = test_pool();
+    ok &= test_sets();
+    ok &= test_allocations();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../test_helpers.h"
+#include "next_version/task_graph.h"
+
+using namespace nv;
+
+static bool test_pool_runs_everything() {
+    std::atomic<int> sum {0};
+    {
+        ThreadPool pool(4);
+        for (int i = 1; i <= 100; ++i) {
+            pool.submit([&pool, &sum, i]() {
+                sum += i;
+                // Follow-up work submitted from a worker lands on its own deque
+                pool.submit([&sum]() { sum += 1000; });
+            });
+        }
+    }
+    TEST_ASSERT(sum == 5050 + 100 * 1000, "every task and follow-up ran, sum " << sum);
+    TEST_PASS("thread pool runs nested submissions before joining");
+    return true;
+}
+
+static bool test_dependencies_respected() {
+    for (unsigned jobs : {1u, 2u, 8u}) {
+        std::atomic<int> clock {0};
+        int at[6] = {};
+        TaskGraph g;
+        auto stamp = [&](int i) { return [&, i]() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); at[i] = ++clock; }; };
+        const auto a = g.add("a", stamp(0));
+        const auto b = g.add("b", stamp(1), {a});
+        const auto c = g.add("c", stamp(2), {a});
+        const auto d = g.add("d", stamp(3), {b, c});
+        const auto e = g.add("e", stamp(4));
+        g.add("f", stamp(5), {d, e});
+        g.run(jobs);
+        TEST_ASSERT(at[0] < at[1] && at[0] < at[2], "jobs " << jobs << ": a before b and c");
+        TEST_ASSERT(at[1] < at[3] && at[2] < at[3], "jobs " << jobs << ": diamond joins at d");
+        TEST_ASSERT(at[3] < at[5] && at[4] < at[5], "jobs " << jobs << ": f last");
+        if (jobs == 1) TEST_ASSERT(at[0] == 1 && at[3] == 4 && at[5] == 6, "one job runs in insertion order");
+    }
+    TEST_PASS("tasks start only after their dependencies");
+    return true;
+}
+
+// Independent tasks meet at a barrier, which only works if they run at once.
+static bool test_independent_tasks_overlap() {
+    std::atomic<int> arrived {0};
+    std::atomic<int> sawAll {0};
+    TaskGraph g;
+    for (int i = 0; i < 4; ++i) {
+        g.add(std::to_string(i), [&]() {
+            ++arrived;
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (arrived < 4 && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+            if (arrived == 4) ++sawAll;
+        });
+    }
+    g.run(4);
+    TEST_ASSERT(sawAll == 4, "all four tasks should be running together");
+    TEST_PASS("independent tasks run concurrently");
+    return true;
+}
+
+static bool test_failure_skips_dependents() {
+    for (unsigned jobs : {1u, 3u}) {
+        bool ranDependent = false;
+        TaskGraph g;
+        const auto bad = g.add("bad", []() { throw std::runtime_error("boom"); });
+        g.add("after", [&]() { ranDependent = true; }, {bad});
+        bool thrown = false;
+        try { g.run(jobs); } catch (const std::runtime_error &) { thrown = true; }
+        TEST_ASSERT(thrown, "jobs " << jobs << ": failure is rethrown");
+        TEST_ASSERT(!ranDependent, "jobs " << jobs << ": dependents of a failed task do not run");
+    }
+    TEST_PASS("a failing task stops the graph");
+    return true;
+}
+
+static bool test_parallel_for() {
+    for (unsigned workers : {0u, 1u, 3u}) {
+        std::unique_ptr<ThreadPool> pool;
+        if (workers) pool = std::make_unique<ThreadPool>(workers);
+        std::vector<std::atomic<int>> hits(1000);
+        parallelFor(pool.get(), hits.size(), [&](std::size_t i) { ++hits[i]; });
+        bool once = true;
+        for (const auto &h : hits) once &= h == 1;
+        TEST_ASSERT(once, workers << " workers: every index runs exactly once");
+        std::atomic<int> ran {0};
+        bool thrown = false;
+        try {
+            parallelFor(pool.get(), 50, [&](std::size_t i) { ++ran; if (i == 7) throw std::runtime_error("boom"); });
+        } catch (const std::runtime_error &) { thrown = true; }
+        TEST_ASSERT(thrown && ran == 50, workers << " workers: failure rethrown after the other indexes ran");
+    }
+    TEST_PASS("parallelFor covers every index");
+    return true;
+}
+
+// Phases that spread their work over the pool they run on keep at most
+// pool.size() threads busy, however many of them run at once.
+static bool test_nested_work_capped() {
+    constexpr unsigned jobs = 3;
+    ThreadPool pool(jobs);
+    std::atomic<unsigned> busy {0}, peak {0}, ran {0};
+    auto work = [&](std::size_t) {
+        const unsigned now = ++busy;
+        for (unsigned seen = peak; now > seen && !peak.compare_exchange_weak(seen, now);) {}
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++ran;
+        --busy;
+    };
+    TaskGraph g;
+    std::vector<TaskGraph::TaskId> phases;
+    for (int i = 0; i < 4; ++i) phases.push_back(g.add("scan", [&]() { parallelFor(&pool, 30, work); }));
+    g.add("join", [&]() { parallelFor(&pool, 30, work); }, phases);
+    g.run(pool);
+    TEST_ASSERT(ran == 5 * 30, "every index ran, got " << ran);
+    TEST_ASSERT(peak <= jobs, peak << " threads were busy on a pool of " << jobs);
+    TEST_ASSERT(peak >= 2, "the work overlapped");
+    TEST_PASS("a graph and its nested work share one pool");
+    return true;
+}
+
+static bool test_cgroup_quota() {
+    const std::string root = std::string("/tmp/nv_cgroup_") + std::to_string(::getpid());
+    std::filesystem::remove_all(root);
+    // v2, limit set on an ancestor and a looser one on the leaf
+    write_file(root + "/v2/cpu.max", "max 100000\n");
+    write_file(root + "/v2/ci/cpu.max", "250000 100000\n");
+    write_file(root + "/v2/ci/job/cpu.max", "800000 100000\n");
+    write_file(root + "/self_v2", "0::/ci/job\n");
+    TEST_ASSERT(cgroupCpuLimit(root + "/v2", root + "/self_v2") == 3, "2.5 CPUs round up to 3, tightest level wins");
+    write_file(root + "/self_unlimited", "0::/\n");
+    TEST_ASSERT(cgroupCpuLimit(root + "/v2", root + "/self_unlimited") == 0, "\"max\" means no quota");
+    // v1 cpu controller
+    write_file(root + "/v1/cpu,cpuacct/docker/x/cpu.cfs_quota_us", "150000\n");
+    write_file(root + "/v1/cpu,cpuacct/docker/x/cpu.cfs_period_us", "100000\n");
+    write_file(root + "/self_v1", "4:memory:/docker/x\n3:cpu,cpuacct:/docker/x\n");
+    TEST_ASSERT(cgroupCpuLimit(root + "/v1", root + "/self_v1") == 2, "v1 quota of 1.5 CPUs");
+    write_file(root + "/v1/cpu,cpuacct/docker/x/cpu.cfs_quota_us", "-1\n");
+    TEST_ASSERT(cgroupCpuLimit(root + "/v1", root + "/self_v1") == 0, "v1 quota of -1 means unlimited");
+    TEST_ASSERT(cgroupCpuLimit(root + "/missing", root + "/missing_self") == 0, "no cgroup files, no limit");
+    std::filesystem::remove_all(root);
+
+    TEST_ASSERT(effectiveJobs(1) == 1, "--jobs 1 stays serial");
+    TEST_ASSERT(effectiveJobs(0) >= 1, "default is at least one job");
+    TEST_PASS("cgroup CPU quota caps the job count");
+    return true;
+}
+
+int main() {
+    std::cout << "Running task graph tests..." << std::endl;
+    bool ok = test_pool_runs_everything();
+    ok &= test_dependencies_respected();
+    ok &= test_independent_tasks_overlap();
+    ok &= test_failure_skips_dependents();
+    ok &= test_parallel_for();
+    ok &= test_nested_work_capped();
+    ok &= test_cgroup_quota();
+    return ok ? 0 : 1;
+}
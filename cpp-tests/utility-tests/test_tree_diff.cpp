@@ -0,0 +1,203 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
+#include "../test_helpers.h"
+#include "next_version/git_helpers.h"
+#include "next_version/pathspec.h"
+#include "next_version/range_snapshot.h"
+#include "next_version/tree_diff.h"
+
+using namespace nv;
+
+static std::string numbered(int from, int to, const std::string &tag = "") {
+    std::string s;
+    for (int i = from; i < to; ++i) s += "line " + std::to_string(i) + tag + "\n";
+    return s;
+}
+
+// Base tag v1 and a target commit exercising every kind of file-level change.
+static std::string init_repo() {
+    const std::string dir = init_test_repo("tree_diff");
+    for (int i = 0; i < 20; ++i) write_file(dir + "/vendor_tree/deep/f" + std::to_string(i) + ".c", numbered(0, 5, std::to_string(i)));
+    write_file(dir + "/src/core.cpp", numbered(0, 40));
+    write_file(dir + "/src/old_name.cpp", numbered(100, 130));
+    write_file(dir + "/src/gone.cpp", numbered(200, 210));
+    write_file(dir + "/docs/guide.md", "# Guide\n\nSome text.\n");
+    write_file(dir + "/tools/run.sh", "#!/bin/sh\necho run\n");
+    write_file(dir + "/space.txt", "alpha beta\ngamma\n");
+    write_file(dir + "/thing", "a file that becomes a directory\n");
+    write_file(dir + "/blob.bin", std::string("\0\1\2binary", 9));
+    write_file(dir + "/lib/parser.cpp", numbered(400, 440));
+    write_file(dir + "/lib/lexer.cpp", numbered(500, 540));
+    git(dir, "add -A");
+    git(dir, "commit -q -m base");
+    git(dir, "tag v1");
+
+    write_file(dir + "/src/core.cpp", numbered(0, 10) + "inserted\n" + numbered(12, 40) + "tail\n");
+    git(dir, "mv src/old_name.cpp src/new_name.cpp");
+    git(dir, "rm -q src/gone.cpp");
+    write_file(dir + "/src/feature.cpp", numbered(300, 320));
+    write_file(dir + "/tests/feature_test.cpp", "int main(){}\n");
+    write_file(dir + "/docs/api.md", "# API\n");
+    write_file(dir + "/docs/guide_copy.md", "# Guide\n\nSome text.\n");
+    write_file(dir + "/docs/guide.md", "# Guide\n\nSome text, revised.\n");
+    write_file(dir + "/space.txt", "alpha   beta\r\ngamma\n");
+    write_file(dir + "/blob.bin", std::string("\0\1\3binary", 9));
+    git(dir, "rm -q lib/parser.cpp");
+    write_file(dir + "/src/parse.cpp", numbered(400, 430) + "edited\n" + numbered(431, 440));
+    write_file(dir + "/src/lexer_fork.cpp", numbered(500, 525) + numbered(0, 10, "x") + "no newline");
+    git(dir, "rm -q thing");
+    write_file(dir + "/thing/inner.txt", "now a directory\n");
+    std::filesystem::permissions(dir + "/tools/run.sh", std::filesystem::perms::owner_exec, std::filesystem::perm_options::add);
+    run_checked("ln -s src/core.cpp " + dir + "/link");
+    git(dir, "add -A");
+    git(dir, "commit -q -m target");
+    return dir;
+}
+
+static bool same_stats(const FileChangeStats &a, const FileChangeStats &b, const std::string &label) {
+    TEST_ASSERT(a.addedFiles == b.addedFiles, label << ": added " << a.addedFiles << " vs " << b.addedFiles);
+    TEST_ASSERT(a.modifiedFiles == b.modifiedFiles, label << ": modified " << a.modifiedFiles << " vs " << b.modifiedFiles);
+    TEST_ASSERT(a.deletedFiles == b.deletedFiles, label << ": deleted " << a.deletedFiles << " vs " << b.deletedFiles);
+    TEST_ASSERT(a.newSourceFiles == b.newSourceFiles, label << ": new source " << a.newSourceFiles << " vs " << b.newSourceFiles);
+    TEST_ASSERT(a.newTestFiles == b.newTestFiles, label << ": new tests " << a.newTestFiles << " vs " << b.newTestFiles);
+    TEST_ASSERT(a.newDocFiles == b.newDocFiles, label << ": new docs " << a.newDocFiles << " vs " << b.newDocFiles);
+    TEST_ASSERT(a.insertions == b.insertions, label << ": insertions " << a.insertions << " vs " << b.insertions);
+    TEST_ASSERT(a.deletions == b.deletions, label << ": deletions " << a.deletions << " vs " << b.deletions);
+    return true;
+}
+
+static bool test_matches_git(const std::string &repo) {
+    const char *pathspecs[] = {"", "src", "src/,docs", ":(glob)**/*.cpp", "*.md", "src/*.cpp,:(exclude)src/feature.cpp", "thing"};
+    for (const char *ps : pathspecs) {
+        for (bool ws : {false, true}) {
+            const std::string label = std::string("pathspec '") + ps + "'" + (ws ? " -w" : "");
+            RangeSnapshot viaGit = collectRangeSnapshot(repo, "v1", "HEAD", ps, ws, SnapshotFileStats, false);
+            RangeSnapshot native = collectRangeSnapshot(repo, "v1", "HEAD", ps, ws, SnapshotFileStats, true);
+            TEST_ASSERT(native.native, label << ": native path should be taken");
+            TEST_ASSERT(native.hasChanges == viaGit.hasChanges, label << ": hasChanges differs");
+            if (!same_stats(computeFileChangeStats(native), computeFileChangeStats(viaGit), label)) return false;
+        }
+    }
+    TEST_PASS("native file stats match git diff --raw --numstat");
+    return true;
+}
+
+static bool test_change_records(const std::string &repo) {
+    RangeSnapshot snap = collectRangeSnapshot(repo, "v1", "HEAD", "", false, SnapshotFileStats, true);
+    auto find = [&](const std::string &path) -> const TreeChange * {
+        for (const auto &c : snap.changes) if (c.path() == path) return &c;
+        return nullptr;
+    };
+    const TreeChange *rename = find("src/new_name.cpp");
+    TEST_ASSERT(rename && rename->status == 'R' && rename->oldPath == "src/old_name.cpp", "exact rename should pair");
+    TEST_ASSERT(rename->oldOid == rename->newOid && rename->insertions == 0, "rename keeps the blob");
+    const TreeChange *copy = find("docs/guide_copy.md");
+    TEST_ASSERT(copy && copy->status == 'C' && copy->oldPath == "docs/guide.md", "copy of a modified file's preimage");
+    const TreeChange *mode = find("tools/run.sh");
+    TEST_ASSERT(mode && mode->status == 'M' && mode->newMode == 0100755 && mode->oldMode == 0100644, "mode change");
+    const TreeChange *bin = find("blob.bin");
+    TEST_ASSERT(bin && bin->binary && bin->insertions == 0, "binary blob should be flagged");
+    const TreeChange *core = find("src/core.cpp");
+    TEST_ASSERT(core && core->insertions == 2 && core->deletions == 2, "core.cpp numstat");
+    TEST_ASSERT(find("thing") && find("thing")->status == 'D' && find("thing/inner.txt"), "file replaced by directory");
+    const TreeChange *near = find("src/parse.cpp");
+    TEST_ASSERT(near && near->status == 'R' && near->oldPath == "lib/parser.cpp" && near->similarity == 97,
+                "inexact rename with git's similarity index");
+    const TreeChange *fork = find("src/lexer_fork.cpp");
+    TEST_ASSERT(fork && fork->status == 'A', "a 60% copy of an unchanged file stays an addition");
+    for (const auto &c : snap.changes) {
+        TEST_ASSERT(c.path().rfind("vendor_tree/", 0) != 0, "unchanged subtree should not produce records");
+    }
+    TEST_PASS("typed change records");
+    return true;
+}
+
+static bool test_rename_threshold(const std::string &repo) {
+    for (int threshold : {30, 50, 75, 97}) {
+        const std::string label = "threshold " + std::to_string(threshold);
+        RangeSnapshot viaGit = collectRangeSnapshot(repo, "v1", "HEAD", "", false, SnapshotAll, false, threshold);
+        RangeSnapshot native = collectRangeSnapshot(repo, "v1", "HEAD", "", false, SnapshotAll, true, threshold);
+        TEST_ASSERT(native.native, label << ": native path should be taken");
+        TEST_ASSERT(native.diff == viaGit.diff, label << ": patch differs\n--- native\n" << native.diff << "--- git\n" << viaGit.diff);
+        if (!same_stats(computeFileChangeStats(native), computeFileChangeStats(viaGit), label)) return false;
+    }
+    TEST_PASS("rename thresholds pair like git -M<n>% -C<n>%");
+    return true;
+}
+
+// Past the exhaustive limit candidates come from LSH buckets; clear moves must
+// still pair with the same source and score.
+static bool test_sketch_candidates(const std::string &repo) {
+    auto store = ObjectStore::open(repo);
+    TEST_ASSERT(store != nullptr, "store should open");
+    std::string base, head;
+    runGitCapture({"rev-parse", "v1^{tree}"}, repo, base);
+    runGitCapture({"rev-parse", "HEAD^{tree}"}, repo, head);
+    std::vector<TreeChange> exact, sketched;
+    TEST_ASSERT(diffTrees(*store, ObjectId::fromHex(trim(base)), ObjectId::fromHex(trim(head)), PathFilter(), exact), "diff");
+    sketched = exact;
+    TEST_ASSERT(detectRenames(*store, exact), "exhaustive detection");
+    RenameOptions opts;
+    opts.exhaustiveLimit = 0;
+    TEST_ASSERT(detectRenames(*store, sketched, opts), "sketch detection");
+    TEST_ASSERT(exact.size() == sketched.size(), "same number of records");
+    for (std::size_t i = 0; i < exact.size(); ++i) {
+        TEST_ASSERT(exact[i].status == sketched[i].status && exact[i].oldPath == sketched[i].oldPath &&
+                    exact[i].similarity == sketched[i].similarity, "record " << exact[i].path() << " differs");
+    }
+    TEST_PASS("LSH candidates agree with exhaustive scoring");
+    return true;
+}
+
+static bool test_identical_trees(const std::string &repo) {
+    auto store = ObjectStore::open(repo);
+    TEST_ASSERT(store != nullptr, "store should open");
+    std::string head;
+    runGitCapture({"rev-parse", "HEAD^{tree}"}, repo, head);
+    std::vector<TreeChange> changes;
+    TEST_ASSERT(diffTrees(*store, ObjectId::fromHex(trim(head)), ObjectId::fromHex(trim(head)), PathFilter(), changes), "diff");
+    TEST_ASSERT(changes.empty(), "identical trees should not differ");
+    TEST_ASSERT(diffTrees(*store, ObjectId{}, ObjectId::fromHex(trim(head)), PathFilter("src"), changes), "diff vs empty");
+    TEST_ASSERT(changes.size() == 5, "src holds five files, got " << changes.size());
+    TEST_PASS("identical and empty trees");
+    return true;
+}
+
+static bool test_pathspec_matching() {
+    TEST_ASSERT(wildmatch("**/*.c", "a.c", true) && wildmatch("**/*.c", "x/y/a.c", true), "** spans zero or more dirs");
+    TEST_ASSERT(!wildmatch("*.c", "x/a.c", true) && wildmatch("*.c", "x/a.c", false), "* and / in glob vs plain");
+    TEST_ASSERT(wildmatch("src/**", "src/a/b", true) && wildmatch("a/**/b", "a/b", true), "trailing and inner **");
+    TEST_ASSERT(wildmatch("f[0-9].[ch]", "f3.h", true) && !wildmatch("f[!0-9]", "f3", true), "bracket classes");
+    PathFilter f("src, :(glob)docs/*.md, :!src/generated");
+    TEST_ASSERT(f.supported(), "filter should be supported");
+    TEST_ASSERT(f.matches("src/a.cpp") && f.matches("src") && !f.matches("srcx/a.cpp"), "directory prefix");
+    TEST_ASSERT(f.matches("docs/a.md") && !f.matches("docs/x/a.md"), "glob does not cross /");
+    TEST_ASSERT(!f.matches("src/generated/x.cpp"), "exclude wins");
+    TEST_ASSERT(f.mayMatchUnder("src/deep") && f.mayMatchUnder("docs") && !f.mayMatchUnder("lib"), "subtree pruning");
+    TEST_ASSERT(!PathFilter(":(icase)src").supported(), "unsupported magic is reported");
+    TEST_PASS("pathspec matching");
+    return true;
+}
+
+int main() {
+    std::cout << "Running tree diff tests..." << std::endl;
+    bool ok = test_pathspec_matching();
+#ifdef NEXT_VERSION_HAVE_ZLIB
+    const std::string repo = init_repo();
+    ok &= test_matches_git(repo);
+    ok &= test_change_records(repo);
+    ok &= test_rename_threshold(repo);
+    ok &= test_sketch_candidates(repo);
+    ok &= test_identical_trees(repo);
+#endif
+    return ok ? 0 : 1;
+}
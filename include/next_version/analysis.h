@@ -0,0 +1,33 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <string>
+#include "next_version/types.h"
+
+namespace nv {
+
+// What one run over a range suggests, and what the output formats report.
+struct AnalysisResult {
+  std::string baseRef;
+  std::string targetRef;
+  std::string suggestion;
+  std::string currentVersion;
+  std::string nextVersion;   // empty when the suggestion is none
+  int totalBonus {0};
+  int loc {0};
+  Kv cli;
+};
+
+// Resolves the range opts names, analyzes it and suggests the next version,
+// with cfg as read by loadConfigValues(opts.repoRoot). Writes only the caches
+// and, with opts.verbose, debug lines on stderr, so several calls may run at
+// once on different threads.
+AnalysisResult analyzeRange(const Options &opts, const ConfigValues &cfg);
+
+}
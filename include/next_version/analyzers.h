@@ -8,7 +8,15 @@
 #pragma once
 
 #include "next_version/types.h"
+#include "next_version/commit_log.h"
+#include "next_version/cpp_lexer.h"
+#include "next_version/diff_model.h"
+#include "next_version/range_snapshot.h"
+#include "next_version/pattern_matcher.h"
+#include "next_version/symbol_pool.h"
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace nv {
 
@@ -18,6 +26,175 @@ KeywordResults analyzeKeywords(const std::string &repoRoot, const std::string &b
 CliResults analyzeCliOptions(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef, const std::string &onlyPathsCsv, bool ignoreWhitespace);
 SecurityResults analyzeSecurity(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef, const std::string &onlyPathsCsv, bool ignoreWhitespace, bool addedOnly=false);
 
+// Snapshot-based variants: the wrappers above fetch their own snapshot, while
+// main() collects one per run and shares it across all analyzers.
+KeywordResults analyzeKeywords(const RangeSnapshot &snap);
+CliResults analyzeCliOptions(const RangeSnapshot &snap);
+SecurityResults analyzeSecurity(const RangeSnapshot &snap, bool addedOnly=false);
+
+// Incremental analyzers for streamed patches (see DiffSinks): feed() takes
+// line-aligned batches in order, finish() adds the commit log where the analyzer
+// reads one, either as the `git log -z` text or as the totals of a
+// CommitLogScanner over logPatterns (one log scan can serve both analyzers). No diff pattern spans two lines of a unified=0 patch, and the CLI
+// scanner keeps its lexer state from one batch to the next, so batch
+// boundaries never change a count. The CLI scanner and the added-only security
+// scanner walk the lines of a DiffModel parsed from each batch; added lines are
+// matched one at a time, like the shell analyzer's grep.
+//
+// The keyword and security scanners count with countPatterns: the security
+// scanner alone runs on the SecurityTokenScanner, and a caller feeding both
+// the same batches can count the union of their diffPatterns in one fused
+// PatternMatcher pass (countPatch) and hand the result to add() instead of
+// calling feed().
+//
+// With a pool, feed() cuts the batch into DiffModel ranges of about
+// kParallelRangeBytes at file and hunk starts and scans the ranges
+// concurrently, each into its own partial, which are then merged in range
+// order. Every accumulator is a sum, an OR or a set union, and the CLI
+// scanner's lexers start over at every hunk, so the results are the same for
+// any pool size, including none.
+class ThreadPool;
+
+inline constexpr std::size_t kParallelRangeBytes = 64u << 10;
+
+// countPatterns over a batch, split over `pool` as described above.
+// `model` is only used (and reparsed) when there is a pool.
+void countPatch(std::string_view diff, PatternSet patterns, PatternCounts &counts, DiffModel &model, ThreadPool *pool);
+
+class KeywordScanner {
+public:
+  static constexpr PatternSet diffPatterns = patternBit(Pattern::CliBreaking) | patternBit(Pattern::ApiBreaking) |
+                                             patternBit(Pattern::SecurityComment) | patternBit(Pattern::RemovedOption);
+  // Code patterns for breaking changes (align with shell analyzer); commit
+  // messages also accept "BREAKING: ... CLI" and "BREAKING: ... API", and the
+  // bash commit pattern (SECURITY|VULNERABILIT(Y|IES)|CVE[- ]?[0-9]{4}-[0-9]+)
+  static constexpr PatternSet logPatterns = patternBit(Pattern::CliBreaking) | patternBit(Pattern::ApiBreaking) |
+                                            patternBit(Pattern::CliBreakingCommit) | patternBit(Pattern::ApiBreakingCommit) |
+                                            patternBit(Pattern::GeneralBreaking) | patternBit(Pattern::SecurityOrCve);
+  void feed(std::string_view diff, ThreadPool *pool = nullptr);
+  void add(const PatternCounts &counts);
+  KeywordResults finish(const std::string &logs) const;
+  KeywordResults finish(const PatternCounts &log) const;
+
+private:
+  DiffModel model_;
+  PatternCounts diff_;
+};
+
+// Reads the removed and the added lines as two runs of C/C++ source, each
+// through its own CppLexer, so comments and literals are known even when they
+// span lines. Long options are taken from string literals and comments,
+// short option removals from the same, case labels and removed prototypes
+// from the code tokens. The manual sets keep the shell analyzer's rule: all
+// options of a line that neither starts a comment nor has a quote in it. Both sides start
+// over at every hunk; their state carries across feed() batches.
+class CliScanner {
+public:
+  // Longer diff lines are skipped. The lexer takes linear time on any line;
+  // the cap keeps minified or generated code from filling the option sets
+  // with megabyte-long names, and no hand-written C/C++ line comes near it.
+  static constexpr std::size_t kMaxLineLength = std::size_t(1) << 20;
+
+  void feed(std::string_view diff, ThreadPool *pool = nullptr);
+  void merge(CliScanner &&other);   // moves the other scanner's findings into this one
+  CliFindings findings() const;
+  void add(const CliFindings &findings);
+  CliResults finish() const;
+
+private:
+  enum class Decl : std::uint8_t { Start, Type, Operator, Params, After, Skip };
+
+  // One side of the hunk: the lexer and the statement and case label in progress.
+  struct Side {
+    CppLexer lexer;
+    std::vector<CppToken> tokens;   // of the current line
+    Decl decl {Decl::Start};
+    int idents {0};                 // identifiers of the declaration so far
+    int depth {0};                  // parentheses in Params, name state in Operator
+    int nested {0};                 // open <...> or [...] in Start and Type
+    bool lastName {false};          // the last token was an identifier
+    bool inCase {false};
+    bool directive {false};         // in a preprocessor line
+    std::string caseLabel;
+    void reset();
+    bool advanceDecl(const CppToken &t);
+    bool advanceCase(const CppToken &t);
+  };
+
+  void scan(const DiffModel &model, const PatchRange &range);
+  void scanLine(Side &side, std::string_view line, bool removed);   // line with its marker
+  DiffModel model_;
+  Side removed_, added_;
+  // Option names and case labels, interned: a name found again costs a
+  // hash probe, not a copy and a tree node.
+  SymbolPool symbols_;
+  SymbolSet removedLongFromStruct_, addedLongFromStruct_;
+  SymbolSet removedLongManual_, addedLongManual_;
+  SymbolSet removedCases_, addedCases_;
+  bool apiBreaking_ {false};
+  int removedShortCount_ {0};
+};
+
+class SecurityScanner {
+public:
+  static constexpr PatternSet diffPatterns = patternBit(Pattern::SecurityWord) | patternBit(Pattern::CveId) |
+                                             patternBit(Pattern::MemorySafety) | patternBit(Pattern::Crash);
+  static constexpr PatternSet logPatterns = patternBit(Pattern::SecurityWord);
+  explicit SecurityScanner(bool addedOnly = false) : addedOnly_(addedOnly) {}
+  void feed(std::string_view diff, ThreadPool *pool = nullptr);
+  void add(const PatternCounts &counts);   // counts over the batch as fed, so not with addedOnly
+  SecurityResults finish(const std::string &commits) const;
+  SecurityResults finish(const PatternCounts &log) const;
+
+private:
+  bool addedOnly_;
+  DiffModel model_;
+  PatternCounts diff_;
+};
+
+class CommitCache;
+
+// The counts of the cache's patterns over the commit messages of
+// base..target, through a CommitCache: the range's commits are listed with
+// rev-list, the cached ones counted from the cache, and only the messages of
+// the others fetched (git log --no-walk) and scanned, then stored. When more
+// than kListedCommits are missing, or the cache is empty, the whole range's
+// log is scanned instead.
+inline constexpr std::size_t kListedCommits = 2048;
+PatternCounts countRangeLog(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef,
+                            CommitCache &cache, ThreadPool *pool = nullptr);
+
+class PairCache;
+struct PairFindings;
+
+// Analyzes native patches a blob pair at a time through a PairCache (see
+// DiffSinks::pairKnown). The findings of a pair the cache knows are added
+// without the pair being diffed; the others are scanned on their own, in
+// parallel over the pool, and stored. Findings go to the scanners the parts'
+// sinks feed, and they are sums, ORs and sets merged by union, so the results
+// are those of scanning the whole patches. The security scanner counts all
+// lines (not addedOnly), as with add().
+class PairScanner {
+public:
+  PairScanner(PairCache &cache, KeywordScanner &keywords, SecurityScanner &security, CliScanner &cli,
+              ThreadPool *pool = nullptr);
+  void attach(DiffSinks &sinks);
+
+  // The findings of one pair's hunks for one part.
+  static void scan(unsigned part, std::string_view hunks, PairFindings &out);
+
+private:
+  bool known(PairSection &section);
+  void scan(const std::vector<PairSection> &batch);
+  void add(unsigned part, const PairFindings &findings);
+
+  PairCache &cache_;
+  KeywordScanner &keywords_;
+  SecurityScanner &security_;
+  CliScanner &cli_;
+  ThreadPool *pool_;
+};
+
 int baseDeltaFor(const std::string &bumpType, int loc, const ConfigValues &cfg);
 int computeTotalBonusWithMultiplier(int baseBonus, int loc, const std::string &bumpType, const ConfigValues &cfg);
 std::string bumpVersion(const std::string &current, const std::string &bumpType, int loc, int bonus, const ConfigValues &cfg, int mainMod=1000);
@@ -0,0 +1,61 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include "next_version/analysis.h"
+#include "next_version/types.h"
+
+namespace nv {
+
+// One line of a --batch file: a job's options, laid over the command line's,
+// or why the line is not a job.
+struct BatchJob {
+  std::size_t line {0};
+  std::string id;   // the job's "id" as written (a JSON string or number), echoed in its result
+  Options opts;
+  std::string error;
+};
+
+// Parses one NDJSON job line over defaults. A job is a flat JSON object; its
+// fields are "id", the strings "repo", "base", "target", "since",
+// "since_commit", "since_date", "tag_match", "only_paths" and "shared_cache",
+// the booleans "ignore_whitespace", "native_git", "first_parent",
+// "no_merge_base" and "no_cache", and the number "rename_threshold". False,
+// with job.error set, for anything else.
+bool parseBatchJob(std::string_view text, const Options &defaults, BatchJob &job);
+
+// The result line of a job (without its newline): the fields of --json, with
+// the job's line, id and repository first.
+std::string formatBatchResult(const BatchJob &job, const AnalysisResult &result, const ConfigValues &cfg);
+std::string formatBatchError(const BatchJob &job);
+
+struct BatchOptions {
+  unsigned workers {1};   // jobs running at once
+  unsigned perRepo {1};   // jobs running at once on one repository
+  std::function<AnalysisResult(const Options &, const ConfigValues &)> analyze {analyzeRange};
+};
+
+// Reads job lines from in and runs them on batch.workers threads as they
+// come, writing each result line to out as soon as its job finishes, so
+// results are in completion order. A job waits while batch.perRepo jobs on
+// its repository are running, and later jobs on other repositories go
+// ahead of it. Each job analyzes on one thread; the configuration of a
+// repository is read once for all its jobs. Returns 0 when every non-blank
+// line was a job that ran, 1 otherwise.
+int runBatch(std::istream &in, std::ostream &out, const Options &defaults, const BatchOptions &batch);
+
+// --batch: the jobs of opts.batchFile ("-" for stdin) on effectiveJobs()
+// workers, one job per repository at a time, results on stdout.
+int runBatch(const Options &opts);
+
+}
@@ -0,0 +1,70 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nv {
+
+enum class DiffAlgorithm { Myers, Histogram };
+
+struct BlobDiffOptions {
+  bool ignoreWhitespace {false};   // git diff -w: lines compare equal when they differ only in whitespace
+  DiffAlgorithm algorithm {DiffAlgorithm::Myers};
+};
+
+// Lines of one blob as offsets into the caller's buffer, each with a hash of its
+// comparison key (the raw bytes, or the non-whitespace bytes under -w). A line
+// keeps its trailing '\n'; only the last line of a blob may lack one.
+class LineTable {
+public:
+  void build(std::string_view text, bool ignoreWhitespace);
+  std::size_t size() const { return starts_.empty() ? 0 : starts_.size() - 1; }
+  std::string_view line(std::size_t i) const { return text_.substr(starts_[i], starts_[i + 1] - starts_[i]); }
+  std::uint64_t hash(std::size_t i) const { return hashes_[i]; }
+  std::string_view text() const { return text_; }
+
+private:
+  std::string_view text_;
+  std::vector<std::size_t> starts_;
+  std::vector<std::uint64_t> hashes_;
+};
+
+// A change as line spans: old lines [oldBegin, oldBegin+oldCount) were replaced
+// by new lines [newBegin, newBegin+newCount). Zero-based.
+struct DiffHunk {
+  std::size_t oldBegin {0};
+  std::size_t oldCount {0};
+  std::size_t newBegin {0};
+  std::size_t newCount {0};
+};
+
+// Line views over the two input buffers plus the hunks between them. The
+// buffers must outlive the BlobDiff.
+struct BlobDiff {
+  LineTable oldLines;
+  LineTable newLines;
+  std::vector<DiffHunk> hunks;
+  int insertions {0};
+  int deletions {0};
+};
+
+// Hunks follow git's xdiff: the same Myers split heuristics, discarding of
+// unmatched lines and change compaction with the indent heuristic, so the
+// output lines up with `git diff --unified=0`.
+void diffBlobs(std::string_view oldText, std::string_view newText, const BlobDiffOptions &opts, BlobDiff &out);
+
+// Append the hunks as `--unified=0` text: "@@ -a,b +c,d @@ <funcname>" headers
+// (git's default funcname rule), '-'/'+' lines and "\ No newline at end of file".
+void appendUnifiedHunks(const BlobDiff &diff, std::string &out);
+
+}
@@ -0,0 +1,44 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "next_version/literal_prefilter.h"
+
+namespace nv {
+
+// Copy n bytes from src to dst with ASCII letters lowercased, as the "C"
+// locale folds them; every other byte, UTF-8 included, is copied unchanged.
+// Vector kernels do 16 or 32 bytes per step.
+void foldAscii(const char *src, std::size_t n, char *dst, SimdLevel level);
+void foldAscii(const char *src, std::size_t n, char *dst);
+
+// A case-folded shadow of a text: byte i of the shadow is byte i of the text
+// folded, so offsets found in one hold in the other and case-insensitive
+// searches can run as plain ones. Folding is byte by byte, so a text can be
+// folded chunk by chunk as it streams in (append) and the shadow is the same
+// as folding it whole. The buffer is kept between texts.
+class FoldedText {
+public:
+  // Fold `text` in place of the current shadow.
+  std::string_view assign(std::string_view text) {
+    buf_.clear();
+    return append(text);
+  }
+  // Fold the next chunk of the text after the previous ones; returns its shadow.
+  std::string_view append(std::string_view chunk);
+  void clear() { buf_.clear(); }
+  std::string_view view() const { return buf_; }
+
+private:
+  std::string buf_;
+};
+
+}
@@ -0,0 +1,65 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "next_version/object_store.h"
+#include "next_version/pattern_matcher.h"
+
+namespace nv {
+
+class ThreadPool;
+
+// Commit messages of a range come from `git log -z --format=%s %b`: one
+// "subject body" record per commit, each ended by a NUL.
+//
+// CommitLogScanner counts patterns in every record on its own, so no match
+// spans two commits. feed() takes batches of whole records in log order
+// (streamLines with delimiter '\0'); text after the last NUL of a batch is
+// taken as one more record. With a pool, the records of a batch are split
+// into chunks of about kChunkBytes that are counted concurrently and merged
+// in commit order, so the results do not depend on the pool size.
+//
+// With withIds, each record starts with the commit's id and a space
+// (`--format=%H %s %b`); the id is kept in ids() and not counted.
+class CommitLogScanner {
+public:
+  static constexpr std::size_t kChunkBytes = 64u << 10;
+
+  struct Hit {
+    std::size_t commit;       // position in log order
+    PatternCounts counts;
+  };
+
+  explicit CommitLogScanner(PatternSet patterns, bool withIds = false) : patterns_(patterns), withIds_(withIds) {}
+
+  void feed(std::string_view records, ThreadPool *pool = nullptr);
+
+  std::size_t commits() const { return commits_; }
+  // The id of every commit in log order, with withIds; empty where a record had none.
+  const std::vector<ObjectId> &ids() const { return ids_; }
+  // Commits with at least one match, in log order; their counts add up to totals().
+  const std::vector<Hit> &hits() const { return hits_; }
+  const PatternCounts &totals() const { return totals_; }
+
+private:
+  PatternSet patterns_;
+  bool withIds_;
+  std::size_t commits_ {0};
+  std::vector<ObjectId> ids_;
+  std::vector<Hit> hits_;
+  PatternCounts totals_;
+  std::vector<std::string_view> records_;   // reused between batches
+};
+
+// Totals of a whole log held in memory, counted commit by commit.
+PatternCounts countCommitLog(std::string_view log, PatternSet patterns);
+
+}
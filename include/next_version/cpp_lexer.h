@@ -0,0 +1,55 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nv {
+
+enum class CppTokenKind : std::uint8_t {
+  Identifier,   // keywords included
+  Number,
+  String,       // with its prefix and quotes; a piece of it when it spans lines
+  Char,
+  Comment,      // with its // or /* */; a piece of it when it spans lines
+  Punct,        // one character, or "::"
+};
+
+struct CppToken {
+  CppTokenKind kind;
+  std::string_view text;   // a slice of the lexed line
+};
+
+// Splits C and C++ source into tokens one line at a time. Block comments,
+// raw strings and literals continued with a trailing backslash carry over to
+// the next line, so a run of lines (one side of a diff hunk) is lexed as the
+// text it came from. A table of character classes drives the code state;
+// the literal and comment states look only for their terminators, so lexing
+// takes linear time.
+class CppLexer {
+public:
+  // Append the tokens of `line` (without its '\n') to `out`.
+  void lexLine(std::string_view line, std::vector<CppToken> &out);
+  // Back to code, e.g. at a hunk start where the text before is unknown.
+  void reset();
+  bool inCode() const { return state_ == State::Code; }
+
+private:
+  enum class State : std::uint8_t { Code, LineComment, BlockComment, String, Char, RawString };
+
+  std::size_t lexCode(std::string_view line, std::size_t pos, std::vector<CppToken> &out);
+  std::size_t lexQuoted(std::string_view line, std::size_t pos, char quote);
+
+  State state_ {State::Code};
+  std::string rawEnd_;   // )delimiter" that closes the open raw string
+};
+
+}
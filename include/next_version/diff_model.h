@@ -0,0 +1,108 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace nv {
+
+enum class PatchLineKind : std::uint8_t {
+  Header,    // file header: diff --git, index, mode, rename, ---/+++ lines
+  Hunk,      // @@ -a,b +c,d @@
+  Context,
+  Removed,
+  Added,
+  Note,      // \ No newline at end of file
+};
+
+// One line of the parsed text, without its '\n'.
+struct PatchLine {
+  std::size_t offset;
+  std::size_t length;
+  std::uint32_t file;        // index into DiffModel::files()
+  PatchLineKind kind;
+};
+
+struct PatchHunk {
+  std::uint32_t file;
+  std::uint32_t firstLine;   // the @@ line, or 0 when continued from the previous text
+  std::uint32_t lineCount;   // including the @@ line
+};
+
+struct PatchFile {
+  std::uint32_t firstLine;
+  std::uint32_t lineCount;
+  std::uint32_t firstHunk;
+  std::uint32_t hunkCount;
+  bool continued;            // begins before this text (a stream batch cut inside it)
+};
+
+// Lines [firstLine, endLine) of a DiffModel.
+struct PatchRange {
+  std::size_t firstLine;
+  std::size_t endLine;
+};
+
+// A unified diff split into files, hunks and lines, as flat records over the
+// text they came from. Nothing is copied: every line is a string_view into
+// that text, so the text has to outlive the model until the next parse().
+//
+// Hunk lines are told apart by the @@ line counts, so removed or added
+// content that itself starts with "--" or "++" stays a Removed or Added line.
+// Lines outside any hunk that start with '-', '+' or ' ' (other than the
+// ---/+++ file header lines) are classified by that marker too; callers that
+// feed bare diff lines get the same view as with full headers.
+//
+// parse() may be called once per line-aligned batch of a stream: the records
+// are replaced, but the file and hunk the previous batch ended in carry over.
+// The vectors keep their capacity between batches.
+class DiffModel {
+public:
+  void parse(std::string_view text);
+  void reset();   // forget the open file and hunk before parsing a new patch
+
+  std::string_view text() const { return text_; }
+  const std::vector<PatchLine> &lines() const { return lines_; }
+  const std::vector<PatchHunk> &hunks() const { return hunks_; }
+  const std::vector<PatchFile> &files() const { return files_; }
+  // Indexes into lines() of the Added lines, in order.
+  const std::vector<std::uint32_t> &addedLines() const { return added_; }
+
+  std::string_view line(const PatchLine &l) const { return text_.substr(l.offset, l.length); }
+  // The line without its '-', '+' or ' ' marker; the whole line for other kinds.
+  std::string_view content(const PatchLine &l) const;
+
+  // Consecutive ranges covering lines(), each cut where a file or a hunk
+  // starts once it holds at least `bytes`. A range holds whole hunks, so it
+  // can be scanned on its own.
+  std::vector<PatchRange> ranges(std::size_t bytes) const;
+  // The text of a range, with the '\n' of its last line.
+  std::string_view text(const PatchRange &r) const;
+
+private:
+  void startFile(bool continued);
+  void startHunk(std::string_view header);
+  void endHunk();
+  PatchLineKind classify(std::string_view line);
+
+  std::string_view text_;
+  std::vector<PatchLine> lines_;
+  std::vector<PatchHunk> hunks_;
+  std::vector<PatchFile> files_;
+  std::vector<std::uint32_t> added_;
+  // Lines still expected in the open hunk; -1 when its header had no counts.
+  long removedLeft_ {0};
+  long addedLeft_ {0};
+  bool inHunk_ {false};
+  bool inFile_ {false};
+};
+
+}
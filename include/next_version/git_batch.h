@@ -0,0 +1,53 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "next_version/process.h"
+
+#include <cstddef>
+#include <string>
+
+namespace nv {
+
+struct GitObjectInfo {
+  bool found {false};
+  std::string oid;
+  std::string type;       // "commit", "tree", "blob" or "tag"
+  std::size_t size {0};
+};
+
+// One long-lived `git cat-file --batch-command` per repository. Ref resolution,
+// object-type checks and blob reads become a request/response round trip on a
+// pipe instead of a fork+exec each. Falls back to a --batch-check/--batch pair
+// on git older than 2.36. Not thread-safe; use one instance per thread.
+class GitBatch {
+public:
+  explicit GitBatch(std::string repoRoot);
+
+  // Object id, type and size for any revision expression (e.g. "v1.0^{commit}", "HEAD:path").
+  GitObjectInfo info(const std::string &rev);
+  // Same as info() and appends the raw object payload to data; false when missing.
+  bool contents(const std::string &rev, GitObjectInfo &info, std::string &data);
+
+  // Full object id for rev, or "" when it does not resolve (like `rev-parse -q --verify`).
+  std::string resolve(const std::string &rev) { return info(rev).oid; }
+  std::string resolveCommit(const std::string &rev) { return rev.empty() ? std::string() : resolve(rev + "^{commit}"); }
+
+private:
+  enum class Mode { Unstarted, Command, Split, Failed };
+  bool request(bool withContents, const std::string &rev, GitObjectInfo &info, std::string *data);
+  bool roundTrip(Coprocess &proc, const std::string &line, bool withContents, GitObjectInfo &info, std::string *data);
+
+  std::string repoRoot_;
+  Mode mode_ {Mode::Unstarted};
+  Coprocess command_;   // --batch-command
+  Coprocess check_;     // --batch-check (fallback)
+  Coprocess batch_;     // --batch (fallback)
+};
+
+}
@@ -8,6 +8,9 @@
 #pragma once
 
 #include "next_version/types.h"
+#include "next_version/line_stream.h"
+#include "next_version/process.h"
+#include "next_version/range_snapshot.h"
 #include <string>
 #include <vector>
 
@@ -15,9 +18,20 @@ namespace nv {
 
 std::string shellQuote(const std::string &s);
 std::string buildCommand(const std::vector<std::string> &args);
+// Run a shell command line via /bin/sh -c; stderr is discarded.
 int runProcessCapture(const std::string &command, std::string &stdoutData);
 
 int runGitCapture(const std::vector<std::string> &args, const std::string &repoRoot, std::string &out);
+// Same as above but keeps stderr separately (spawned directly, no shell involved).
+int runGitCapture(const std::vector<std::string> &args, const std::string &repoRoot, ProcessResult &result);
+// Hand git's stdout to consume in line-aligned batches while git is still running
+// (see streamLines); returns git's exit status.
+int streamGit(const std::vector<std::string> &args, const std::string &repoRoot, const LineBatchFn &consume,
+              const LineStreamOptions &opts = {});
+// Start a long-lived git child (e.g. cat-file --batch-command) and count it like runGitCapture.
+bool startGitCoprocess(Coprocess &proc, const std::vector<std::string> &args, const std::string &repoRoot);
+// Number of git processes started through runGitCapture or startGitCoprocess in this process (for --verbose).
+int gitInvocationCount();
 bool gitHasCommits(const std::string &repoRoot);
 std::string gitDescribeLastTag(const std::string &match, const std::string &repoRoot);
 std::string gitRevListBeforeDate(const std::string &date, const std::string &repoRoot);
@@ -29,6 +43,7 @@ FileChangeStats computeFileChangeStats(const std::string &repoRoot,
                                       const std::string &targetRef,
                                       const std::string &onlyPathsCsv,
                                       bool ignoreWhitespace);
+FileChangeStats computeFileChangeStats(const RangeSnapshot &snap);
 
 }
 
@@ -0,0 +1,43 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+namespace nv {
+
+// Receives whole lines, several at a time. Every line keeps its '\n' except
+// possibly the last line of the stream.
+using LineBatchFn = std::function<void(std::string_view lines)>;
+// Reads up to n bytes into dst and returns the count; 0 means end of input.
+using ReadFn = std::function<std::size_t(char *dst, std::size_t n)>;
+
+struct LineStreamOptions {
+  std::size_t chunkSize {1u << 20};   // bytes per ring slot; a slot grows only for a longer line
+  std::size_t chunkCount {4};         // slots shared between the reader and the consumer
+  char delimiter {'\n'};              // ends a line; '\0' streams NUL-terminated records
+};
+
+struct LineStreamStats {
+  std::size_t bytes {0};
+  std::size_t batches {0};
+  std::size_t ringBytes {0};          // memory held by the ring at its peak
+};
+
+// Drain `read` on a reader thread while `consume` runs on the calling thread.
+// The reader fills a ring of fixed-size chunks, cuts each one after its last
+// delimiter (the partial line moves to the next chunk) and hands it over through
+// a lock-free single-producer/single-consumer queue. Memory stays at
+// chunkCount * chunkSize however long the input is, and reading overlaps the
+// consumer's work. An exception from `consume` is rethrown once the input
+// has been drained.
+LineStreamStats streamLines(const ReadFn &read, const LineBatchFn &consume, const LineStreamOptions &opts = {});
+
+}
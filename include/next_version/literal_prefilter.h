@@ -0,0 +1,51 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nv {
+
+// Vector instruction sets the prefilter has kernels for.
+enum class SimdLevel { Scalar, Ssse3, Avx2 };
+
+// Widest level this CPU supports (Scalar when built without NEXT_VERSION_HAVE_SIMD).
+SimdLevel detectSimdLevel();
+const char *simdLevelName(SimdLevel level);
+
+// Teddy-style prefilter for a set of lowercase words: the first four bytes of
+// every word form a fingerprint, fingerprints are grouped into eight buckets,
+// and per-position nibble tables (looked up with a byte shuffle) tell which
+// buckets the four bytes starting at each text position can belong to.
+// ASCII letters are folded to lowercase. The result is a superset of the
+// positions where a word starts; callers verify each candidate.
+class LiteralPrefilter {
+public:
+  static constexpr std::size_t kBlock = 32;
+
+  LiteralPrefilter() = default;   // matches nothing
+  explicit LiteralPrefilter(const std::vector<std::string> &words);
+
+  // First block [start, start + kBlock) at or after `from` holding a
+  // candidate; bit i of `mask` marks start + i. npos when there is none.
+  // Scalar does the table lookups one byte at a time, which is only worth it
+  // for testing the kernels against.
+  std::size_t nextBlock(std::string_view text, std::size_t from, std::uint32_t &mask, SimdLevel level) const;
+
+private:
+  std::uint32_t tailMask(std::string_view text, std::size_t pos) const;
+
+  alignas(32) std::uint8_t lo_[4][16] {};   // low nibble -> buckets, per byte of the fingerprint
+  alignas(32) std::uint8_t hi_[4][16] {};   // high nibble -> buckets
+};
+
+}
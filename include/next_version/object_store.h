@@ -0,0 +1,125 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nv {
+
+enum class ObjectType : int { Bad = 0, Commit = 1, Tree = 2, Blob = 3, Tag = 4 };
+
+const char *objectTypeName(ObjectType type);
+
+// Raw object id: 20 bytes in SHA-1 repositories, 32 bytes in SHA-256 ones.
+struct ObjectId {
+  std::array<unsigned char, 32> bytes {};
+  std::uint8_t size {0};
+
+  bool empty() const { return size == 0; }
+  std::string hex() const;
+  static ObjectId fromHex(std::string_view hex);                      // empty on malformed input
+  static ObjectId fromRaw(const unsigned char *raw, std::size_t len);
+
+  friend bool operator==(const ObjectId &a, const ObjectId &b) {
+    return a.size == b.size && std::memcmp(a.bytes.data(), b.bytes.data(), a.size) == 0;
+  }
+  friend bool operator!=(const ObjectId &a, const ObjectId &b) { return !(a == b); }
+  friend bool operator<(const ObjectId &a, const ObjectId &b) {
+    int c = std::memcmp(a.bytes.data(), b.bytes.data(), a.size < b.size ? a.size : b.size);
+    return c < 0 || (c == 0 && a.size < b.size);
+  }
+};
+
+struct ObjectIdHash {
+  std::size_t operator()(const ObjectId &id) const {
+    std::size_t h; std::memcpy(&h, id.bytes.data(), sizeof(h)); return h; // ids are uniformly distributed
+  }
+};
+
+// An inflated object. data() views a buffer shared with the store's delta-base
+// cache, so handing objects around never copies the payload.
+class Object {
+public:
+  ObjectType type() const { return type_; }
+  std::string_view data() const { return buf_ ? std::string_view(*buf_) : std::string_view(); }
+  bool valid() const { return type_ != ObjectType::Bad && buf_ != nullptr; }
+
+private:
+  friend class ObjectStore;
+  ObjectType type_ {ObjectType::Bad};
+  std::shared_ptr<const std::string> buf_;
+};
+
+// Zero-copy commit header view; message points into the object payload.
+struct CommitView {
+  ObjectId tree;
+  std::vector<ObjectId> parents;
+  std::string_view message;
+};
+bool parseCommit(std::string_view data, CommitView &out);
+
+struct TreeEntry {
+  std::uint32_t mode {0};
+  std::string_view name;
+  ObjectId oid;
+  bool isTree() const { return (mode & 0170000u) == 0040000u; }
+  bool isSubmodule() const { return (mode & 0170000u) == 0160000u; }
+};
+
+// Iterates the binary "<mode> <name>\0<raw oid>" records of a tree payload.
+class TreeIterator {
+public:
+  TreeIterator(std::string_view data, std::size_t hashSize) : data_(data), hashSize_(hashSize) {}
+  bool next(TreeEntry &entry);   // false at the end or on malformed input
+  bool malformed() const { return malformed_; }
+
+private:
+  std::string_view data_;
+  std::size_t hashSize_;
+  std::size_t pos_ {0};
+  bool malformed_ {false};
+};
+
+// The repository's common git directory, shared by all of its worktrees;
+// empty when repoRoot is not inside a repository.
+std::string gitCommonDir(const std::string &repoRoot);
+
+// Read-only, in-process view of a repository's object database: loose objects,
+// packfiles through their v2 .idx or the multi-pack-index, OFS/REF deltas with a
+// delta-base cache, alternates, and both SHA-1 and SHA-256 object formats.
+// Pack and index files are mmap'd. read() is safe to call from several threads.
+class ObjectStore {
+public:
+  // nullptr when repoRoot is not inside a git repository (or native reading is unavailable).
+  static std::unique_ptr<ObjectStore> open(const std::string &repoRoot);
+  ~ObjectStore();
+  ObjectStore(const ObjectStore &) = delete;
+  ObjectStore &operator=(const ObjectStore &) = delete;
+
+  std::size_t hashSize() const;
+  const std::string &gitDir() const;
+  bool read(const ObjectId &id, Object &out);
+  bool contains(const ObjectId &id);
+  // Upper bound for inflated delta bases kept in memory (default 96 MiB, like core.deltaBaseCacheLimit).
+  void setDeltaBaseCacheLimit(std::size_t bytes);
+
+  struct Impl;
+
+private:
+  explicit ObjectStore(std::unique_ptr<Impl> impl);
+  std::unique_ptr<Impl> impl_;
+};
+
+}
@@ -12,6 +12,14 @@
 
 namespace nv {
 
+// The loc_delta of the JSON output: the version delta of each bump.
+struct LocDeltas {
+  int patch {0};
+  int minor {0};
+  int major {0};
+};
+LocDeltas computeLocDeltas(const std::string &currentVersion, int totalBonus, int loc, const ConfigValues &cfg);
+
 void formatOutput(const Options &opts, const std::string &suggestion, const std::string &currentVersion, 
                   const std::string &nextVersion, int totalBonus, const Kv &CLI, 
                   const std::string &baseRef, const std::string &targetRef, 
@@ -0,0 +1,47 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nv {
+
+// The subset of git pathspecs accepted by --only-paths, matched in-process:
+// plain items (exact path, leading directory, or fnmatch where '*' crosses '/'),
+// :(glob) items (wildmatch with '**'), and :(exclude)/:! items. Anything else
+// (icase, attr, ...) marks the filter unsupported so callers fall back to git.
+class PathFilter {
+public:
+  PathFilter() = default;
+  explicit PathFilter(const std::string &csv);
+
+  bool supported() const { return supported_; }
+  bool empty() const { return includes_.empty() && excludes_.empty(); }
+  bool matches(std::string_view path) const;
+  // False when no path below dir (no trailing '/') can match, so the subtree can be skipped.
+  bool mayMatchUnder(std::string_view dir) const;
+
+private:
+  struct Item {
+    std::string pattern;
+    std::size_t literalLen {0};   // length before the first wildcard character
+    bool glob {false};
+  };
+  static bool matchItem(const Item &item, std::string_view path);
+  std::vector<Item> includes_;
+  std::vector<Item> excludes_;
+  bool supported_ {true};
+};
+
+// git wildmatch(): '*' and '?' stop at '/' when pathname is set, and "**/",
+// "/**/" and "/**" span directories.
+bool wildmatch(std::string_view pattern, std::string_view text, bool pathname);
+
+}
@@ -0,0 +1,93 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "next_version/literal_prefilter.h"
+
+namespace nv {
+
+// The keyword and security patterns, each named after the case-insensitive
+// ECMAScript regex whose match count it reproduces.
+enum class Pattern : unsigned {
+  CliBreaking,         // CLI[\- ]?BREAKING
+  ApiBreaking,         // API[\- ]?BREAKING
+  CliBreakingCommit,   // BREAKING[^A-Za-z0-9]+.*CLI
+  ApiBreakingCommit,   // BREAKING[^A-Za-z0-9]+.*API
+  GeneralBreaking,     // BREAKING\s+CHANGE|BREAKING[^A-Za-z0-9]+.*(CHANGE|MAJOR)
+  SecurityComment,     // (^|\s)[+-]?\s*(//|/\*|#|--)\s*SECURITY
+  RemovedOption,       // REMOVED\s+OPTION(S)?
+  SecurityOrCve,       // SECURITY|VULNERABILIT(Y|IES)|CVE[- ]?[0-9]{4}-[0-9]+
+  SecurityWord,        // \b(security|vuln|exploit|...|traversal)\b
+  CveId,               // \bCVE-[0-9]{4}-[0-9]{4,7}\b
+  MemorySafety,        // \b(buffer[- _]?overflow|...|deadlock)\b
+  Crash,               // \b(segfault|segmentation\s+fault|...|stack\s+trace)\b
+  Count
+};
+
+using PatternSet = std::uint32_t;
+constexpr PatternSet patternBit(Pattern p) { return PatternSet(1) << static_cast<unsigned>(p); }
+
+struct PatternCounts {
+  std::array<int, static_cast<std::size_t>(Pattern::Count)> hits {};
+  int operator[](Pattern p) const { return hits[static_cast<std::size_t>(p)]; }
+  int &operator[](Pattern p) { return hits[static_cast<std::size_t>(p)]; }
+  PatternCounts &operator+=(const PatternCounts &o) {
+    for (std::size_t i = 0; i < hits.size(); ++i) hits[i] += o.hits[i];
+    return *this;
+  }
+};
+
+// All patterns compiled into one matcher: the literal words of every pattern
+// are found in a single pass, and a small per-pattern check at each word
+// handles separators, word boundaries and the rest of the regex. Counts are
+// what iterating the regex over the same text gives: leftmost,
+// non-overlapping matches, per pattern. Each check scans a bounded stretch
+// around its word (a BREAKING pattern's search for CLI, API, CHANGE or MAJOR
+// is cached per line), so counting takes linear time on lines of any length.
+//
+// Words are found by a LiteralPrefilter kernel for the widest SIMD level the
+// CPU has, with an exact check of each candidate; without SIMD a case-folded
+// Aho-Corasick automaton walks every byte instead.
+class PatternMatcher {
+public:
+  static const PatternMatcher &get();
+
+  // Add the matches of every pattern in `patterns` within `text` to `counts`.
+  void count(std::string_view text, PatternSet patterns, PatternCounts &counts) const;
+  // The same on a given level (Scalar is the automaton); for tests and benchmarks.
+  void count(std::string_view text, PatternSet patterns, PatternCounts &counts, SimdLevel level) const;
+
+private:
+  PatternMatcher();
+
+  struct Hit {
+    Pattern pattern;
+    unsigned alt;      // which alternative of the pattern starts with this word
+  };
+  struct Word {
+    std::string text;
+    std::vector<Hit> hits;
+  };
+  void addWord(const std::string &word, Pattern p, unsigned alt);
+  void build();
+
+  std::vector<Word> words_;
+  std::vector<std::uint16_t> next_;                // DFA: state * alphabet size + letter class
+  std::vector<std::vector<unsigned>> output_;      // words ending in each state
+  LiteralPrefilter prefilter_;
+  std::vector<std::uint8_t> prefixGroup_;          // first three letter classes -> group, 0 = none
+  std::vector<std::vector<unsigned>> groups_;      // words by group
+  SimdLevel level_ {SimdLevel::Scalar};
+};
+
+}
@@ -0,0 +1,92 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include "next_version/pattern_matcher.h"
+#include "next_version/static_regex.h"
+
+// Every built-in pattern the analyzers and the version logic match with.
+// None of them is compiled at run time: the line patterns below are
+// static_regex types, and the keyword and security patterns are the cases of
+// PatternMatcher, listed here with the regex each one reproduces. The words of
+// the security patterns are shared with SecurityTokenScanner.
+namespace nv::patterns {
+
+namespace detail {
+using namespace nv::sre;
+
+using DashChar = Set<AlNum, Ch<'-'>>;    // [A-Za-z0-9\-], [0-9A-Za-z-]
+using SemverNumber = Alt<Lit<"0">, Seq<One<Range<'1', '9'>>, Star<Digit>>>;   // 0|[1-9][0-9]*
+using SemverNumbers = Seq<SemverNumber, Lit<".">, SemverNumber, Lit<".">, SemverNumber>;
+template <char Lead>
+using SemverIds = Seq<One<Ch<Lead>>, Plus<DashChar>, Many<Seq<Lit<".">, Plus<DashChar>>>>;
+
+using LongOption = Regex<Seq<Lit<"--">, One<AlNum>, Star<DashChar>>>;
+using ShortOption = Regex<Seq<Alt<Bol, One<Not<Ch<'-'>>>>, Lit<"-">, One<Alpha>, Alt<One<Space>, Eol>>>;
+using SemverCore = Regex<SemverNumbers>;
+using SemverFull = Regex<Seq<SemverNumbers, Opt<SemverIds<'-'>>, Opt<SemverIds<'+'>>>>;
+}
+
+// --[A-Za-z0-9][A-Za-z0-9\-]*
+using detail::LongOption;
+// (^|[^-])-[A-Za-z](\s|$), searched in the text of a literal or comment
+using detail::ShortOption;
+// (0|[1-9][0-9]*)\.(0|[1-9][0-9]*)\.(0|[1-9][0-9]*)
+using detail::SemverCore;
+// The same, then (\-[0-9A-Za-z-]+(\.[0-9A-Za-z-]+)*)?(\+[0-9A-Za-z-]+(\.[0-9A-Za-z-]+)*)?
+using detail::SemverFull;
+
+// Regex of each PatternMatcher case, matched case-insensitively.
+inline constexpr std::array<std::string_view, static_cast<std::size_t>(Pattern::Count)> kKeywordSources = {
+    R"(CLI[\- ]?BREAKING)",
+    R"(API[\- ]?BREAKING)",
+    R"(BREAKING[^A-Za-z0-9]+.*CLI)",
+    R"(BREAKING[^A-Za-z0-9]+.*API)",
+    R"(BREAKING\s+CHANGE|BREAKING[^A-Za-z0-9]+.*(CHANGE|MAJOR))",
+    R"((^|\s)[+-]?\s*(//|/\*|#|--)\s*SECURITY)",
+    R"(REMOVED\s+OPTION(S)?)",
+    R"(SECURITY|VULNERABILIT(Y|IES)|CVE[- ]?[0-9]{4}-[0-9]+)",
+    R"(\b(security|vuln|exploit|breach|attack|threat|malware|virus|trojan|backdoor|rootkit|phishing|ddos|overflow|injection|xss|csrf|sqli|rce|ssrf|xxe|privilege|escalation|bypass|mitigation|hardening|sandbox|auth|encryption|decryption|tls|ssl|certificate|secret|token|leak|expos|traversal)\b)",
+    R"(\bCVE-[0-9]{4}-[0-9]{4,7}\b)",
+    R"(\b(buffer[- _]?overflow|stack[- _]?overflow|heap[- _]?overflow|use[- _]?after[- _]?free|double[- _]?free|null[- _]?pointer|dangling[- _]?pointer|out[- _]?of[- _]?bounds|oob|memory[- _]?leak|format[- _]?string|integer[- _]?overflow|signedness|race[- _]?condition|data[- _]?race|deadlock)\b)",
+    R"(\b(segfault|segmentation\s+fault|crash|abort|assert|panic|fatal\s+error|core\s+dump|stack\s+trace)\b)",
+};
+
+constexpr std::string_view keywordSource(Pattern p) { return kKeywordSources[static_cast<std::size_t>(p)]; }
+
+// Alternatives of the \b(...)\b security patterns. A phrase is a sequence of
+// lowercase words; unused slots are empty.
+struct Phrase {
+  std::array<std::string_view, 3> words;
+};
+
+inline constexpr std::string_view kSecurityWords[] = {
+  "security", "vuln", "exploit", "breach", "attack", "threat", "malware", "virus", "trojan", "backdoor",
+  "rootkit", "phishing", "ddos", "overflow", "injection", "xss", "csrf", "sqli", "rce", "ssrf", "xxe",
+  "privilege", "escalation", "bypass", "mitigation", "hardening", "sandbox", "auth", "encryption",
+  "decryption", "tls", "ssl", "certificate", "secret", "token", "leak", "expos", "traversal",
+};
+
+// MemorySafety: words joined by [- _]?
+inline constexpr Phrase kMemoryPhrases[] = {
+  {{"buffer", "overflow"}}, {{"stack", "overflow"}}, {{"heap", "overflow"}}, {{"use", "after", "free"}},
+  {{"double", "free"}}, {{"null", "pointer"}}, {{"dangling", "pointer"}}, {{"out", "of", "bounds"}},
+  {{"oob"}}, {{"memory", "leak"}}, {{"format", "string"}}, {{"integer", "overflow"}}, {{"signedness"}},
+  {{"race", "condition"}}, {{"data", "race"}}, {{"deadlock"}},
+};
+
+// Crash: words joined by \s+
+inline constexpr Phrase kCrashPhrases[] = {
+  {{"segfault"}}, {{"segmentation", "fault"}}, {{"crash"}}, {{"abort"}}, {{"assert"}}, {{"panic"}},
+  {{"fatal", "error"}}, {{"core", "dump"}}, {{"stack", "trace"}},
+};
+
+}
@@ -0,0 +1,56 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace nv {
+
+struct ProcessResult {
+  int exitCode {127};   // exit status; 128+N when killed by signal N; 127 when spawn failed
+  std::string out;      // captured stdout
+  std::string err;      // captured stderr (only when captureStderr is set)
+};
+
+// Run argv[0] (looked up in PATH) with the given arguments, without a shell.
+// stdin is /dev/null; stdout is captured; stderr is captured or sent to /dev/null.
+// Returns result.exitCode.
+int runProcess(const std::vector<std::string> &argv, ProcessResult &result, bool captureStderr = true);
+
+// Long-lived child with a request pipe on stdin and buffered reads from stdout,
+// for line-oriented protocols such as `git cat-file --batch-command`.
+// stderr goes to /dev/null. Writes never raise SIGPIPE; a dead child just
+// makes write()/read calls fail.
+class Coprocess {
+public:
+  Coprocess() = default;
+  ~Coprocess();
+  Coprocess(const Coprocess &) = delete;
+  Coprocess &operator=(const Coprocess &) = delete;
+
+  bool start(const std::vector<std::string> &argv);
+  bool running() const { return pid_ > 0; }
+  bool write(std::string_view data);
+  bool readLine(std::string &line);                    // strips the trailing '\n'
+  bool readExact(std::size_t n, std::string &out);     // appends exactly n bytes
+  std::size_t readSome(char *dst, std::size_t n);      // up to n bytes of raw output; 0 at EOF
+  int finish();                                        // close stdin and reap; returns exit status
+
+private:
+  bool fill();
+  int in_ {-1};
+  int out_ {-1};
+  pid_t pid_ {-1};
+  std::string buf_;
+  std::size_t pos_ {0};
+};
+
+}
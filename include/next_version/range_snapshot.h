@@ -0,0 +1,103 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "next_version/line_stream.h"
+#include "next_version/tree_diff.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nv {
+
+// Parts of a range snapshot; callers that only need some analyzers can skip
+// the git invocations for the rest.
+enum SnapshotPart : unsigned {
+  SnapshotFileStats = 1u << 0,  // --raw --numstat -z (plus the -w quick check)
+  SnapshotDiff      = 1u << 1,  // --unified=0 patch restricted to onlyPaths
+  SnapshotCliDiff   = 1u << 2,  // --unified=0 patch restricted to the CLI pathspec
+  SnapshotLog       = 1u << 3,  // commit subjects and bodies
+  SnapshotAll       = SnapshotFileStats | SnapshotDiff | SnapshotCliDiff | SnapshotLog
+};
+
+// Everything the analyzers read from git for one base..target range, fetched
+// once per run and shared instead of re-running the same -M -C diff per analyzer.
+// With native set, file stats and patches come from ObjectStore, diffTrees and
+// the blob diff engine when the repository, pathspec and diff.algorithm allow
+// it, falling back to git otherwise.
+struct RangeSnapshot {
+  std::string repoRoot;
+  std::string baseRef;
+  std::string targetRef;
+  std::string onlyPaths;
+  bool ignoreWhitespace {false};
+  unsigned parts {0};
+  bool native {false};        // file stats came from the in-process tree diff
+  int renameThreshold {50};   // -M/-C minimum similarity percent
+
+
+  bool hasChanges {true};     // false when `git diff --quiet` reported no changes
+  std::string rawNumstat;     // NUL-separated --raw records followed by --numstat records
+  std::vector<TreeChange> changes;  // native replacement for rawNumstat
+  std::string diff;           // unified=0 diff for onlyPaths
+  std::string cliDiff;        // unified=0 diff for the CLI pathspec; empty when shared with diff
+  bool cliDiffIsDiff {false}; // true when both pathspecs are identical
+  std::string log;            // `git log -z --format=%s %b` output: NUL-ended commit records
+
+  const std::string &cliDiffText() const { return cliDiffIsDiff ? diff : cliDiff; }
+};
+
+// Consumers for streamed patches. A part with a sink is handed over in
+// line-aligned batches while git (or the native renderer) is still producing
+// it, and its RangeSnapshot string stays empty; peak memory is then bounded
+// by the stream's ring instead of the patch size. When both parts use the
+// same pathspec one stream feeds both sinks. The commit log can be streamed
+// the same way, in batches of whole NUL-ended records.
+//
+// The native renderer can also hand over patches a blob pair at a time, so a
+// pair analyzed by an earlier run need not be diffed again. With pairKnown
+// and pairHunks set, every section whose hunks depend on its blobs alone (see
+// hunksByBlobs) is first offered to pairKnown; when that returns true only
+// the section's header lines are streamed. Otherwise the section is rendered,
+// its header lines streamed and its hunks passed to pairHunks, in batches of
+// about the stream's size. Either way the hunks never reach the parts' sinks:
+// the two calls account for them, for every part the stream feeds.
+struct PairSection {
+  unsigned parts {0};                  // SnapshotDiff and/or SnapshotCliDiff
+  const TreeChange *change {nullptr};
+  const BlobDiffOptions *opts {nullptr};
+  HunkShape shape;                     // filled by pairKnown on a hit
+  std::string_view hunks;              // for pairHunks
+};
+using PairKnownFn = std::function<bool(PairSection &section)>;
+using PairHunksFn = std::function<void(const std::vector<PairSection> &batch)>;
+
+struct DiffSinks {
+  LineBatchFn diff;       // SnapshotDiff
+  LineBatchFn cliDiff;    // SnapshotCliDiff
+  LineBatchFn log;        // SnapshotLog
+  PairKnownFn pairKnown;  // native patches only, with the sinks of their parts
+  PairHunksFn pairHunks;
+};
+
+// Pathspec used by the CLI analyzer when no --only-paths filter is given:
+// restrict to common C/C++ sources and headers like the shell analyzer.
+std::string cliPathspecFor(const std::string &onlyPathsCsv);
+
+RangeSnapshot collectRangeSnapshot(const std::string &repoRoot,
+                                   const std::string &baseRef,
+                                   const std::string &targetRef,
+                                   const std::string &onlyPathsCsv,
+                                   bool ignoreWhitespace,
+                                   unsigned parts = SnapshotAll,
+                                   bool native = false,
+                                   int renameThreshold = 50,
+                                   const DiffSinks &sinks = {});
+
+}
@@ -0,0 +1,250 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "next_version/object_store.h"
+#include "next_version/pattern_matcher.h"
+#include "next_version/tree_diff.h"
+#include "next_version/types.h"
+
+namespace nv {
+
+// Bump when an analyzer gives different results for the same range, so
+// entries written by older builds are never read back.
+inline constexpr std::uint32_t kAnalysisVersion = 2;
+
+// What the analysis of a range feeds into the bonus calculation.
+struct RangeAnalysis {
+  Kv files;
+  Kv cli;
+  Kv security;
+  Kv keywords;
+};
+
+// Everything a RangeAnalysis depends on: the resolved commits and the
+// options and configuration that change how the range is read.
+struct ResultCacheKey {
+  std::string baseOid;
+  std::string targetOid;
+  std::string onlyPaths;
+  std::string pathPrefix;      // where --only-paths is relative to (git rev-parse --show-prefix)
+  std::string diffAlgorithm;   // diff.algorithm, which shapes the patch text
+  bool ignoreWhitespace {false};
+  bool firstParent {false};
+  bool noMergeBase {false};
+  bool nativeGit {false};
+  int renameThreshold {50};
+  std::uint64_t configHash {0};
+
+  std::string serialize() const;
+};
+
+// False when the range did not resolve to commits (nothing to key on) or
+// git could not tell where the pathspecs are relative to.
+bool makeResultCacheKey(const RefResolution &ref, const Options &opts, const ConfigValues &cfg, ResultCacheKey &key);
+std::uint64_t hashConfigValues(const ConfigValues &cfg);
+
+// Memoized range analyses, one small binary file per key in a directory
+// (by default <git common dir>/next-version/cache, shared by worktrees).
+// An entry holds a format header, the full key (a digest collision reads as
+// a miss) and the four key-value sets, closed by a checksum. Entries are
+// written to a temporary file and renamed into place, so readers never see
+// a partial one; damaged or foreign entries read as misses. A hit refreshes
+// the entry's mtime, and a store evicts the least recently used entries
+// until the directory fits maxBytes. Every failure is silent: the cache only
+// ever saves work.
+class ResultCache {
+public:
+  static constexpr std::uint32_t kFormatVersion = 1;
+  static constexpr std::uintmax_t kDefaultMaxBytes = std::uintmax_t(8) << 20;
+
+  explicit ResultCache(std::filesystem::path dir, std::uintmax_t maxBytes = kDefaultMaxBytes);
+  // The cache of the repository containing repoRoot; disabled outside one.
+  static ResultCache forRepository(const std::string &repoRoot);
+
+  bool enabled() const { return !dir_.empty(); }
+  const std::filesystem::path &dir() const { return dir_; }
+  bool load(const ResultCacheKey &key, RangeAnalysis &out) const;
+  bool store(const ResultCacheKey &key, const RangeAnalysis &value) const;
+
+private:
+  std::filesystem::path entryPath(const std::string &serializedKey) const;
+  void evict() const;
+
+  std::filesystem::path dir_;
+  std::uintmax_t maxBytes_;
+};
+
+// RangeAnalysis entries shared by every process on a host that opens the same
+// directory (say /dev/shm on a CI runner), so concurrent jobs over clones of
+// one repository reuse each other's results without a daemon. The key is the
+// same as ResultCache's: the object ids (their length tells the object
+// formats apart), the options and the configuration hash; nothing ties an
+// entry to one clone.
+//
+// The file is a fixed table of kSlots slots mapped shared. A key hashes to a
+// 64-bit tag and is looked for in up to kProbe slots from its home slot; a
+// writer claims an empty slot by a compare-and-swap on its tag, or takes over
+// the last one probed when none is free. Each slot is a seqlock: a writer
+// takes it by a compare-and-swap of the sequence from even to odd, writes the
+// entry and makes it even again, and a reader copies the entry out and keeps
+// it only when the sequence was even and unchanged around the copy. A slot
+// held by another writer, or left odd by one that died, is passed over by
+// writers and readers alike. The entry carries the full key and a checksum,
+// so a tag collision reads as a miss. Entries that do not fit a slot are not
+// shared.
+// The file's name carries the user id, the format and kAnalysisVersion. A
+// new table is set up under a temporary name and linked into place; an
+// existing one is used only when it is a regular file of the user's (not a
+// link) with the table's exact size and header, and is never resized.
+class SharedCache {
+public:
+  static constexpr std::uint32_t kFormatVersion = 1;
+  static constexpr std::size_t kSlots = 1024;
+  static constexpr std::size_t kSlotBytes = 4096;
+  static constexpr std::size_t kProbe = 8;
+
+  // Disabled when dir is empty or the table cannot be mapped.
+  explicit SharedCache(const std::filesystem::path &dir);
+  ~SharedCache();
+  SharedCache(const SharedCache &) = delete;
+  SharedCache &operator=(const SharedCache &) = delete;
+
+  bool enabled() const { return map_ != nullptr; }
+  const std::filesystem::path &file() const { return file_; }
+  bool load(const ResultCacheKey &key, RangeAnalysis &out) const;
+  bool store(const ResultCacheKey &key, const RangeAnalysis &value) const;
+
+private:
+  unsigned char *slot(std::size_t i) const;
+
+  std::filesystem::path file_;
+  unsigned char *map_ {nullptr};
+};
+
+// What the analyzers found in the hunks of one blob pair, for one patch: the
+// keyword and security pattern hits for the onlyPaths patch (SnapshotDiff),
+// the CLI findings for the CLI patch (SnapshotCliDiff).
+struct PairFindings {
+  HunkShape shape;
+  PatternCounts hits;
+  CliFindings cli;
+};
+
+// PairFindings kept from run to run, keyed by the old and new blob ids, the
+// patch, the diff options and kAnalysisVersion, in one file (by default
+// <git common dir>/next-version/pairs). A release range moves on by a few
+// commits at a time, so most of its blob pairs were analyzed by the run before.
+//
+// The file is read whole when the cache is opened. It is a header followed by
+// records of the full key and the findings, each closed by a checksum; a
+// damaged record ends the read. save() appends the records added since, in
+// one write, or rewrites the file through a temporary and a rename when it
+// was damaged or would outgrow maxBytes, keeping only the records this run
+// used or added. find() and add() may be called from several threads.
+class PairCache {
+public:
+  static constexpr std::uint32_t kFormatVersion = 1;
+  static constexpr std::uintmax_t kDefaultMaxBytes = std::uintmax_t(64) << 20;
+
+  explicit PairCache(std::filesystem::path file, std::uintmax_t maxBytes = kDefaultMaxBytes);
+  PairCache(const PairCache &) = delete;
+  PairCache &operator=(const PairCache &) = delete;
+  // The cache of the repository containing repoRoot; disabled outside one.
+  static std::filesystem::path pathFor(const std::string &repoRoot);
+
+  static std::string key(unsigned part, const TreeChange &change, const BlobDiffOptions &opts);
+
+  bool enabled() const { return !file_.empty(); }
+  const std::filesystem::path &file() const { return file_; }
+  bool find(const std::string &key, PairFindings &out);
+  void add(const std::string &key, const PairFindings &findings);
+  bool save();
+  std::size_t hits() const;
+  std::size_t misses() const;
+
+private:
+  struct Record {
+    std::string_view bytes;     // as framed in the file
+    std::string_view findings;
+    bool used {false};
+  };
+
+  std::filesystem::path file_;
+  std::uintmax_t maxBytes_;
+  mutable std::mutex mutex_;
+  std::string loaded_;
+  std::unordered_map<std::string_view, Record> records_;   // keys view loaded_
+  std::unordered_map<std::string, std::string> added_;     // key -> encoded findings
+  bool damaged_ {false};
+  std::size_t hits_ {0};
+  std::size_t misses_ {0};
+};
+
+// Pattern counts of commit messages kept from run to run, keyed by commit id
+// (a commit's message never changes), in one file (by default <git common
+// dir>/next-version/commits) that is mapped, not read. A header naming the
+// patterns, the id size and kAnalysisVersion is followed by blocks of
+// fixed-size entries (the id and one count per pattern) sorted by id, each
+// closed by a checksum, so a lookup is a binary search per block. save()
+// appends the entries added since as one more block, in one write; past
+// kMaxBlocks the file is rewritten as a single block through a temporary file
+// and a rename. A damaged block ends the read and has the file rewritten; a
+// file for other patterns or another analysis version is started over. Not
+// for use from several threads.
+class CommitCache {
+public:
+  static constexpr std::uint32_t kFormatVersion = 1;
+  static constexpr std::size_t kMaxBlocks = 8;
+
+  CommitCache(std::filesystem::path file, PatternSet patterns);
+  ~CommitCache();
+  CommitCache(const CommitCache &) = delete;
+  CommitCache &operator=(const CommitCache &) = delete;
+  static std::filesystem::path pathFor(const std::string &repoRoot);
+
+  bool enabled() const { return !file_.empty(); }
+  const std::filesystem::path &file() const { return file_; }
+  PatternSet patterns() const { return patterns_; }
+  bool empty() const { return blocks_.empty(); }   // nothing stored by earlier runs
+  bool find(const ObjectId &id, PatternCounts &out);
+  void add(const ObjectId &id, const PatternCounts &counts);   // ignored when already there
+  bool save();
+  std::size_t hits() const { return hits_; }
+  std::size_t misses() const { return misses_; }
+
+private:
+  struct Block {
+    const unsigned char *entries;
+    std::size_t count;
+  };
+
+  std::size_t entrySize() const;
+  const unsigned char *lookup(const ObjectId &id) const;
+  void appendEntry(std::string &out, const ObjectId &id, const PatternCounts &counts) const;
+
+  std::filesystem::path file_;
+  PatternSet patterns_;
+  const unsigned char *map_ {nullptr};
+  std::size_t mapSize_ {0};
+  std::size_t idSize_ {0};
+  std::vector<Block> blocks_;
+  bool rewrite_ {false};   // damaged or stale
+  std::vector<std::pair<ObjectId, PatternCounts>> added_;
+  std::size_t hits_ {0};
+  std::size_t misses_ {0};
+};
+
+}
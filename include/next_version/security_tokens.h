@@ -0,0 +1,53 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <string_view>
+#include "next_version/literal_prefilter.h"
+#include "next_version/pattern_matcher.h"
+
+namespace nv {
+
+// The \b(...)\b security patterns counted on tokens instead of characters.
+// Every match of SecurityWord, CveId, MemorySafety and Crash starts and ends
+// at a word boundary, so one pass splits the text into alphanumeric tokens
+// (through a 256-entry table that also lowercases them) and looks each one
+// up in a perfect hash table built at compile time, keyed on the token's
+// length and its first and last two letters. A token is a security word, "cve", or the first token of a phrase:
+// the phrase's remaining tokens and separators are checked in place, and
+// "CVE" is followed by a parser for -YYYY-NNNN. Words glued together by the
+// optional [- _]? separators of MemorySafety are tokens of their own
+// ("useafterfree", "afterfree"). On CPUs with SIMD, a LiteralPrefilter over
+// the words that can start a match skips the tokens in between.
+//
+// Counts equal PatternMatcher::count for these patterns on any text.
+class SecurityTokenScanner {
+public:
+  static constexpr PatternSet kPatterns = patternBit(Pattern::SecurityWord) | patternBit(Pattern::CveId) |
+                                          patternBit(Pattern::MemorySafety) | patternBit(Pattern::Crash);
+
+  static const SecurityTokenScanner &get();
+
+  // Add the matches of the patterns in `patterns & kPatterns` to `counts`.
+  void count(std::string_view text, PatternSet patterns, PatternCounts &counts) const;
+  // The same on a given level (Scalar tokenizes every byte); for tests and benchmarks.
+  void count(std::string_view text, PatternSet patterns, PatternCounts &counts, SimdLevel level) const;
+
+private:
+  SecurityTokenScanner();
+
+  LiteralPrefilter prefilter_;   // tokens that can start a match
+  SimdLevel level_ {SimdLevel::Scalar};
+};
+
+// Count `patterns` in `text` in one pass: on tokens when they are all
+// security patterns, otherwise with the fused PatternMatcher (its single
+// pass beats two, one per matcher).
+void countPatterns(std::string_view text, PatternSet patterns, PatternCounts &counts);
+
+}
@@ -0,0 +1,544 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Regexes spelled as types. A pattern such as
+//
+//   case\s+([^:\s]+)\s*:
+//
+// becomes Seq<Lit<"case">, Plus<Space>, Group<1, Plus<Not<Ch<':'>, Space>>>, Star<Space>, Lit<":">>,
+// which the compiler turns into a Thompson NFA and two DFAs over byte
+// classes; nothing is parsed or allocated at run time, and every function is
+// constexpr, so patterns can be checked with static_assert.
+//
+// Matching never backtracks. search(text) and match(text) walk a DFA, one
+// table lookup per byte. search(text, m) and forEach() report spans and
+// groups, and run the NFA as a Pike VM that keeps at most one thread per
+// instruction. Either way a search costs O(text length x pattern size) time
+// and a fixed amount of stack, whatever the input looks like. Results follow
+// ECMAScript (leftmost match, greedy quantifiers, alternatives in order) on
+// bytes with the C locale, which is what std::regex gives.
+namespace nv::sre {
+
+// ---- Character sets: a static test(unsigned char) ----
+
+template <char C>
+struct Ch {
+  static constexpr bool test(unsigned char c) { return c == static_cast<unsigned char>(C); }
+};
+
+template <char Lo, char Hi>
+struct Range {
+  static constexpr bool test(unsigned char c) { return c >= static_cast<unsigned char>(Lo) && c <= static_cast<unsigned char>(Hi); }
+};
+
+template <class... Sets>
+struct Set {
+  static constexpr bool test(unsigned char c) { return (Sets::test(c) || ...); }
+};
+
+template <class... Sets>
+struct Not {
+  static constexpr bool test(unsigned char c) { return !(Sets::test(c) || ...); }
+};
+
+using Digit = Range<'0', '9'>;
+using Alpha = Set<Range<'A', 'Z'>, Range<'a', 'z'>>;
+using AlNum = Set<Alpha, Digit>;
+using Space = Set<Ch<' '>, Range<'\t', '\r'>>;   // \s
+using Any = Not<Ch<'\n'>, Ch<'\r'>>;              // .
+
+// ---- NFA program ----
+
+struct ByteSet {
+  std::uint64_t bits[4] {};
+  constexpr bool has(unsigned char c) const { return bits[c >> 6] >> (c & 63) & 1; }
+  constexpr void add(unsigned char c) { bits[c >> 6] |= std::uint64_t(1) << (c & 63); }
+};
+
+template <class S>
+constexpr ByteSet byteSet() {
+  ByteSet s;
+  for (unsigned c = 0; c < 256; ++c) {
+    if (S::test(static_cast<unsigned char>(c))) s.add(static_cast<unsigned char>(c));
+  }
+  return s;
+}
+
+struct Inst {
+  enum Op : std::uint8_t { Byte, Split, Jump, Save, Bol, Eol, Match };
+  Op op {Match};
+  std::uint8_t x {0}, y {0};   // Split: preferred and other target; Jump: target; Save: slot
+  ByteSet set {};              // Byte
+};
+
+// Sets of instructions are 64-bit masks, so a pattern has at most 64
+// instructions; a larger one fails to compile.
+constexpr std::size_t kMaxInsts = 64;
+using PcSet = std::uint64_t;
+constexpr PcSet pcBit(std::size_t pc) { return PcSet(1) << pc; }
+
+struct Program {
+  std::array<Inst, kMaxInsts> inst {};
+  std::size_t size {0};
+
+  constexpr std::size_t push(Inst::Op op, std::size_t x = 0, std::size_t y = 0, ByteSet set = {}) {
+    inst[size] = Inst {op, static_cast<std::uint8_t>(x), static_cast<std::uint8_t>(y), set};
+    return size++;
+  }
+  constexpr void target(std::size_t at) { inst[at].y = static_cast<std::uint8_t>(size); }
+};
+
+// ---- Nodes: emit(program) appends the node's instructions ----
+
+template <std::size_t N>
+struct Text {
+  char chars[N] {};
+  constexpr Text(const char (&s)[N]) {
+    for (std::size_t i = 0; i < N; ++i) chars[i] = s[i];
+  }
+};
+
+template <Text T>
+struct Lit {
+  static constexpr void emit(Program &p) {
+    for (std::size_t i = 0; i + 1 < sizeof(T.chars); ++i) {
+      ByteSet s;
+      s.add(static_cast<unsigned char>(T.chars[i]));
+      p.push(Inst::Byte, 0, 0, s);
+    }
+  }
+};
+
+// One character of a set.
+template <class S>
+struct One {
+  static constexpr void emit(Program &p) { p.push(Inst::Byte, 0, 0, byteSet<S>()); }
+};
+
+// Greedy run of at least Min characters of a set.
+template <class S, std::size_t Min>
+struct Run {
+  static constexpr void emit(Program &p) {
+    for (std::size_t i = 0; i < Min; ++i) One<S>::emit(p);
+    const std::size_t loop = p.push(Inst::Split, p.size + 1);
+    One<S>::emit(p);
+    p.push(Inst::Jump, loop);
+    p.target(loop);
+  }
+};
+
+template <class S> using Star = Run<S, 0>;
+template <class S> using Plus = Run<S, 1>;
+
+struct Bol {
+  static constexpr void emit(Program &p) { p.push(Inst::Bol); }
+};
+
+struct Eol {
+  static constexpr void emit(Program &p) { p.push(Inst::Eol); }
+};
+
+template <class... Nodes>
+struct Seq {
+  static constexpr void emit(Program &p) { (Nodes::emit(p), ...); }
+};
+
+template <class... Nodes>
+struct Alt {
+  static constexpr void emit(Program &p) {
+    std::array<std::size_t, sizeof...(Nodes)> jumps {};
+    std::size_t i = 0;
+    ((jumps[i] = alternative<Nodes>(p, i + 1 == sizeof...(Nodes)), ++i), ...);
+    for (std::size_t k = 0; k + 1 < sizeof...(Nodes); ++k) p.inst[jumps[k]].x = static_cast<std::uint8_t>(p.size);
+  }
+
+private:
+  // Every alternative but the last is tried first and jumps past the rest.
+  template <class Node>
+  static constexpr std::size_t alternative(Program &p, bool last) {
+    if (last) {
+      Node::emit(p);
+      return 0;
+    }
+    const std::size_t split = p.push(Inst::Split, p.size + 1);
+    Node::emit(p);
+    const std::size_t jump = p.push(Inst::Jump);
+    p.target(split);
+    return jump;
+  }
+};
+
+// Greedy optional node.
+template <class Node>
+struct Opt {
+  static constexpr void emit(Program &p) {
+    const std::size_t split = p.push(Inst::Split, p.size + 1);
+    Node::emit(p);
+    p.target(split);
+  }
+};
+
+// Greedy repetition of a node that cannot match the empty string.
+template <class Node>
+struct Many {
+  static constexpr void emit(Program &p) {
+    const std::size_t loop = p.push(Inst::Split, p.size + 1);
+    Node::emit(p);
+    p.push(Inst::Jump, loop);
+    p.target(loop);
+  }
+};
+
+// Capturing group N (1-based).
+template <std::size_t N, class... Nodes>
+struct Group {
+  static constexpr void emit(Program &p) {
+    p.push(Inst::Save, 2 * N);
+    Seq<Nodes...>::emit(p);
+    p.push(Inst::Save, 2 * N + 1);
+  }
+};
+
+template <class Node>
+constexpr Program compile() {
+  Program p;
+  Node::emit(p);
+  p.push(Inst::Match);
+  return p;
+}
+
+// ---- DFA ----
+
+// Instructions reachable from `seeds` without reading a byte, given whether
+// the position is the start and the end of the text.
+constexpr PcSet closure(const Program &p, PcSet seeds, bool atStart, bool atEnd) {
+  PcSet out = 0;
+  while (seeds) {
+    const auto pc = static_cast<std::size_t>(std::countr_zero(seeds));
+    seeds &= seeds - 1;
+    if (out & pcBit(pc)) continue;
+    out |= pcBit(pc);
+    const Inst &in = p.inst[pc];
+    switch (in.op) {
+      case Inst::Split: seeds |= pcBit(in.x) | pcBit(in.y); break;
+      case Inst::Jump: seeds |= pcBit(in.x); break;
+      case Inst::Save: seeds |= pcBit(pc + 1); break;
+      case Inst::Bol: if (atStart) seeds |= pcBit(pc + 1); break;
+      case Inst::Eol: if (atEnd) seeds |= pcBit(pc + 1); break;
+      default: break;
+    }
+  }
+  return out;
+}
+
+constexpr bool hasMatch(const Program &p, PcSet s) {
+  for (; s; s &= s - 1) {
+    if (p.inst[static_cast<std::size_t>(std::countr_zero(s))].op == Inst::Match) return true;
+  }
+  return false;
+}
+
+// Limits of the construction below; a pattern beyond them fails to compile.
+constexpr std::size_t kMaxStates = 128, kMaxClasses = 32;
+constexpr std::uint8_t kAccept = 1, kAcceptAtEnd = 2;
+
+// Subset construction. A search DFA folds a fresh start into every state, so
+// it finds matches beginning anywhere; a whole-text DFA starts once.
+struct DfaBuild {
+  std::array<std::uint8_t, 256> byteClass {};
+  std::array<unsigned char, kMaxClasses> representative {};
+  std::size_t classes {0};
+  std::array<PcSet, kMaxStates> sets {};
+  std::array<std::uint8_t, kMaxStates> flags {};
+  std::size_t states {0};
+  std::array<std::uint8_t, kMaxStates * kMaxClasses> next {};
+  std::size_t restart {0};   // state of a search with nothing under way
+  int lead {-1};             // the byte every fresh attempt starts with
+  bool restartDead {false};  // no attempt can start
+  bool fresh {false};        // the restart state never holds an older attempt
+
+  constexpr std::size_t state(const Program &p, PcSet s) {
+    for (std::size_t i = 0; i < states; ++i) {
+      if (sets[i] == s) return i;
+    }
+    sets[states] = s;
+    flags[states] = static_cast<std::uint8_t>((hasMatch(p, s) ? kAccept : 0) | (hasMatch(p, closure(p, s, false, true)) ? kAcceptAtEnd : 0));
+    return states++;
+  }
+};
+
+constexpr DfaBuild buildDfa(const Program &p, bool search) {
+  DfaBuild d;
+  // Bytes that every Byte instruction treats alike share a class.
+  std::array<PcSet, kMaxClasses> signature {};
+  for (unsigned c = 0; c < 256; ++c) {
+    PcSet sig = 0;
+    for (std::size_t pc = 0; pc < p.size; ++pc) {
+      if (p.inst[pc].op == Inst::Byte && p.inst[pc].set.has(static_cast<unsigned char>(c))) sig |= pcBit(pc);
+    }
+    std::size_t k = 0;
+    while (k < d.classes && signature[k] != sig) ++k;
+    if (k == d.classes) {
+      signature[k] = sig;
+      d.representative[k] = static_cast<unsigned char>(c);
+      ++d.classes;
+    }
+    d.byteClass[c] = static_cast<std::uint8_t>(k);
+  }
+
+  const PcSet restart = search ? closure(p, pcBit(0), false, false) : 0;
+  d.state(p, closure(p, pcBit(0), true, false));
+  d.restart = d.state(p, restart);
+  for (std::size_t s = 0; s < d.states; ++s) {
+    for (std::size_t k = 0; k < d.classes; ++k) {
+      PcSet to = 0;
+      for (PcSet from = d.sets[s]; from; from &= from - 1) {
+        const auto pc = static_cast<std::size_t>(std::countr_zero(from));
+        if (p.inst[pc].op == Inst::Byte && p.inst[pc].set.has(d.representative[k])) to |= pcBit(pc + 1);
+      }
+      d.next[s * kMaxClasses + k] = static_cast<std::uint8_t>(d.state(p, closure(p, to, false, false) | restart));
+    }
+  }
+
+  // With nothing under way, a search can skip ahead to the one byte every
+  // fresh attempt needs first, or stop when no attempt can start again; a
+  // whole-text match with nothing under way has failed.
+  d.restartDead = !search;
+  if (search && !d.flags[d.restart]) {
+    int lead = -1;
+    bool single = true, anyByte = false;
+    for (PcSet r = restart; r; r &= r - 1) {
+      const Inst &in = p.inst[static_cast<std::size_t>(std::countr_zero(r))];
+      if (in.op != Inst::Byte) continue;
+      anyByte = true;
+      for (unsigned c = 0; c < 256; ++c) {
+        if (!in.set.has(static_cast<unsigned char>(c))) continue;
+        if (lead >= 0 && lead != static_cast<int>(c)) single = false;
+        lead = static_cast<int>(c);
+      }
+    }
+    d.restartDead = !anyByte;
+    if (anyByte && single) d.lead = lead;
+  }
+
+  // The restart state only holds fresh attempts when nothing but the start
+  // leads into it; then no match can begin before the last time a search
+  // passed through it.
+  if (search) {
+    d.fresh = true;
+    for (std::size_t pc = 0; pc < p.size; ++pc) {
+      const Inst &in = p.inst[pc];
+      if ((restart & pcBit(pc)) && in.op != Inst::Byte) continue;
+      PcSet to = 0;
+      switch (in.op) {
+        case Inst::Split: to = pcBit(in.x) | pcBit(in.y); break;
+        case Inst::Jump: to = pcBit(in.x); break;
+        case Inst::Match: break;
+        default: to = pcBit(pc + 1); break;
+      }
+      if (to & restart) d.fresh = false;
+    }
+  }
+  return d;
+}
+
+// Only read while compiling.
+template <class Node, bool Search>
+inline constexpr DfaBuild kBuiltDfa = buildDfa(compile<Node>(), Search);
+
+// A built DFA cut down to its real size.
+template <class Node, bool Search>
+struct Dfa {
+  static constexpr std::size_t states = kBuiltDfa<Node, Search>.states;
+  static constexpr std::size_t classes = kBuiltDfa<Node, Search>.classes;
+
+  std::array<std::uint8_t, 256> byteClass {};
+  std::array<std::uint8_t, states * classes> next {};
+  std::array<std::uint8_t, states> flags {};
+  std::size_t restart {0};
+  int lead {-1};
+  bool restartDead {false};
+  bool fresh {false};
+
+  static constexpr Dfa make() {
+    const DfaBuild &b = kBuiltDfa<Node, Search>;
+    Dfa d;
+    d.byteClass = b.byteClass;
+    for (std::size_t s = 0; s < states; ++s) {
+      d.flags[s] = b.flags[s];
+      for (std::size_t k = 0; k < classes; ++k) d.next[s * classes + k] = b.next[s * kMaxClasses + k];
+    }
+    d.restart = b.restart;
+    d.lead = b.lead;
+    d.restartDead = b.restartDead;
+    d.fresh = b.fresh;
+    return d;
+  }
+
+  // A search stops at the first accepting state; a whole-text match needs
+  // the text to end in one. A search may begin past the start of the text,
+  // and reports in `start` a position no later than where the leftmost match
+  // begins.
+  constexpr bool run(std::string_view text, std::size_t from = 0, std::size_t *start = nullptr) const {
+    std::size_t s = from > 0 ? restart : 0, quiet = from;
+    for (std::size_t i = from; i < text.size(); ++i) {
+      if (Search && (flags[s] & kAccept)) break;
+      if (s == restart && i > 0) {
+        if (restartDead) break;
+        if (Search && lead >= 0) {
+          i = text.find(static_cast<char>(lead), i);
+          if (i == std::string_view::npos) break;
+        }
+        if (fresh) quiet = i;
+      }
+      s = next[s * classes + byteClass[static_cast<unsigned char>(text[i])]];
+    }
+    if (start) *start = quiet;
+    return flags[s] != 0;
+  }
+};
+
+// ---- The compiled pattern ----
+
+template <class Node, std::size_t Groups = 0>
+class Regex {
+public:
+  // Match 0 is the whole match; groups that did not take part are empty.
+  struct Match {
+    std::string_view text;
+    std::array<std::size_t, 2 * (Groups + 1)> span {};
+    constexpr std::string_view operator[](std::size_t n) const {
+      return span[2 * n] == std::string_view::npos ? std::string_view() : text.substr(span[2 * n], span[2 * n + 1] - span[2 * n]);
+    }
+    constexpr std::size_t begin() const { return span[0]; }
+    constexpr std::size_t end() const { return span[1]; }
+  };
+
+  // Whole-text match, like std::regex_match.
+  static constexpr bool match(std::string_view text) { return wholeDfa.run(text); }
+
+  // Whether the text contains a match, like std::regex_search.
+  static constexpr bool search(std::string_view text) { return searchDfa.run(text); }
+
+  // Leftmost match at or after `from`, with its groups.
+  static constexpr bool search(std::string_view text, Match &m, std::size_t from = 0) {
+    m.text = text;
+    // The DFA rules out most texts and skips most of the rest.
+    std::size_t begin = from;
+    if (!searchDfa.run(text, from, &begin)) return false;
+    Spans found {};
+    Threads a, b;
+    a.count = 0;
+    a.on = 0;
+    Threads *cur = &a, *nxt = &b;
+    bool matched = false;
+    for (std::size_t pos = begin; pos <= text.size(); ++pos) {
+      if (!matched) {
+        if (cur->count == 0 && pos > 0) {
+          if (searchDfa.restartDead) break;
+          if (searchDfa.lead >= 0) {
+            pos = text.find(static_cast<char>(searchDfa.lead), pos);
+            if (pos == std::string_view::npos) break;
+          }
+        }
+        // A fresh attempt needing the lead byte dies at once without it.
+        if (searchDfa.lead < 0 || pos == 0 || (pos < text.size() && text[pos] == static_cast<char>(searchDfa.lead))) {
+          Spans start;
+          start.fill(std::string_view::npos);
+          start[0] = pos;
+          add(*cur, text, 0, pos, start);
+        }
+      }
+      if (cur->count == 0) break;
+      nxt->count = 0;
+      nxt->on = 0;
+      for (std::size_t i = 0; i < cur->count; ++i) {
+        const Thread &t = cur->threads[i];
+        const Inst &in = program.inst[t.pc];
+        if (in.op == Inst::Match) {
+          // The threads after this one have lower priority.
+          found = t.spans;
+          found[1] = pos;
+          matched = true;
+          break;
+        }
+        if (pos < text.size() && in.set.has(static_cast<unsigned char>(text[pos]))) add(*nxt, text, t.pc + 1, pos + 1, t.spans);
+      }
+      Threads *tmp = cur;
+      cur = nxt;
+      nxt = tmp;
+    }
+    if (matched) m.span = found;
+    return matched;
+  }
+
+  // Calls fn for each non-overlapping match, like std::sregex_iterator for
+  // patterns that cannot match the empty string.
+  template <class Fn>
+  static constexpr void forEach(std::string_view text, Fn &&fn) {
+    Match m;
+    for (std::size_t pos = 0; pos <= text.size() && search(text, m, pos);) {
+      fn(static_cast<const Match &>(m));
+      pos = m.end() > m.begin() ? m.end() : m.end() + 1;
+    }
+  }
+
+private:
+  using Spans = std::array<std::size_t, 2 * (Groups + 1)>;
+  struct Thread {
+    std::size_t pc;
+    Spans spans;
+  };
+  // Threads in priority order, at most one per instruction. Left
+  // uninitialized: only the first `count` are ever read.
+  struct Threads {
+    std::array<Thread, kMaxInsts> threads;
+    std::size_t count;
+    PcSet on;
+  };
+
+  static constexpr Program program = compile<Node>();
+  static constexpr Dfa<Node, true> searchDfa = Dfa<Node, true>::make();
+  static constexpr Dfa<Node, false> wholeDfa = Dfa<Node, false>::make();
+
+  // Follows the instructions that read no byte, in priority order, and
+  // queues the byte readers and the match. Recursion is bounded by the
+  // program size.
+  static constexpr void add(Threads &l, std::string_view text, std::size_t pc, std::size_t pos, Spans spans) {
+    if (l.on & pcBit(pc)) return;
+    l.on |= pcBit(pc);
+    const Inst &in = program.inst[pc];
+    switch (in.op) {
+      case Inst::Jump: add(l, text, in.x, pos, spans); return;
+      case Inst::Split:
+        add(l, text, in.x, pos, spans);
+        add(l, text, in.y, pos, spans);
+        return;
+      case Inst::Save:
+        spans[in.x] = pos;
+        add(l, text, pc + 1, pos, spans);
+        return;
+      case Inst::Bol:
+        if (pos == 0) add(l, text, pc + 1, pos, spans);
+        return;
+      case Inst::Eol:
+        if (pos == text.size()) add(l, text, pc + 1, pos, spans);
+        return;
+      default: l.threads[l.count++] = Thread {pc, spans};
+    }
+  }
+};
+
+}
@@ -0,0 +1,66 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nv {
+
+// Index of an interned string in its SymbolPool.
+using Symbol = std::uint32_t;
+
+// Interns strings as dense 32-bit symbols. Each distinct string is copied
+// once into one growing buffer; interning a string seen before only hashes
+// and compares it, so it allocates nothing. The lookup table is open
+// addressing with linear probing over symbols, sized to a power of two and
+// kept at most half full.
+class SymbolPool {
+public:
+  Symbol intern(std::string_view s);
+  std::string_view view(Symbol s) const { return std::string_view(text_).substr(starts_[s], starts_[s + 1] - starts_[s]); }
+  std::size_t size() const { return starts_.size() - 1; }
+
+private:
+  void grow();
+
+  std::string text_;                            // the strings back to back
+  std::vector<std::uint32_t> starts_ {0};       // symbol s is text_[starts_[s], starts_[s + 1])
+  std::vector<std::uint32_t> hashes_;           // per symbol, for rehashing and early rejects
+  std::vector<std::uint32_t> slots_;            // symbol + 1, or 0 when empty
+};
+
+// A set of symbols: open addressing over a power-of-two table of symbols,
+// kept at most half full, with kEmpty for a free slot.
+class SymbolSet {
+public:
+  bool insert(Symbol s);   // false when already present
+  bool contains(Symbol s) const;
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  std::vector<Symbol> sorted() const;
+
+  template <class Fn>
+  void forEach(Fn &&fn) const {
+    for (Symbol s : slots_) if (s != kEmpty) fn(s);
+  }
+
+private:
+  static constexpr Symbol kEmpty = ~Symbol(0);
+
+  std::vector<Symbol> slots_;
+  std::size_t size_ {0};
+};
+
+// Whether `a` has a symbol that `b` lacks, by a merge of their sorted symbols.
+bool hasMissing(const SymbolSet &a, const SymbolSet &b);
+
+}
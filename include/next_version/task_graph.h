@@ -0,0 +1,111 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nv {
+
+// Fixed set of worker threads, each with its own task deque. A worker runs its
+// newest task first and, when its deque is empty, steals the oldest task from
+// another worker. Tasks submitted from inside a worker go to that worker's
+// deque, so follow-up work stays on the thread that produced its inputs.
+// The destructor runs everything still queued, then joins.
+class ThreadPool {
+public:
+  explicit ThreadPool(unsigned workers);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void submit(std::function<void()> task);
+  unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+  bool take(unsigned self, std::function<void()> &task);
+  void work(unsigned self);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::mutex wakeMutex_;
+  std::condition_variable wake_;
+  std::atomic<std::size_t> queued_ {0};
+  std::atomic<unsigned> nextQueue_ {0};
+  bool stopping_ {false};
+};
+
+// Calls fn(i) for every i in [0, n) on the pool's workers and the calling
+// thread, and returns once all calls are done. Threads claim the next index
+// from a shared counter, so one slow index never holds up the rest. A null
+// pool runs them in order on the calling thread. The first exception is
+// rethrown after every claimed index has finished.
+void parallelFor(ThreadPool *pool, std::size_t n, const std::function<void(std::size_t)> &fn);
+
+// A set of named tasks with dependencies, run once each. A task may only
+// depend on tasks added before it, so the graph cannot have cycles and the
+// insertion order is a valid sequential order.
+class TaskGraph {
+public:
+  using TaskId = std::size_t;
+
+  TaskId add(std::string name, std::function<void()> fn, const std::vector<TaskId> &deps = {});
+
+  // Run every task as soon as its dependencies are done, on up to `jobs`
+  // threads; jobs <= 1 runs them in insertion order on the calling thread.
+  // After a task throws, tasks not yet started are skipped and the first
+  // exception is rethrown here.
+  void run(unsigned jobs);
+  // The same on the workers of pool, while the calling thread waits. Tasks
+  // may hand work to the same pool through parallelFor, so the graph and
+  // the work it spreads never keep more than pool.size() threads busy.
+  void run(ThreadPool &pool);
+
+  std::size_t size() const { return tasks_.size(); }
+  const std::string &name(TaskId id) const { return tasks_[id].name; }
+  double seconds(TaskId id) const { return tasks_[id].seconds; }   // wall time in the last run()
+
+private:
+  struct Task {
+    std::string name;
+    std::function<void()> fn;
+    std::vector<TaskId> dependents;
+    std::size_t deps {0};
+    double seconds {0};
+  };
+  void execute(TaskId id);
+
+  std::vector<Task> tasks_;
+  std::mutex failureMutex_;
+  std::exception_ptr failure_;
+  std::atomic<bool> failed_ {false};
+};
+
+// Whole CPUs allowed by the CPU quota of this process's cgroup (cgroup v2
+// cpu.max along the hierarchy, or cgroup v1 cpu.cfs_quota_us), rounded up;
+// 0 when there is no quota. The paths are parameters for testing.
+unsigned cgroupCpuLimit(const std::string &cgroupRoot = "/sys/fs/cgroup",
+                        const std::string &selfCgroup = "/proc/self/cgroup");
+
+// Worker count for --jobs: the requested count (0 picks one per CPU in the
+// affinity mask), capped by the cgroup quota. Always at least 1.
+unsigned effectiveJobs(int requested);
+
+}
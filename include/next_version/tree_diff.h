@@ -0,0 +1,90 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "next_version/blob_diff.h"
+#include "next_version/object_store.h"
+#include "next_version/pathspec.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nv {
+
+// One file-level change between two trees, the in-process equivalent of a
+// `git diff --raw` record plus its --numstat line.
+struct TreeChange {
+  char status {'M'};            // 'A', 'D', 'M', 'T' (type change), 'R' (rename) or 'C' (copy)
+  std::string oldPath;          // empty for 'A'
+  std::string newPath;          // empty for 'D'
+  ObjectId oldOid;
+  ObjectId newOid;
+  std::uint32_t oldMode {0};
+  std::uint32_t newMode {0};
+  int similarity {0};           // percent of the pair's content in common, for 'R' and 'C'
+  bool binary {false};          // NUL in the first 8000 bytes of either side (numstat "-")
+  int insertions {0};
+  int deletions {0};
+
+  const std::string &path() const { return newPath.empty() ? oldPath : newPath; }
+};
+
+// Walk two trees in parallel and append one record per changed file. Entries
+// with identical ids are skipped without being read, so unchanged subtrees
+// cost one comparison. An empty id stands for the empty tree.
+bool diffTrees(ObjectStore &store, const ObjectId &oldTree, const ObjectId &newTree,
+               const PathFilter &filter, std::vector<TreeChange> &out);
+
+struct RenameOptions {
+  int minSimilarity {50};                       // percent, like git's -M<n>%
+  std::size_t exhaustiveLimit {1000u * 1000u};  // source x destination pairs scored one by one
+};
+
+// Pair added files with deleted files (renames) and with deleted or modified
+// preimages (copies), scoring similarity like git diff -M -C. Identical blobs
+// pair first. Up to exhaustiveLimit every pair is scored as git does; beyond it,
+// where git gives up, MinHash LSH buckets pick the candidates so large moves
+// still pair in near-linear time. Ties go to the earlier source, keeping the
+// result deterministic. Returns false when a blob cannot be read.
+bool detectRenames(ObjectStore &store, std::vector<TreeChange> &changes, const RenameOptions &opts = {});
+
+// Fill insertions/deletions/binary from the blobs, like --numstat (with -w when
+// opts.ignoreWhitespace is set). Returns false when a blob cannot be read.
+bool computeLineStats(ObjectStore &store, std::vector<TreeChange> &changes, const BlobDiffOptions &opts);
+
+// Append the change as `git diff -M -C --unified=0` renders it and fill its
+// line stats on the way. Returns false when a blob cannot be read.
+bool appendPatch(ObjectStore &store, TreeChange &change, const BlobDiffOptions &opts, std::string &out);
+
+// What rendering a section's hunks tells about its blob pair: enough to
+// render the rest of the section again without reading the blobs.
+struct HunkShape {
+  bool binary {false};
+  bool hasHunks {false};
+  int insertions {0};
+  int deletions {0};
+};
+
+// Whether the change is one section whose hunks depend on nothing but its two
+// blob ids and the diff options: no type change, no submodule, and not a pure
+// rename or mode change.
+bool hunksByBlobs(const TreeChange &change);
+
+// appendPatch for such a change, split where the hunks begin: the header
+// lines, with the ---/+++ labels or the "Binary files" line, go to header
+// and the hunks to hunks. With known set the shape comes from an earlier
+// split of the same pair, and neither blob is read nor any hunk rendered;
+// otherwise the shape is filled in. Line stats are filled either way.
+bool appendPatchSplit(ObjectStore &store, TreeChange &change, const BlobDiffOptions &opts, bool known, HunkShape &shape,
+                      std::string &header, std::string &hunks);
+
+// Peel a commit or tag id to its commit's root tree.
+bool commitTree(ObjectStore &store, const ObjectId &commitOrTag, ObjectId &tree);
+
+}
@@ -9,6 +9,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 namespace nv {
 
@@ -26,6 +27,12 @@ struct Options {
   bool firstParent {false};
   std::string onlyPaths;
   bool ignoreWhitespace {false};
+  bool nativeGit {false};
+  int renameThreshold {50};   // minimum similarity percent for -M/-C pairing
+  int jobs {0};               // analysis threads; 0 = one per available CPU
+  bool noCache {false};       // neither read nor write the result cache
+  std::string sharedCacheDir; // directory of the host-wide shared cache; empty = none
+  std::string batchFile;      // NDJSON jobs to run instead of one analysis ("-" = stdin)
   bool verbose {false};
   bool machine {false};
   bool json {false};
@@ -66,6 +73,7 @@ struct RefResolution {
   // Optional details for parity with shell tools
   std::string requestedBaseSha;   // resolved SHA for the initially selected base
   std::string effectiveBaseSha;   // merge-base(base, target) when applicable
+  std::string targetSha;          // resolved SHA for the target
   int commitCount {0};            // commits between effective base and target
 };
 
@@ -116,6 +124,20 @@ struct CliResults {
   int enhancedCliPatterns {0};
 };
 
+// The sets and counters CliResults are decided from, as a CliScanner collects
+// them. Sets are sorted; findings of any split of a patch merge by union and
+// sum into those of the whole.
+struct CliFindings {
+  std::vector<std::string> removedLongFromStruct;
+  std::vector<std::string> addedLongFromStruct;
+  std::vector<std::string> removedLongManual;
+  std::vector<std::string> addedLongManual;
+  std::vector<std::string> removedCases;
+  std::vector<std::string> addedCases;
+  bool apiBreaking {false};
+  int removedShortCount {0};
+};
+
 struct SecurityResults {
   int securityKeywordsCommits {0};
   int securityPatternsDiff {0};
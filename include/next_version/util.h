@@ -27,6 +27,7 @@ inline bool isInteger(const std::string &s) {
   if (s.empty()) return false;
   std::size_t j = 0;
   if (s[0] == '-' || s[0] == '+') j = 1;
+  if (j == s.size()) return false;   // a lone sign (numstat "-" for binary files)
   for (; j < s.size(); ++j) if (!std::isdigit(static_cast<unsigned char>(s[j]))) return false;
   return true;
 }
@@ -0,0 +1,208 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/analysis.h"
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "next_version/util.h"
+#include "next_version/git_helpers.h"
+#include "next_version/range_snapshot.h"
+#include "next_version/analyzers.h"
+#include "next_version/commit_log.h"
+#include "next_version/defaults.h"
+#include "next_version/bonus_calculator.h"
+#include "next_version/version_reader.h"
+#include "next_version/suggestion_engine.h"
+#include "next_version/task_graph.h"
+#include "next_version/result_cache.h"
+
+namespace nv {
+
+AnalysisResult analyzeRange(const Options &opts, const ConfigValues &CFGN) {
+  // Resolve refs (native)
+  RefResolution ref = resolveRefsNative(opts);
+  std::string BASE_REF, TARGET_REF;
+  if (ref.emptyRepo) { BASE_REF = "EMPTY"; TARGET_REF = "HEAD"; }
+  else { BASE_REF = ref.baseRef; TARGET_REF = ref.targetRef; }
+
+  // After ref resolution every phase below is a node of a task graph: the git
+  // reads and the analyzers run concurrently and join at the bonus calculation.
+  // Patches and the commit log are streamed through the analyzers while git
+  // produces them, so neither is held in memory whole.
+  const bool haveRange = BASE_REF != "EMPTY";
+  const unsigned jobs = effectiveJobs(opts.jobs);
+  // A range analyzed before with the same options and configuration is read
+  // back from the cache, or from the shared cache of other runs on the host;
+  // everything after the analysis runs as usual.
+  const ResultCache cache = haveRange && !opts.noCache ? ResultCache::forRepository(opts.repoRoot) : ResultCache({});
+  const SharedCache shared(haveRange && !opts.noCache ? opts.sharedCacheDir : std::string());
+  ResultCacheKey cacheKey;
+  const bool cacheable = (cache.enabled() || shared.enabled()) && makeResultCacheKey(ref, opts, CFGN, cacheKey);
+  RangeAnalysis cached;
+  const bool localHit = cacheable && cache.load(cacheKey, cached);
+  const bool sharedHit = cacheable && !localHit && shared.load(cacheKey, cached);
+  const bool cacheHit = localHit || sharedHit;
+  if (opts.verbose && cacheable && cache.enabled()) std::cerr << "Debug: result cache " << (localHit ? "hit" : "miss") << " in " << cache.dir().string() << "\n";
+  if (opts.verbose && cacheable && shared.enabled() && !localHit) {
+    std::cerr << "Debug: shared cache " << (sharedHit ? "hit" : "miss") << " in " << shared.file().string() << "\n";
+  }
+  // One pool runs the phases and the scans they spread out: a phase
+  // consuming a stream scans along with the pool's other workers (see
+  // parallelFor), so no more than `jobs` threads are ever busy.
+  std::unique_ptr<ThreadPool> pool;
+  if (jobs > 1) pool = std::make_unique<ThreadPool>(jobs);
+  KeywordScanner kwScanner;
+  CliScanner cliScanner;
+  SecurityScanner secScanner(false);
+  DiffSinks sinks;
+  DiffModel diffModel;
+  sinks.diff = [&](std::string_view lines) {
+    // One matcher pass serves both scanners
+    PatternCounts hits;
+    countPatch(lines, KeywordScanner::diffPatterns | SecurityScanner::diffPatterns, hits, diffModel, pool.get());
+    kwScanner.add(hits);
+    secScanner.add(hits);
+  };
+  sinks.cliDiff = [&](std::string_view lines) { cliScanner.feed(lines, pool.get()); };
+  // One scan of the commit messages serves both log readers. Their counts
+  // are kept per commit, so only commits no earlier run has seen are fetched.
+  CommitLogScanner logScanner(KeywordScanner::logPatterns | SecurityScanner::logPatterns);
+  sinks.log = [&](std::string_view records) { logScanner.feed(records, pool.get()); };
+  CommitCache commitCache(cache.enabled() && !cacheHit ? CommitCache::pathFor(opts.repoRoot) : std::filesystem::path(),
+                          KeywordScanner::logPatterns | SecurityScanner::logPatterns);
+  PatternCounts logCounts;
+  // Native patches are analyzed a blob pair at a time, and pairs analyzed by
+  // earlier runs are neither diffed nor scanned again.
+  PairCache pairCache(opts.nativeGit && cache.enabled() && !cacheHit ? PairCache::pathFor(opts.repoRoot) : std::filesystem::path());
+  PairScanner pairScanner(pairCache, kwScanner, secScanner, cliScanner, pool.get());
+  if (pairCache.enabled()) pairScanner.attach(sinks);
+  auto collect = [&](unsigned parts) {
+    return collectRangeSnapshot(opts.repoRoot, BASE_REF, TARGET_REF, opts.onlyPaths, opts.ignoreWhitespace,
+                                parts, opts.nativeGit, opts.renameThreshold, sinks);
+  };
+  // One stream serves both patches when their pathspecs match, and the native
+  // tree diff is shared between file stats and patches, so those stay one node.
+  const bool cliShared = cliPathspecFor(opts.onlyPaths) == opts.onlyPaths;
+  const unsigned diffParts = SnapshotDiff | (cliShared ? SnapshotCliDiff : 0u);
+
+  Kv fileKv, CLI, SEC, KW;
+  std::string currentVersion;
+  int TOTAL_BONUS = 0;
+  TaskGraph graph;
+  std::vector<TaskGraph::TaskId> phases;
+  if (cacheHit) {
+    fileKv = std::move(cached.files);
+    CLI = std::move(cached.cli);
+    SEC = std::move(cached.security);
+    KW = std::move(cached.keywords);
+  } else if (haveRange) {
+    // 3) Analyze file changes
+    const auto statsNode = graph.add("file-stats", [&]() {
+      const FileChangeStats stats = computeFileChangeStats(collect(SnapshotFileStats | (opts.nativeGit ? diffParts : 0u)));
+      std::ostringstream ss;
+      ss << "ADDED_FILES=" << stats.addedFiles << "\n";
+      ss << "MODIFIED_FILES=" << stats.modifiedFiles << "\n";
+      ss << "DELETED_FILES=" << stats.deletedFiles << "\n";
+      ss << "NEW_SOURCE_FILES=" << stats.newSourceFiles << "\n";
+      ss << "NEW_TEST_FILES=" << stats.newTestFiles << "\n";
+      ss << "NEW_DOC_FILES=" << stats.newDocFiles << "\n";
+      ss << "DIFF_SIZE=" << (stats.insertions + stats.deletions) << "\n";
+      fileKv = parseKv(ss.str());
+    });
+    const auto diffNode = opts.nativeGit ? statsNode : graph.add("diff", [&]() { collect(diffParts); });
+    const auto cliDiffNode = cliShared ? diffNode : graph.add("cli-diff", [&]() { collect(SnapshotCliDiff); });
+    const auto logNode = graph.add("log", [&]() {
+      if (commitCache.enabled()) {
+        logCounts = countRangeLog(opts.repoRoot, BASE_REF, TARGET_REF, commitCache, pool.get());
+      } else {
+        collect(SnapshotLog);
+        logCounts = logScanner.totals();
+      }
+    });
+    phases.push_back(statsNode);
+    // 4) Analyze CLI options (use native C++ implementation)
+    phases.push_back(graph.add("cli", [&]() { CLI = convertCliResultsToKv(cliScanner.finish()); }, {cliDiffNode}));
+    // 5) Security keywords (use native C++ implementation)
+    phases.push_back(graph.add("security", [&]() { SEC = convertSecurityResultsToKv(secScanner.finish(logCounts)); },
+                               {diffNode, logNode}));
+    // 6) General keyword analysis (use native C++ implementation)
+    phases.push_back(graph.add("keywords", [&]() { KW = convertKeywordResultsToKv(kwScanner.finish(logCounts)); },
+                               {diffNode, logNode}));
+  } else {
+    fileKv = makeDefaultFileKv();
+    CLI = makeDefaultCliKv();
+    SEC = makeDefaultSecurityKv();
+    KW = makeDefaultKeywordKv();
+  }
+  // 8) Current version
+  phases.push_back(graph.add("version", [&]() { currentVersion = readCurrentVersion(opts.repoRoot); }));
+  // 7) Bonus calculation
+  graph.add("bonus", [&]() { TOTAL_BONUS = calculateTotalBonus(fileKv, CLI, SEC, KW, CFGN); }, phases);
+  // Ref resolution and the cache key's lookups run before this point; only
+  // the processes the phases start are counted for --verbose (in a --batch
+  // run the counter is shared, so analyses running alongside add theirs).
+  const int gitBefore = gitInvocationCount();
+  if (pool) graph.run(*pool);
+  else graph.run(1u);
+  const int gitForAnalysis = gitInvocationCount() - gitBefore;
+  if (cacheable && !localHit) cache.store(cacheKey, {fileKv, CLI, SEC, KW});
+  if (cacheable && !sharedHit) shared.store(cacheKey, {fileKv, CLI, SEC, KW});
+  pairCache.save();
+  commitCache.save();
+  if (opts.verbose && pairCache.enabled()) {
+    std::cerr << "Debug: blob pair cache: " << pairCache.hits() << " hits, " << pairCache.misses() << " misses\n";
+  }
+  if (opts.verbose && commitCache.enabled()) {
+    std::cerr << "Debug: commit cache: " << commitCache.hits() << " hits, " << commitCache.misses() << " misses\n";
+  }
+  if (opts.verbose) {
+    std::cerr << "Debug: git invocations for analysis: " << gitForAnalysis << "\n";
+    for (TaskGraph::TaskId id = 0; id < graph.size(); ++id) {
+      std::cerr << "Debug: phase " << graph.name(id) << " took " << static_cast<long>(graph.seconds(id) * 1000.0) << " ms\n";
+    }
+  }
+
+  // 9) Determine suggestion
+  std::string suggestion = determineSuggestion(TOTAL_BONUS, CFGN);
+
+  // Align with shell analyzer fallback: when patch threshold is 0 and we detected
+  // any changes (LOC > 0), suggest a PATCH instead of NONE.
+  // This keeps parity with test expectations in randomized repositories.
+  if (suggestion == "none") {
+    const int locSize = intOrDefault(fileKv.count("DIFF_SIZE") ? fileKv.at("DIFF_SIZE") : "", 0);
+    if (CFGN.patchBonusThreshold <= 0 && locSize > 0) {
+      suggestion = "patch";
+    }
+  }
+
+  // 10) Next version (native)
+  std::string nextVersion;
+  if (suggestion != "none") {
+    nextVersion = bumpVersion(currentVersion, suggestion,
+                              intOrDefault(fileKv.count("DIFF_SIZE") ? fileKv.at("DIFF_SIZE") : "", 0),
+                              TOTAL_BONUS, CFGN);
+  }
+
+  AnalysisResult result;
+  result.baseRef = BASE_REF;
+  result.targetRef = TARGET_REF;
+  result.suggestion = std::move(suggestion);
+  result.currentVersion = std::move(currentVersion);
+  result.nextVersion = std::move(nextVersion);
+  result.totalBonus = TOTAL_BONUS;
+  result.loc = intOrDefault(fileKv.count("DIFF_SIZE") ? fileKv.at("DIFF_SIZE") : "", 0);
+  result.cli = std::move(CLI);
+  return result;
+}
+
+}
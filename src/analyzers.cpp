@@ -8,21 +8,30 @@
 #include "next_version/types.h"
 #include "next_version/util.h"
 #include "next_version/git_helpers.h"
+#include "next_version/git_batch.h"
 #include "next_version/analyzers.h"
+#include "next_version/pattern_registry.h"
+#include "next_version/range_snapshot.h"
+#include "next_version/result_cache.h"
+#include "next_version/security_tokens.h"
+#include "next_version/task_graph.h"
 
 #include <algorithm>
 #include <cmath>
 #include <regex>
-#include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace nv {
 
 RefResolution resolveRefsNative(const Options &opts) {
   RefResolution rr;
   rr.targetRef = opts.targetRef.empty() ? std::string("HEAD") : opts.targetRef;
-  rr.hasCommits = gitHasCommits(opts.repoRoot);
+  // All rev-parse style lookups share one cat-file coprocess
+  GitBatch batch(opts.repoRoot);
+  rr.hasCommits = !batch.resolveCommit("HEAD").empty();
   if (!rr.hasCommits) { rr.emptyRepo = true; return rr; }
 
   // Step 1: choose initial base ref (mirror bash ref-resolver.sh)
@@ -35,23 +44,20 @@ RefResolution resolveRefsNative(const Options &opts) {
   } else {
     // Default to last tag (match pattern), fallback to HEAD~1, then first commit
     std::string lastTag = gitDescribeLastTag(opts.tagMatch.empty()?"*":opts.tagMatch, opts.repoRoot);
-    if (!lastTag.empty()) rr.baseRef = lastTag; else { std::string parent = gitParentHead(opts.repoRoot); if (!parent.empty()) rr.baseRef = parent; else { std::string first = gitFirstCommit(opts.repoRoot); if (!first.empty()) { rr.baseRef = first; rr.singleCommitRepo = true; } else rr.emptyRepo = true; } }
+    if (!lastTag.empty()) rr.baseRef = lastTag; else { std::string parent = batch.resolve("HEAD~1"); if (!parent.empty()) rr.baseRef = parent; else { std::string first = gitFirstCommit(opts.repoRoot); if (!first.empty()) { rr.baseRef = first; rr.singleCommitRepo = true; } else rr.emptyRepo = true; } }
   }
   if (rr.emptyRepo) return rr;
 
   // Resolve SHAs for base and target
-  auto resolveSha = [&](const std::string &ref) -> std::string {
-    std::string out; runGitCapture({"rev-parse","-q","--verify", ref + "^{commit}"}, opts.repoRoot, out); return trim(out);
-  };
-
-  rr.requestedBaseSha = resolveSha(rr.baseRef);
+  rr.requestedBaseSha = batch.resolveCommit(rr.baseRef);
   rr.targetRef = rr.targetRef.empty() ? std::string("HEAD") : rr.targetRef;
-  const std::string targetSha = resolveSha(rr.targetRef);
+  const std::string targetSha = batch.resolveCommit(rr.targetRef);
+  rr.targetSha = targetSha;
 
   // Step 2: compute merge-base for disjoint branches unless disabled (bash parity)
   if (!opts.noMergeBase && !rr.requestedBaseSha.empty() && !targetSha.empty()) {
-    std::string effective; runGitCapture({"merge-base", rr.requestedBaseSha, targetSha}, opts.repoRoot, effective);
-    rr.effectiveBaseSha = trim(effective);
+    if (rr.requestedBaseSha == targetSha) rr.effectiveBaseSha = targetSha; // merge-base(x, x) == x
+    else { std::string effective; runGitCapture({"merge-base", rr.requestedBaseSha, targetSha}, opts.repoRoot, effective); rr.effectiveBaseSha = trim(effective); }
     if (!rr.effectiveBaseSha.empty() && rr.effectiveBaseSha != rr.requestedBaseSha) {
       rr.baseRef = rr.effectiveBaseSha; // use merge-base as effective base
     }
@@ -226,149 +232,309 @@ ConfigValues loadConfigValues(const std::string &projectRoot) {
   return cfg;
 }
 
-static std::string getDiffText(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef, bool ignoreWhitespace, const std::string &onlyPathsCsv, bool addedOnly=false) {
-  std::vector<std::string> args = {"diff","-M","-C","--unified=0","--no-ext-diff"}; if (ignoreWhitespace) args.push_back("-w"); args.push_back(baseRef + ".." + targetRef);
-  if (!onlyPathsCsv.empty()) { args.push_back("--"); std::istringstream iss(onlyPathsCsv); std::string tok; while (std::getline(iss, tok, ',')) { auto t = trim(tok); if (!t.empty()) args.push_back(t); } }
-  std::string text; runGitCapture(args, repoRoot, text);
-  if (addedOnly) { std::istringstream in(text); std::string line; std::string out; while (std::getline(in, line)) { if (line.rfind("+++",0)==0 || line.rfind("---",0)==0 || line.rfind("@@",0)==0) continue; if (!line.empty() && line[0]=='+') out.append(line.substr(1)).push_back('\n'); } return out; }
-  return text;
+KeywordResults analyzeKeywords(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef, const std::string &onlyPathsCsv, bool ignoreWhitespace) {
+  return analyzeKeywords(collectRangeSnapshot(repoRoot, baseRef, targetRef, onlyPathsCsv, ignoreWhitespace, SnapshotDiff | SnapshotLog));
 }
 
-static std::string getCommitMessages(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef, bool noMerges=false) {
-  std::vector<std::string> args = {"log","--format=%s %b"}; if (noMerges) args.insert(args.begin(), "--no-merges"); args.push_back(baseRef + ".." + targetRef); std::string logs; runGitCapture(args, repoRoot, logs); return logs;
+KeywordResults analyzeKeywords(const RangeSnapshot &snap) {
+  KeywordScanner scanner;
+  scanner.feed(snap.diff);
+  return scanner.finish(snap.log);
 }
 
-static int countRegex(const std::string &text, const std::regex &re) { int cnt=0; for (auto it=std::sregex_iterator(text.begin(), text.end(), re), end=std::sregex_iterator(); it!=end; ++it) ++cnt; return cnt; }
+void countPatch(std::string_view diff, PatternSet patterns, PatternCounts &counts, DiffModel &model, ThreadPool *pool) {
+  if (!pool) {
+    countPatterns(diff, patterns, counts);
+    return;
+  }
+  model.parse(diff);
+  const std::vector<PatchRange> ranges = model.ranges(kParallelRangeBytes);
+  std::vector<PatternCounts> parts(ranges.size());
+  parallelFor(pool, ranges.size(), [&](std::size_t i) {
+    countPatterns(model.text(ranges[i]), patterns, parts[i]);
+  });
+  for (const PatternCounts &part : parts) counts += part;
+}
 
-KeywordResults analyzeKeywords(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef, const std::string &onlyPathsCsv, bool ignoreWhitespace) {
-  KeywordResults res; std::string diff = getDiffText(repoRoot, baseRef, targetRef, ignoreWhitespace, onlyPathsCsv, false); std::string logs = getCommitMessages(repoRoot, baseRef, targetRef, false);
-  // Code and commit patterns for breaking changes (align with shell analyzer)
-  std::regex cliBreakCode(R"(CLI[\- ]?BREAKING)", std::regex::icase);
-  std::regex apiBreakCode(R"(API[\- ]?BREAKING)", std::regex::icase);
-  // In commit messages also accept "BREAKING: ... CLI" and "BREAKING: ... API"
-  std::regex cliBreakCommit(R"(BREAKING[^A-Za-z0-9]+.*CLI)", std::regex::icase);
-  std::regex apiBreakCommit(R"(BREAKING[^A-Za-z0-9]+.*API)", std::regex::icase);
-  std::regex generalBreakCommit(R"(BREAKING\s+CHANGE|BREAKING[^A-Za-z0-9]+.*(CHANGE|MAJOR))", std::regex::icase);
-  // Match bash version's comment pattern: (^|[[:space:]])[+-]?[[:space:]]*(//|/\\*|#|--)[[:space:]]*SECURITY
-  std::regex securityCode(R"((^|\s)[+-]?\s*(//|/\*|#|--)\s*SECURITY)", std::regex::icase);
-  std::regex removedOptCode(R"(REMOVED\s+OPTION(S)?)", std::regex::icase);
-  // Match bash version's commit pattern: (SECURITY|VULNERABILIT(Y|IES)|CVE[- ]?[0-9]{4}-[0-9]+)
-  std::regex secOrCve(R"(SECURITY|VULNERABILIT(Y|IES)|CVE[- ]?[0-9]{4}-[0-9]+)", std::regex::icase);
-  int cli_breaking = countRegex(diff, cliBreakCode) + countRegex(logs, cliBreakCode) + countRegex(logs, cliBreakCommit);
-  int api_breaking = countRegex(diff, apiBreakCode) + countRegex(logs, apiBreakCode) + countRegex(logs, apiBreakCommit);
-  int general_break = countRegex(logs, generalBreakCommit);
-  int security_total = countRegex(diff, securityCode) + countRegex(logs, secOrCve);
-  res.hasCliBreaking = (cli_breaking>0); res.hasApiBreaking = (api_breaking>0); res.hasGeneralBreaking = (general_break>0); res.totalSecurity = security_total; res.removedOptionsKeywords = countRegex(diff, removedOptCode); return res;
+void KeywordScanner::feed(std::string_view diff, ThreadPool *pool) {
+  countPatch(diff, diffPatterns, diff_, model_, pool);
+}
+
+void KeywordScanner::add(const PatternCounts &counts) { diff_ += counts; }
+
+KeywordResults KeywordScanner::finish(const std::string &logs) const {
+  return finish(countCommitLog(logs, logPatterns));
+}
+
+KeywordResults KeywordScanner::finish(const PatternCounts &log) const {
+  KeywordResults res;
+  int cli_breaking = diff_[Pattern::CliBreaking] + log[Pattern::CliBreaking] + log[Pattern::CliBreakingCommit];
+  int api_breaking = diff_[Pattern::ApiBreaking] + log[Pattern::ApiBreaking] + log[Pattern::ApiBreakingCommit];
+  int general_break = log[Pattern::GeneralBreaking];
+  int security_total = diff_[Pattern::SecurityComment] + log[Pattern::SecurityOrCve];
+  res.hasCliBreaking = (cli_breaking>0); res.hasApiBreaking = (api_breaking>0); res.hasGeneralBreaking = (general_break>0); res.totalSecurity = security_total; res.removedOptionsKeywords = diff_[Pattern::RemovedOption]; return res;
 }
 
 CliResults analyzeCliOptions(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef, const std::string &onlyPathsCsv, bool ignoreWhitespace) {
-  CliResults r;
-  // Full diff for general signals
-  // Parity with bash analyzer: when no path filters are provided, restrict to common C/C++ files by default.
-  // Use recursive glob pathspecs via Git's :(glob) to match **/*.ext like the shell version.
-  const std::string defaultCppGlobPathspec =
-      ":(glob)**/*.c,:(glob)**/*.cc,:(glob)**/*.cpp,:(glob)**/*.cxx,:(glob)**/*.h,:(glob)**/*.hh,:(glob)**/*.hpp";
-  const std::string effectivePaths = onlyPathsCsv.empty() ? defaultCppGlobPathspec : onlyPathsCsv;
-  std::string diff = getDiffText(repoRoot, baseRef, targetRef, ignoreWhitespace, effectivePaths, false);
-  // Restrict help text and CLI pattern heuristics to C/C++ sources/headers to align with bash CPP_DIFF
-  // Use the same effective pathspec as above to ensure parity with PATHSPEC handling in shell analyzer
-  const std::string cppPathspec = effectivePaths;
-  std::string cppDiff = getDiffText(repoRoot, baseRef, targetRef, ignoreWhitespace, cppPathspec, false);
-  std::istringstream iss(diff);
-  std::istringstream cppIss(cppDiff);
-  std::string line;
-  std::set<std::string> removedLongFromStruct, addedLongFromStruct;
-  std::set<std::string> removedLongManual, addedLongManual;
-  std::regex longOpt(R"(--[A-Za-z0-9][A-Za-z0-9\-]*)");
-  std::regex protoRemoved(R"(^-[^+].*[A-Za-z_][A-Za-z0-9_\s\*]+\s+[A-Za-z_][A-Za-z0-9_]*\([^;]*\)\s*;\s*$)");
-  std::regex shortOpt(R"(^-[^+].*[^-]-[A-Za-z](\s|$))");
-  // Detect case labels like bash analyzer: collect removed and added case labels and compare
-  std::set<std::string> removedCases, addedCases;
-  std::regex caseLabelRe(R"(case\s+([^:\s]+)\s*:)");
-  // Enhanced CLI patterns (heuristic signals)
-  std::regex getoptCall(R"((getopt_long|getopt)\s*\()");
-  std::regex argcArgvAdded(R"(^\+.*\b(argc|argv)\b)");
-  // Make help/usage pattern case-insensitive to align with bash analyzer (-i)
-  std::regex helpUsageAdded(R"(^\+.*\b(usage|help|option|argument)\b)", std::regex::icase);
-  // Additional enhanced CLI patterns to mirror bash analyzer heuristics
-  std::regex shortOptionAdded(R"(^\+[^/#!].*-[A-Za-z](\s|$))");
-  std::regex longOptionAdded(R"(^\+[^/#!].*--[A-Za-z0-9\-]+)");
-  std::regex argcCheckAdded(R"(^\+.*\bargc\s*[<>=!])");
-  std::regex argvAccessAdded(R"(^\+.*\bargv\[)");
-  // Exclude generic main() additions from enhanced CLI patterns to reduce noise
-  // by not defining a mainSignatureAdded regex here (kept as a no-op placeholder)
-  [[maybe_unused]] const bool countMainSignature = false;
-  int enhancedCount = 0;
-  int helpTextChangesCount = 0;
-  
-  auto isCommentLine = [](const std::string &ln) -> bool {
-    // minus or plus, optional spaces, then // or /*
-    size_t i = 0; if (ln.empty()) return false; char s = ln[0]; if (s!='-' && s!='+') return false; i = 1; while (i < ln.size() && std::isspace(static_cast<unsigned char>(ln[i]))) ++i; if (i+1 < ln.size() && ln[i]=='/' && (ln[i+1]=='/' || ln[i+1]=='*')) return true; return false;
+  return analyzeCliOptions(collectRangeSnapshot(repoRoot, baseRef, targetRef, onlyPathsCsv, ignoreWhitespace, SnapshotCliDiff));
+}
+
+CliResults analyzeCliOptions(const RangeSnapshot &snap) {
+  // Parity with bash analyzer: when no path filters are provided, the snapshot restricts
+  // this diff to common C/C++ files (see cliPathspecFor).
+  CliScanner scanner;
+  scanner.feed(snap.cliDiffText());
+  return scanner.finish();
+}
+
+void CliScanner::Side::reset() {
+  lexer.reset();
+  decl = Decl::Start;
+  nested = 0;
+  inCase = false;
+  directive = false;
+}
+
+void CliScanner::feed(std::string_view diff, ThreadPool *pool) {
+  model_.parse(diff);
+  if (!pool) {
+    scan(model_, {0, model_.lines().size()});
+    return;
+  }
+  // The first range may go on with a hunk of the previous batch; the sides
+  // left open by the last one go on into the next batch.
+  const std::vector<PatchRange> ranges = model_.ranges(kParallelRangeBytes);
+  std::vector<CliScanner> parts(ranges.size());
+  if (parts.empty()) return;
+  parts.front().removed_ = std::move(removed_);
+  parts.front().added_ = std::move(added_);
+  parallelFor(pool, ranges.size(), [&](std::size_t i) { parts[i].scan(model_, ranges[i]); });
+  removed_ = std::move(parts.back().removed_);
+  added_ = std::move(parts.back().added_);
+  for (CliScanner &part : parts) merge(std::move(part));
+}
+
+void CliScanner::scan(const DiffModel &model, const PatchRange &range) {
+  for (std::size_t i = range.firstLine; i < range.endLine; ++i) {
+    const PatchLine &l = model.lines()[i];
+    switch (l.kind) {
+    case PatchLineKind::Removed: scanLine(removed_, model.line(l), true); break;
+    case PatchLineKind::Added: scanLine(added_, model.line(l), false); break;
+    case PatchLineKind::Note: break;
+    default: removed_.reset(); added_.reset(); break;   // the text in between is unknown
+    }
+  }
+}
+
+void CliScanner::merge(CliScanner &&other) {
+  // The other scanner's symbols are its own; intern their names here
+  auto add = [&](SymbolSet &into, const SymbolSet &from) {
+    from.forEach([&](Symbol s) { into.insert(symbols_.intern(other.symbols_.view(s))); });
   };
-  auto hasQuotedLongOpt = [](const std::string &ln) -> bool {
-    // crude: if line contains a quote and also --, treat as quoted long opt (skip)
-    return (ln.find('"') != std::string::npos) && (ln.find("--") != std::string::npos);
+  add(removedLongFromStruct_, other.removedLongFromStruct_);
+  add(addedLongFromStruct_, other.addedLongFromStruct_);
+  add(removedLongManual_, other.removedLongManual_);
+  add(addedLongManual_, other.addedLongManual_);
+  add(removedCases_, other.removedCases_);
+  add(addedCases_, other.addedCases_);
+  apiBreaking_ = apiBreaking_ || other.apiBreaking_;
+  removedShortCount_ += other.removedShortCount_;
+}
+
+CliFindings CliScanner::findings() const {
+  auto names = [&](const SymbolSet &set) {
+    std::vector<std::string> out;
+    out.reserve(set.size());
+    set.forEach([&](Symbol s) { out.emplace_back(symbols_.view(s)); });
+    std::sort(out.begin(), out.end());
+    return out;
   };
+  CliFindings f;
+  f.removedLongFromStruct = names(removedLongFromStruct_);
+  f.addedLongFromStruct = names(addedLongFromStruct_);
+  f.removedLongManual = names(removedLongManual_);
+  f.addedLongManual = names(addedLongManual_);
+  f.removedCases = names(removedCases_);
+  f.addedCases = names(addedCases_);
+  f.apiBreaking = apiBreaking_;
+  f.removedShortCount = removedShortCount_;
+  return f;
+}
 
-  while (std::getline(iss, line)) {
-    if (line.rfind("+++",0)==0 || line.rfind("---",0)==0 || line.rfind("@@",0)==0) continue;
-    if (!line.empty() && line[0]=='-') {
-      // Struct-based long options and short option removals
-      for (auto it = std::sregex_iterator(line.begin(), line.end(), longOpt), end=std::sregex_iterator(); it!=end; ++it) {
-        removedLongFromStruct.insert((*it)[0]);
-      }
-      if (std::regex_search(line, protoRemoved)) r.apiBreaking = true;
-      if (std::regex_search(line, shortOpt)) r.removedShortCount++;
-      // Do not count enhanced CLI patterns on removed lines to align with bash
-      // Manual long option detection on diff lines excluding obvious comments/quoted strings
-      if (!isCommentLine(line) && !hasQuotedLongOpt(line)) {
-        for (auto it = std::sregex_iterator(line.begin(), line.end(), longOpt), end=std::sregex_iterator(); it!=end; ++it) {
-          removedLongManual.insert((*it)[0]);
-        }
-      }
-      std::smatch m; if (std::regex_search(line, m, caseLabelRe)) { removedCases.insert(m[1].str()); }
-    } else if (!line.empty() && line[0]=='+') {
-      for (auto it = std::sregex_iterator(line.begin(), line.end(), longOpt), end=std::sregex_iterator(); it!=end; ++it) {
-        addedLongFromStruct.insert((*it)[0]);
-      }
-       if (!isCommentLine(line) && !hasQuotedLongOpt(line)) {
-        for (auto it = std::sregex_iterator(line.begin(), line.end(), longOpt), end=std::sregex_iterator(); it!=end; ++it) {
-          addedLongManual.insert((*it)[0]);
-        }
-      }
-      std::smatch m; if (std::regex_search(line, m, caseLabelRe)) { addedCases.insert(m[1].str()); }
-       // Disabled help/usage and heuristic enhanced pattern boosts for parity with shell results
+void CliScanner::add(const CliFindings &findings) {
+  auto add = [&](SymbolSet &into, const std::vector<std::string> &names) {
+    for (const std::string &name : names) into.insert(symbols_.intern(name));
+  };
+  add(removedLongFromStruct_, findings.removedLongFromStruct);
+  add(addedLongFromStruct_, findings.addedLongFromStruct);
+  add(removedLongManual_, findings.removedLongManual);
+  add(addedLongManual_, findings.addedLongManual);
+  add(removedCases_, findings.removedCases);
+  add(addedCases_, findings.addedCases);
+  apiBreaking_ = apiBreaking_ || findings.apiBreaking;
+  removedShortCount_ += findings.removedShortCount;
+}
+
+static bool isPunct(const CppToken &t, char c) {
+  return t.kind == CppTokenKind::Punct && t.text.size() == 1 && t.text[0] == c;
+}
+
+static bool endsStatement(const CppToken &t) { return isPunct(t, ';') || isPunct(t, '{') || isPunct(t, '}'); }
+
+// Identifiers that start a statement other than a declaration.
+static bool isStatementKeyword(std::string_view id) {
+  static constexpr std::string_view kWords[] = {"return", "else", "delete", "throw", "goto", "case", "new", "sizeof",
+                                                "if", "while", "for", "switch", "do", "using", "typedef",
+                                                "co_return", "co_yield", "co_await"};
+  for (std::string_view w : kWords) if (id == w) return true;
+  return false;
+}
+
+// The text of a string literal without its prefix and quotes, or of a piece of one.
+static std::string_view literalBody(std::string_view text) {
+  const std::size_t open = text.find('"');
+  if (open != std::string_view::npos) text.remove_prefix(open + 1);
+  if (!text.empty() && text.back() == '"') text.remove_suffix(1);
+  return text;
+}
+
+// The declaration recognizer, one code token of a removed line at a time:
+// [qualifiers] type name(params) [qualifiers];, where the type and name are
+// at least two identifiers, possibly with *, &, ::, <...> and [[...]], and the
+// name may be an operator. Returns true at the ';' of such a declaration.
+bool CliScanner::Side::advanceDecl(const CppToken &t) {
+  if (nested > 0) {
+    // inside <...> or [...] of the type
+    if (endsStatement(t)) { decl = Decl::Start; nested = 0; }
+    else if (isPunct(t, '<') || isPunct(t, '[')) ++nested;
+    else if (isPunct(t, '>') || isPunct(t, ']')) --nested;
+    return false;
+  }
+  switch (decl) {
+  case Decl::Start:
+    if (t.kind == CppTokenKind::Identifier) {
+      decl = isStatementKeyword(t.text) ? Decl::Skip : t.text == "operator" ? Decl::Operator : Decl::Type;
+      idents = 1;
+      depth = 0;
+      lastName = true;
+    } else if (t.text == "::") {
+      decl = Decl::Type;
+      idents = 0;
+      lastName = false;
+    } else if (isPunct(t, '[')) {
+      nested = 1;   // an attribute
+    } else if (!endsStatement(t)) {
+      decl = Decl::Skip;
+    }
+    return false;
+  case Decl::Type:
+    if (t.kind == CppTokenKind::Identifier) {
+      if (t.text == "operator") { decl = Decl::Operator; depth = 0; }
+      ++idents;
+      lastName = true;
+    } else if (isPunct(t, '*') || isPunct(t, '&') || t.text == "::") {
+      lastName = false;
+    } else if (isPunct(t, '<') || isPunct(t, '[')) {
+      nested = 1;
+      lastName = false;
+    } else if (isPunct(t, '(')) {
+      if (idents >= 2 && lastName) { decl = Decl::Params; depth = 1; }
+      else decl = Decl::Skip;
+    } else if (isPunct(t, ':') && idents == 1 && lastName) {
+      decl = Decl::Start;   // a label such as public:
+    } else {
+      decl = endsStatement(t) ? Decl::Start : Decl::Skip;
     }
+    return false;
+  case Decl::Operator:
+    // depth 0: right after "operator", 1: in the name, 2: in the () of operator()
+    if (endsStatement(t)) decl = Decl::Start;
+    else if (depth == 2) { if (isPunct(t, ')')) depth = 1; else decl = Decl::Skip; }
+    else if (isPunct(t, '(')) { if (depth == 0) depth = 2; else { decl = Decl::Params; depth = 1; } }
+    else depth = 1;
+    return false;
+  case Decl::Params:
+    if (isPunct(t, '(')) ++depth;
+    else if (isPunct(t, ')')) { if (--depth == 0) decl = Decl::After; }
+    else if (endsStatement(t)) decl = Decl::Start;
+    return false;
+  case Decl::After:
+    // const, noexcept(...), override, = 0, -> type and the like
+    if (isPunct(t, ';')) { decl = Decl::Start; return true; }
+    if (endsStatement(t)) decl = Decl::Start;
+    else if (isPunct(t, ':')) decl = Decl::Skip;   // a constructor's initializers
+    return false;
+  case Decl::Skip:
+    if (endsStatement(t)) decl = Decl::Start;
+    return false;
   }
+  return false;
+}
 
-  // Second pass on C/C++-only diff for help text and enhanced CLI patterns (parity with bash CPP_DIFF)
-  while (std::getline(cppIss, line)) {
-    if (line.rfind("+++",0)==0 || line.rfind("---",0)==0 || line.rfind("@@",0)==0) continue;
-    if (!line.empty() && line[0]=='+') {
-      // Disabled help/usage and heuristic enhanced pattern boosts for parity with shell results
-      // Manual long option detection only on C/C++ lines to reduce false positives
-      if (!isCommentLine(line) && !hasQuotedLongOpt(line)) {
-        for (auto it = std::sregex_iterator(line.begin(), line.end(), longOpt), end=std::sregex_iterator(); it!=end; ++it) {
-          addedLongManual.insert((*it)[0]);
-        }
-      }
-    } else if (!line.empty() && line[0]=='-') {
-      // Removed side for manual long options and short option removals
-      if (std::regex_search(line, shortOpt)) r.removedShortCount++;
-      if (!isCommentLine(line) && !hasQuotedLongOpt(line)) {
-        for (auto it = std::sregex_iterator(line.begin(), line.end(), longOpt), end=std::sregex_iterator(); it!=end; ++it) {
-          removedLongManual.insert((*it)[0]);
-        }
+// case <tokens>:, with the tokens' text joined into caseLabel. Returns true
+// when a label is complete.
+bool CliScanner::Side::advanceCase(const CppToken &t) {
+  if (!inCase) {
+    if (t.kind == CppTokenKind::Identifier && t.text == "case") { inCase = true; caseLabel.clear(); }
+    return false;
+  }
+  if (isPunct(t, ':')) { inCase = false; return !caseLabel.empty(); }
+  if (endsStatement(t)) inCase = false;
+  else caseLabel.append(t.text);
+  return false;
+}
+
+// Each line goes through both of the shell analyzer's passes: the first over the
+// CLI diff, the second over CPP_DIFF, which used the identical pathspec. Both only
+// collect sets and counters, so interleaving them per line gives the same result.
+void CliScanner::scanLine(Side &side, std::string_view line, bool removed) {
+  const std::string_view content = line.substr(1);
+  if (content.size() > kMaxLineLength) { side.reset(); return; }
+  side.tokens.clear();
+  const bool atCode = side.lexer.inCode();
+  side.lexer.lexLine(content, side.tokens);
+  SymbolSet &fromStruct = removed ? removedLongFromStruct_ : addedLongFromStruct_;
+  SymbolSet &manual = removed ? removedLongManual_ : addedLongManual_;
+  SymbolSet &cases = removed ? removedCases_ : addedCases_;
+  bool shortOption = false;
+  for (const CppToken &t : side.tokens) {
+    if (t.kind == CppTokenKind::Comment || t.kind == CppTokenKind::String) {
+      // Options in option tables, usage strings and their comments
+      if (t.text.find('-') == std::string_view::npos) continue;
+      patterns::LongOption::forEach(t.text, [&](const auto &m) { fromStruct.insert(symbols_.intern(m[0])); });
+      if (removed && !shortOption) {
+        shortOption = patterns::ShortOption::search(t.kind == CppTokenKind::String ? literalBody(t.text) : t.text);
       }
+      continue;
     }
+    if (&t == &side.tokens.front() && atCode && isPunct(t, '#')) side.directive = true;
+    if (side.directive) continue;
+    if (side.advanceCase(t)) cases.insert(symbols_.intern(side.caseLabel));
+    if (removed && side.advanceDecl(t)) apiBreaking_ = true;
   }
+  // Counted once per pass, like the shell analyzer
+  if (shortOption) removedShortCount_ += 2;
+  // Manual options keep the shell analyzer's rule: every option on the line,
+  // marker included, unless it starts a comment or has a quote in it. Lines
+  // starting with ---/+++ were dropped there as file headers.
+  const bool commentLine = atCode && !side.tokens.empty() && side.tokens.front().kind == CppTokenKind::Comment;
+  const bool headerLike = line.rfind("---", 0) == 0 || line.rfind("+++", 0) == 0;
+  if (!commentLine && !headerLike && line.find('"') == std::string_view::npos && line.find("--") != std::string_view::npos) {
+    patterns::LongOption::forEach(line, [&](const auto &m) { manual.insert(symbols_.intern(m[0])); });
+  }
+  side.directive = side.directive && !content.empty() && content.back() == '\\';
+}
+
+CliResults CliScanner::finish() const {
+  CliResults r;
+  r.apiBreaking = apiBreaking_;
+  r.removedShortCount = removedShortCount_;
   // Compute missing cases: present in removed but not re-added
-  bool breakingByCases = false;
-  for (const auto &c : removedCases) { if (addedCases.find(c) == addedCases.end()) { breakingByCases = true; break; } }
-  r.removedLongCount = static_cast<int>(removedLongFromStruct.size());
-  r.addedLongCount = static_cast<int>(addedLongFromStruct.size());
-  r.manualRemovedLongCount = static_cast<int>(removedLongManual.size());
-  r.manualAddedLongCount = static_cast<int>(addedLongManual.size());
+  const bool breakingByCases = hasMissing(removedCases_, addedCases_);
+  r.removedLongCount = static_cast<int>(removedLongFromStruct_.size());
+  r.addedLongCount = static_cast<int>(addedLongFromStruct_.size());
+  r.manualRemovedLongCount = static_cast<int>(removedLongManual_.size());
+  r.manualAddedLongCount = static_cast<int>(addedLongManual_.size());
   // Align with bash: breaking CLI based on removed switch-case labels only (more accurate)
   r.breakingCliChanges = breakingByCases;
   // If switch-case label analysis indicates removed options but struct/manual
@@ -379,8 +545,9 @@ CliResults analyzeCliOptions(const std::string &repoRoot, const std::string &bas
   }
   // Restrict manual CLI changes to explicit manual long option edits only.
   r.manualCliChanges = (r.manualAddedLongCount>0 || r.manualRemovedLongCount>0);
-  r.helpTextChanges = helpTextChangesCount;
-  r.enhancedCliPatterns = enhancedCount;
+  // Help text and enhanced pattern boosts stay disabled for parity with shell results
+  r.helpTextChanges = 0;
+  r.enhancedCliPatterns = 0;
   // Align CLI change flag with bash: treat any option set change or short removals as CLI changes
   r.cliChanges = r.breakingCliChanges
               || r.manualCliChanges
@@ -391,16 +558,160 @@ CliResults analyzeCliOptions(const std::string &repoRoot, const std::string &bas
 }
 
 SecurityResults analyzeSecurity(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef, const std::string &onlyPathsCsv, bool ignoreWhitespace, bool addedOnly) {
-  SecurityResults s; std::string commits = getCommitMessages(repoRoot, baseRef, targetRef, false); std::string diff = getDiffText(repoRoot, baseRef, targetRef, ignoreWhitespace, onlyPathsCsv, addedOnly);
-  std::regex secRe(R"(\b(security|vuln|exploit|breach|attack|threat|malware|virus|trojan|backdoor|rootkit|phishing|ddos|overflow|injection|xss|csrf|sqli|rce|ssrf|xxe|privilege|escalation|bypass|mitigation|hardening|sandbox|auth|encryption|decryption|tls|ssl|certificate|secret|token|leak|expos|traversal)\b)", std::regex::icase); std::regex cveRe(R"(\bCVE-[0-9]{4}-[0-9]{4,7}\b)", std::regex::icase); std::regex memRe(R"(\b(buffer[- _]?overflow|stack[- _]?overflow|heap[- _]?overflow|use[- _]?after[- _]?free|double[- _]?free|null[- _]?pointer|dangling[- _]?pointer|out[- _]?of[- _]?bounds|oob|memory[- _]?leak|format[- _]?string|integer[- _]?overflow|signedness|race[- _]?condition|data[- _]?race|deadlock)\b)", std::regex::icase); std::regex crashRe(R"(\b(segfault|segmentation\s+fault|crash|abort|assert|panic|fatal\s+error|core\s+dump|stack\s+trace)\b)", std::regex::icase);
-  s.securityKeywordsCommits = static_cast<int>(std::distance(std::sregex_iterator(commits.begin(), commits.end(), secRe), std::sregex_iterator()));
-  s.securityPatternsDiff = static_cast<int>(std::distance(std::sregex_iterator(diff.begin(), diff.end(), secRe), std::sregex_iterator()));
-  s.cvePatterns = static_cast<int>(std::distance(std::sregex_iterator(diff.begin(), diff.end(), cveRe), std::sregex_iterator()));
-  s.memorySafetyIssues = static_cast<int>(std::distance(std::sregex_iterator(diff.begin(), diff.end(), memRe), std::sregex_iterator()));
-  s.crashFixes = static_cast<int>(std::distance(std::sregex_iterator(diff.begin(), diff.end(), crashRe), std::sregex_iterator()));
+  return analyzeSecurity(collectRangeSnapshot(repoRoot, baseRef, targetRef, onlyPathsCsv, ignoreWhitespace, SnapshotDiff | SnapshotLog), addedOnly);
+}
+
+SecurityResults analyzeSecurity(const RangeSnapshot &snap, bool addedOnly) {
+  SecurityScanner scanner(addedOnly);
+  scanner.feed(snap.diff);
+  return scanner.finish(snap.log);
+}
+
+// Added lines of a range, matched one at a time.
+static void countAddedLines(const DiffModel &model, const PatchRange &range, PatternSet patterns, PatternCounts &counts) {
+  const std::vector<std::uint32_t> &added = model.addedLines();
+  for (auto it = std::lower_bound(added.begin(), added.end(), range.firstLine); it != added.end() && *it < range.endLine; ++it) {
+    const std::string_view line = model.line(model.lines()[*it]);
+    if (line.rfind("+++",0)==0) continue;   // skipped as a header, like the shell analyzer
+    countPatterns(line.substr(1), patterns, counts);
+  }
+}
+
+void SecurityScanner::feed(std::string_view diff, ThreadPool *pool) {
+  if (!addedOnly_) { countPatch(diff, diffPatterns, diff_, model_, pool); return; }
+  model_.parse(diff);
+  if (!pool) {
+    countAddedLines(model_, {0, model_.lines().size()}, diffPatterns, diff_);
+    return;
+  }
+  const std::vector<PatchRange> ranges = model_.ranges(kParallelRangeBytes);
+  std::vector<PatternCounts> parts(ranges.size());
+  parallelFor(pool, ranges.size(), [&](std::size_t i) { countAddedLines(model_, ranges[i], diffPatterns, parts[i]); });
+  for (const PatternCounts &part : parts) diff_ += part;
+}
+
+void SecurityScanner::add(const PatternCounts &counts) { diff_ += counts; }
+
+SecurityResults SecurityScanner::finish(const std::string &commits) const {
+  return finish(countCommitLog(commits, logPatterns));
+}
+
+SecurityResults SecurityScanner::finish(const PatternCounts &log) const {
+  SecurityResults s;
+  s.securityPatternsDiff = diff_[Pattern::SecurityWord];
+  s.cvePatterns = diff_[Pattern::CveId];
+  s.memorySafetyIssues = diff_[Pattern::MemorySafety];
+  s.crashFixes = diff_[Pattern::Crash];
+  s.securityKeywordsCommits = log[Pattern::SecurityWord];
   return s;
 }
 
+PairScanner::PairScanner(PairCache &cache, KeywordScanner &keywords, SecurityScanner &security, CliScanner &cli,
+                         ThreadPool *pool)
+    : cache_(cache), keywords_(keywords), security_(security), cli_(cli), pool_(pool) {}
+
+void PairScanner::attach(DiffSinks &sinks) {
+  sinks.pairKnown = [this](PairSection &section) { return known(section); };
+  sinks.pairHunks = [this](const std::vector<PairSection> &batch) { scan(batch); };
+}
+
+void PairScanner::scan(unsigned part, std::string_view hunks, PairFindings &out) {
+  if (part == SnapshotDiff) {
+    countPatterns(hunks, KeywordScanner::diffPatterns | SecurityScanner::diffPatterns, out.hits);
+  } else {
+    // The hunks alone read like a patch whose header was cut off; the lexers start over at each @@
+    CliScanner cli;
+    cli.feed(hunks);
+    out.cli = cli.findings();
+  }
+}
+
+static constexpr unsigned kPairParts[] = {SnapshotDiff, SnapshotCliDiff};
+
+bool PairScanner::known(PairSection &section) {
+  // All of the section's parts or none, as the hunks go nowhere else
+  PairFindings found[2];
+  for (std::size_t i = 0; i < 2; ++i) {
+    if ((section.parts & kPairParts[i]) &&
+        !cache_.find(PairCache::key(kPairParts[i], *section.change, *section.opts), found[i])) {
+      return false;
+    }
+  }
+  for (std::size_t i = 0; i < 2; ++i) {
+    if (!(section.parts & kPairParts[i])) continue;
+    add(kPairParts[i], found[i]);
+    section.shape = found[i].shape;
+  }
+  return true;
+}
+
+void PairScanner::scan(const std::vector<PairSection> &batch) {
+  struct Job {
+    const PairSection *section;
+    unsigned part;
+    PairFindings findings;
+  };
+  std::vector<Job> jobs;
+  for (const PairSection &section : batch) {
+    for (unsigned part : kPairParts) {
+      if (section.parts & part) jobs.push_back({&section, part, {}});
+    }
+  }
+  parallelFor(pool_, jobs.size(), [&](std::size_t i) { scan(jobs[i].part, jobs[i].section->hunks, jobs[i].findings); });
+  for (Job &job : jobs) {
+    job.findings.shape = job.section->shape;
+    cache_.add(PairCache::key(job.part, *job.section->change, *job.section->opts), job.findings);
+    add(job.part, job.findings);
+  }
+}
+
+void PairScanner::add(unsigned part, const PairFindings &findings) {
+  if (part == SnapshotDiff) {
+    keywords_.add(findings.hits);
+    security_.add(findings.hits);
+  } else {
+    cli_.add(findings.cli);
+  }
+}
+
+PatternCounts countRangeLog(const std::string &repoRoot, const std::string &baseRef, const std::string &targetRef,
+                            CommitCache &cache, ThreadPool *pool) {
+  const std::string range = baseRef + ".." + targetRef;
+  std::string listed;
+  // With nothing cached, listing the range first would only walk it twice
+  const bool haveList = !cache.empty() && runGitCapture({"rev-list", range}, repoRoot, listed) == 0;
+  PatternCounts totals;
+  std::vector<std::string> missing;
+  std::istringstream lines(listed);
+  for (std::string line; haveList && std::getline(lines, line);) {
+    PatternCounts counts;
+    if (cache.find(ObjectId::fromHex(line), counts)) totals += counts;
+    else missing.push_back(line);
+  }
+  if (haveList && missing.empty()) return totals;
+
+  std::vector<std::string> args = {"log", "-z", "--format=%H %s %b"};
+  if (haveList && missing.size() <= kListedCommits) {
+    args.push_back("--no-walk=unsorted");
+    args.insert(args.end(), missing.begin(), missing.end());
+  } else {
+    args.push_back(range);
+    totals = PatternCounts{};
+  }
+  CommitLogScanner scanner(cache.patterns(), true);
+  LineStreamOptions records;
+  records.delimiter = '\0';
+  streamGit(args, repoRoot, [&](std::string_view batch) { scanner.feed(batch, pool); }, records);
+  // Every commit fetched is stored, with or without hits
+  auto hit = scanner.hits().begin();
+  for (std::size_t i = 0; i < scanner.ids().size(); ++i) {
+    PatternCounts counts;
+    if (hit != scanner.hits().end() && hit->commit == i) counts = (hit++)->counts;
+    cache.add(scanner.ids()[i], counts);
+  }
+  return totals += scanner.totals();
+}
+
 int baseDeltaFor(const std::string &bumpType, int loc, const ConfigValues &cfg) {
   // Use config-driven base deltas and divisors (mirrors shell math: rounded additions)
   if (bumpType == "patch") {
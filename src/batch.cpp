@@ -0,0 +1,380 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/batch.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "next_version/analyzers.h"
+#include "next_version/output_formatter.h"
+#include "next_version/task_graph.h"
+#include "next_version/util.h"
+
+namespace nv {
+
+namespace {
+
+struct JsonValue {
+  enum Kind { String, Number, Bool, Null } kind {Null};
+  std::string text;        // a string's contents
+  std::string_view raw;    // the value as written
+  bool flag {false};
+};
+
+// The values of one flat JSON object, read front to back; the first error
+// sticks.
+struct JsonReader {
+  std::string_view s;
+  std::size_t pos {0};
+  std::string error;
+
+  bool fail(std::string why) {
+    if (error.empty()) error = std::move(why);
+    return false;
+  }
+  void skip() {
+    while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\r' || s[pos] == '\n')) ++pos;
+  }
+  bool peek(char c) {
+    skip();
+    return pos < s.size() && s[pos] == c;
+  }
+  bool expect(char c) {
+    if (peek(c)) return ++pos, true;
+    return fail(std::string("expected '") + c + "' at offset " + std::to_string(pos));
+  }
+
+  bool hex4(unsigned &out) {
+    if (s.size() - pos < 4) return fail("short \\u escape");
+    out = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char c = s[pos++];
+      out <<= 4;
+      if (c >= '0' && c <= '9') out |= static_cast<unsigned>(c - '0');
+      else if (c >= 'a' && c <= 'f') out |= static_cast<unsigned>(c - 'a' + 10);
+      else if (c >= 'A' && c <= 'F') out |= static_cast<unsigned>(c - 'A' + 10);
+      else return fail("bad \\u escape");
+    }
+    return true;
+  }
+
+  bool string(std::string &out) {
+    if (!expect('"')) return false;
+    out.clear();
+    while (pos < s.size()) {
+      const char c = s[pos++];
+      if (c == '"') return true;
+      if (static_cast<unsigned char>(c) < 0x20) return fail("control character in a string");
+      if (c != '\\') {
+        out.push_back(c);
+        continue;
+      }
+      if (pos == s.size()) break;
+      switch (const char e = s[pos++]) {
+        case '"': case '\\': case '/': out.push_back(e); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+          unsigned cp;
+          if (!hex4(cp)) return false;
+          if (cp >= 0xd800 && cp < 0xdc00) {
+            unsigned low;
+            if (s.substr(pos, 2) != "\\u") return fail("unpaired surrogate");
+            pos += 2;
+            if (!hex4(low)) return false;
+            if (low < 0xdc00 || low >= 0xe000) return fail("unpaired surrogate");
+            cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+          } else if (cp >= 0xdc00 && cp < 0xe000) {
+            return fail("unpaired surrogate");
+          }
+          // UTF-8
+          if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+          } else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | cp >> 6));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+          } else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | cp >> 12));
+            out.push_back(static_cast<char>(0x80 | (cp >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+          } else {
+            out.push_back(static_cast<char>(0xf0 | cp >> 18));
+            out.push_back(static_cast<char>(0x80 | (cp >> 12 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+          }
+          break;
+        }
+        default: return fail("bad escape in a string");
+      }
+    }
+    return fail("unterminated string");
+  }
+
+  bool digits() {
+    const std::size_t start = pos;
+    while (pos < s.size() && s[pos] >= '0' && s[pos] <= '9') ++pos;
+    return pos > start || fail("bad number");
+  }
+
+  bool value(JsonValue &v) {
+    skip();
+    const std::size_t start = pos;
+    v = JsonValue{};
+    if (pos == s.size()) return fail("missing value");
+    const char c = s[pos];
+    bool ok = true;
+    if (c == '"') {
+      v.kind = JsonValue::String;
+      ok = string(v.text);
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+      v.kind = JsonValue::Number;
+      if (c == '-') ++pos;
+      ok = digits();
+      if (ok && pos < s.size() && s[pos] == '.') ++pos, ok = digits();
+      if (ok && pos < s.size() && (s[pos] == 'e' || s[pos] == 'E')) {
+        ++pos;
+        if (pos < s.size() && (s[pos] == '+' || s[pos] == '-')) ++pos;
+        ok = digits();
+      }
+    } else if (s.substr(pos, 4) == "true" || s.substr(pos, 5) == "false") {
+      v.kind = JsonValue::Bool;
+      v.flag = c == 't';
+      pos += v.flag ? 4 : 5;
+    } else if (s.substr(pos, 4) == "null") {
+      pos += 4;
+    } else if (c == '{' || c == '[') {
+      return fail("nested objects and arrays are not job fields");
+    } else {
+      return fail("bad value at offset " + std::to_string(pos));
+    }
+    v.raw = s.substr(start, pos - start);
+    return ok;
+  }
+};
+
+const std::pair<const char *, std::string Options::*> kStringFields[] = {
+  {"repo", &Options::repoRoot},        {"base", &Options::baseRef},         {"target", &Options::targetRef},
+  {"since", &Options::sinceTag},       {"since_commit", &Options::sinceCommit}, {"since_date", &Options::sinceDate},
+  {"tag_match", &Options::tagMatch},   {"only_paths", &Options::onlyPaths}, {"shared_cache", &Options::sharedCacheDir},
+};
+
+const std::pair<const char *, bool Options::*> kFlagFields[] = {
+  {"ignore_whitespace", &Options::ignoreWhitespace}, {"native_git", &Options::nativeGit},
+  {"first_parent", &Options::firstParent},           {"no_merge_base", &Options::noMergeBase},
+  {"no_cache", &Options::noCache},
+};
+
+bool applyField(JsonReader &r, const std::string &key, const JsonValue &v, BatchJob &job) {
+  if (key == "id") {
+    if (v.kind != JsonValue::String && v.kind != JsonValue::Number) return r.fail("\"id\" expects a string or a number");
+    job.id = std::string(v.raw);
+    return true;
+  }
+  for (const auto &[name, field] : kStringFields) {
+    if (key != name) continue;
+    if (v.kind != JsonValue::String) return r.fail("\"" + key + "\" expects a string");
+    job.opts.*field = v.text;
+    return true;
+  }
+  for (const auto &[name, field] : kFlagFields) {
+    if (key != name) continue;
+    if (v.kind != JsonValue::Bool) return r.fail("\"" + key + "\" expects true or false");
+    job.opts.*field = v.flag;
+    return true;
+  }
+  if (key == "rename_threshold") {
+    const bool whole = v.kind == JsonValue::Number && isInteger(std::string(v.raw)) && v.raw[0] != '-' && v.raw.size() <= 3;
+    const int percent = whole ? std::stoi(std::string(v.raw)) : 0;
+    if (percent < 1 || percent > 100) return r.fail("\"rename_threshold\" expects a percentage between 1 and 100");
+    job.opts.renameThreshold = percent;
+    return true;
+  }
+  return r.fail("unknown field \"" + key + "\"");
+}
+
+std::string repoKey(const std::string &repoRoot) {
+  std::error_code ec;
+  const std::filesystem::path path = std::filesystem::weakly_canonical(repoRoot.empty() ? "." : repoRoot, ec);
+  return ec ? repoRoot : path.string();
+}
+
+void writeHead(std::ostream &o, const BatchJob &job) {
+  o << "{\"line\":" << job.line;
+  if (!job.id.empty()) o << ",\"id\":" << job.id;
+}
+
+}
+
+bool parseBatchJob(std::string_view text, const Options &defaults, BatchJob &job) {
+  job.opts = defaults;
+  job.opts.batchFile.clear();
+  job.id.clear();
+  job.error.clear();
+  JsonReader r {text, 0, {}};
+  bool ok = r.expect('{');
+  if (ok && r.peek('}')) {
+    ++r.pos;
+  } else {
+    while (ok) {
+      std::string key;
+      JsonValue v;
+      ok = r.string(key) && r.expect(':') && r.value(v) && applyField(r, key, v, job);
+      if (ok && r.peek('}')) {
+        ++r.pos;
+        break;
+      }
+      ok = ok && r.expect(',');
+    }
+  }
+  r.skip();
+  if (ok && r.pos != text.size()) ok = r.fail("text after the job object");
+  job.error = r.error;
+  return ok;
+}
+
+std::string formatBatchResult(const BatchJob &job, const AnalysisResult &result, const ConfigValues &cfg) {
+  auto flagTrue = [&](const char *k) {
+    auto it = result.cli.find(k); return it != result.cli.end() && it->second == "true";
+  };
+  auto count = [&](const char *k) {
+    auto it = result.cli.find(k); return intOrDefault(it != result.cli.end() ? it->second : "", 0);
+  };
+  const LocDeltas deltas = computeLocDeltas(result.currentVersion, result.totalBonus, result.loc, cfg);
+  std::ostringstream o;
+  writeHead(o, job);
+  o << ",\"repo\":\"" << jsonEscape(job.opts.repoRoot) << "\"";
+  o << ",\"suggestion\":\"" << jsonEscape(result.suggestion) << "\"";
+  o << ",\"current_version\":\"" << jsonEscape(result.currentVersion) << "\"";
+  if (!result.nextVersion.empty()) o << ",\"next_version\":\"" << jsonEscape(result.nextVersion) << "\"";
+  o << ",\"total_bonus\":" << result.totalBonus;
+  o << ",\"manual_cli_changes\":" << (flagTrue("MANUAL_CLI_CHANGES") ? "true" : "false");
+  o << ",\"manual_added_long_count\":" << count("MANUAL_ADDED_LONG_COUNT");
+  o << ",\"manual_removed_long_count\":" << count("MANUAL_REMOVED_LONG_COUNT");
+  o << ",\"base_ref\":\"" << jsonEscape(result.baseRef) << "\"";
+  o << ",\"target_ref\":\"" << jsonEscape(result.targetRef) << "\"";
+  o << ",\"loc_delta\":{\"patch_delta\":" << deltas.patch << ",\"minor_delta\":" << deltas.minor
+    << ",\"major_delta\":" << deltas.major << "}}";
+  return o.str();
+}
+
+std::string formatBatchError(const BatchJob &job) {
+  std::ostringstream o;
+  writeHead(o, job);
+  o << ",\"error\":\"" << jsonEscape(job.error) << "\"}";
+  return o.str();
+}
+
+int runBatch(std::istream &in, std::ostream &out, const Options &defaults, const BatchOptions &batch) {
+  struct Pending {
+    BatchJob job;
+    std::string repo;
+  };
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<Pending> queue;
+  std::map<std::string, unsigned> running;   // by repository
+  bool inputDone = false;
+  std::mutex configMutex;
+  std::map<std::string, ConfigValues> configs;
+  std::mutex outMutex;
+  bool failed = false;
+
+  auto emit = [&](const std::string &line, bool error) {
+    std::lock_guard<std::mutex> lock(outMutex);
+    out << line << '\n' << std::flush;
+    failed |= error;
+  };
+  auto configFor = [&](const Pending &p) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    auto it = configs.find(p.repo);
+    if (it == configs.end()) it = configs.emplace(p.repo, loadConfigValues(p.job.opts.repoRoot)).first;
+    return it->second;
+  };
+  auto run = [&](Pending &p) {
+    try {
+      const ConfigValues cfg = configFor(p);
+      emit(formatBatchResult(p.job, batch.analyze(p.job.opts, cfg), cfg), false);
+    } catch (const std::exception &e) {
+      p.job.error = e.what();
+      emit(formatBatchError(p.job), true);
+    }
+  };
+  auto work = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      // The oldest job whose repository has room
+      const auto next = std::find_if(queue.begin(), queue.end(), [&](const Pending &p) { return running[p.repo] < batch.perRepo; });
+      if (next == queue.end()) {
+        if (inputDone && queue.empty()) return;
+        wake.wait(lock);
+        continue;
+      }
+      Pending p = std::move(*next);
+      queue.erase(next);
+      ++running[p.repo];
+      lock.unlock();
+      run(p);
+      lock.lock();
+      --running[p.repo];
+      wake.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < std::max(1u, batch.workers); ++i) workers.emplace_back(work);
+  std::string text;
+  for (std::size_t line = 1; std::getline(in, text); ++line) {
+    if (text.find_first_not_of(" \t\r") == std::string::npos) continue;
+    Pending p;
+    p.job.line = line;
+    if (!parseBatchJob(text, defaults, p.job)) {
+      emit(formatBatchError(p.job), true);
+      continue;
+    }
+    p.job.opts.jobs = 1;   // the batch runs jobs side by side instead
+    p.repo = repoKey(p.job.opts.repoRoot);
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(std::move(p));
+    wake.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    inputDone = true;
+  }
+  wake.notify_all();
+  for (std::thread &t : workers) t.join();
+  return failed ? 1 : 0;
+}
+
+int runBatch(const Options &opts) {
+  BatchOptions batch;
+  batch.workers = effectiveJobs(opts.jobs);
+  if (opts.batchFile == "-") return runBatch(std::cin, std::cout, opts, batch);
+  std::ifstream in(opts.batchFile);
+  if (!in) {
+    std::cerr << "Error: cannot read batch file " << opts.batchFile << "\n";
+    return 1;
+  }
+  return runBatch(in, std::cout, opts, batch);
+}
+
+}
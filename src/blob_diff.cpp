@@ -0,0 +1,758 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/blob_diff.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace nv {
+
+namespace {
+
+// Tuning constants shared with git's xdiff, so hunk boundaries agree with it.
+constexpr long kMaxCostMin = 256;
+constexpr long kHeurMinCost = 256;
+constexpr long kSnakeCnt = 20;
+constexpr long kHeurK = 4;
+constexpr long kMaxEqLimit = 1024;
+constexpr long kSimScanWindow = 100;
+constexpr long kDiscardRunK = 4;
+constexpr long kLineMax = std::numeric_limits<long>::max();
+constexpr int kMaxIndent = 200;
+constexpr int kMaxBlanks = 20;
+constexpr long kIndentMaxSliding = 100;
+constexpr std::size_t kHistogramMaxChain = 64;
+constexpr std::size_t kFuncNameMax = 80;
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+bool isAlpha(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+constexpr std::uint64_t kHashMul = 0x9e3779b97f4a7c15ULL;
+
+std::uint64_t mixWord(std::uint64_t h, std::uint64_t w) {
+  h ^= w;
+  h *= kHashMul;
+  return h ^ (h >> 29);
+}
+
+// Eight bytes per step; the tail is packed into one final word.
+std::uint64_t hashBytes(std::string_view s) {
+  std::uint64_t h = 0x243f6a8885a308d3ULL ^ s.size();
+  std::size_t i = 0;
+  for (; i + 8 <= s.size(); i += 8) {
+    std::uint64_t w;
+    std::memcpy(&w, s.data() + i, 8);
+    h = mixWord(h, w);
+  }
+  std::uint64_t tail = 0;
+  for (std::size_t k = 0; i + k < s.size(); ++k) {
+    tail |= std::uint64_t{static_cast<unsigned char>(s[i + k])} << (8 * k);
+  }
+  return mixWord(h, tail);
+}
+
+std::uint64_t hashIgnoringSpace(std::string_view s) {
+  std::uint64_t h = 0x13198a2e03707344ULL;
+  for (char c : s) {
+    if (!isSpace(c)) h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+  }
+  return mixWord(h, 0);
+}
+
+bool equalIgnoringSpace(std::string_view a, std::string_view b) {
+  std::size_t i = 0, j = 0;
+  for (;;) {
+    while (i < a.size() && isSpace(a[i])) ++i;
+    while (j < b.size() && isSpace(b[j])) ++j;
+    if (i == a.size() || j == b.size()) return i == a.size() && j == b.size();
+    if (a[i++] != b[j++]) return false;
+  }
+}
+
+long bogoSqrt(long n) {
+  long i = 1;
+  for (; n > 0; n >>= 2) i <<= 1;
+  return i;
+}
+
+// Equivalence classes of lines across both blobs; class ids replace line
+// comparisons everywhere after this step.
+struct Classifier {
+  struct Entry {
+    std::string_view key;
+    long next;
+    long count[2];
+  };
+  bool ignoreWhitespace;
+  std::vector<Entry> entries;
+  std::unordered_map<std::uint64_t, long> heads;
+
+  long classify(std::string_view line, std::uint64_t hash, int side) {
+    auto [it, inserted] = heads.emplace(hash, -1);
+    for (long c = it->second; c >= 0; c = entries[static_cast<std::size_t>(c)].next) {
+      Entry &e = entries[static_cast<std::size_t>(c)];
+      if (ignoreWhitespace ? equalIgnoringSpace(e.key, line) : e.key == line) {
+        ++e.count[side];
+        return c;
+      }
+    }
+    const long id = static_cast<long>(entries.size());
+    entries.push_back({line, it->second, {side == 0 ? 1L : 0L, side == 1 ? 1L : 0L}});
+    it->second = id;
+    return id;
+  }
+};
+
+// One side of the diff in xdiff's terms: line classes, the changed-line map
+// (with a zero sentinel on each end) and the reduced line set fed to Myers.
+struct Side {
+  const LineTable *lines {nullptr};
+  long nrec {0};
+  std::vector<long> ha;
+  std::vector<char> changedStore;
+  char *rchg {nullptr};
+  std::vector<long> rindex;
+  std::vector<long> reduced;
+  long nreff {0};
+  long dstart {0};
+  long dend {-1};
+
+  void init(const LineTable &table, Classifier &cls, int side) {
+    lines = &table;
+    nrec = static_cast<long>(table.size());
+    ha.resize(table.size());
+    for (std::size_t i = 0; i < table.size(); ++i) ha[i] = cls.classify(table.line(i), table.hash(i), side);
+    changedStore.assign(table.size() + 2, 0);
+    rchg = changedStore.data() + 1;
+  }
+};
+
+struct MyersEnv {
+  long mxcost;
+  long snakeCnt;
+  long heurMin;
+};
+
+struct SplitPoint {
+  long i1 {0};
+  long i2 {0};
+  bool minLo {false};
+  bool minHi {false};
+};
+
+// Find the middle snake of the box, or a good-enough split once the edit cost
+// passes the heuristic limits (xdiff's xdl_split).
+void split(const long *ha1, long off1, long lim1, const long *ha2, long off2, long lim2,
+           long *kvdf, long *kvdb, bool needMin, SplitPoint &spl, const MyersEnv &env) {
+  const long dmin = off1 - lim2, dmax = lim1 - off2;
+  const long fmid = off1 - off2, bmid = lim1 - lim2;
+  const bool odd = ((fmid - bmid) & 1) != 0;
+  long fmin = fmid, fmax = fmid;
+  long bmin = bmid, bmax = bmid;
+
+  kvdf[fmid] = off1;
+  kvdb[bmid] = lim1;
+
+  for (long ec = 1;; ec++) {
+    bool gotSnake = false;
+
+    if (fmin > dmin) kvdf[--fmin - 1] = -1;
+    else ++fmin;
+    if (fmax < dmax) kvdf[++fmax + 1] = -1;
+    else --fmax;
+
+    for (long d = fmax; d >= fmin; d -= 2) {
+      long i1 = kvdf[d - 1] >= kvdf[d + 1] ? kvdf[d - 1] + 1 : kvdf[d + 1];
+      const long prev1 = i1;
+      long i2 = i1 - d;
+      for (; i1 < lim1 && i2 < lim2 && ha1[i1] == ha2[i2]; i1++, i2++) {}
+      if (i1 - prev1 > env.snakeCnt) gotSnake = true;
+      kvdf[d] = i1;
+      if (odd && bmin <= d && d <= bmax && kvdb[d] <= i1) {
+        spl = {i1, i2, true, true};
+        return;
+      }
+    }
+
+    if (bmin > dmin) kvdb[--bmin - 1] = kLineMax;
+    else ++bmin;
+    if (bmax < dmax) kvdb[++bmax + 1] = kLineMax;
+    else --bmax;
+
+    for (long d = bmax; d >= bmin; d -= 2) {
+      long i1 = kvdb[d - 1] < kvdb[d + 1] ? kvdb[d - 1] : kvdb[d + 1] - 1;
+      const long prev1 = i1;
+      long i2 = i1 - d;
+      for (; i1 > off1 && i2 > off2 && ha1[i1 - 1] == ha2[i2 - 1]; i1--, i2--) {}
+      if (prev1 - i1 > env.snakeCnt) gotSnake = true;
+      kvdb[d] = i1;
+      if (!odd && fmin <= d && d <= fmax && i1 <= kvdf[d]) {
+        spl = {i1, i2, true, true};
+        return;
+      }
+    }
+
+    if (needMin) continue;
+
+    // Past the heuristic cost, accept a diagonal that has come far along a
+    // long enough snake.
+    if (gotSnake && ec > env.heurMin) {
+      long best = 0;
+      for (long d = fmax; d >= fmin; d -= 2) {
+        const long dd = d > fmid ? d - fmid : fmid - d;
+        const long i1 = kvdf[d];
+        const long i2 = i1 - d;
+        const long v = (i1 - off1) + (i2 - off2) - dd;
+        if (v > kHeurK * ec && v > best && off1 + env.snakeCnt <= i1 && i1 < lim1 &&
+            off2 + env.snakeCnt <= i2 && i2 < lim2) {
+          for (long k = 1; ha1[i1 - k] == ha2[i2 - k]; k++) {
+            if (k == env.snakeCnt) {
+              best = v;
+              spl.i1 = i1;
+              spl.i2 = i2;
+              break;
+            }
+          }
+        }
+      }
+      if (best > 0) {
+        spl.minLo = true;
+        spl.minHi = false;
+        return;
+      }
+
+      for (long d = bmax; d >= bmin; d -= 2) {
+        const long dd = d > bmid ? d - bmid : bmid - d;
+        const long i1 = kvdb[d];
+        const long i2 = i1 - d;
+        const long v = (lim1 - i1) + (lim2 - i2) - dd;
+        if (v > kHeurK * ec && v > best && off1 < i1 && i1 <= lim1 - env.snakeCnt &&
+            off2 < i2 && i2 <= lim2 - env.snakeCnt) {
+          for (long k = 0; ha1[i1 + k] == ha2[i2 + k]; k++) {
+            if (k == env.snakeCnt - 1) {
+              best = v;
+              spl.i1 = i1;
+              spl.i2 = i2;
+              break;
+            }
+          }
+        }
+      }
+      if (best > 0) {
+        spl.minLo = false;
+        spl.minHi = true;
+        return;
+      }
+    }
+
+    // Too expensive: take the furthest reaching path in either direction.
+    if (ec >= env.mxcost) {
+      long fbest = -1, fbest1 = -1;
+      for (long d = fmax; d >= fmin; d -= 2) {
+        long i1 = std::min(kvdf[d], lim1);
+        long i2 = i1 - d;
+        if (lim2 < i2) {
+          i1 = lim2 + d;
+          i2 = lim2;
+        }
+        if (fbest < i1 + i2) {
+          fbest = i1 + i2;
+          fbest1 = i1;
+        }
+      }
+      long bbest = kLineMax, bbest1 = kLineMax;
+      for (long d = bmax; d >= bmin; d -= 2) {
+        long i1 = std::max(off1, kvdb[d]);
+        long i2 = i1 - d;
+        if (i2 < off2) {
+          i1 = off2 + d;
+          i2 = off2;
+        }
+        if (i1 + i2 < bbest) {
+          bbest = i1 + i2;
+          bbest1 = i1;
+        }
+      }
+      if ((lim1 + lim2) - bbest < fbest - (off1 + off2)) spl = {fbest1, fbest - fbest1, true, false};
+      else spl = {bbest1, bbest - bbest1, false, true};
+      return;
+    }
+  }
+}
+
+struct MyersInput {
+  const long *ha;       // classes of the lines taking part
+  const long *rindex;   // their line numbers in the blob
+  char *rchg;
+};
+
+void compareRecords(const MyersInput &a, long off1, long lim1, const MyersInput &b, long off2, long lim2,
+                    long *kvdf, long *kvdb, bool needMin, const MyersEnv &env) {
+  while (off1 < lim1 && off2 < lim2 && a.ha[off1] == b.ha[off2]) { off1++; off2++; }
+  while (off1 < lim1 && off2 < lim2 && a.ha[lim1 - 1] == b.ha[lim2 - 1]) { lim1--; lim2--; }
+
+  if (off1 == lim1) {
+    for (; off2 < lim2; off2++) b.rchg[b.rindex[off2]] = 1;
+  } else if (off2 == lim2) {
+    for (; off1 < lim1; off1++) a.rchg[a.rindex[off1]] = 1;
+  } else {
+    SplitPoint spl;
+    split(a.ha, off1, lim1, b.ha, off2, lim2, kvdf, kvdb, needMin, spl, env);
+    compareRecords(a, off1, spl.i1, b, off2, spl.i2, kvdf, kvdb, spl.minLo, env);
+    compareRecords(a, spl.i1, lim1, b, spl.i2, lim2, kvdf, kvdb, spl.minHi, env);
+  }
+}
+
+// Run Myers over reduced line sets of n1 and n2 entries.
+void runMyers(const MyersInput &a, long n1, const MyersInput &b, long n2) {
+  const long ndiags = n1 + n2 + 3;
+  std::vector<long> kv(static_cast<std::size_t>(2 * ndiags + 2));
+  long *kvdf = kv.data() + n2 + 1;
+  long *kvdb = kv.data() + ndiags + n2 + 1;
+  MyersEnv env {std::max(bogoSqrt(ndiags), kMaxCostMin), kSnakeCnt, kHeurMinCost};
+  compareRecords(a, 0, n1, b, 0, n2, kvdf, kvdb, false, env);
+}
+
+void trimEnds(Side &a, Side &b) {
+  const long lim = std::min(a.nrec, b.nrec);
+  long i = 0;
+  while (i < lim && a.ha[static_cast<std::size_t>(i)] == b.ha[static_cast<std::size_t>(i)]) ++i;
+  a.dstart = b.dstart = i;
+  long j = 0;
+  while (j < lim - i && a.ha[static_cast<std::size_t>(a.nrec - 1 - j)] == b.ha[static_cast<std::size_t>(b.nrec - 1 - j)]) ++j;
+  a.dend = a.nrec - j - 1;
+  b.dend = b.nrec - j - 1;
+}
+
+// A line that matches many lines on the other side is dropped from the Myers
+// input when it sits inside a run of lines that match nothing.
+bool discardMultiMatch(const std::vector<char> &dis, long i, long s, long e) {
+  if (i - s > kSimScanWindow) s = i - kSimScanWindow;
+  if (e - i > kSimScanWindow) e = i + kSimScanWindow;
+  auto at = [&](long k) { return dis[static_cast<std::size_t>(k)]; };
+
+  long rdis0 = 0, rpdis0 = 1;
+  for (long r = 1; i - r >= s; r++) {
+    if (!at(i - r)) rdis0++;
+    else if (at(i - r) == 2) rpdis0++;
+    else break;
+  }
+  if (rdis0 == 0) return false;
+  long rdis1 = 0, rpdis1 = 1;
+  for (long r = 1; i + r <= e; r++) {
+    if (!at(i + r)) rdis1++;
+    else if (at(i + r) == 2) rpdis1++;
+    else break;
+  }
+  if (rdis1 == 0) return false;
+  rdis1 += rdis0;
+  rpdis1 += rpdis0;
+  return rpdis1 * kDiscardRunK < rpdis1 + rdis1;
+}
+
+void cleanupRecords(Side &side, const Classifier &cls, int other) {
+  const long mlim = std::min(bogoSqrt(side.nrec), kMaxEqLimit);
+  std::vector<char> dis(static_cast<std::size_t>(side.nrec + 1), 0);
+  for (long i = side.dstart; i <= side.dend; i++) {
+    const long nm = cls.entries[static_cast<std::size_t>(side.ha[static_cast<std::size_t>(i)])].count[other];
+    dis[static_cast<std::size_t>(i)] = nm == 0 ? 0 : nm >= mlim ? 2 : 1;
+  }
+  side.rindex.clear();
+  side.reduced.clear();
+  for (long i = side.dstart; i <= side.dend; i++) {
+    const char d = dis[static_cast<std::size_t>(i)];
+    if (d == 1 || (d == 2 && !discardMultiMatch(dis, i, side.dstart, side.dend))) {
+      side.rindex.push_back(i);
+      side.reduced.push_back(side.ha[static_cast<std::size_t>(i)]);
+    } else {
+      side.rchg[i] = 1;
+    }
+  }
+  side.nreff = static_cast<long>(side.rindex.size());
+}
+
+void classicDiff(Side &a, Side &b, const Classifier &cls) {
+  trimEnds(a, b);
+  cleanupRecords(a, cls, 1);
+  cleanupRecords(b, cls, 0);
+  runMyers({a.reduced.data(), a.rindex.data(), a.rchg}, a.nreff, {b.reduced.data(), b.rindex.data(), b.rchg}, b.nreff);
+}
+
+// Myers over a sub-box of the full line arrays, used when histogram gives up.
+void myersRange(Side &a, long a0, long a1, Side &b, long b0, long b1) {
+  std::vector<long> ra, rb;
+  for (long i = a0; i < a1; ++i) ra.push_back(i);
+  for (long i = b0; i < b1; ++i) rb.push_back(i);
+  runMyers({a.ha.data() + a0, ra.data(), a.rchg}, a1 - a0, {b.ha.data() + b0, rb.data(), b.rchg}, b1 - b0);
+}
+
+// Histogram diff: anchor on the longest common region whose rarest line
+// occurs least often in the old range, then recurse on both sides of it.
+void histogramRange(Side &a, long a0, long a1, Side &b, long b0, long b1) {
+  for (;;) {
+    if (a0 == a1) {
+      for (long i = b0; i < b1; ++i) b.rchg[i] = 1;
+      return;
+    }
+    if (b0 == b1) {
+      for (long i = a0; i < a1; ++i) a.rchg[i] = 1;
+      return;
+    }
+    auto ha = [&](long i) { return a.ha[static_cast<std::size_t>(i)]; };
+    auto hb = [&](long i) { return b.ha[static_cast<std::size_t>(i)]; };
+
+    std::unordered_map<long, std::vector<long>> occurrences;
+    for (long i = a0; i < a1; ++i) occurrences[ha(i)].push_back(i);
+
+    bool sawCommon = false;
+    std::size_t bestCount = kHistogramMaxChain + 1;
+    long bestA = 0, bestB = 0, bestLen = 0;
+    for (long bi = b0; bi < b1;) {
+      long nextB = bi + 1;
+      auto it = occurrences.find(hb(bi));
+      if (it != occurrences.end()) {
+        sawCommon = true;
+        if (it->second.size() <= bestCount) {
+          for (long ai : it->second) {
+            long as = ai, bs = bi, ae = ai + 1, be = bi + 1;
+            std::size_t rc = it->second.size();
+            while (as > a0 && bs > b0 && ha(as - 1) == hb(bs - 1)) {
+              --as; --bs;
+              rc = std::min(rc, occurrences[ha(as)].size());
+            }
+            while (ae < a1 && be < b1 && ha(ae) == hb(be)) {
+              rc = std::min(rc, occurrences[ha(ae)].size());
+              ++ae; ++be;
+            }
+            if (ae - as > bestLen || rc < bestCount) {
+              bestA = as; bestB = bs; bestLen = ae - as; bestCount = rc;
+            }
+            nextB = std::max(nextB, be);
+          }
+        }
+      }
+      bi = nextB;
+    }
+
+    if (bestLen == 0) {
+      if (sawCommon) {
+        myersRange(a, a0, a1, b, b0, b1);
+      } else {
+        for (long i = a0; i < a1; ++i) a.rchg[i] = 1;
+        for (long i = b0; i < b1; ++i) b.rchg[i] = 1;
+      }
+      return;
+    }
+    histogramRange(a, a0, bestA, b, b0, bestB);
+    a0 = bestA + bestLen;
+    b0 = bestB + bestLen;
+  }
+}
+
+// ---- change compaction (xdiff's xdl_change_compact) ----
+
+struct Group {
+  long start;
+  long end;
+};
+
+void groupInit(const Side &s, Group &g) {
+  g.start = g.end = 0;
+  while (s.rchg[g.end]) g.end++;
+}
+
+bool groupNext(const Side &s, Group &g) {
+  if (g.end == s.nrec) return false;
+  g.start = g.end + 1;
+  for (g.end = g.start; s.rchg[g.end]; g.end++) {}
+  return true;
+}
+
+bool groupPrevious(const Side &s, Group &g) {
+  if (g.start == 0) return false;
+  g.end = g.start - 1;
+  for (g.start = g.end; s.rchg[g.start - 1]; g.start--) {}
+  return true;
+}
+
+bool slideDown(Side &s, Group &g) {
+  if (g.end < s.nrec && s.ha[static_cast<std::size_t>(g.start)] == s.ha[static_cast<std::size_t>(g.end)]) {
+    s.rchg[g.start++] = 0;
+    s.rchg[g.end++] = 1;
+    while (s.rchg[g.end]) g.end++;
+    return true;
+  }
+  return false;
+}
+
+bool slideUp(Side &s, Group &g) {
+  if (g.start > 0 && s.ha[static_cast<std::size_t>(g.start - 1)] == s.ha[static_cast<std::size_t>(g.end - 1)]) {
+    s.rchg[--g.start] = 1;
+    s.rchg[--g.end] = 0;
+    while (s.rchg[g.start - 1]) g.start--;
+    return true;
+  }
+  return false;
+}
+
+int indentOf(std::string_view line) {
+  int ret = 0;
+  for (char c : line) {
+    if (!isSpace(c)) return ret;
+    if (c == ' ') ret += 1;
+    else if (c == '\t') ret += 8 - ret % 8;
+    if (ret >= kMaxIndent) return kMaxIndent;
+  }
+  return -1;   // blank line
+}
+
+struct SplitMeasurement {
+  bool endOfFile;
+  int indent;
+  int preBlank;
+  int preIndent;
+  int postBlank;
+  int postIndent;
+};
+
+struct SplitScore {
+  int effectiveIndent;
+  int penalty;
+};
+
+void measureSplit(const Side &s, long at, SplitMeasurement &m) {
+  auto indent = [&](long i) { return indentOf(s.lines->line(static_cast<std::size_t>(i))); };
+  if (at >= s.nrec) {
+    m.endOfFile = true;
+    m.indent = -1;
+  } else {
+    m.endOfFile = false;
+    m.indent = indent(at);
+  }
+  m.preBlank = 0;
+  m.preIndent = -1;
+  for (long i = at - 1; i >= 0; i--) {
+    m.preIndent = indent(i);
+    if (m.preIndent != -1) break;
+    m.preBlank += 1;
+    if (m.preBlank == kMaxBlanks) {
+      m.preIndent = 0;
+      break;
+    }
+  }
+  m.postBlank = 0;
+  m.postIndent = -1;
+  for (long i = at + 1; i < s.nrec; i++) {
+    m.postIndent = indent(i);
+    if (m.postIndent != -1) break;
+    m.postBlank += 1;
+    if (m.postBlank == kMaxBlanks) {
+      m.postIndent = 0;
+      break;
+    }
+  }
+}
+
+void scoreAddSplit(const SplitMeasurement &m, SplitScore &s) {
+  if (m.preIndent == -1 && m.preBlank == 0) s.penalty += 1;    // start of file
+  if (m.endOfFile) s.penalty += 21;
+  const int postBlank = m.indent == -1 ? 1 + m.postBlank : 0;
+  const int totalBlank = m.preBlank + postBlank;
+  s.penalty += -30 * totalBlank;
+  s.penalty += 6 * postBlank;
+  const int indent = m.indent != -1 ? m.indent : m.postIndent;
+  const bool anyBlanks = totalBlank != 0;
+  s.effectiveIndent += indent;
+  if (indent == -1 || m.preIndent == -1) {
+    // no adjustment
+  } else if (indent > m.preIndent) {
+    s.penalty += anyBlanks ? 10 : -4;
+  } else if (indent == m.preIndent) {
+    // no adjustment
+  } else if (m.postIndent != -1 && m.postIndent > indent) {
+    s.penalty += anyBlanks ? 17 : 24;
+  } else {
+    s.penalty += anyBlanks ? 17 : 23;
+  }
+}
+
+int scoreCompare(const SplitScore &s1, const SplitScore &s2) {
+  const int cmpIndents = (s1.effectiveIndent > s2.effectiveIndent) - (s1.effectiveIndent < s2.effectiveIndent);
+  return 60 * cmpIndents + (s1.penalty - s2.penalty);
+}
+
+// Slide each group of changed lines to its canonical position: merged with
+// neighbours where possible, aligned with a change on the other side, else at
+// the split the indent heuristic scores best.
+void compact(Side &s, Side &other) {
+  Group g, go;
+  groupInit(s, g);
+  groupInit(other, go);
+
+  for (;;) {
+    if (g.end != g.start) {
+      long groupSize, earliestEnd, endMatchingOther;
+      do {
+        groupSize = g.end - g.start;
+        endMatchingOther = -1;
+        while (slideUp(s, g)) groupPrevious(other, go);
+        earliestEnd = g.end;
+        if (go.end > go.start) endMatchingOther = g.end;
+        while (slideDown(s, g)) {
+          groupNext(other, go);
+          if (go.end > go.start) endMatchingOther = g.end;
+        }
+      } while (groupSize != g.end - g.start);
+
+      if (g.end == earliestEnd) {
+        // cannot move
+      } else if (endMatchingOther != -1) {
+        while (go.end == go.start) {
+          slideUp(s, g);
+          groupPrevious(other, go);
+        }
+      } else {
+        long shift = earliestEnd;
+        if (g.end - groupSize - 1 > shift) shift = g.end - groupSize - 1;
+        if (g.end - kIndentMaxSliding > shift) shift = g.end - kIndentMaxSliding;
+        long bestShift = -1;
+        SplitScore bestScore {0, 0};
+        for (; shift <= g.end; shift++) {
+          SplitMeasurement m;
+          SplitScore score {0, 0};
+          measureSplit(s, shift, m);
+          scoreAddSplit(m, score);
+          measureSplit(s, shift - groupSize, m);
+          scoreAddSplit(m, score);
+          if (bestShift == -1 || scoreCompare(score, bestScore) <= 0) {
+            bestScore = score;
+            bestShift = shift;
+          }
+        }
+        while (g.end > bestShift) {
+          slideUp(s, g);
+          groupPrevious(other, go);
+        }
+      }
+    }
+    if (!groupNext(s, g)) break;
+    groupNext(other, go);
+  }
+}
+
+// git's default funcname rule: a line starting with a letter, '_' or '$',
+// cut to 80 bytes with trailing whitespace removed.
+bool funcName(std::string_view line, std::string &name) {
+  if (line.empty() || !(isAlpha(line[0]) || line[0] == '_' || line[0] == '$')) return false;
+  std::size_t len = std::min(line.size(), kFuncNameMax);
+  while (len > 0 && isSpace(line[len - 1])) --len;
+  name.assign(line.substr(0, len));
+  return true;
+}
+
+void appendNumber(std::string &out, std::size_t n) {
+  out += std::to_string(n);
+}
+
+void appendLine(std::string &out, char prefix, std::string_view line) {
+  out.push_back(prefix);
+  out.append(line);
+  if (line.empty() || line.back() != '\n') out += "\n\\ No newline at end of file\n";
+}
+
+}  // namespace
+
+void LineTable::build(std::string_view text, bool ignoreWhitespace) {
+  text_ = text;
+  starts_.clear();
+  hashes_.clear();
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    const void *nl = std::memchr(text.data() + pos, '\n', text.size() - pos);
+    const std::size_t end = nl ? static_cast<std::size_t>(static_cast<const char *>(nl) - text.data()) + 1 : text.size();
+    const std::string_view line = text.substr(pos, end - pos);
+    starts_.push_back(pos);
+    hashes_.push_back(ignoreWhitespace ? hashIgnoringSpace(line) : hashBytes(line));
+    pos = end;
+  }
+  starts_.push_back(text.size());
+}
+
+void diffBlobs(std::string_view oldText, std::string_view newText, const BlobDiffOptions &opts, BlobDiff &out) {
+  out.oldLines.build(oldText, opts.ignoreWhitespace);
+  out.newLines.build(newText, opts.ignoreWhitespace);
+  out.hunks.clear();
+  out.insertions = out.deletions = 0;
+
+  Classifier cls {opts.ignoreWhitespace, {}, {}};
+  cls.entries.reserve(out.oldLines.size() + out.newLines.size());
+  Side a, b;
+  a.init(out.oldLines, cls, 0);
+  b.init(out.newLines, cls, 1);
+
+  if (opts.algorithm == DiffAlgorithm::Histogram) histogramRange(a, 0, a.nrec, b, 0, b.nrec);
+  else classicDiff(a, b, cls);
+  compact(a, b);
+  compact(b, a);
+
+  // Unchanged lines pair up in order, so one forward pass recovers the hunks.
+  long i1 = 0, i2 = 0;
+  while (i1 < a.nrec || i2 < b.nrec) {
+    if (a.rchg[i1] || b.rchg[i2]) {
+      const long s1 = i1, s2 = i2;
+      while (a.rchg[i1]) i1++;
+      while (b.rchg[i2]) i2++;
+      DiffHunk h;
+      h.oldBegin = static_cast<std::size_t>(s1);
+      h.oldCount = static_cast<std::size_t>(i1 - s1);
+      h.newBegin = static_cast<std::size_t>(s2);
+      h.newCount = static_cast<std::size_t>(i2 - s2);
+      out.deletions += static_cast<int>(h.oldCount);
+      out.insertions += static_cast<int>(h.newCount);
+      out.hunks.push_back(h);
+    } else {
+      i1++;
+      i2++;
+    }
+  }
+}
+
+void appendUnifiedHunks(const BlobDiff &diff, std::string &out) {
+  std::string func;
+  long prevSearch = -1;
+  for (const DiffHunk &h : diff.hunks) {
+    // Look upwards from the line before the hunk, stopping where the previous
+    // hunk's search began; if nothing turns up the previous name still applies.
+    const long start = static_cast<long>(h.oldBegin) - 1;
+    for (long l = start; l != prevSearch && l >= 0; --l) {
+      if (funcName(diff.oldLines.line(static_cast<std::size_t>(l)), func)) break;
+    }
+    prevSearch = start;
+
+    out += "@@ -";
+    appendNumber(out, h.oldCount ? h.oldBegin + 1 : h.oldBegin);
+    if (h.oldCount != 1) { out.push_back(','); appendNumber(out, h.oldCount); }
+    out += " +";
+    appendNumber(out, h.newCount ? h.newBegin + 1 : h.newBegin);
+    if (h.newCount != 1) { out.push_back(','); appendNumber(out, h.newCount); }
+    out += " @@";
+    if (!func.empty()) { out.push_back(' '); out += func; }
+    out.push_back('\n');
+    for (std::size_t i = 0; i < h.oldCount; ++i) appendLine(out, '-', diff.oldLines.line(h.oldBegin + i));
+    for (std::size_t i = 0; i < h.newCount; ++i) appendLine(out, '+', diff.newLines.line(h.newBegin + i));
+  }
+}
+
+}
@@ -0,0 +1,72 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/case_fold.h"
+
+#ifdef NEXT_VERSION_HAVE_SIMD
+#include <immintrin.h>
+#endif
+
+namespace nv {
+
+namespace {
+
+#ifdef NEXT_VERSION_HAVE_SIMD
+
+// Bytes in 'A'..'Z' get 0x20 added; signed compares leave bytes >= 0x80 alone.
+__attribute__((target("avx2")))
+std::size_t foldAvx2(const char *src, std::size_t n, char *dst) {
+  const __m256i below = _mm256_set1_epi8('A' - 1), above = _mm256_set1_epi8('Z' + 1), bit = _mm256_set1_epi8(0x20);
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, below), _mm256_cmpgt_epi8(above, v));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(v, _mm256_and_si256(upper, bit)));
+  }
+  return i;
+}
+
+__attribute__((target("sse2")))
+std::size_t foldSse2(const char *src, std::size_t n, char *dst) {
+  const __m128i below = _mm_set1_epi8('A' - 1), above = _mm_set1_epi8('Z' + 1), bit = _mm_set1_epi8(0x20);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmpgt_epi8(above, v));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(v, _mm_and_si128(upper, bit)));
+  }
+  return i;
+}
+
+#endif
+
+}
+
+void foldAscii(const char *src, std::size_t n, char *dst, SimdLevel level) {
+  std::size_t i = 0;
+#ifdef NEXT_VERSION_HAVE_SIMD
+  if (level == SimdLevel::Avx2) i = foldAvx2(src, n, dst);
+  else if (level == SimdLevel::Ssse3) i = foldSse2(src, n, dst);
+#else
+  (void)level;
+#endif
+  for (; i < n; ++i) {
+    const auto c = static_cast<unsigned char>(src[i]);
+    dst[i] = static_cast<char>(c >= 'A' && c <= 'Z' ? c + 32 : c);
+  }
+}
+
+void foldAscii(const char *src, std::size_t n, char *dst) { foldAscii(src, n, dst, detectSimdLevel()); }
+
+std::string_view FoldedText::append(std::string_view chunk) {
+  const std::size_t at = buf_.size();
+  buf_.resize(at + chunk.size());
+  foldAscii(chunk.data(), chunk.size(), buf_.data() + at);
+  return std::string_view(buf_).substr(at);
+}
+
+}
@@ -6,6 +6,7 @@
 // See the LICENSE file in the project root for details.
 
 #include "next_version/cli.h"
+#include "next_version/util.h"
 
 #include <cstdlib>
 #include <iostream>
@@ -47,6 +48,12 @@ Options:
   --no-merge-base          Disable automatic merge-base detection for disjoint branches
   --only-paths <globs>     Restrict analysis to comma-separated path globs
   --ignore-whitespace      Ignore whitespace changes in diff analysis
+  --native-git             Diff trees in-process instead of running git diff
+  --rename-threshold <n>   Minimum similarity percent for rename/copy detection (default: 50)
+  --jobs <n>               Run analysis phases and patch scans on up to n threads (default: available CPUs)
+  --no-cache               Do not read or write cached analysis results under .git/next-version
+  --shared-cache <dir>     Share analysis results with other runs on this host through a table in dir (e.g. /dev/shm)
+  --batch <file|->         Run the NDJSON jobs in file (or stdin), one JSON result line per job
   --verbose                Show detailed progress and debug lines on stderr
   --machine                Output machine-readable key=value (top-level result)
   --json                   Output machine-readable JSON (top-level result)
@@ -98,6 +105,30 @@ Options parseArgs(int argc, char **argv) {
     else if (arg == "--first-parent") opts.firstParent = true;
     else if (arg == "--only-paths") opts.onlyPaths = needValue(arg.c_str());
     else if (arg == "--ignore-whitespace") opts.ignoreWhitespace = true;
+    else if (arg == "--native-git") opts.nativeGit = true;
+    else if (arg == "--rename-threshold") {
+      const std::string value = needValue(arg.c_str());
+      if (!isInteger(value) || value[0] == '-' || value[0] == '+' || value.size() > 3 ||
+          std::stoi(value) < 1 || std::stoi(value) > 100) {
+        std::cerr << "Error: --rename-threshold expects a percentage between 1 and 100\n";
+        std::exit(1);
+      }
+      opts.renameThreshold = std::stoi(value);
+    }
+    else if (arg == "--jobs") {
+      const std::string value = needValue(arg.c_str());
+      if (!isInteger(value) || value[0] == '-' || value[0] == '+' || value.size() > 4 || std::stoi(value) < 1) {
+        std::cerr << "Error: --jobs expects a positive thread count\n";
+        std::exit(1);
+      }
+      opts.jobs = std::stoi(value);
+    }
+    else if (arg == "--no-cache") opts.noCache = true;
+    else if (arg == "--shared-cache") opts.sharedCacheDir = needValue(arg.c_str());
+    else if (arg == "--batch") {
+      if (i + 1 < argc && std::string(argv[i + 1]) == "-") opts.batchFile = argv[++i];
+      else opts.batchFile = needValue(arg.c_str());
+    }
     else if (arg == "--verbose") opts.verbose = true;
     else if (arg == "--machine") opts.machine = true;
     else if (arg == "--json") opts.json = true;
@@ -0,0 +1,86 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/commit_log.h"
+#include "next_version/security_tokens.h"
+#include "next_version/task_graph.h"
+
+#include <cstring>
+
+namespace nv {
+
+namespace {
+
+void splitRecords(std::string_view text, std::vector<std::string_view> &out) {
+  out.clear();
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    const void *nul = std::memchr(text.data() + pos, '\0', text.size() - pos);
+    const std::size_t end = nul ? static_cast<std::size_t>(static_cast<const char *>(nul) - text.data()) : text.size();
+    out.push_back(text.substr(pos, end - pos));
+    pos = end + 1;
+  }
+}
+
+bool any(const PatternCounts &c) {
+  for (int n : c.hits) {
+    if (n) return true;
+  }
+  return false;
+}
+
+struct Chunk {
+  std::size_t first {0};
+  std::size_t end {0};
+  std::vector<CommitLogScanner::Hit> hits;
+};
+
+void countChunk(const std::vector<std::string_view> &records, PatternSet patterns, std::size_t base, Chunk &chunk) {
+  for (std::size_t i = chunk.first; i < chunk.end; ++i) {
+    PatternCounts counts;
+    countPatterns(records[i], patterns, counts);
+    if (any(counts)) chunk.hits.push_back({base + i, counts});
+  }
+}
+
+}
+
+void CommitLogScanner::feed(std::string_view records, ThreadPool *pool) {
+  splitRecords(records, records_);
+  if (withIds_) {
+    for (std::string_view &r : records_) {
+      const std::size_t space = r.find(' ');
+      ids_.push_back(ObjectId::fromHex(r.substr(0, space)));
+      r.remove_prefix(space == std::string_view::npos ? r.size() : space + 1);
+    }
+  }
+  std::vector<Chunk> chunks;
+  for (std::size_t i = 0, bytes = 0; i < records_.size(); ++i) {
+    if (chunks.empty() || (pool && bytes >= kChunkBytes)) {
+      chunks.push_back({i, i, {}});
+      bytes = 0;
+    }
+    chunks.back().end = i + 1;
+    bytes += records_[i].size() + 1;
+  }
+  parallelFor(pool, chunks.size(), [&](std::size_t c) { countChunk(records_, patterns_, commits_, chunks[c]); });
+  for (const Chunk &chunk : chunks) {
+    for (const Hit &h : chunk.hits) {
+      totals_ += h.counts;
+      hits_.push_back(h);
+    }
+  }
+  commits_ += records_.size();
+}
+
+PatternCounts countCommitLog(std::string_view log, PatternSet patterns) {
+  CommitLogScanner scanner(patterns);
+  scanner.feed(log);
+  return scanner.totals();
+}
+
+}
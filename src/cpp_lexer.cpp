@@ -0,0 +1,216 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/cpp_lexer.h"
+
+#include <array>
+
+namespace nv {
+
+namespace {
+
+enum CharClass : std::uint8_t { Other, Space, Ident, Digit, Quote, Apostrophe, Slash, Colon, Dot };
+
+constexpr std::array<std::uint8_t, 256> makeClasses() {
+  std::array<std::uint8_t, 256> t {};
+  for (unsigned c = 0x80; c < 256; ++c) t[c] = Ident;   // UTF-8 in identifiers
+  for (unsigned c = 'a'; c <= 'z'; ++c) t[c] = Ident;
+  for (unsigned c = 'A'; c <= 'Z'; ++c) t[c] = Ident;
+  for (unsigned c = '0'; c <= '9'; ++c) t[c] = Digit;
+  t['_'] = Ident; t['$'] = Ident;
+  t[' '] = Space; t['\t'] = Space; t['\r'] = Space; t['\v'] = Space; t['\f'] = Space;
+  t['"'] = Quote; t['\''] = Apostrophe; t['/'] = Slash; t[':'] = Colon; t['.'] = Dot;
+  return t;
+}
+
+constexpr std::array<std::uint8_t, 256> kClass = makeClasses();
+
+inline std::uint8_t classOf(char c) { return kClass[static_cast<unsigned char>(c)]; }
+inline bool isIdentChar(char c) { return classOf(c) == Ident || classOf(c) == Digit; }
+
+// u8, u, U, L and R, and the raw forms u8R, uR, UR, LR: the identifiers that
+// start a literal when a quote follows.
+bool isLiteralPrefix(std::string_view id) {
+  if (!id.empty() && id.back() == 'R') id.remove_suffix(1);
+  return id.empty() || id == "u8" || id == "u" || id == "U" || id == "L";
+}
+
+inline void emit(std::vector<CppToken> &out, CppTokenKind kind, std::string_view line, std::size_t from, std::size_t to) {
+  out.push_back({kind, line.substr(from, to - from)});
+}
+
+}
+
+void CppLexer::reset() {
+  state_ = State::Code;
+  rawEnd_.clear();
+}
+
+// End of the literal opened before `pos` (just past its closing quote), or npos.
+std::size_t CppLexer::lexQuoted(std::string_view line, std::size_t pos, char quote) {
+  const char stops[] = {quote, '\\', '\0'};
+  for (;;) {
+    pos = line.find_first_of(std::string_view(stops, 2), pos);
+    if (pos == std::string_view::npos) return pos;
+    if (line[pos] == quote) return pos + 1;
+    pos += 2;
+    if (pos >= line.size()) return std::string_view::npos;
+  }
+}
+
+// Lex from `pos` until the line ends or a literal or comment stays open;
+// returns the position lexing stopped at.
+std::size_t CppLexer::lexCode(std::string_view line, std::size_t pos, std::vector<CppToken> &out) {
+  const std::size_t n = line.size();
+  while (pos < n) {
+    const char c = line[pos];
+    const std::size_t start = pos;
+    switch (classOf(c)) {
+    case Space:
+      ++pos;
+      break;
+    case Ident: {
+      while (pos < n && isIdentChar(line[pos])) ++pos;
+      const std::string_view id = line.substr(start, pos - start);
+      if (pos < n && (line[pos] == '"' || line[pos] == '\'') && isLiteralPrefix(id)) {
+        if (line[pos] == '"' && id.back() == 'R') {
+          // R"delim( ... )delim"; the delimiter is at most 16 characters
+          const std::size_t open = line.find('(', pos + 1);
+          if (open != std::string_view::npos && open - pos - 1 <= 16) {
+            rawEnd_.assign(")").append(line.substr(pos + 1, open - pos - 1)).push_back('"');
+            const std::size_t end = line.find(rawEnd_, open + 1);
+            if (end == std::string_view::npos) {
+              emit(out, CppTokenKind::String, line, start, n);
+              state_ = State::RawString;
+              return n;
+            }
+            pos = end + rawEnd_.size();
+            emit(out, CppTokenKind::String, line, start, pos);
+            break;
+          }
+        }
+        const char quote = line[pos];
+        const std::size_t end = lexQuoted(line, pos + 1, quote);
+        const CppTokenKind kind = quote == '"' ? CppTokenKind::String : CppTokenKind::Char;
+        if (end == std::string_view::npos) {
+          emit(out, kind, line, start, n);
+          state_ = quote == '"' ? State::String : State::Char;
+          return n;
+        }
+        pos = end;
+        emit(out, kind, line, start, pos);
+        break;
+      }
+      emit(out, CppTokenKind::Identifier, line, start, pos);
+      break;
+    }
+    case Dot:
+      if (pos + 1 >= n || classOf(line[pos + 1]) != Digit) {
+        ++pos;
+        emit(out, CppTokenKind::Punct, line, start, pos);
+        break;
+      }
+      [[fallthrough]];
+    case Digit:
+      // pp-number: digits, letters, '.', exponent signs and ' separators
+      for (++pos; pos < n; ++pos) {
+        const char d = line[pos];
+        if (isIdentChar(d) || d == '.') continue;
+        const char prev = line[pos - 1];
+        if ((d == '+' || d == '-') && (prev == 'e' || prev == 'E' || prev == 'p' || prev == 'P')) continue;
+        if (d == '\'' && pos + 1 < n && isIdentChar(line[pos + 1])) continue;
+        break;
+      }
+      emit(out, CppTokenKind::Number, line, start, pos);
+      break;
+    case Quote:
+    case Apostrophe: {
+      const std::size_t end = lexQuoted(line, pos + 1, c);
+      const CppTokenKind kind = c == '"' ? CppTokenKind::String : CppTokenKind::Char;
+      if (end == std::string_view::npos) {
+        emit(out, kind, line, start, n);
+        state_ = c == '"' ? State::String : State::Char;
+        return n;
+      }
+      pos = end;
+      emit(out, kind, line, start, pos);
+      break;
+    }
+    case Slash:
+      if (pos + 1 < n && line[pos + 1] == '/') {
+        emit(out, CppTokenKind::Comment, line, start, n);
+        state_ = State::LineComment;
+        return n;
+      }
+      if (pos + 1 < n && line[pos + 1] == '*') {
+        const std::size_t end = line.find("*/", pos + 2);
+        if (end == std::string_view::npos) {
+          emit(out, CppTokenKind::Comment, line, start, n);
+          state_ = State::BlockComment;
+          return n;
+        }
+        pos = end + 2;
+        emit(out, CppTokenKind::Comment, line, start, pos);
+        break;
+      }
+      ++pos;
+      emit(out, CppTokenKind::Punct, line, start, pos);
+      break;
+    case Colon:
+      pos += pos + 1 < n && line[pos + 1] == ':' ? 2 : 1;
+      emit(out, CppTokenKind::Punct, line, start, pos);
+      break;
+    default:
+      ++pos;
+      emit(out, CppTokenKind::Punct, line, start, pos);
+      break;
+    }
+  }
+  return pos;
+}
+
+void CppLexer::lexLine(std::string_view line, std::vector<CppToken> &out) {
+  std::size_t pos = 0;
+  while (pos < line.size()) {
+    std::size_t end = std::string_view::npos;
+    switch (state_) {
+    case State::Code:
+      pos = lexCode(line, pos, out);
+      continue;
+    case State::LineComment:
+      break;
+    case State::BlockComment:
+      end = line.find("*/", pos);
+      if (end != std::string_view::npos) end += 2;
+      break;
+    case State::String:
+      end = lexQuoted(line, pos, '"');
+      break;
+    case State::Char:
+      end = lexQuoted(line, pos, '\'');
+      break;
+    case State::RawString:
+      end = line.find(rawEnd_, pos);
+      if (end != std::string_view::npos) end += rawEnd_.size();
+      break;
+    }
+    const CppTokenKind kind = state_ == State::LineComment || state_ == State::BlockComment ? CppTokenKind::Comment
+                              : state_ == State::Char ? CppTokenKind::Char : CppTokenKind::String;
+    if (end == std::string_view::npos) {
+      emit(out, kind, line, pos, line.size());
+      break;
+    }
+    emit(out, kind, line, pos, end);
+    state_ = State::Code;
+    pos = end;
+  }
+  // Line comments and ordinary literals only go on after a backslash-newline
+  const bool spliced = !line.empty() && line.back() == '\\';
+  if (!spliced && (state_ == State::LineComment || state_ == State::String || state_ == State::Char)) state_ = State::Code;
+}
+
+}
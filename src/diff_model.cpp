@@ -0,0 +1,162 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/diff_model.h"
+
+#include <cstring>
+
+namespace nv {
+
+static bool startsWith(std::string_view s, std::string_view prefix) { return s.substr(0, prefix.size()) == prefix; }
+
+// One side of a hunk header, "-a,b" or "+c" (count 1); sets count to b.
+static bool parseRange(std::string_view h, std::size_t &i, char sign, long &count) {
+  if (i >= h.size() || h[i] != sign) return false;
+  ++i;
+  const std::size_t digits = i;
+  while (i < h.size() && h[i] >= '0' && h[i] <= '9') ++i;
+  if (i == digits) return false;
+  count = 1;
+  if (i < h.size() && h[i] == ',') {
+    count = 0;
+    const std::size_t from = ++i;
+    for (; i < h.size() && h[i] >= '0' && h[i] <= '9'; ++i) {
+      if (count < 100000000) count = count * 10 + (h[i] - '0');
+    }
+    if (i == from) return false;
+  }
+  return true;
+}
+
+void DiffModel::reset() {
+  inFile_ = inHunk_ = false;
+  removedLeft_ = addedLeft_ = 0;
+}
+
+void DiffModel::parse(std::string_view text) {
+  text_ = text;
+  lines_.clear();
+  hunks_.clear();
+  files_.clear();
+  added_.clear();
+  const bool hunkOpen = inHunk_;
+  if (inFile_) startFile(true);
+  if (hunkOpen) {
+    inHunk_ = true;
+    hunks_.push_back({0, 0, 0});
+    ++files_.back().hunkCount;
+  }
+
+  const char *data = text.data();
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    const void *nl = std::memchr(data + pos, '\n', text.size() - pos);
+    const std::size_t end = nl ? static_cast<std::size_t>(static_cast<const char *>(nl) - data) : text.size();
+    const PatchLineKind kind = classify(text.substr(pos, end - pos));
+    if (kind == PatchLineKind::Added) added_.push_back(static_cast<std::uint32_t>(lines_.size()));
+    lines_.push_back({pos, end - pos, static_cast<std::uint32_t>(files_.size() - 1), kind});
+    ++files_.back().lineCount;
+    if (inHunk_) ++hunks_.back().lineCount;
+    pos = end + 1;
+  }
+}
+
+std::string_view DiffModel::content(const PatchLine &l) const {
+  const std::string_view s = line(l);
+  switch (l.kind) {
+    case PatchLineKind::Context:
+    case PatchLineKind::Removed:
+    case PatchLineKind::Added:
+      return s.substr(1);
+    default:
+      return s;
+  }
+}
+
+std::vector<PatchRange> DiffModel::ranges(std::size_t bytes) const {
+  std::vector<PatchRange> out;
+  std::size_t first = 0;
+  for (std::size_t i = 1; i < lines_.size(); ++i) {
+    const bool boundary = lines_[i].kind == PatchLineKind::Hunk || lines_[i].file != lines_[i - 1].file;
+    if (boundary && lines_[i].offset - lines_[first].offset >= bytes) {
+      out.push_back({first, i});
+      first = i;
+    }
+  }
+  if (!lines_.empty()) out.push_back({first, lines_.size()});
+  return out;
+}
+
+std::string_view DiffModel::text(const PatchRange &r) const {
+  if (r.firstLine >= r.endLine) return {};
+  const std::size_t begin = lines_[r.firstLine].offset;
+  const std::size_t end = r.endLine < lines_.size() ? lines_[r.endLine].offset : text_.size();
+  return text_.substr(begin, end - begin);
+}
+
+void DiffModel::startFile(bool continued) {
+  files_.push_back({static_cast<std::uint32_t>(lines_.size()), 0, static_cast<std::uint32_t>(hunks_.size()), 0, continued});
+  inFile_ = true;
+  inHunk_ = false;
+}
+
+void DiffModel::startHunk(std::string_view header) {
+  std::size_t i = 3;   // after "@@ "
+  if (!(parseRange(header, i, '-', removedLeft_) && i < header.size() && header[i++] == ' ' &&
+        parseRange(header, i, '+', addedLeft_))) {
+    removedLeft_ = addedLeft_ = -1;   // no counts: the hunk ends at the first line without a marker
+  }
+  hunks_.push_back({static_cast<std::uint32_t>(files_.size() - 1), static_cast<std::uint32_t>(lines_.size()), 0});
+  ++files_.back().hunkCount;
+  inHunk_ = true;
+}
+
+void DiffModel::endHunk() {
+  inHunk_ = false;
+  removedLeft_ = addedLeft_ = 0;
+}
+
+PatchLineKind DiffModel::classify(std::string_view line) {
+  const char c = line.empty() ? '\0' : line[0];
+  if (inHunk_) {
+    if (c == '-' && removedLeft_ != 0) {
+      if (removedLeft_ > 0) --removedLeft_;
+      return PatchLineKind::Removed;
+    }
+    if (c == '+' && addedLeft_ != 0) {
+      if (addedLeft_ > 0) --addedLeft_;
+      return PatchLineKind::Added;
+    }
+    if (c == ' ' && removedLeft_ != 0 && addedLeft_ != 0) {
+      if (removedLeft_ > 0) --removedLeft_;
+      if (addedLeft_ > 0) --addedLeft_;
+      return PatchLineKind::Context;
+    }
+    if (c == '\\') return PatchLineKind::Note;
+    endHunk();
+  }
+
+  if (startsWith(line, "diff ")) {
+    startFile(false);
+    return PatchLineKind::Header;
+  }
+  if (files_.empty()) startFile(false);   // bare lines before any file header
+  if (startsWith(line, "@@")) {
+    startHunk(line);
+    return PatchLineKind::Hunk;
+  }
+  if (startsWith(line, "---") || startsWith(line, "+++")) return PatchLineKind::Header;
+  switch (c) {
+    case '-': return PatchLineKind::Removed;
+    case '+': return PatchLineKind::Added;
+    case ' ': return PatchLineKind::Context;
+    case '\\': return PatchLineKind::Note;
+    default: return PatchLineKind::Header;
+  }
+}
+
+}
@@ -0,0 +1,85 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/git_batch.h"
+#include "next_version/git_helpers.h"
+#include "next_version/util.h"
+
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nv {
+
+GitBatch::GitBatch(std::string repoRoot) : repoRoot_(std::move(repoRoot)) {}
+
+// Parse "<oid> <type> <size>" or "<rev> missing|ambiguous".
+static bool parseHeader(const std::string &line, GitObjectInfo &info) {
+  info = GitObjectInfo{};
+  std::istringstream ls(line);
+  std::string oid, type, size;
+  if (!(ls >> oid >> type >> size)) return false;
+  if (!isInteger(size)) return false;
+  info.found = true;
+  info.oid = std::move(oid);
+  info.type = std::move(type);
+  info.size = static_cast<std::size_t>(std::stoull(size));
+  return true;
+}
+
+bool GitBatch::roundTrip(Coprocess &proc, const std::string &line, bool withContents, GitObjectInfo &info, std::string *data) {
+  if (!proc.write(line)) return false;
+  std::string header;
+  if (!proc.readLine(header)) return false;
+  if (!parseHeader(header, info)) return true; // answered, but missing or ambiguous
+  if (withContents) {
+    std::string scratch;
+    std::string &dst = data ? *data : scratch;
+    if (!proc.readExact(info.size, dst)) return false;
+    std::string lf;
+    if (!proc.readExact(1, lf)) return false;
+  }
+  return true;
+}
+
+bool GitBatch::request(bool withContents, const std::string &rev, GitObjectInfo &info, std::string *data) {
+  info = GitObjectInfo{};
+  // The protocol is line based; refuse names that would desynchronize it.
+  if (rev.empty() || rev.find('\n') != std::string::npos) return false;
+
+  if (mode_ == Mode::Unstarted) {
+    mode_ = startGitCoprocess(command_, {"cat-file", "--batch-command"}, repoRoot_) ? Mode::Command : Mode::Failed;
+  }
+  if (mode_ == Mode::Command) {
+    const std::string line = std::string(withContents ? "contents " : "info ") + rev + "\n";
+    if (roundTrip(command_, line, withContents, info, data)) return info.found;
+    // Older git rejects --batch-command and exits with usage; switch to the pair.
+    command_.finish();
+    const bool checkOk = startGitCoprocess(check_, {"cat-file", "--batch-check"}, repoRoot_);
+    const bool batchOk = startGitCoprocess(batch_, {"cat-file", "--batch"}, repoRoot_);
+    mode_ = (checkOk && batchOk) ? Mode::Split : Mode::Failed;
+  }
+  if (mode_ == Mode::Split) {
+    if (roundTrip(withContents ? batch_ : check_, rev + "\n", withContents, info, data)) return info.found;
+    check_.finish(); batch_.finish();
+    mode_ = Mode::Failed;
+  }
+  return false;
+}
+
+GitObjectInfo GitBatch::info(const std::string &rev) {
+  GitObjectInfo info;
+  request(false, rev, info, nullptr);
+  return info;
+}
+
+bool GitBatch::contents(const std::string &rev, GitObjectInfo &info, std::string &data) {
+  return request(true, rev, info, &data);
+}
+
+}
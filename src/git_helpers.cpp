@@ -8,13 +8,15 @@
 #include "next_version/types.h"
 #include "next_version/util.h"
 #include "next_version/git_helpers.h"
+#include "next_version/process.h"
+#include "next_version/range_snapshot.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstdio>
 #include <sstream>
 #include <string>
-#include <sys/wait.h>
 #include <vector>
 
 namespace nv {
@@ -39,29 +41,50 @@ std::string buildCommand(const std::vector<std::string> &args) {
 }
 
 int runProcessCapture(const std::string &command, std::string &stdoutData) {
-  std::string cmd = command + " 2>/dev/null";
-  FILE *pipe = popen(cmd.c_str(), "r");
-  if (!pipe) return 127;
-  char buffer[4096];
-  while (true) {
-    std::size_t n = std::fread(buffer, 1, sizeof(buffer), pipe);
-    if (n > 0) stdoutData.append(buffer, n);
-    if (n < sizeof(buffer)) {
-      if (std::feof(pipe)) break;
-      if (std::ferror(pipe)) break;
-    }
-  }
-  int status = pclose(pipe);
-  if (WIFEXITED(status)) return WEXITSTATUS(status);
-  return 1;
+  // Shell strings still need /bin/sh; argv-based callers should use runProcess directly.
+  ProcessResult res;
+  runProcess({"/bin/sh", "-c", command}, res, false);
+  stdoutData.append(res.out);
+  return res.exitCode;
 }
 
-int runGitCapture(const std::vector<std::string> &args, const std::string &repoRoot, std::string &out) {
+static std::atomic<int> gitInvocations {0};
+
+int gitInvocationCount() {
+  return gitInvocations.load(std::memory_order_relaxed);
+}
+
+static std::vector<std::string> gitArgv(const std::vector<std::string> &args, const std::string &repoRoot) {
+  gitInvocations.fetch_add(1, std::memory_order_relaxed);
   std::vector<std::string> full;
+  full.reserve(args.size() + 3);
   full.push_back("git");
   if (!repoRoot.empty()) { full.push_back("-C"); full.push_back(repoRoot); }
   full.insert(full.end(), args.begin(), args.end());
-  return runProcessCapture(buildCommand(full), out);
+  return full;
+}
+
+int runGitCapture(const std::vector<std::string> &args, const std::string &repoRoot, ProcessResult &result) {
+  return runProcess(gitArgv(args, repoRoot), result);
+}
+
+bool startGitCoprocess(Coprocess &proc, const std::vector<std::string> &args, const std::string &repoRoot) {
+  return proc.start(gitArgv(args, repoRoot));
+}
+
+int streamGit(const std::vector<std::string> &args, const std::string &repoRoot, const LineBatchFn &consume,
+              const LineStreamOptions &opts) {
+  Coprocess proc;
+  if (!proc.start(gitArgv(args, repoRoot))) return 127;
+  streamLines([&](char *dst, std::size_t n) { return proc.readSome(dst, n); }, consume, opts);
+  return proc.finish();
+}
+
+int runGitCapture(const std::vector<std::string> &args, const std::string &repoRoot, std::string &out) {
+  ProcessResult res;
+  runGitCapture(args, repoRoot, res);
+  if (out.empty()) out = std::move(res.out); else out.append(res.out);
+  return res.exitCode;
 }
 
 bool gitHasCommits(const std::string &repoRoot) {
@@ -139,57 +162,55 @@ static std::vector<std::string> splitByNul(const std::string &data) {
   return out;
 }
 
-FileChangeStats computeFileChangeStats(const std::string &repoRoot,
-                                      const std::string &baseRef,
-                                      const std::string &targetRef,
-                                      const std::string &onlyPathsCsv,
-                                      bool ignoreWhitespace) {
+// Renames, copies and type changes all count as modifications.
+static void countChange(FileChangeStats &stats, char code, const std::string &path) {
+  switch (code) { case 'A': { stats.addedFiles += 1; int cls = classifyPath(path); if (cls==30) stats.newSourceFiles++; else if (cls==10) stats.newTestFiles++; else if (cls==20) stats.newDocFiles++; } break; case 'D': stats.deletedFiles++; break; default: stats.modifiedFiles++; }
+}
+
+FileChangeStats computeFileChangeStats(const RangeSnapshot &snap) {
   FileChangeStats stats;
-  // quick test
-  {
-    std::vector<std::string> args = {"git", "-c", "color.ui=false", "-c", "core.quotepath=false"};
-    if (!repoRoot.empty()) { args.push_back("-C"); args.push_back(repoRoot); }
-    args.push_back("diff"); args.push_back("-M"); args.push_back("-C");
-    if (ignoreWhitespace) args.push_back("-w");
-    args.push_back("--quiet");
-    args.push_back(baseRef + ".." + targetRef);
-    if (!onlyPathsCsv.empty()) {
-      args.push_back("--");
-      std::istringstream iss(onlyPathsCsv); std::string tok; while (std::getline(iss, tok, ',')) { auto t = trim(tok); if (!t.empty()) args.push_back(t); }
+  if (!snap.hasChanges) return stats;
+  if (snap.native) {
+    for (const auto &c : snap.changes) {
+      countChange(stats, c.status, c.path());
+      stats.insertions += c.insertions;
+      stats.deletions += c.deletions;
     }
-    std::string out; int ec = runProcessCapture(buildCommand(args), out);
-    if (ec == 0) return stats;
+    return stats;
   }
-  // name-status -z
-  {
-    std::vector<std::string> args = {"git", "-c", "color.ui=false", "-c", "core.quotepath=false"};
-    if (!repoRoot.empty()) { args.push_back("-C"); args.push_back(repoRoot); }
-    args.push_back("diff"); args.push_back("-M"); args.push_back("-C");
-    if (ignoreWhitespace) args.push_back("-w");
-    args.push_back("--name-status"); args.push_back("-z");
-    args.push_back(baseRef + ".." + targetRef);
-    if (!onlyPathsCsv.empty()) { args.push_back("--"); std::istringstream iss(onlyPathsCsv); std::string tok; while (std::getline(iss, tok, ',')) { auto t = trim(tok); if (!t.empty()) args.push_back(t); } }
-    std::string data; runProcessCapture(buildCommand(args), data);
-    auto fields = splitByNul(data);
-    for (std::size_t i = 0; i < fields.size();) {
-      if (fields[i].empty()) { ++i; continue; }
-      std::string status = fields[i++]; if (status.empty()) break; char code = status[0];
-      std::string p1, p2; if (code == 'R' || code == 'C') { if (i < fields.size()) p1 = fields[i++]; if (i < fields.size()) p2 = fields[i++]; } else { if (i < fields.size()) p1 = fields[i++]; }
-      switch (code) { case 'A': { stats.addedFiles += 1; int cls = classifyPath(p1); if (cls==30) stats.newSourceFiles++; else if (cls==10) stats.newTestFiles++; else if (cls==20) stats.newDocFiles++; } break; case 'D': stats.deletedFiles++; break; default: stats.modifiedFiles++; }
+  // `--raw --numstat -z`: raw records (":modes shas STATUS\0path\0[path2\0]") come
+  // first, then numstat records ("ins\tdel\tpath\0", or "ins\tdel\t\0old\0new\0").
+  auto fields = splitByNul(snap.rawNumstat);
+  for (std::size_t i = 0; i < fields.size();) {
+    const std::string &field = fields[i++];
+    if (field.empty()) continue;
+    if (field[0] == ':') {
+      std::size_t sp = field.rfind(' ');
+      std::string status = (sp == std::string::npos) ? std::string() : field.substr(sp + 1);
+      if (status.empty()) break;
+      char code = status[0];
+      std::string p1; if (i < fields.size()) p1 = fields[i++];
+      if ((code == 'R' || code == 'C') && i < fields.size()) ++i;
+      countChange(stats, code, p1);
+      continue;
     }
-  }
-  // numstat
-  {
-    std::vector<std::string> args = {"git", "-c", "color.ui=false", "-c", "core.quotepath=false"};
-    if (!repoRoot.empty()) { args.push_back("-C"); args.push_back(repoRoot); }
-    args.push_back("diff"); args.push_back("-M"); args.push_back("-C"); if (ignoreWhitespace) args.push_back("-w"); args.push_back("--numstat"); args.push_back(baseRef + ".." + targetRef);
-    if (!onlyPathsCsv.empty()) { args.push_back("--"); std::istringstream iss(onlyPathsCsv); std::string tok; while (std::getline(iss, tok, ',')) { auto t = trim(tok); if (!t.empty()) args.push_back(t); } }
-    std::string text; runProcessCapture(buildCommand(args), text);
-    std::istringstream iss(text); std::string line; while (std::getline(iss, line)) { std::istringstream ls(line); std::string insStr, delStr; if (!std::getline(ls, insStr, '\t')) continue; if (!std::getline(ls, delStr, '\t')) continue; int insVal = isInteger(insStr)?std::stoi(insStr):0; int delVal = isInteger(delStr)?std::stoi(delStr):0; stats.insertions += insVal; stats.deletions += delVal; }
+    std::istringstream ls(field); std::string insStr, delStr, path;
+    if (!std::getline(ls, insStr, '\t')) continue;
+    if (!std::getline(ls, delStr, '\t')) continue;
+    if (!std::getline(ls, path) || path.empty()) i += 2; // rename/copy: old and new paths follow
+    int insVal = isInteger(insStr)?std::stoi(insStr):0; int delVal = isInteger(delStr)?std::stoi(delStr):0; stats.insertions += insVal; stats.deletions += delVal;
   }
   return stats;
 }
 
+FileChangeStats computeFileChangeStats(const std::string &repoRoot,
+                                      const std::string &baseRef,
+                                      const std::string &targetRef,
+                                      const std::string &onlyPathsCsv,
+                                      bool ignoreWhitespace) {
+  return computeFileChangeStats(collectRangeSnapshot(repoRoot, baseRef, targetRef, onlyPathsCsv, ignoreWhitespace, SnapshotFileStats));
+}
+
 std::string gitDescribeLastTag(const std::string &match, const std::string &repoRoot) {
   std::string out; int ec = runGitCapture({"describe","--tags","--abbrev=0","--match", match}, repoRoot, out); if (ec != 0) return {}; return trim(out);
 }
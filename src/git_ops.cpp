@@ -35,14 +35,12 @@ static bool worktreeDirty(const std::string &repoRoot) {
   return !out.empty();
 }
 
-static bool branchIsDetached(const std::string &repoRoot) {
+// Short name of the checked-out branch, or "" when HEAD is detached. One call
+// answers both the detached-HEAD preflight and the branch to push.
+static std::string symbolicHeadBranch(const std::string &repoRoot) {
   std::string out;
-  int ec = runGitCapture({"symbolic-ref","-q","HEAD"}, repoRoot, out);
-  return ec != 0;
-}
-
-static std::string currentBranch(const std::string &repoRoot) {
-  std::string out; runGitCapture({"rev-parse","--abbrev-ref","HEAD"}, repoRoot, out); return trim(out);
+  int ec = runGitCapture({"symbolic-ref","-q","--short","HEAD"}, repoRoot, out);
+  return ec == 0 ? trim(out) : std::string();
 }
 
 int performGitOperations(const GitOpsOptions &opts,
@@ -50,7 +48,9 @@ int performGitOperations(const GitOpsOptions &opts,
                         const std::string &newVersion,
                         const std::string &currentVersion) {
   // Basic preflight checks when committing/tagging/pushing
-  if ((opts.doCommit || opts.doTag || opts.doPush || opts.pushTags) && branchIsDetached(repoRoot)) {
+  const bool anyOperation = opts.doCommit || opts.doTag || opts.doPush || opts.pushTags;
+  const std::string branch = anyOperation ? symbolicHeadBranch(repoRoot) : std::string();
+  if (anyOperation && branch.empty()) {
     std::fprintf(stderr, "Error: Detached HEAD; checkout a branch before continuing.\n");
     return 2;
   }
@@ -104,7 +104,6 @@ int performGitOperations(const GitOpsOptions &opts,
 
   // Push
   if (opts.doPush || opts.pushTags) {
-    std::string branch = currentBranch(repoRoot);
     if (opts.doPush) {
       std::string out; int ec = git({"push", opts.remote, branch}, repoRoot, out);
       if (ec != 0) { std::fprintf(stderr, "Error: git push failed.\n"); return 7; }
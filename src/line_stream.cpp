@@ -0,0 +1,132 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/line_stream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace nv {
+
+namespace {
+
+// Bounded queue of slot indices with one producer and one consumer thread.
+// Every slot index sits in at most one queue at a time, so a queue sized to
+// the slot count can never overflow and push() needs no full check.
+class SlotQueue {
+public:
+  explicit SlotQueue(std::size_t capacity) : ring_(capacity) {}
+
+  void push(std::size_t slot) {
+    const std::size_t t = tail_.load(std::memory_order_relaxed);
+    ring_[t % ring_.size()] = slot;
+    tail_.store(t + 1, std::memory_order_release);
+    tail_.notify_one();
+  }
+
+  std::size_t pop() {
+    std::size_t t = tail_.load(std::memory_order_acquire);
+    while (t == head_) {
+      tail_.wait(t, std::memory_order_acquire);
+      t = tail_.load(std::memory_order_acquire);
+    }
+    return ring_[head_++ % ring_.size()];
+  }
+
+private:
+  std::vector<std::size_t> ring_;
+  std::size_t head_ {0};                 // only touched by the consumer
+  std::atomic<std::size_t> tail_ {0};
+};
+
+struct Slot {
+  std::unique_ptr<char[]> data;
+  std::size_t cap {0};
+  std::size_t len {0};
+  bool last {false};                     // end of input; the consumer stops after this slot
+
+  // Keep the first `keep` bytes and make room for at least `want`.
+  void reserve(std::size_t want, std::size_t keep, std::atomic<std::size_t> &ringBytes) {
+    if (cap >= want) return;
+    std::unique_ptr<char[]> grown(new char[want]);
+    if (keep > 0) std::memcpy(grown.get(), data.get(), keep);
+    ringBytes.fetch_add(want - cap, std::memory_order_relaxed);
+    data = std::move(grown);
+    cap = want;
+  }
+};
+
+}
+
+LineStreamStats streamLines(const ReadFn &read, const LineBatchFn &consume, const LineStreamOptions &opts) {
+  const std::size_t chunkSize = std::max<std::size_t>(opts.chunkSize, 1);
+  const std::size_t chunkCount = std::max<std::size_t>(opts.chunkCount, 2);
+  std::vector<Slot> slots(chunkCount);
+  SlotQueue freeSlots(chunkCount), fullSlots(chunkCount);
+  for (std::size_t i = 0; i < chunkCount; ++i) freeSlots.push(i);
+  std::atomic<std::size_t> ringBytes {0};
+
+  // Slots are allocated on first use, so a short stream only costs one chunk.
+  std::thread reader([&]() {
+    std::size_t cur = freeSlots.pop();
+    slots[cur].reserve(chunkSize, 0, ringBytes);
+    while (true) {
+      Slot &s = slots[cur];
+      if (s.len == s.cap) s.reserve(s.cap * 2, s.len, ringBytes);   // one line fills the slot
+      const std::size_t n = read(s.data.get() + s.len, s.cap - s.len);
+      if (n == 0) {
+        s.last = true;
+        fullSlots.push(cur);
+        return;
+      }
+      s.len += n;
+      if (s.len < s.cap) continue;
+      const char *base = s.data.get();
+      const void *nl = ::memrchr(base, opts.delimiter, s.len);
+      if (!nl) continue;
+      const std::size_t cut = static_cast<std::size_t>(static_cast<const char *>(nl) - base) + 1;
+      const std::size_t next = freeSlots.pop();
+      Slot &t = slots[next];
+      t.reserve(std::max(chunkSize, s.len - cut + 1), 0, ringBytes);
+      t.len = s.len - cut;
+      if (t.len > 0) std::memcpy(t.data.get(), base + cut, t.len);
+      s.len = cut;
+      fullSlots.push(cur);
+      cur = next;
+    }
+  });
+
+  LineStreamStats stats;
+  std::exception_ptr failure;
+  while (true) {
+    const std::size_t idx = fullSlots.pop();
+    Slot &s = slots[idx];
+    if (s.len > 0 && !failure) {
+      try {
+        consume(std::string_view(s.data.get(), s.len));
+      } catch (...) {
+        failure = std::current_exception();
+      }
+    }
+    stats.bytes += s.len;
+    if (s.len > 0) ++stats.batches;
+    s.len = 0;
+    if (s.last) break;
+    freeSlots.push(idx);
+  }
+  reader.join();
+  stats.ringBytes = ringBytes.load(std::memory_order_relaxed);
+  if (failure) std::rethrow_exception(failure);
+  return stats;
+}
+
+}
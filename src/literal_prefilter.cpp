@@ -0,0 +1,244 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/literal_prefilter.h"
+
+#include <algorithm>
+#include <array>
+
+#ifdef NEXT_VERSION_HAVE_SIMD
+#include <immintrin.h>
+#endif
+
+namespace nv {
+
+namespace {
+
+constexpr unsigned kBuckets = 8;
+constexpr std::size_t kWidth = 4;   // fingerprint bytes
+
+// OR 0x20 lowercases ASCII letters and never turns a non-letter into one.
+inline std::uint8_t fold(unsigned char c) { return static_cast<std::uint8_t>(c | 0x20); }
+
+// Rough frequency of each folded byte in source code and prose. Buckets are
+// arranged so that common bytes pass as few of them as possible.
+double byteWeight(unsigned b) {
+  static const double letters[26] = {8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.15, 0.8, 4.0, 2.4,
+                                     6.7, 7.5, 1.9, 0.1, 6.0, 6.3, 9.1, 2.8, 1.0, 2.4, 0.15, 2.0, 0.07};
+  if (b >= 'a' && b <= 'z') return letters[b - 'a'];
+  if (b == ' ') return 15.0;
+  return b < 0x80 ? 0.3 : 0.05;
+}
+
+struct Fingerprint {
+  std::uint8_t bytes[kWidth];
+  std::size_t len;
+};
+
+// Nibble sets accepted by one bucket, per fingerprint byte.
+struct BucketSets {
+  std::uint16_t lo[kWidth] {}, hi[kWidth] {};
+
+  void add(const Fingerprint &fp) {
+    for (std::size_t k = 0; k < kWidth; ++k) {
+      if (k < fp.len) {
+        lo[k] = static_cast<std::uint16_t>(lo[k] | (1u << (fp.bytes[k] & 15)));
+        hi[k] = static_cast<std::uint16_t>(hi[k] | (1u << (fp.bytes[k] >> 4)));
+      } else {
+        lo[k] = hi[k] = 0xFFFF;   // a shorter word accepts any byte here
+      }
+    }
+  }
+
+  // Expected share of positions that pass this bucket.
+  double cost() const {
+    double c = 1;
+    for (std::size_t k = 0; k < kWidth; ++k) {
+      double w = 0;
+      for (unsigned l = 0; l < 16; ++l) {
+        if (!(lo[k] >> l & 1)) continue;
+        for (unsigned h = 0; h < 16; ++h) {
+          if (hi[k] >> h & 1) w += byteWeight(h << 4 | l);
+        }
+      }
+      c *= w;
+    }
+    return c;
+  }
+};
+
+#ifdef NEXT_VERSION_HAVE_SIMD
+
+// Both kernels advance `pos` block by block while all four loads stay inside
+// the text, and stop at the first block with a candidate.
+__attribute__((target("avx2")))
+bool scanAvx2(const std::uint8_t (*lo)[16], const std::uint8_t (*hi)[16], const char *d, std::size_t n,
+              std::size_t &pos, std::uint32_t &mask) {
+  const __m256i nibble = _mm256_set1_epi8(0x0F), lower = _mm256_set1_epi8(0x20);
+  __m256i loT[kWidth], hiT[kWidth];
+  for (std::size_t k = 0; k < kWidth; ++k) {
+    loT[k] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(lo[k])));
+    hiT[k] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(hi[k])));
+  }
+  for (; pos + LiteralPrefilter::kBlock + kWidth - 1 <= n; pos += LiteralPrefilter::kBlock) {
+    __m256i acc = _mm256_set1_epi8(-1);
+    for (std::size_t k = 0; k < kWidth; ++k) {
+      const __m256i v = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(d + pos + k)), lower);
+      const __m256i l = _mm256_shuffle_epi8(loT[k], _mm256_and_si256(v, nibble));
+      const __m256i h = _mm256_shuffle_epi8(hiT[k], _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+      acc = _mm256_and_si256(acc, _mm256_and_si256(l, h));
+    }
+    const auto zero = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(acc, _mm256_setzero_si256())));
+    if (zero != 0xFFFFFFFFu) {
+      mask = ~zero;
+      return true;
+    }
+  }
+  return false;
+}
+
+__attribute__((target("ssse3")))
+std::uint32_t blockSsse3(const __m128i *loT, const __m128i *hiT, const char *d) {
+  const __m128i nibble = _mm_set1_epi8(0x0F), lower = _mm_set1_epi8(0x20);
+  __m128i acc = _mm_set1_epi8(-1);
+  for (std::size_t k = 0; k < kWidth; ++k) {
+    const __m128i v = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(d + k)), lower);
+    const __m128i l = _mm_shuffle_epi8(loT[k], _mm_and_si128(v, nibble));
+    const __m128i h = _mm_shuffle_epi8(hiT[k], _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+    acc = _mm_and_si128(acc, _mm_and_si128(l, h));
+  }
+  return ~static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128()))) & 0xFFFFu;
+}
+
+__attribute__((target("ssse3")))
+bool scanSsse3(const std::uint8_t (*lo)[16], const std::uint8_t (*hi)[16], const char *d, std::size_t n,
+               std::size_t &pos, std::uint32_t &mask) {
+  __m128i loT[kWidth], hiT[kWidth];
+  for (std::size_t k = 0; k < kWidth; ++k) {
+    loT[k] = _mm_load_si128(reinterpret_cast<const __m128i *>(lo[k]));
+    hiT[k] = _mm_load_si128(reinterpret_cast<const __m128i *>(hi[k]));
+  }
+  for (; pos + LiteralPrefilter::kBlock + kWidth - 1 <= n; pos += LiteralPrefilter::kBlock) {
+    const std::uint32_t m = blockSsse3(loT, hiT, d + pos) | blockSsse3(loT, hiT, d + pos + 16) << 16;
+    if (m) {
+      mask = m;
+      return true;
+    }
+  }
+  return false;
+}
+
+#endif
+
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef NEXT_VERSION_HAVE_SIMD
+  static const SimdLevel level = __builtin_cpu_supports("avx2")    ? SimdLevel::Avx2
+                                 : __builtin_cpu_supports("ssse3") ? SimdLevel::Ssse3
+                                                                   : SimdLevel::Scalar;
+  return level;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+const char *simdLevelName(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Ssse3: return "ssse3";
+    case SimdLevel::Scalar: break;
+  }
+  return "scalar";
+}
+
+LiteralPrefilter::LiteralPrefilter(const std::vector<std::string> &words) {
+  std::vector<Fingerprint> fps;
+  for (const auto &w : words) {
+    Fingerprint fp {};
+    fp.len = std::min(w.size(), kWidth);
+    for (std::size_t k = 0; k < kWidth && k < w.size(); ++k) fp.bytes[k] = fold(static_cast<unsigned char>(w[k]));
+    const bool dup = std::any_of(fps.begin(), fps.end(), [&](const Fingerprint &o) {
+      return o.len == fp.len && std::equal(o.bytes, o.bytes + o.len, fp.bytes);
+    });
+    if (!dup) fps.push_back(fp);
+  }
+
+  // Local search over bucket assignments, moving one fingerprint at a time
+  // and keeping moves that do not raise the expected candidate rate.
+  std::vector<unsigned> bucket(fps.size());
+  for (std::size_t i = 0; i < fps.size(); ++i) bucket[i] = static_cast<unsigned>(i % kBuckets);
+  auto setsOf = [&](unsigned b) {
+    BucketSets s;
+    for (std::size_t i = 0; i < fps.size(); ++i) {
+      if (bucket[i] == b) s.add(fps[i]);
+    }
+    return s;
+  };
+  std::array<double, kBuckets> cost {};
+  for (unsigned b = 0; b < kBuckets; ++b) cost[b] = setsOf(b).cost();
+  std::uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  auto next = [&rng](std::size_t bound) {
+    rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<std::size_t>((rng >> 33) % bound);
+  };
+  for (int it = 0; it < 4000 && fps.size() > kBuckets; ++it) {
+    const std::size_t i = next(fps.size());
+    const unsigned from = bucket[i], to = static_cast<unsigned>(next(kBuckets));
+    if (from == to) continue;
+    bucket[i] = to;
+    const double a = setsOf(from).cost(), b = setsOf(to).cost();
+    if (a + b <= cost[from] + cost[to]) {
+      cost[from] = a;
+      cost[to] = b;
+    } else {
+      bucket[i] = from;
+    }
+  }
+
+  for (unsigned b = 0; b < kBuckets; ++b) {
+    const BucketSets s = setsOf(b);
+    for (std::size_t k = 0; k < kWidth; ++k) {
+      for (unsigned v = 0; v < 16; ++v) {
+        if (s.lo[k] >> v & 1) lo_[k][v] = static_cast<std::uint8_t>(lo_[k][v] | (1u << b));
+        if (s.hi[k] >> v & 1) hi_[k][v] = static_cast<std::uint8_t>(hi_[k][v] | (1u << b));
+      }
+    }
+  }
+}
+
+// The same lookup one position at a time, with zero bytes past the end.
+std::uint32_t LiteralPrefilter::tailMask(std::string_view text, std::size_t pos) const {
+  std::uint32_t mask = 0;
+  const std::size_t end = std::min(text.size(), pos + kBlock);
+  for (std::size_t i = pos; i < end; ++i) {
+    std::uint8_t m = 0xFF;
+    for (std::size_t k = 0; k < kWidth && m; ++k) {
+      const std::uint8_t c = fold(i + k < text.size() ? static_cast<unsigned char>(text[i + k]) : 0);
+      m = static_cast<std::uint8_t>(m & lo_[k][c & 15] & hi_[k][c >> 4]);
+    }
+    if (m) mask |= 1u << (i - pos);
+  }
+  return mask;
+}
+
+std::size_t LiteralPrefilter::nextBlock(std::string_view text, std::size_t from, std::uint32_t &mask, SimdLevel level) const {
+  std::size_t pos = from;
+#ifdef NEXT_VERSION_HAVE_SIMD
+  if (level == SimdLevel::Avx2 && scanAvx2(lo_, hi_, text.data(), text.size(), pos, mask)) return pos;
+  if (level == SimdLevel::Ssse3 && scanSsse3(lo_, hi_, text.data(), text.size(), pos, mask)) return pos;
+#else
+  (void)level;
+#endif
+  for (; pos < text.size(); pos += kBlock) {
+    mask = tailMask(text, pos);
+    if (mask) return pos;
+  }
+  return std::string_view::npos;
+}
+
+}
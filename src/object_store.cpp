@@ -0,0 +1,739 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/object_store.h"
+#include "next_version/util.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+
+#ifdef NEXT_VERSION_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace nv {
+
+namespace {
+
+constexpr std::size_t kDefaultDeltaBaseCache = 96u * 1024u * 1024u;
+constexpr std::size_t kMaxDeltaChain = 10000;   // git's own hard limit on --depth is 4095
+constexpr int kMaxRefDeltaDepth = 64;
+constexpr int kMaxAlternateDepth = 5;
+
+std::uint32_t be32(const unsigned char *p) {
+  return (std::uint32_t{p[0]} << 24) | (std::uint32_t{p[1]} << 16) | (std::uint32_t{p[2]} << 8) | std::uint32_t{p[3]};
+}
+
+std::uint64_t be64(const unsigned char *p) {
+  return (std::uint64_t{be32(p)} << 32) | be32(p + 4);
+}
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() { if (data_) ::munmap(const_cast<unsigned char *>(data_), size_); }
+
+  bool map(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+    void *p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    data_ = static_cast<const unsigned char *>(p);
+    size_ = static_cast<std::size_t>(st.st_size);
+    return true;
+  }
+  const unsigned char *data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  const unsigned char *data_ {nullptr};
+  std::size_t size_ {0};
+};
+
+// A fanout table never decreases; its last entry is the number of ids. Index
+// files failing this are not read, so a search never leaves the id table.
+bool validFanout(const unsigned char *fanout) {
+  for (unsigned i = 1; i < 256; ++i) {
+    if (be32(fanout + 4 * i) < be32(fanout + 4 * (i - 1))) return false;
+  }
+  return true;
+}
+
+// Binary search over a fanout-bucketed, sorted table of raw ids (shared by .idx and MIDX).
+bool searchOids(const unsigned char *fanout, const unsigned char *oids, std::size_t hashSize,
+                const ObjectId &id, std::size_t &pos) {
+  const unsigned first = id.bytes[0];
+  std::size_t lo = first == 0 ? 0 : be32(fanout + 4 * (first - 1));
+  std::size_t hi = be32(fanout + 4 * first);
+  while (lo < hi) {
+    const std::size_t mid = lo + (hi - lo) / 2;
+    const int c = std::memcmp(oids + mid * hashSize, id.bytes.data(), hashSize);
+    if (c == 0) { pos = mid; return true; }
+    if (c < 0) lo = mid + 1; else hi = mid;
+  }
+  return false;
+}
+
+// Version 2 pack index: header, fanout, ids, CRCs, 31-bit offsets, 64-bit offsets.
+struct PackIndex {
+  MappedFile file;
+  std::size_t pack {0};     // index into Impl::packs
+  std::size_t count {0};
+  const unsigned char *fanout {nullptr};
+  const unsigned char *oids {nullptr};
+  const unsigned char *offsets {nullptr};
+  const unsigned char *largeOffsets {nullptr};
+  std::size_t largeCount {0};
+
+  bool load(const std::string &path, std::size_t hashSize) {
+    if (!file.map(path)) return false;
+    const unsigned char *d = file.data();
+    const std::size_t n = file.size();
+    if (n < 8 + 1024 || std::memcmp(d, "\377tOc", 4) != 0 || be32(d + 4) != 2) return false;
+    fanout = d + 8;
+    if (!validFanout(fanout)) return false;
+    count = be32(fanout + 4 * 255);
+    const std::size_t fixed = 8 + 1024 + count * (hashSize + 4 + 4) + 2 * hashSize;
+    if (fixed > n) return false;
+    oids = fanout + 1024;
+    offsets = oids + count * hashSize + count * 4;
+    largeOffsets = offsets + count * 4;
+    largeCount = (n - fixed) / 8;
+    return true;
+  }
+
+  bool find(const ObjectId &id, std::size_t hashSize, std::uint64_t &offset) const {
+    std::size_t pos;
+    if (!searchOids(fanout, oids, hashSize, id, pos)) return false;
+    const std::uint32_t off = be32(offsets + 4 * pos);
+    if (!(off & 0x80000000u)) { offset = off; return true; }
+    const std::size_t large = off & 0x7fffffffu;
+    if (large >= largeCount) return false;
+    offset = be64(largeOffsets + 8 * large);
+    return true;
+  }
+};
+
+// multi-pack-index: one id table covering several packs (format version 1).
+struct MultiPackIndex {
+  MappedFile file;
+  std::vector<std::size_t> packs;   // MIDX pack-int-id -> index into Impl::packs
+  std::vector<std::string> packNames;
+  std::size_t count {0};
+  const unsigned char *fanout {nullptr};
+  const unsigned char *oids {nullptr};
+  const unsigned char *objectOffsets {nullptr};
+  const unsigned char *largeOffsets {nullptr};
+  std::size_t largeCount {0};
+
+  bool load(const std::string &path, std::size_t hashSize) {
+    if (!file.map(path)) return false;
+    const unsigned char *d = file.data();
+    const std::size_t n = file.size();
+    if (n < 12 || std::memcmp(d, "MIDX", 4) != 0 || d[4] != 1) return false;
+    if ((d[5] == 1 ? 20u : 32u) != hashSize) return false;
+    const std::size_t chunks = d[6];
+    const std::uint32_t packCount = be32(d + 8);
+    if (12 + (chunks + 1) * 12 > n) return false;
+    const unsigned char *names = nullptr, *namesEnd = nullptr, *large = nullptr, *largeEnd = nullptr;
+    const unsigned char *oidsEnd = nullptr, *objectOffsetsEnd = nullptr;
+    for (std::size_t i = 0; i < chunks; ++i) {
+      const unsigned char *entry = d + 12 + i * 12;
+      const std::uint32_t chunkId = be32(entry);
+      const std::uint64_t begin = be64(entry + 4);
+      const std::uint64_t end = be64(entry + 16);
+      if (begin > end || end > n) return false;
+      switch (chunkId) {
+        case 0x504e414d: names = d + begin; namesEnd = d + end; break;          // PNAM
+        case 0x4f494446: fanout = d + begin; if (end - begin < 1024) return false; break; // OIDF
+        case 0x4f49444c: oids = d + begin; oidsEnd = d + end; break;            // OIDL
+        case 0x4f4f4646: objectOffsets = d + begin; objectOffsetsEnd = d + end; break; // OOFF
+        case 0x4c4f4646: large = d + begin; largeEnd = d + end; break;          // LOFF
+        default: break;
+      }
+    }
+    if (!names || !fanout || !oids || !objectOffsets || !validFanout(fanout)) return false;
+    count = be32(fanout + 4 * 255);
+    // The id and offset tables hold count records each, within their own chunks
+    if (static_cast<std::size_t>(oidsEnd - oids) / hashSize < count ||
+        static_cast<std::size_t>(objectOffsetsEnd - objectOffsets) / 8 < count) {
+      return false;
+    }
+    if (large) { largeOffsets = large; largeCount = static_cast<std::size_t>(largeEnd - large) / 8; }
+    const unsigned char *p = names;
+    while (packNames.size() < packCount && p < namesEnd) {
+      const unsigned char *z = static_cast<const unsigned char *>(std::memchr(p, 0, static_cast<std::size_t>(namesEnd - p)));
+      if (!z) return false;
+      if (z > p) packNames.emplace_back(reinterpret_cast<const char *>(p), static_cast<std::size_t>(z - p));
+      p = z + 1;
+      while (p < namesEnd && *p == 0) ++p;   // PNAM is padded to a 4-byte boundary
+    }
+    return packNames.size() == packCount;
+  }
+
+  bool find(const ObjectId &id, std::size_t hashSize, std::size_t &pack, std::uint64_t &offset) const {
+    std::size_t pos;
+    if (!searchOids(fanout, oids, hashSize, id, pos)) return false;
+    const unsigned char *rec = objectOffsets + 8 * pos;
+    const std::uint32_t packId = be32(rec);
+    const std::uint32_t off = be32(rec + 4);
+    if (packId >= packs.size()) return false;
+    pack = packs[packId];
+    if (!(off & 0x80000000u)) { offset = off; return true; }
+    const std::size_t idx = off & 0x7fffffffu;
+    if (idx >= largeCount) return false;
+    offset = be64(largeOffsets + 8 * idx);
+    return true;
+  }
+};
+
+struct Pack {
+  std::string path;
+  MappedFile file;
+};
+
+#ifdef NEXT_VERSION_HAVE_ZLIB
+// Inflate a zlib stream that must produce exactly `expected` bytes.
+bool inflateExact(const unsigned char *src, std::size_t avail, std::size_t expected, std::string &out) {
+  if (expected >= UINT_MAX) return false;
+  out.resize(expected + 1);   // one spare byte so Z_FINISH never starves on empty objects
+  z_stream zs {};
+  if (inflateInit(&zs) != Z_OK) return false;
+  zs.next_in = const_cast<Bytef *>(src);
+  zs.avail_in = static_cast<uInt>(std::min<std::size_t>(avail, UINT_MAX));
+  zs.next_out = reinterpret_cast<Bytef *>(out.data());
+  zs.avail_out = static_cast<uInt>(expected + 1);
+  const int rc = inflate(&zs, Z_FINISH);
+  const bool ok = rc == Z_STREAM_END && zs.total_out == expected;
+  inflateEnd(&zs);
+  out.resize(expected);
+  return ok;
+}
+
+// Loose objects carry "<type> <size>\0" in front of the payload.
+bool inflateLoose(const std::string &raw, ObjectType &type, std::string &out) {
+  z_stream zs {};
+  if (inflateInit(&zs) != Z_OK) return false;
+  zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(raw.data()));
+  zs.avail_in = static_cast<uInt>(std::min<std::size_t>(raw.size(), UINT_MAX));
+  char head[64];
+  zs.next_out = reinterpret_cast<Bytef *>(head);
+  zs.avail_out = sizeof(head);
+  int rc = inflate(&zs, Z_SYNC_FLUSH);
+  if (rc != Z_OK && rc != Z_STREAM_END) { inflateEnd(&zs); return false; }
+  const std::size_t got = sizeof(head) - zs.avail_out;
+  const char *nul = static_cast<const char *>(std::memchr(head, 0, got));
+  const char *sp = static_cast<const char *>(std::memchr(head, ' ', got));
+  if (!nul || !sp || sp > nul) { inflateEnd(&zs); return false; }
+  const std::string_view typeName(head, static_cast<std::size_t>(sp - head));
+  type = typeName == "commit" ? ObjectType::Commit : typeName == "tree" ? ObjectType::Tree
+       : typeName == "blob" ? ObjectType::Blob : typeName == "tag" ? ObjectType::Tag : ObjectType::Bad;
+  std::size_t size = 0;
+  for (const char *p = sp + 1; p < nul; ++p) {
+    if (*p < '0' || *p > '9' || size > (SIZE_MAX - 9) / 10) { inflateEnd(&zs); return false; }
+    size = size * 10 + static_cast<std::size_t>(*p - '0');
+  }
+  const std::size_t already = got - static_cast<std::size_t>(nul + 1 - head);
+  if (type == ObjectType::Bad || already > size || size >= UINT_MAX) { inflateEnd(&zs); return false; }
+  out.resize(size + 1);
+  std::memcpy(out.data(), nul + 1, already);
+  if (rc != Z_STREAM_END) {
+    zs.next_out = reinterpret_cast<Bytef *>(out.data() + already);
+    zs.avail_out = static_cast<uInt>(size + 1 - already);
+    rc = inflate(&zs, Z_FINISH);
+  }
+  const bool ok = rc == Z_STREAM_END && zs.total_out == size + static_cast<std::size_t>(nul + 1 - head);
+  inflateEnd(&zs);
+  out.resize(size);
+  return ok;
+}
+#else
+bool inflateExact(const unsigned char *, std::size_t, std::size_t, std::string &) { return false; }
+bool inflateLoose(const std::string &, ObjectType &, std::string &) { return false; }
+#endif
+
+bool readDeltaSize(std::string_view delta, std::size_t &pos, std::size_t &value) {
+  value = 0;
+  unsigned shift = 0;
+  while (pos < delta.size() && shift < 64) {
+    const unsigned char c = static_cast<unsigned char>(delta[pos++]);
+    value |= std::size_t{c & 0x7fu} << shift;
+    if (!(c & 0x80u)) return true;
+    shift += 7;
+  }
+  return false;
+}
+
+// Git delta: source size, target size, then copy-from-base / insert-literal opcodes.
+bool applyDelta(std::string_view base, std::string_view delta, std::string &out) {
+  std::size_t pos = 0, srcSize, dstSize;
+  if (!readDeltaSize(delta, pos, srcSize) || !readDeltaSize(delta, pos, dstSize)) return false;
+  if (srcSize != base.size()) return false;
+  out.resize(dstSize);
+  std::size_t w = 0;
+  const auto *d = reinterpret_cast<const unsigned char *>(delta.data());
+  while (pos < delta.size()) {
+    const unsigned char op = d[pos++];
+    if (op & 0x80u) {
+      std::size_t off = 0, size = 0;
+      for (unsigned i = 0; i < 4; ++i) {
+        if (!(op & (1u << i))) continue;
+        if (pos >= delta.size()) return false;
+        off |= std::size_t{d[pos++]} << (8 * i);
+      }
+      for (unsigned i = 0; i < 3; ++i) {
+        if (!(op & (0x10u << i))) continue;
+        if (pos >= delta.size()) return false;
+        size |= std::size_t{d[pos++]} << (8 * i);
+      }
+      if (size == 0) size = 0x10000;
+      if (off > base.size() || size > base.size() - off || size > dstSize - w) return false;
+      std::memcpy(out.data() + w, base.data() + off, size);
+      w += size;
+    } else if (op) {
+      if (op > delta.size() - pos || op > dstSize - w) return false;
+      std::memcpy(out.data() + w, d + pos, op);
+      pos += op; w += op;
+    } else {
+      return false;   // opcode 0 is reserved
+    }
+  }
+  return w == dstSize;
+}
+
+std::string readSmallFile(const fs::path &p) {
+  std::ifstream in(p, std::ios::binary);
+  if (!in) return {};
+  return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+// Resolve the directory git itself would use for `git -C repoRoot`.
+fs::path discoverGitDir(const std::string &repoRoot) {
+  std::error_code ec;
+  fs::path start = repoRoot.empty() ? fs::current_path(ec) : fs::absolute(repoRoot, ec);
+  if (ec) return {};
+  if (const char *env = std::getenv("GIT_DIR"); env && *env) {
+    fs::path p(env);
+    return p.is_absolute() ? p : start / p;
+  }
+  for (fs::path p = start; ; p = p.parent_path()) {
+    const fs::path dotgit = p / ".git";
+    if (fs::is_directory(dotgit, ec) && fs::exists(dotgit / "HEAD", ec)) return dotgit;
+    if (fs::is_regular_file(dotgit, ec)) {
+      std::string text = trim(readSmallFile(dotgit));
+      if (text.rfind("gitdir:", 0) != 0) return {};
+      fs::path target(trim(text.substr(7)));
+      return target.is_absolute() ? target : p / target;
+    }
+    if (fs::exists(p / "HEAD", ec) && fs::is_directory(p / "objects", ec) && fs::is_directory(p / "refs", ec)) return p;
+    if (p == p.parent_path()) break;
+  }
+  return {};
+}
+
+// extensions.objectFormat from the repository config; "sha1" when unset.
+std::string configuredObjectFormat(const fs::path &commonDir) {
+  std::ifstream in(commonDir / "config");
+  std::string line, section;
+  while (std::getline(in, line)) {
+    std::string t = trim(line);
+    if (t.empty() || t[0] == '#' || t[0] == ';') continue;
+    std::transform(t.begin(), t.end(), t.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (t[0] == '[') { section = t; continue; }
+    if (section != "[extensions]") continue;
+    const auto eq = t.find('=');
+    if (eq != std::string::npos && trim(t.substr(0, eq)) == "objectformat") return trim(t.substr(eq + 1));
+  }
+  return "sha1";
+}
+
+struct PairHash {
+  std::size_t operator()(const std::pair<std::size_t, std::uint64_t> &k) const {
+    return std::hash<std::uint64_t>{}(k.second * 31 + k.first);
+  }
+};
+
+}
+
+struct ObjectStore::Impl {
+  std::string gitDir;
+  std::size_t hashSize {20};
+  std::vector<std::string> objectDirs;   // own objects directory first, then alternates
+  std::vector<std::unique_ptr<Pack>> packs;
+  std::vector<std::unique_ptr<MultiPackIndex>> midxs;
+  std::vector<std::unique_ptr<PackIndex>> idxs;   // packs not covered by a multi-pack-index
+
+  // Delta-base cache: (pack, offset) -> inflated object, evicted least-recently-used.
+  using Key = std::pair<std::size_t, std::uint64_t>;
+  struct CacheEntry {
+    ObjectType type;
+    std::shared_ptr<const std::string> buf;
+    std::list<Key>::iterator lru;
+  };
+  std::mutex cacheMutex;
+  std::unordered_map<Key, CacheEntry, PairHash> cache;
+  std::list<Key> lru;
+  std::size_t cacheBytes {0};
+  std::size_t cacheLimit {kDefaultDeltaBaseCache};
+
+  void addObjectDir(const fs::path &dir, int depth);
+  bool locate(const ObjectId &id, std::size_t &pack, std::uint64_t &offset) const;
+  bool unpack(std::size_t pack, std::uint64_t offset, ObjectType &type, std::shared_ptr<const std::string> &buf, int refDepth);
+  bool readLoose(const ObjectId &id, ObjectType &type, std::shared_ptr<const std::string> &buf) const;
+  bool readAny(const ObjectId &id, ObjectType &type, std::shared_ptr<const std::string> &buf, int refDepth);
+  bool cacheGet(const Key &key, ObjectType &type, std::shared_ptr<const std::string> &buf);
+  void cachePut(const Key &key, ObjectType type, const std::shared_ptr<const std::string> &buf);
+};
+
+void ObjectStore::Impl::addObjectDir(const fs::path &dir, int depth) {
+  std::error_code ec;
+  if (!fs::is_directory(dir, ec)) return;
+  const std::string canon = fs::weakly_canonical(dir, ec).string();
+  if (std::find(objectDirs.begin(), objectDirs.end(), canon) != objectDirs.end()) return;
+  objectDirs.push_back(canon);
+
+  const fs::path packDir = dir / "pack";
+  std::vector<std::string> covered;
+  auto midx = std::make_unique<MultiPackIndex>();
+  if (fs::exists(packDir / "multi-pack-index", ec) && midx->load((packDir / "multi-pack-index").string(), hashSize)) {
+    bool ok = true;
+    for (const auto &name : midx->packNames) {
+      auto pack = std::make_unique<Pack>();
+      pack->path = (packDir / fs::path(name).replace_extension(".pack")).string();
+      if (!pack->file.map(pack->path)) { ok = false; break; }
+      midx->packs.push_back(packs.size());
+      packs.push_back(std::move(pack));
+      covered.push_back(fs::path(name).stem().string());
+    }
+    if (ok) midxs.push_back(std::move(midx));
+    else covered.clear();   // stale MIDX: fall back to the individual .idx files
+  }
+
+  std::vector<fs::path> idxFiles;
+  for (const auto &entry : fs::directory_iterator(packDir, ec)) {
+    if (entry.path().extension() == ".idx") idxFiles.push_back(entry.path());
+  }
+  std::sort(idxFiles.begin(), idxFiles.end());
+  for (const auto &idxPath : idxFiles) {
+    const std::string stem = idxPath.stem().string();
+    if (std::find(covered.begin(), covered.end(), stem) != covered.end()) continue;
+    auto pack = std::make_unique<Pack>();
+    pack->path = fs::path(idxPath).replace_extension(".pack").string();
+    auto idx = std::make_unique<PackIndex>();
+    if (!pack->file.map(pack->path) || !idx->load(idxPath.string(), hashSize)) continue;
+    idx->pack = packs.size();
+    packs.push_back(std::move(pack));
+    idxs.push_back(std::move(idx));
+  }
+
+  if (depth >= kMaxAlternateDepth) return;
+  std::ifstream alt(dir / "info" / "alternates");
+  std::string line;
+  while (std::getline(alt, line)) {
+    line = trim(line);
+    if (line.empty() || line[0] == '#') continue;
+    fs::path p(line);
+    addObjectDir(p.is_absolute() ? p : dir / p, depth + 1);
+  }
+}
+
+bool ObjectStore::Impl::locate(const ObjectId &id, std::size_t &pack, std::uint64_t &offset) const {
+  for (const auto &m : midxs) if (m->find(id, hashSize, pack, offset)) return true;
+  for (const auto &i : idxs) {
+    if (i->find(id, hashSize, offset)) { pack = i->pack; return true; }
+  }
+  return false;
+}
+
+bool ObjectStore::Impl::cacheGet(const Key &key, ObjectType &type, std::shared_ptr<const std::string> &buf) {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto it = cache.find(key);
+  if (it == cache.end()) return false;
+  lru.splice(lru.begin(), lru, it->second.lru);
+  type = it->second.type;
+  buf = it->second.buf;
+  return true;
+}
+
+void ObjectStore::Impl::cachePut(const Key &key, ObjectType type, const std::shared_ptr<const std::string> &buf) {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  if (buf->size() > cacheLimit / 2 || cache.count(key)) return;
+  lru.push_front(key);
+  cache.emplace(key, CacheEntry{type, buf, lru.begin()});
+  cacheBytes += buf->size();
+  while (cacheBytes > cacheLimit && !lru.empty()) {
+    auto victim = cache.find(lru.back());
+    cacheBytes -= victim->second.buf->size();
+    cache.erase(victim);
+    lru.pop_back();
+  }
+}
+
+// Walk the delta chain down to a whole object (or a cached base), then apply
+// the deltas back up, caching each intermediate base on the way.
+bool ObjectStore::Impl::unpack(std::size_t packNo, std::uint64_t offset, ObjectType &type,
+                               std::shared_ptr<const std::string> &buf, int refDepth) {
+  const Pack &pack = *packs[packNo];
+  const unsigned char *d = pack.file.data();
+  const std::size_t n = pack.file.size();
+  std::vector<std::pair<std::uint64_t, std::string>> deltas;   // (entry offset, inflated delta)
+  std::shared_ptr<const std::string> base;
+  bool baseFromPack = false;
+  std::uint64_t off = offset;
+
+  while (true) {
+    if (cacheGet({packNo, off}, type, base)) break;
+    if (deltas.size() > kMaxDeltaChain || off < 12 || off >= n) return false;
+    std::size_t p = static_cast<std::size_t>(off);
+    unsigned char c = d[p++];
+    const unsigned kind = (c >> 4) & 7u;
+    std::size_t size = c & 15u;
+    unsigned shift = 4;
+    while (c & 0x80u) {
+      if (p >= n || shift > 57) return false;
+      c = d[p++];
+      size |= std::size_t{c & 0x7fu} << shift;
+      shift += 7;
+    }
+    if (kind >= 1 && kind <= 4) {
+      std::string data;
+      if (!inflateExact(d + p, n - p, size, data)) return false;
+      type = static_cast<ObjectType>(kind);
+      base = std::make_shared<const std::string>(std::move(data));
+      baseFromPack = true;
+      break;
+    }
+    if (kind == 6) {   // OFS_DELTA: base lives earlier in the same pack
+      if (p >= n) return false;
+      c = d[p++];
+      std::uint64_t rel = c & 0x7fu;
+      while (c & 0x80u) {
+        if (p >= n || rel > (UINT64_MAX >> 8)) return false;
+        c = d[p++];
+        rel = ((rel + 1) << 7) | (c & 0x7fu);
+      }
+      if (rel == 0 || rel > off) return false;
+      std::string delta;
+      if (!inflateExact(d + p, n - p, size, delta)) return false;
+      deltas.emplace_back(off, std::move(delta));
+      off -= rel;
+      continue;
+    }
+    if (kind == 7) {   // REF_DELTA: base named by id, possibly outside this pack
+      if (n - p < hashSize || refDepth >= kMaxRefDeltaDepth) return false;
+      const ObjectId baseId = ObjectId::fromRaw(d + p, hashSize);
+      p += hashSize;
+      std::string delta;
+      if (!inflateExact(d + p, n - p, size, delta)) return false;
+      deltas.emplace_back(off, std::move(delta));
+      if (!readAny(baseId, type, base, refDepth + 1)) return false;
+      break;
+    }
+    return false;
+  }
+
+  if (baseFromPack && !deltas.empty()) cachePut({packNo, off}, type, base);
+  for (std::size_t i = deltas.size(); i-- > 0;) {
+    std::string result;
+    if (!applyDelta(*base, deltas[i].second, result)) return false;
+    base = std::make_shared<const std::string>(std::move(result));
+    if (i > 0) cachePut({packNo, deltas[i].first}, type, base);
+  }
+  buf = std::move(base);
+  return true;
+}
+
+bool ObjectStore::Impl::readLoose(const ObjectId &id, ObjectType &type, std::shared_ptr<const std::string> &buf) const {
+  const std::string hex = id.hex();
+  for (const auto &dir : objectDirs) {
+    const std::string raw = readSmallFile(fs::path(dir) / hex.substr(0, 2) / hex.substr(2));
+    if (raw.empty()) continue;
+    std::string data;
+    if (!inflateLoose(raw, type, data)) return false;
+    buf = std::make_shared<const std::string>(std::move(data));
+    return true;
+  }
+  return false;
+}
+
+bool ObjectStore::Impl::readAny(const ObjectId &id, ObjectType &type, std::shared_ptr<const std::string> &buf, int refDepth) {
+  if (id.size != hashSize) return false;
+  std::size_t pack;
+  std::uint64_t offset;
+  if (locate(id, pack, offset)) return unpack(pack, offset, type, buf, refDepth);
+  return readLoose(id, type, buf);
+}
+
+const char *objectTypeName(ObjectType type) {
+  switch (type) {
+    case ObjectType::Commit: return "commit";
+    case ObjectType::Tree: return "tree";
+    case ObjectType::Blob: return "blob";
+    case ObjectType::Tag: return "tag";
+    default: return "bad";
+  }
+}
+
+std::string ObjectId::hex() const {
+  static const char digits[] = "0123456789abcdef";
+  std::string out(2 * std::size_t{size}, '0');
+  for (std::size_t i = 0; i < size; ++i) {
+    out[2 * i] = digits[bytes[i] >> 4];
+    out[2 * i + 1] = digits[bytes[i] & 15];
+  }
+  return out;
+}
+
+ObjectId ObjectId::fromHex(std::string_view hex) {
+  ObjectId id;
+  if (hex.size() != 40 && hex.size() != 64) return id;
+  for (std::size_t i = 0; i < hex.size() / 2; ++i) {
+    const int hi = hexValue(hex[2 * i]), lo = hexValue(hex[2 * i + 1]);
+    if (hi < 0 || lo < 0) return ObjectId{};
+    id.bytes[i] = static_cast<unsigned char>((hi << 4) | lo);
+  }
+  id.size = static_cast<std::uint8_t>(hex.size() / 2);
+  return id;
+}
+
+ObjectId ObjectId::fromRaw(const unsigned char *raw, std::size_t len) {
+  ObjectId id;
+  if (len != 20 && len != 32) return id;
+  std::memcpy(id.bytes.data(), raw, len);
+  id.size = static_cast<std::uint8_t>(len);
+  return id;
+}
+
+bool parseCommit(std::string_view data, CommitView &out) {
+  out = CommitView{};
+  std::size_t pos = 0;
+  while (pos < data.size()) {
+    std::size_t eol = data.find('\n', pos);
+    if (eol == std::string_view::npos) eol = data.size();
+    const std::string_view line = data.substr(pos, eol - pos);
+    if (line.empty()) { out.message = data.substr(std::min(eol + 1, data.size())); break; }
+    if (line.rfind("tree ", 0) == 0) out.tree = ObjectId::fromHex(line.substr(5));
+    else if (line.rfind("parent ", 0) == 0) out.parents.push_back(ObjectId::fromHex(line.substr(7)));
+    pos = eol + 1;
+  }
+  return !out.tree.empty();
+}
+
+bool TreeIterator::next(TreeEntry &entry) {
+  if (pos_ >= data_.size() || malformed_) return false;
+  const std::size_t sp = data_.find(' ', pos_);
+  const std::size_t nul = sp == std::string_view::npos ? sp : data_.find('\0', sp + 1);
+  if (nul == std::string_view::npos || data_.size() - nul - 1 < hashSize_ || sp == pos_) { malformed_ = true; return false; }
+  std::uint32_t mode = 0;
+  for (std::size_t i = pos_; i < sp; ++i) {
+    const char c = data_[i];
+    if (c < '0' || c > '7') { malformed_ = true; return false; }
+    mode = (mode << 3) | static_cast<std::uint32_t>(c - '0');
+  }
+  entry.mode = mode;
+  entry.name = data_.substr(sp + 1, nul - sp - 1);
+  entry.oid = ObjectId::fromRaw(reinterpret_cast<const unsigned char *>(data_.data()) + nul + 1, hashSize_);
+  pos_ = nul + 1 + hashSize_;
+  return true;
+}
+
+std::string gitCommonDir(const std::string &repoRoot) {
+  const fs::path gitDir = discoverGitDir(repoRoot);
+  if (gitDir.empty()) return {};
+  const std::string common = trim(readSmallFile(gitDir / "commondir"));
+  if (common.empty()) return gitDir.string();
+  return (fs::path(common).is_absolute() ? fs::path(common) : gitDir / common).lexically_normal().string();
+}
+
+ObjectStore::ObjectStore(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
+ObjectStore::~ObjectStore() = default;
+
+std::unique_ptr<ObjectStore> ObjectStore::open(const std::string &repoRoot) {
+#ifndef NEXT_VERSION_HAVE_ZLIB
+  (void)repoRoot;
+  return nullptr;
+#else
+  const fs::path gitDir = discoverGitDir(repoRoot);
+  if (gitDir.empty()) return nullptr;
+  fs::path commonDir = gitDir;
+  const std::string common = trim(readSmallFile(gitDir / "commondir"));
+  if (!common.empty()) commonDir = fs::path(common).is_absolute() ? fs::path(common) : gitDir / common;
+
+  auto impl = std::make_unique<Impl>();
+  impl->gitDir = gitDir.string();
+  const std::string format = configuredObjectFormat(commonDir);
+  if (format == "sha256") impl->hashSize = 32;
+  else if (format != "sha1") return nullptr;
+
+  fs::path objects = commonDir / "objects";
+  if (const char *env = std::getenv("GIT_OBJECT_DIRECTORY"); env && *env) objects = env;
+  impl->addObjectDir(objects, 0);
+  if (impl->objectDirs.empty()) return nullptr;
+  return std::unique_ptr<ObjectStore>(new ObjectStore(std::move(impl)));
+#endif
+}
+
+std::size_t ObjectStore::hashSize() const { return impl_->hashSize; }
+
+const std::string &ObjectStore::gitDir() const { return impl_->gitDir; }
+
+bool ObjectStore::read(const ObjectId &id, Object &out) {
+  out = Object{};
+  ObjectType type = ObjectType::Bad;
+  std::shared_ptr<const std::string> buf;
+  if (!impl_->readAny(id, type, buf, 0)) return false;
+  out.type_ = type;
+  out.buf_ = std::move(buf);
+  return true;
+}
+
+bool ObjectStore::contains(const ObjectId &id) {
+  if (id.size != impl_->hashSize) return false;
+  std::size_t pack;
+  std::uint64_t offset;
+  if (impl_->locate(id, pack, offset)) return true;
+  const std::string hex = id.hex();
+  std::error_code ec;
+  for (const auto &dir : impl_->objectDirs) {
+    if (fs::exists(fs::path(dir) / hex.substr(0, 2) / hex.substr(2), ec)) return true;
+  }
+  return false;
+}
+
+void ObjectStore::setDeltaBaseCacheLimit(std::size_t bytes) {
+  std::lock_guard<std::mutex> lock(impl_->cacheMutex);
+  impl_->cacheLimit = bytes;
+}
+
+}
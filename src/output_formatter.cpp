@@ -13,6 +13,20 @@
 
 namespace nv {
 
+LocDeltas computeLocDeltas(const std::string &currentVersion, int totalBonus, int loc, const ConfigValues &cfg) {
+  // Precompute three deltas (native) matching version-calculator.sh
+  // When current_version is 0.0.0, emit zeros to match calculator early-exit.
+  LocDeltas d;
+  if (!(currentVersion == "0.0.0")) {
+    // Use same math as shell: TOTAL_DELTA = BASE_DELTA + TOTAL_BONUS, both >= 0, min 1 only applies to final TOTAL_DELTA
+    auto clamp_total = [](int baseDelta, int totBonus) { int t = baseDelta + totBonus; return t < 1 ? 1 : t; };
+    d.patch = clamp_total(baseDeltaFor("patch", loc, cfg), computeTotalBonusWithMultiplier(totalBonus, loc, "patch", cfg));
+    d.minor = clamp_total(baseDeltaFor("minor", loc, cfg), computeTotalBonusWithMultiplier(totalBonus, loc, "minor", cfg));
+    d.major = clamp_total(baseDeltaFor("major", loc, cfg), computeTotalBonusWithMultiplier(totalBonus, loc, "major", cfg));
+  }
+  return d;
+}
+
 void formatOutput(const Options &opts, const std::string &suggestion, const std::string &currentVersion, 
                   const std::string &nextVersion, int totalBonus, const Kv &CLI, 
                   const std::string &baseRef, const std::string &targetRef, 
@@ -24,16 +38,8 @@ void formatOutput(const Options &opts, const std::string &suggestion, const std:
   if (opts.suggestOnly) {
     std::cout << suggestion << "\n";
   } else if (opts.json) {
-    // Precompute three deltas (native) matching version-calculator.sh
-    // When current_version is 0.0.0, emit zeros to match calculator early-exit.
-    int pd = 0, md = 0, jd = 0;
-    if (!(currentVersion == "0.0.0")) {
-      // Use same math as shell: TOTAL_DELTA = BASE_DELTA + TOTAL_BONUS, both >= 0, min 1 only applies to final TOTAL_DELTA
-      auto clamp_total = [](int baseDelta, int totBonus) { int t = baseDelta + totBonus; return t < 1 ? 1 : t; };
-      pd = clamp_total(baseDeltaFor("patch", loc, cfg), computeTotalBonusWithMultiplier(totalBonus, loc, "patch", cfg));
-      md = clamp_total(baseDeltaFor("minor", loc, cfg), computeTotalBonusWithMultiplier(totalBonus, loc, "minor", cfg));
-      jd = clamp_total(baseDeltaFor("major", loc, cfg), computeTotalBonusWithMultiplier(totalBonus, loc, "major", cfg));
-    }
+    const LocDeltas deltas = computeLocDeltas(currentVersion, totalBonus, loc, cfg);
+    const int pd = deltas.patch, md = deltas.minor, jd = deltas.major;
 
     std::cout << "{\n";
     std::cout << "  \"suggestion\": \"" << jsonEscape(suggestion) << "\",\n";
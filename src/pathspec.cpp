@@ -0,0 +1,154 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/pathspec.h"
+#include "next_version/util.h"
+
+#include <sstream>
+
+namespace nv {
+
+static bool matchFrom(std::string_view p, std::size_t pi, std::string_view t, std::size_t ti, bool pathname) {
+  while (pi < p.size()) {
+    char c = p[pi];
+    if (c == '*') {
+      std::size_t after = pi + 1;
+      while (after < p.size() && p[after] == '*') ++after;
+      const bool doubleStar = after - pi >= 2;
+      if (pathname && doubleStar && (pi == 0 || p[pi - 1] == '/') && (after == p.size() || p[after] == '/')) {
+        if (after == p.size()) return true;
+        // "**/" matches zero or more leading directories
+        for (std::size_t k = ti;;) {
+          if (matchFrom(p, after + 1, t, k, pathname)) return true;
+          const std::size_t slash = t.find('/', k);
+          if (slash == std::string_view::npos) return false;
+          k = slash + 1;
+        }
+      }
+      for (std::size_t k = ti;; ++k) {
+        if (matchFrom(p, after, t, k, pathname)) return true;
+        if (k >= t.size() || (pathname && t[k] == '/')) return false;
+      }
+    }
+    if (ti >= t.size()) return false;
+    const char ch = t[ti];
+    if (c == '?') {
+      if (pathname && ch == '/') return false;
+      ++pi; ++ti;
+      continue;
+    }
+    if (c == '[') {
+      std::size_t q = pi + 1;
+      bool negate = false;
+      if (q < p.size() && (p[q] == '!' || p[q] == '^')) { negate = true; ++q; }
+      bool matched = false;
+      bool first = true;
+      while (q < p.size() && (first || p[q] != ']')) {
+        first = false;
+        char lo = p[q];
+        if (lo == '\\' && q + 1 < p.size()) lo = p[++q];
+        ++q;
+        if (q + 1 < p.size() && p[q] == '-' && p[q + 1] != ']') {
+          char hi = p[q + 1];
+          if (hi == '\\' && q + 2 < p.size()) { hi = p[q + 2]; ++q; }
+          q += 2;
+          if (lo <= ch && ch <= hi) matched = true;
+        } else if (lo == ch) {
+          matched = true;
+        }
+      }
+      if (q >= p.size()) return false;   // unterminated class never matches
+      if (matched == negate || (pathname && ch == '/')) return false;
+      pi = q + 1; ++ti;
+      continue;
+    }
+    if (c == '\\' && pi + 1 < p.size()) c = p[++pi];
+    if (c != ch) return false;
+    ++pi; ++ti;
+  }
+  return ti == t.size();
+}
+
+bool wildmatch(std::string_view pattern, std::string_view text, bool pathname) {
+  return matchFrom(pattern, 0, text, 0, pathname);
+}
+
+PathFilter::PathFilter(const std::string &csv) {
+  std::istringstream iss(csv);
+  std::string tok;
+  while (std::getline(iss, tok, ',')) {
+    std::string t = trim(tok);
+    if (t.empty()) continue;
+    bool exclude = false, glob = false, literal = false;
+    if (t.rfind(":(", 0) == 0) {
+      const auto close = t.find(')');
+      if (close == std::string::npos) { supported_ = false; continue; }
+      std::istringstream magic(t.substr(2, close - 2));
+      std::string word;
+      while (std::getline(magic, word, ',')) {
+        word = trim(word);
+        if (word == "glob") glob = true;
+        else if (word == "exclude") exclude = true;
+        else if (word == "literal") literal = true;
+        else if (word != "top") supported_ = false;
+      }
+      t = t.substr(close + 1);
+    } else if (t.rfind(":!", 0) == 0 || t.rfind(":^", 0) == 0) {
+      exclude = true;
+      t = t.substr(2);
+    } else if (t.rfind(":/", 0) == 0) {
+      t = t.substr(2);
+    } else if (t[0] == ':') {
+      supported_ = false;
+      continue;
+    }
+    while (t.rfind("./", 0) == 0) t = t.substr(2);
+    Item item;
+    item.glob = glob;
+    item.literalLen = literal ? t.size() : std::min(t.size(), t.find_first_of("*?[\\"));
+    item.pattern = std::move(t);
+    (exclude ? excludes_ : includes_).push_back(std::move(item));
+  }
+}
+
+bool PathFilter::matchItem(const Item &item, std::string_view path) {
+  const std::string &pat = item.pattern;
+  if (pat.empty()) return true;   // "." and ":/" name the whole tree
+  if (path.substr(0, pat.size()) == pat &&
+      (path.size() == pat.size() || pat.back() == '/' || path[pat.size()] == '/')) return true;
+  if (item.literalLen == pat.size()) return false;
+  if (path.substr(0, item.literalLen) != std::string_view(pat).substr(0, item.literalLen)) return false;
+  return wildmatch(pat, path, item.glob);
+}
+
+bool PathFilter::matches(std::string_view path) const {
+  bool included = includes_.empty();
+  for (const auto &item : includes_) {
+    if (matchItem(item, path)) { included = true; break; }
+  }
+  if (!included) return false;
+  for (const auto &item : excludes_) {
+    if (matchItem(item, path)) return false;
+  }
+  return true;
+}
+
+bool PathFilter::mayMatchUnder(std::string_view dir) const {
+  if (includes_.empty()) return true;
+  const std::string prefix = std::string(dir) + "/";
+  for (const auto &item : includes_) {
+    const std::string_view lit = std::string_view(item.pattern).substr(0, item.literalLen);
+    if (lit.substr(0, std::min(lit.size(), prefix.size())) == std::string_view(prefix).substr(0, std::min(lit.size(), prefix.size()))) {
+      // Literal part is inside dir, or dir sits under it; plain items must end on a path boundary
+      if (item.literalLen < item.pattern.size() || lit.size() >= prefix.size() || lit.empty() ||
+          lit.back() == '/' || prefix[lit.size()] == '/') return true;
+    }
+  }
+  return false;
+}
+
+}
@@ -0,0 +1,407 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/pattern_matcher.h"
+#include "next_version/case_fold.h"
+#include "next_version/pattern_registry.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace nv {
+
+namespace {
+
+// The automaton only tracks letters; every other byte resets it, since no
+// literal word contains one.
+constexpr unsigned kAlphabet = 27;
+constexpr std::size_t kNone = std::string_view::npos;
+
+// Character classes as std::regex sees them in the "C" locale.
+inline unsigned char lower(char c) {
+  const auto u = static_cast<unsigned char>(c);
+  return (u >= 'A' && u <= 'Z') ? static_cast<unsigned char>(u + 32) : u;
+}
+constexpr std::array<std::uint8_t, 256> kLetterClass = [] {
+  std::array<std::uint8_t, 256> t {};
+  for (unsigned c = 'a'; c <= 'z'; ++c) t[c] = t[c - 32] = static_cast<std::uint8_t>(c - 'a' + 1);
+  return t;
+}();
+inline unsigned letterClass(char c) { return kLetterClass[static_cast<unsigned char>(c)]; }
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isAlnum(char c) { return letterClass(c) != 0 || isDigit(c); }
+inline bool isWordChar(char c) { return isAlnum(c) || c == '_'; }                  // \w
+inline bool isSpace(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }       // \s
+inline bool isLineEnd(char c) { return c == '\n' || c == '\r'; }                    // not matched by .
+
+// Case-insensitive: does text contain the lowercase word `w` at pos?
+bool wordAt(std::string_view text, std::size_t pos, std::string_view w) {
+  if (pos > text.size() || text.size() - pos < w.size()) return false;
+  for (std::size_t i = 0; i < w.size(); ++i) {
+    if (lower(text[pos + i]) != static_cast<unsigned char>(w[i])) return false;
+  }
+  return true;
+}
+
+bool boundaryBefore(std::string_view text, std::size_t pos) { return pos == 0 || !isWordChar(text[pos - 1]); }
+bool boundaryAt(std::string_view text, std::size_t pos) { return pos == text.size() || !isWordChar(text[pos]); }
+
+std::size_t skipSpace(std::string_view text, std::size_t pos) {
+  while (pos < text.size() && isSpace(text[pos])) ++pos;
+  return pos;
+}
+
+std::size_t skipDigits(std::string_view text, std::size_t pos) {
+  while (pos < text.size() && isDigit(text[pos])) ++pos;
+  return pos;
+}
+
+using patterns::Phrase;
+using patterns::kSecurityWords;
+using patterns::kMemoryPhrases;
+using patterns::kCrashPhrases;
+
+// End of the phrase whose first word is at `at`, or kNone. No two
+// alternatives share a first word, and their separators are never letters,
+// so there is nothing to backtrack into.
+std::size_t matchPhrase(std::string_view text, std::size_t at, const Phrase &ph, bool spaceSeparated) {
+  if (!boundaryBefore(text, at)) return kNone;
+  std::size_t pos = at + ph.words[0].size();
+  for (std::size_t k = 1; k < ph.words.size() && !ph.words[k].empty(); ++k) {
+    const std::string_view w = ph.words[k];
+    if (spaceSeparated) {
+      const std::size_t s = skipSpace(text, pos);
+      if (s == pos || !wordAt(text, s, w)) return kNone;
+      pos = s + w.size();
+    } else if (pos < text.size() && (text[pos] == '-' || text[pos] == ' ' || text[pos] == '_') && wordAt(text, pos + 1, w)) {
+      pos += 1 + w.size();
+    } else if (wordAt(text, pos, w)) {
+      pos += w.size();
+    } else {
+      return kNone;
+    }
+  }
+  return boundaryAt(text, pos) ? pos : kNone;
+}
+
+// [0-9]{4}-[0-9]+ at pos; returns the end or kNone.
+std::size_t matchCveNumber(std::string_view text, std::size_t pos) {
+  if (skipDigits(text, pos) - pos < 4) return kNone;
+  pos += 4;
+  if (pos >= text.size() || text[pos] != '-') return kNone;
+  const std::size_t end = skipDigits(text, pos + 1);
+  return end > pos + 1 ? end : kNone;
+}
+
+// For BREAKING[^A-Za-z0-9]+.*X: the run of non-alphanumerics may cross lines,
+// but .* cannot, so X must be the last occurrence on the line where the run
+// ends. Those last occurrences are found once per line, by plain searches in
+// a case-folded shadow of the line, and reused by every BREAKING whose run
+// ends on the same line.
+class TailScan {
+public:
+  explicit TailScan(std::string_view text) : text_(text) {}
+
+  // Last start of `w` ("cli", "api", "change" or "major") in [from, end of line).
+  std::size_t last(std::size_t from, unsigned w) {
+    if (from < begin_ || from >= end_) scan(from);
+    return last_[w] != kNone && last_[w] >= from ? last_[w] : kNone;
+  }
+  static constexpr std::string_view words[4] = {"cli", "api", "change", "major"};
+
+private:
+  void scan(std::size_t from) {
+    begin_ = from;
+    end_ = from;
+    while (end_ < text_.size() && !isLineEnd(text_[end_])) ++end_;
+    const std::string_view line = shadow_.assign(text_.substr(from, end_ - from));
+    // Forward searches skip ahead with memchr, which rfind does not.
+    for (unsigned w = 0; w < 4; ++w) {
+      last_[w] = kNone;
+      for (std::size_t at = line.find(words[w]); at != kNone; at = line.find(words[w], at + 1)) last_[w] = from + at;
+    }
+  }
+
+  std::string_view text_;
+  FoldedText shadow_;
+  std::size_t begin_ {0}, end_ {0};
+  std::size_t last_[4] {kNone, kNone, kNone, kNone};
+};
+
+// Start of the run after BREAKING's non-alphanumeric tail, or kNone when the
+// tail is empty or runs to the end of the text.
+std::size_t breakingTail(std::string_view text, std::size_t after) {
+  if (after >= text.size() || isAlnum(text[after])) return kNone;
+  while (after < text.size() && !isAlnum(text[after])) ++after;
+  return after < text.size() ? after : kNone;
+}
+
+struct Match {
+  std::size_t start, end;
+};
+
+// Checks the candidate at `at`, where the automaton found the pattern's
+// literal word, and sets the span the regex would match there.
+bool verify(std::string_view text, std::size_t at, Pattern p, unsigned alt, TailScan &tails, Match &m) {
+  switch (p) {
+    case Pattern::CliBreaking:
+    case Pattern::ApiBreaking: {
+      // Word is BREAKING; look back for the prefix and optional separator.
+      const std::string_view prefix = p == Pattern::CliBreaking ? "cli" : "api";
+      m.end = at + 8;
+      if (at >= 4 && (text[at - 1] == '-' || text[at - 1] == ' ') && wordAt(text, at - 4, prefix)) m.start = at - 4;
+      else if (at >= 3 && wordAt(text, at - 3, prefix)) m.start = at - 3;
+      else return false;
+      return true;
+    }
+    case Pattern::CliBreakingCommit:
+    case Pattern::ApiBreakingCommit: {
+      m.start = at;
+      const std::size_t run = breakingTail(text, at + 8);
+      if (run == kNone) return false;
+      const std::size_t x = tails.last(run, p == Pattern::CliBreakingCommit ? 0 : 1);
+      if (x == kNone) return false;
+      m.end = x + 3;
+      return true;
+    }
+    case Pattern::GeneralBreaking: {
+      m.start = at;
+      const std::size_t w = skipSpace(text, at + 8);
+      if (w > at + 8 && wordAt(text, w, "change")) {
+        m.end = w + 6;
+        return true;
+      }
+      const std::size_t run = breakingTail(text, at + 8);
+      if (run == kNone) return false;
+      const std::size_t change = tails.last(run, 2), major = tails.last(run, 3);
+      if (change == kNone && major == kNone) return false;
+      if (major == kNone || (change != kNone && change > major)) m.end = change + 6;
+      else m.end = major + 5;
+      return true;
+    }
+    case Pattern::SecurityComment: {
+      // Walk back from SECURITY over \s*, the comment token and the prefix,
+      // taking the latest possible start of the match.
+      m.end = at + 8;
+      std::size_t t = at;
+      while (t > 0 && isSpace(text[t - 1])) --t;
+      if (t == 0) return false;
+      std::size_t u;
+      const char c = text[t - 1];
+      if (c == '#') u = t - 1;
+      else if (t >= 2 && ((text[t - 2] == '/' && (c == '/' || c == '*')) || (text[t - 2] == '-' && c == '-'))) u = t - 2;
+      else return false;
+      if (u == 0) m.start = 0;
+      else if (isSpace(text[u - 1])) m.start = u - 1;
+      else if (text[u - 1] == '+' || text[u - 1] == '-') {
+        const std::size_t v = u - 1;
+        if (v == 0) m.start = 0;
+        else if (isSpace(text[v - 1])) m.start = v - 1;
+        else return false;
+      } else {
+        return false;
+      }
+      return true;
+    }
+    case Pattern::RemovedOption: {
+      m.start = at;
+      const std::size_t w = skipSpace(text, at + 7);
+      if (w == at + 7 || !wordAt(text, w, "option")) return false;
+      m.end = w + 6 + (wordAt(text, w + 6, "s") ? 1 : 0);
+      return true;
+    }
+    case Pattern::SecurityOrCve: {
+      m.start = at;
+      if (alt == 0) {
+        m.end = at + 8;
+      } else if (alt == 1) {
+        if (wordAt(text, at + 12, "y")) m.end = at + 13;
+        else if (wordAt(text, at + 12, "ies")) m.end = at + 15;
+        else return false;
+      } else {
+        const std::size_t pos = at + 3;
+        std::size_t end = kNone;
+        if (pos < text.size() && (text[pos] == '-' || text[pos] == ' ')) end = matchCveNumber(text, pos + 1);
+        if (end == kNone) end = matchCveNumber(text, pos);
+        if (end == kNone) return false;
+        m.end = end;
+      }
+      return true;
+    }
+    case Pattern::SecurityWord:
+      m.start = at;
+      m.end = at + kSecurityWords[alt].size();
+      return boundaryBefore(text, at) && boundaryAt(text, m.end);
+    case Pattern::CveId: {
+      // Four to seven digits, then a boundary: more digits fail the \b at every split.
+      m.start = at;
+      if (!boundaryBefore(text, at)) return false;
+      std::size_t pos = at + 3;
+      if (pos >= text.size() || text[pos] != '-') return false;
+      if (skipDigits(text, pos + 1) != pos + 5) return false;
+      pos += 5;
+      if (pos >= text.size() || text[pos] != '-') return false;
+      const std::size_t end = skipDigits(text, pos + 1);
+      if (end - (pos + 1) < 4 || end - (pos + 1) > 7 || !boundaryAt(text, end)) return false;
+      m.end = end;
+      return true;
+    }
+    case Pattern::MemorySafety:
+    case Pattern::Crash: {
+      m.start = at;
+      const bool crash = p == Pattern::Crash;
+      m.end = matchPhrase(text, at, crash ? kCrashPhrases[alt] : kMemoryPhrases[alt], crash);
+      return m.end != kNone;
+    }
+    case Pattern::Count:
+      break;
+  }
+  return false;
+}
+
+}
+
+const PatternMatcher &PatternMatcher::get() {
+  static const PatternMatcher matcher;
+  return matcher;
+}
+
+PatternMatcher::PatternMatcher() {
+  for (Pattern p : {Pattern::CliBreaking, Pattern::ApiBreaking, Pattern::CliBreakingCommit,
+                    Pattern::ApiBreakingCommit, Pattern::GeneralBreaking}) {
+    addWord("breaking", p, 0);
+  }
+  addWord("security", Pattern::SecurityComment, 0);
+  addWord("removed", Pattern::RemovedOption, 0);
+  addWord("security", Pattern::SecurityOrCve, 0);
+  addWord("vulnerabilit", Pattern::SecurityOrCve, 1);
+  addWord("cve", Pattern::SecurityOrCve, 2);
+  for (unsigned i = 0; i < std::size(kSecurityWords); ++i) addWord(std::string(kSecurityWords[i]), Pattern::SecurityWord, i);
+  addWord("cve", Pattern::CveId, 0);
+  for (unsigned i = 0; i < std::size(kMemoryPhrases); ++i) addWord(std::string(kMemoryPhrases[i].words[0]), Pattern::MemorySafety, i);
+  for (unsigned i = 0; i < std::size(kCrashPhrases); ++i) addWord(std::string(kCrashPhrases[i].words[0]), Pattern::Crash, i);
+  build();
+}
+
+void PatternMatcher::addWord(const std::string &word, Pattern p, unsigned alt) {
+  auto it = std::find_if(words_.begin(), words_.end(), [&](const Word &w) { return w.text == word; });
+  if (it == words_.end()) it = words_.insert(words_.end(), Word{word, {}});
+  it->hits.push_back(Hit{p, alt});
+}
+
+// Aho-Corasick: a trie of the words, then failure links filled in breadth
+// first to turn it into a complete DFA.
+void PatternMatcher::build() {
+  std::vector<std::uint16_t> trie(kAlphabet, 0);   // 0 = no child; the root is never a child
+  output_.assign(1, {});
+  for (unsigned w = 0; w < words_.size(); ++w) {
+    std::size_t s = 0;
+    for (char c : words_[w].text) {
+      const unsigned k = letterClass(c);
+      if (trie[s * kAlphabet + k] == 0) {
+        trie[s * kAlphabet + k] = static_cast<std::uint16_t>(output_.size());
+        output_.emplace_back();
+        trie.resize(output_.size() * kAlphabet, 0);
+      }
+      s = trie[s * kAlphabet + k];
+    }
+    output_[s].push_back(w);
+  }
+
+  next_.assign(trie.size(), 0);
+  std::vector<std::uint16_t> fail(output_.size(), 0);
+  std::deque<std::uint16_t> queue;
+  for (unsigned k = 0; k < kAlphabet; ++k) {
+    const std::uint16_t child = trie[k];
+    next_[k] = child;
+    if (child) queue.push_back(child);
+  }
+  while (!queue.empty()) {
+    const std::uint16_t s = queue.front();
+    queue.pop_front();
+    for (unsigned k = 0; k < kAlphabet; ++k) {
+      const std::uint16_t child = trie[s * kAlphabet + k];
+      const std::uint16_t via = next_[fail[s] * kAlphabet + k];
+      if (!child) {
+        next_[s * kAlphabet + k] = via;
+        continue;
+      }
+      next_[s * kAlphabet + k] = child;
+      fail[child] = via;
+      // Longer words (earlier starts) first, so hits stay in start order.
+      output_[child].insert(output_[child].end(), output_[via].begin(), output_[via].end());
+      queue.push_back(child);
+    }
+  }
+
+  // Every word has at least three letters, so those index the words a
+  // prefilter candidate can start.
+  std::vector<std::string> texts;
+  prefixGroup_.assign(kAlphabet * kAlphabet * kAlphabet, 0);
+  groups_.assign(1, {});
+  for (unsigned w = 0; w < words_.size(); ++w) {
+    const std::string &t = words_[w].text;
+    texts.push_back(t);
+    std::uint8_t &group = prefixGroup_[(letterClass(t[0]) * kAlphabet + letterClass(t[1])) * kAlphabet + letterClass(t[2])];
+    if (!group) {
+      group = static_cast<std::uint8_t>(groups_.size());
+      groups_.emplace_back();
+    }
+    groups_[group].push_back(w);
+  }
+  prefilter_ = LiteralPrefilter(texts);
+  level_ = detectSimdLevel();
+}
+
+void PatternMatcher::count(std::string_view text, PatternSet patterns, PatternCounts &counts) const {
+  count(text, patterns, counts, level_);
+}
+
+void PatternMatcher::count(std::string_view text, PatternSet patterns, PatternCounts &counts, SimdLevel level) const {
+  std::array<std::size_t, static_cast<std::size_t>(Pattern::Count)> lastEnd {};
+  TailScan tails(text);
+  auto found = [&](const Word &word, std::size_t at) {
+    for (const Hit &h : word.hits) {
+      if (!(patterns & patternBit(h.pattern))) continue;
+      Match m {0, 0};
+      if (!verify(text, at, h.pattern, h.alt, tails, m)) continue;
+      // Iterating the regex resumes after the previous match.
+      std::size_t &last = lastEnd[static_cast<std::size_t>(h.pattern)];
+      if (m.start < last) continue;
+      last = m.end;
+      ++counts[h.pattern];
+    }
+  };
+
+  if (level == SimdLevel::Scalar) {
+    std::size_t state = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+      state = next_[state * kAlphabet + letterClass(text[i])];
+      for (unsigned w : output_[state]) found(words_[w], i + 1 - words_[w].text.size());
+    }
+    return;
+  }
+
+  // Prefilter candidates arrive in start order; the first three letters pick
+  // the words that can start there.
+  std::uint32_t mask = 0;
+  for (std::size_t pos = 0; (pos = prefilter_.nextBlock(text, pos, mask, level)) != kNone; pos += LiteralPrefilter::kBlock) {
+    for (; mask; mask &= mask - 1) {
+      const std::size_t at = pos + static_cast<std::size_t>(__builtin_ctz(mask));
+      if (text.size() - at < 3) continue;
+      // Class 0 (not a letter) never leads to a group.
+      const unsigned a = letterClass(text[at]), b = letterClass(text[at + 1]), c = letterClass(text[at + 2]);
+      const std::uint8_t group = prefixGroup_[(a * kAlphabet + b) * kAlphabet + c];
+      if (!group) continue;
+      for (unsigned w : groups_[group]) {
+        if (wordAt(text, at, words_[w].text)) found(words_[w], at);
+      }
+    }
+  }
+}
+
+}
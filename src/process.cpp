@@ -0,0 +1,217 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/process.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+namespace nv {
+
+namespace {
+
+constexpr std::size_t kReadChunk = 64 * 1024;
+
+struct Pipe {
+  int fd[2] {-1, -1};
+  bool open() { return ::pipe2(fd, O_CLOEXEC) == 0; }
+  void closeEnd(int i) { if (fd[i] >= 0) { ::close(fd[i]); fd[i] = -1; } }
+  ~Pipe() { closeEnd(0); closeEnd(1); }
+};
+
+// Read once from fd into the tail of dst; returns false on EOF or error.
+bool drainOnce(int fd, std::string &dst) {
+  const std::size_t used = dst.size();
+  dst.resize(used + kReadChunk);
+  ssize_t n;
+  do { n = ::read(fd, &dst[used], kReadChunk); } while (n < 0 && errno == EINTR);
+  dst.resize(used + (n > 0 ? static_cast<std::size_t>(n) : 0));
+  return n > 0;
+}
+
+int waitStatus(pid_t pid) {
+  int status = 0;
+  while (::waitpid(pid, &status, 0) < 0) { if (errno != EINTR) return 127; }
+  if (WIFEXITED(status)) return WEXITSTATUS(status);
+  if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+  return 1;
+}
+
+}
+
+int runProcess(const std::vector<std::string> &argv, ProcessResult &result, bool captureStderr) {
+  result.exitCode = 127;
+  if (argv.empty()) return result.exitCode;
+
+  Pipe outPipe, errPipe;
+  if (!outPipe.open()) return result.exitCode;
+  if (captureStderr && !errPipe.open()) return result.exitCode;
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, outPipe.fd[1], STDOUT_FILENO);
+  if (captureStderr) posix_spawn_file_actions_adddup2(&actions, errPipe.fd[1], STDERR_FILENO);
+  else posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+  std::vector<char *> cargv;
+  cargv.reserve(argv.size() + 1);
+  for (const auto &a : argv) cargv.push_back(const_cast<char *>(a.c_str()));
+  cargv.push_back(nullptr);
+
+  // glibc's posix_spawn uses CLONE_VM|CLONE_VFORK, so no page tables are copied.
+  pid_t pid = -1;
+  const int rc = ::posix_spawnp(&pid, cargv[0], &actions, nullptr, cargv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  outPipe.closeEnd(1);
+  errPipe.closeEnd(1);
+  if (rc != 0) return result.exitCode;
+
+  // Drain both pipes together so a chatty stderr cannot block the child.
+  pollfd fds[2] = {{outPipe.fd[0], POLLIN, 0}, {errPipe.fd[0], POLLIN, 0}};
+  nfds_t open = captureStderr ? 2 : 1;
+  while (fds[0].fd >= 0 || (open == 2 && fds[1].fd >= 0)) {
+    if (::poll(fds, open, -1) < 0) {
+      if (errno == EINTR) continue;
+      // Stop reading: with our ends closed a child still writing fails with
+      // SIGPIPE instead of blocking on a full pipe while we wait for it.
+      outPipe.closeEnd(0);
+      errPipe.closeEnd(0);
+      break;
+    }
+    if (fds[0].fd >= 0 && (fds[0].revents & (POLLIN | POLLHUP | POLLERR))) {
+      if (!drainOnce(fds[0].fd, result.out)) fds[0].fd = -1;
+    }
+    if (open == 2 && fds[1].fd >= 0 && (fds[1].revents & (POLLIN | POLLHUP | POLLERR))) {
+      if (!drainOnce(fds[1].fd, result.err)) fds[1].fd = -1;
+    }
+  }
+
+  result.exitCode = waitStatus(pid);
+  return result.exitCode;
+}
+
+Coprocess::~Coprocess() { finish(); }
+
+bool Coprocess::start(const std::vector<std::string> &argv) {
+  finish();
+  if (argv.empty()) return false;
+  // A socket for the request side lets write() use MSG_NOSIGNAL instead of
+  // touching the process-wide SIGPIPE disposition.
+  int req[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, req) != 0) return false;
+  Pipe resp;
+  if (!resp.open()) { ::close(req[0]); ::close(req[1]); return false; }
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, req[1], STDIN_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, resp.fd[1], STDOUT_FILENO);
+  posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+  std::vector<char *> cargv;
+  cargv.reserve(argv.size() + 1);
+  for (const auto &a : argv) cargv.push_back(const_cast<char *>(a.c_str()));
+  cargv.push_back(nullptr);
+
+  pid_t pid = -1;
+  const int rc = ::posix_spawnp(&pid, cargv[0], &actions, nullptr, cargv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  ::close(req[1]);
+  resp.closeEnd(1);
+  if (rc != 0) { ::close(req[0]); return false; }
+
+  in_ = req[0];
+  out_ = resp.fd[0]; resp.fd[0] = -1;
+  pid_ = pid;
+  buf_.clear(); pos_ = 0;
+  return true;
+}
+
+bool Coprocess::write(std::string_view data) {
+  while (!data.empty()) {
+    if (in_ < 0) return false;
+    ssize_t n = ::send(in_, data.data(), data.size(), MSG_NOSIGNAL);
+    if (n < 0) { if (errno == EINTR) continue; return false; }
+    data.remove_prefix(static_cast<std::size_t>(n));
+  }
+  return true;
+}
+
+bool Coprocess::fill() {
+  if (out_ < 0) return false;
+  if (pos_ > 0) { buf_.erase(0, pos_); pos_ = 0; }
+  return drainOnce(out_, buf_);
+}
+
+bool Coprocess::readLine(std::string &line) {
+  std::size_t scanFrom = pos_;
+  while (true) {
+    const std::size_t nl = buf_.find('\n', scanFrom);
+    if (nl != std::string::npos) {
+      line.assign(buf_, pos_, nl - pos_);
+      pos_ = nl + 1;
+      return true;
+    }
+    scanFrom = buf_.size() - pos_;
+    if (!fill()) return false;
+  }
+}
+
+bool Coprocess::readExact(std::size_t n, std::string &out) {
+  const std::size_t avail = buf_.size() - pos_;
+  if (avail >= n) { out.append(buf_, pos_, n); pos_ += n; return true; }
+  // Hand the buffered head over, then read the rest straight into the caller's string.
+  out.append(buf_, pos_, avail);
+  buf_.clear(); pos_ = 0;
+  std::size_t used = out.size();
+  std::size_t want = n - avail;
+  out.resize(used + want);
+  while (want > 0) {
+    ssize_t r = ::read(out_, &out[used], want);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) { out.resize(used); return false; }
+    used += static_cast<std::size_t>(r);
+    want -= static_cast<std::size_t>(r);
+  }
+  return true;
+}
+
+std::size_t Coprocess::readSome(char *dst, std::size_t n) {
+  if (pos_ < buf_.size()) {
+    const std::size_t take = std::min(n, buf_.size() - pos_);
+    std::memcpy(dst, buf_.data() + pos_, take);
+    pos_ += take;
+    return take;
+  }
+  if (out_ < 0) return 0;
+  ssize_t r;
+  do { r = ::read(out_, dst, n); } while (r < 0 && errno == EINTR);
+  return r > 0 ? static_cast<std::size_t>(r) : 0;
+}
+
+int Coprocess::finish() {
+  if (in_ >= 0) { ::close(in_); in_ = -1; }
+  if (out_ >= 0) { ::close(out_); out_ = -1; }
+  int status = 0;
+  if (pid_ > 0) { status = waitStatus(pid_); pid_ = -1; }
+  buf_.clear(); pos_ = 0;
+  return status;
+}
+
+}
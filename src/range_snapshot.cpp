@@ -0,0 +1,300 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/range_snapshot.h"
+#include "next_version/git_batch.h"
+#include "next_version/git_helpers.h"
+#include "next_version/object_store.h"
+#include "next_version/util.h"
+
+#include <filesystem>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace nv {
+
+static void appendPathspecs(std::vector<std::string> &args, const std::string &onlyPathsCsv) {
+  if (onlyPathsCsv.empty()) return;
+  args.push_back("--");
+  std::istringstream iss(onlyPathsCsv); std::string tok;
+  while (std::getline(iss, tok, ',')) { auto t = trim(tok); if (!t.empty()) args.push_back(t); }
+}
+
+std::string cliPathspecFor(const std::string &onlyPathsCsv) {
+  // Use recursive glob pathspecs via Git's :(glob) to match **/*.ext like the shell version.
+  static const std::string defaultCppGlobPathspec =
+      ":(glob)**/*.c,:(glob)**/*.cc,:(glob)**/*.cpp,:(glob)**/*.cxx,:(glob)**/*.h,:(glob)**/*.hh,:(glob)**/*.hpp";
+  return onlyPathsCsv.empty() ? defaultCppGlobPathspec : onlyPathsCsv;
+}
+
+// -M and -C, with the threshold spelled out only when it differs from git's default.
+static void appendRenameArgs(std::vector<std::string> &args, int renameThreshold) {
+  const std::string pct = renameThreshold == 50 ? std::string() : std::to_string(renameThreshold) + "%";
+  args.push_back("-M" + pct);
+  args.push_back("-C" + pct);
+}
+
+// The patch goes to sink while git runs when one is given, otherwise into text.
+static void fetchUnifiedDiff(const RangeSnapshot &snap, const std::string &pathspecCsv, const LineBatchFn &sink,
+                             std::string &text) {
+  std::vector<std::string> args = {"diff"};
+  appendRenameArgs(args, snap.renameThreshold);
+  args.insert(args.end(), {"--unified=0","--no-ext-diff"});
+  if (snap.ignoreWhitespace) args.push_back("-w");
+  args.push_back(snap.baseRef + ".." + snap.targetRef);
+  appendPathspecs(args, pathspecCsv);
+  if (sink) streamGit(args, snap.repoRoot, sink);
+  else runGitCapture(args, snap.repoRoot, text);
+}
+
+// Where the two patches go. With identical pathspecs the CLI patch is the same
+// text: stored once (cliDiffIsDiff) or teed from the one stream into both outputs.
+struct PatchOutputs {
+  bool diff {false};
+  bool cliDiff {false};        // a separate CLI patch has to be produced
+  bool cliDiffIsDiff {false};
+  LineBatchFn diffSink;
+  LineBatchFn cliDiffSink;
+  // The parts each native stream hands over a blob pair at a time; 0 when
+  // the stream is not streamed through the pair hooks
+  unsigned diffPairParts {0};
+  unsigned cliDiffPairParts {0};
+  const DiffSinks *sinks {nullptr};
+};
+
+static PatchOutputs planPatches(RangeSnapshot &snap, const DiffSinks &sinks) {
+  PatchOutputs p;
+  p.diff = snap.parts & SnapshotDiff;
+  p.cliDiff = snap.parts & SnapshotCliDiff;
+  p.diffSink = sinks.diff;
+  p.cliDiffSink = sinks.cliDiff;
+  p.sinks = &sinks;
+  const bool pairs = sinks.pairKnown && sinks.pairHunks;
+  p.diffPairParts = pairs && sinks.diff ? SnapshotDiff : 0u;
+  p.cliDiffPairParts = pairs && sinks.cliDiff ? SnapshotCliDiff : 0u;
+  if (!p.diff || !p.cliDiff || cliPathspecFor(snap.onlyPaths) != snap.onlyPaths) return p;
+  p.cliDiff = false;
+  if (!sinks.diff && !sinks.cliDiff) {
+    p.cliDiffIsDiff = true;
+    return p;
+  }
+  // Pairs handed over skip both sinks, so both have to be there
+  p.diffPairParts = pairs && sinks.diff && sinks.cliDiff ? SnapshotDiff | SnapshotCliDiff : 0u;
+  p.diffSink = [&snap, &sinks](std::string_view lines) {
+    if (sinks.diff) sinks.diff(lines); else snap.diff.append(lines);
+    if (sinks.cliDiff) sinks.cliDiff(lines); else snap.cliDiff.append(lines);
+  };
+  return p;
+}
+
+static void fetchFileStats(RangeSnapshot &snap) {
+  auto statArgs = [&]() {
+    std::vector<std::string> args = {"-c", "color.ui=false", "-c", "core.quotepath=false", "diff"};
+    appendRenameArgs(args, snap.renameThreshold);
+    if (snap.ignoreWhitespace) args.push_back("-w");
+    return args;
+  };
+  // With -w, whitespace-only edits still show up in --raw, so ask git whether the
+  // range differs at all; without -w an empty --raw listing already answers that.
+  if (snap.ignoreWhitespace) {
+    auto args = statArgs();
+    args.push_back("--quiet");
+    args.push_back(snap.baseRef + ".." + snap.targetRef);
+    appendPathspecs(args, snap.onlyPaths);
+    std::string out;
+    if (runGitCapture(args, snap.repoRoot, out) == 0) { snap.hasChanges = false; return; }
+  }
+  auto args = statArgs();
+  args.push_back("--raw"); args.push_back("--numstat"); args.push_back("-z");
+  args.push_back(snap.baseRef + ".." + snap.targetRef);
+  appendPathspecs(args, snap.onlyPaths);
+  runGitCapture(args, snap.repoRoot, snap.rawNumstat);
+  snap.hasChanges = !snap.rawNumstat.empty();
+}
+
+static bool resolveTree(ObjectStore &store, GitBatch &batch, const std::string &ref, ObjectId &tree) {
+  ObjectId id = ObjectId::fromHex(ref);
+  if (id.size != store.hashSize()) id = ObjectId::fromHex(batch.resolveCommit(ref));
+  return !id.empty() && commitTree(store, id, tree);
+}
+
+// Changes for one pathspec, with renames and copies paired like -M -C.
+static bool nativeChanges(ObjectStore &store, const RangeSnapshot &snap, const ObjectId &baseTree,
+                          const ObjectId &targetTree, const std::string &pathspecCsv, std::vector<TreeChange> &out) {
+  const PathFilter filter(pathspecCsv);
+  if (!filter.supported()) return false;
+  // Pathspecs are relative to the directory git runs in; only the top level maps 1:1 onto tree paths.
+  const std::filesystem::path root = snap.repoRoot.empty() ? std::filesystem::path(".") : std::filesystem::path(snap.repoRoot);
+  std::error_code ec;
+  if (!filter.empty() && !std::filesystem::exists(root / ".git", ec)) return false;
+  if (!diffTrees(store, baseTree, targetTree, filter, out)) return false;
+  RenameOptions renames;
+  renames.minSimilarity = snap.renameThreshold;
+  return detectRenames(store, out, renames);
+}
+
+// The patch text follows diff.algorithm; algorithms other than myers and
+// histogram are left to git.
+static bool nativeDiffOptions(const RangeSnapshot &snap, BlobDiffOptions &opts) {
+  opts.ignoreWhitespace = snap.ignoreWhitespace;
+  if (!(snap.parts & (SnapshotDiff | SnapshotCliDiff))) return true;
+  std::string algo;
+  runGitCapture({"config", "--get", "diff.algorithm"}, snap.repoRoot, algo);
+  algo = trim(algo);
+  if (algo == "histogram") opts.algorithm = DiffAlgorithm::Histogram;
+  return algo.empty() || algo == "myers" || algo == "default" || algo == "histogram";
+}
+
+// Patches go to sink about every kNativeBatchBytes when one is given, otherwise into out.
+static constexpr std::size_t kNativeBatchBytes = 1u << 20;
+
+// With pairParts, sections whose hunks depend on their blobs alone go through
+// the sinks' pair hooks (see DiffSinks); the hunks of the pairs not known yet
+// are collected in `hunks` and handed over about every kNativeBatchBytes.
+static bool renderNativeDiff(ObjectStore &store, std::vector<TreeChange> &changes, const BlobDiffOptions &opts,
+                             const LineBatchFn &sink, unsigned pairParts, const DiffSinks &sinks, std::string &out) {
+  std::string hunks;
+  std::vector<PairSection> pending;
+  std::vector<std::size_t> ends;   // of each pending section's hunks
+  auto handOver = [&]() {
+    for (std::size_t i = 0, begin = 0; i < pending.size(); begin = ends[i++]) {
+      pending[i].hunks = std::string_view(hunks).substr(begin, ends[i] - begin);
+    }
+    sinks.pairHunks(pending);
+    pending.clear();
+    ends.clear();
+    hunks.clear();
+  };
+  for (auto &c : changes) {
+    if (pairParts && hunksByBlobs(c)) {
+      PairSection section;
+      section.parts = pairParts;
+      section.change = &c;
+      section.opts = &opts;
+      const bool known = sinks.pairKnown(section);
+      if (!appendPatchSplit(store, c, opts, known, section.shape, out, hunks)) return false;
+      if (!known) {
+        pending.push_back(section);
+        ends.push_back(hunks.size());
+        if (hunks.size() >= kNativeBatchBytes) handOver();
+      }
+    } else if (!appendPatch(store, c, opts, out)) {
+      return false;
+    }
+    if (sink && out.size() >= kNativeBatchBytes) { sink(out); out.clear(); }
+  }
+  if (!pending.empty()) handOver();
+  if (sink && !out.empty()) { sink(out); out.clear(); }
+  return true;
+}
+
+// A streamed patch cannot be taken back to retry through git, so check before
+// the first batch that every blob is there (a partial clone may lack some).
+static bool blobsPresent(ObjectStore &store, const std::vector<TreeChange> &changes) {
+  auto present = [&](const ObjectId &oid, std::uint32_t mode) {
+    return oid.empty() || (mode & 0170000u) == 0160000u || store.contains(oid);
+  };
+  return std::all_of(changes.begin(), changes.end(), [&](const TreeChange &c) {
+    return present(c.oldOid, c.oldMode) && present(c.newOid, c.newMode);
+  });
+}
+
+// In-process equivalent of fetchFileStats and fetchUnifiedDiff for the parts
+// requested; returns false to leave all of them to git.
+static bool fetchNative(RangeSnapshot &snap, const PatchOutputs &patches) {
+  BlobDiffOptions opts;
+  if (!nativeDiffOptions(snap, opts)) return false;
+  auto store = ObjectStore::open(snap.repoRoot);
+  if (!store) return false;
+
+  GitBatch batch(snap.repoRoot);
+  ObjectId baseTree, targetTree;
+  if (!resolveTree(*store, batch, snap.baseRef, baseTree) || !resolveTree(*store, batch, snap.targetRef, targetTree)) return false;
+
+  std::vector<TreeChange> changes, cliChanges;
+  if ((snap.parts & SnapshotFileStats) || patches.diff) {
+    if (!nativeChanges(*store, snap, baseTree, targetTree, snap.onlyPaths, changes)) return false;
+  }
+  if (patches.cliDiff) {
+    if (!nativeChanges(*store, snap, baseTree, targetTree, cliPathspecFor(snap.onlyPaths), cliChanges)) return false;
+  }
+  if ((patches.diffSink && !blobsPresent(*store, changes)) || (patches.cliDiffSink && !blobsPresent(*store, cliChanges))) {
+    return false;
+  }
+
+  std::string diff, cliDiff;
+  // Rendering the patch yields the line stats as a by-product
+  if (patches.diff) {
+    if (!renderNativeDiff(*store, changes, opts, patches.diffSink, patches.diffPairParts, *patches.sinks, diff)) return false;
+  } else if ((snap.parts & SnapshotFileStats) && !computeLineStats(*store, changes, opts)) {
+    return false;
+  }
+  if (patches.cliDiff &&
+      !renderNativeDiff(*store, cliChanges, opts, patches.cliDiffSink, patches.cliDiffPairParts, *patches.sinks, cliDiff)) {
+    return false;
+  }
+
+  if (snap.parts & SnapshotFileStats) {
+    // Mirrors `git diff -w --quiet`: only content changes count, not renames or mode flips.
+    if (snap.ignoreWhitespace) {
+      snap.hasChanges = std::any_of(changes.begin(), changes.end(), [](const TreeChange &c) {
+        return c.binary || c.insertions > 0 || c.deletions > 0;
+      });
+    } else {
+      snap.hasChanges = !changes.empty();
+    }
+    snap.changes = std::move(changes);
+    snap.native = true;
+  }
+  if (!diff.empty()) snap.diff = std::move(diff);
+  if (!cliDiff.empty()) snap.cliDiff = std::move(cliDiff);
+  return true;
+}
+
+RangeSnapshot collectRangeSnapshot(const std::string &repoRoot,
+                                   const std::string &baseRef,
+                                   const std::string &targetRef,
+                                   const std::string &onlyPathsCsv,
+                                   bool ignoreWhitespace,
+                                   unsigned parts,
+                                   bool native,
+                                   int renameThreshold,
+                                   const DiffSinks &sinks) {
+  RangeSnapshot snap;
+  snap.repoRoot = repoRoot;
+  snap.baseRef = baseRef;
+  snap.targetRef = targetRef;
+  snap.onlyPaths = onlyPathsCsv;
+  snap.ignoreWhitespace = ignoreWhitespace;
+  snap.parts = parts;
+  snap.renameThreshold = renameThreshold;
+
+  const PatchOutputs patches = planPatches(snap, sinks);
+  snap.cliDiffIsDiff = patches.cliDiffIsDiff;
+  const bool nativeDone = native && (parts & (SnapshotFileStats | SnapshotDiff | SnapshotCliDiff)) && fetchNative(snap, patches);
+  if (!nativeDone) {
+    if (parts & SnapshotFileStats) fetchFileStats(snap);
+    if (patches.diff) fetchUnifiedDiff(snap, onlyPathsCsv, patches.diffSink, snap.diff);
+    if (patches.cliDiff) fetchUnifiedDiff(snap, cliPathspecFor(onlyPathsCsv), patches.cliDiffSink, snap.cliDiff);
+  }
+  if (parts & SnapshotLog) {
+    // One NUL-ended record per commit, so messages can be matched one by one
+    const std::vector<std::string> args = {"log", "-z", "--format=%s %b", baseRef + ".." + targetRef};
+    if (sinks.log) {
+      LineStreamOptions records;
+      records.delimiter = '\0';
+      streamGit(args, repoRoot, sinks.log, records);
+    } else {
+      runGitCapture(args, repoRoot, snap.log);
+    }
+  }
+  return snap;
+}
+
+}
@@ -0,0 +1,759 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/result_cache.h"
+#include "next_version/object_store.h"
+#include "next_version/git_helpers.h"
+#include "next_version/util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace nv {
+
+namespace {
+
+constexpr char kMagic[4] = {'N', 'V', 'R', 'C'};
+constexpr char kPairMagic[4] = {'N', 'V', 'P', 'C'};
+constexpr char kCommitMagic[4] = {'N', 'V', 'C', 'C'};
+constexpr std::string_view kEntrySuffix = ".nvr";
+
+std::uint64_t hash64(std::string_view s, std::uint64_t seed) {
+  std::uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+  for (char c : s) h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+  h ^= h >> 32;
+  h *= 0x9e3779b97f4a7c15ULL;
+  return h ^ (h >> 29);
+}
+
+void putU32(std::string &out, std::uint32_t v) { out.append(reinterpret_cast<const char *>(&v), sizeof(v)); }
+void putU64(std::string &out, std::uint64_t v) { out.append(reinterpret_cast<const char *>(&v), sizeof(v)); }
+void putString(std::string &out, std::string_view s) {
+  putU32(out, static_cast<std::uint32_t>(s.size()));
+  out.append(s);
+}
+
+// Bounds-checked reads over an entry; any overrun leaves ok false.
+struct Reader {
+  std::string_view data;
+  bool ok {true};
+
+  template <class T>
+  T get() {
+    T v {};
+    if (data.size() < sizeof(T)) { ok = false; return v; }
+    std::memcpy(&v, data.data(), sizeof(T));
+    data.remove_prefix(sizeof(T));
+    return v;
+  }
+  std::string_view bytes(std::size_t n) {
+    if (data.size() < n) { ok = false; return {}; }
+    std::string_view s = data.substr(0, n);
+    data.remove_prefix(n);
+    return s;
+  }
+  std::string_view string() { return bytes(get<std::uint32_t>()); }
+};
+
+void putKv(std::string &out, const Kv &kv) {
+  putU32(out, static_cast<std::uint32_t>(kv.size()));
+  for (const auto &[k, v] : kv) {
+    putString(out, k);
+    putString(out, v);
+  }
+}
+
+bool getKv(Reader &in, Kv &kv) {
+  kv.clear();
+  for (std::uint32_t n = in.get<std::uint32_t>(); in.ok && n > 0; --n) {
+    const std::string_view k = in.string();
+    const std::string_view v = in.string();
+    if (in.ok) kv.emplace_hint(kv.end(), k, v);
+  }
+  return in.ok;
+}
+
+void putAnalysis(std::string &out, const RangeAnalysis &value) {
+  putKv(out, value.files);
+  putKv(out, value.cli);
+  putKv(out, value.security);
+  putKv(out, value.keywords);
+}
+
+// The rest of in must be exactly one RangeAnalysis.
+bool getAnalysis(Reader &in, RangeAnalysis &value) {
+  return getKv(in, value.files) && getKv(in, value.cli) && getKv(in, value.security) && getKv(in, value.keywords) &&
+         in.data.empty();
+}
+
+void putStrings(std::string &out, const std::vector<std::string> &list) {
+  putU32(out, static_cast<std::uint32_t>(list.size()));
+  for (const std::string &s : list) putString(out, s);
+}
+
+bool getStrings(Reader &in, std::vector<std::string> &list) {
+  list.clear();
+  for (std::uint32_t n = in.get<std::uint32_t>(); in.ok && n > 0; --n) {
+    const std::string_view s = in.string();
+    if (in.ok) list.emplace_back(s);
+  }
+  return in.ok;
+}
+
+std::string encodeFindings(const PairFindings &f) {
+  std::string out;
+  out.push_back(static_cast<char>(f.shape.binary | f.shape.hasHunks << 1 | f.cli.apiBreaking << 2));
+  putU32(out, static_cast<std::uint32_t>(f.shape.insertions));
+  putU32(out, static_cast<std::uint32_t>(f.shape.deletions));
+  // Most pairs hit no pattern at all
+  std::uint32_t hit = 0;
+  for (int n : f.hits.hits) hit += n != 0;
+  putU32(out, hit);
+  for (std::size_t i = 0; i < f.hits.hits.size(); ++i) {
+    if (f.hits.hits[i] == 0) continue;
+    putU32(out, static_cast<std::uint32_t>(i));
+    putU32(out, static_cast<std::uint32_t>(f.hits.hits[i]));
+  }
+  for (const auto *list : {&f.cli.removedLongFromStruct, &f.cli.addedLongFromStruct, &f.cli.removedLongManual,
+                           &f.cli.addedLongManual, &f.cli.removedCases, &f.cli.addedCases}) {
+    putStrings(out, *list);
+  }
+  putU32(out, static_cast<std::uint32_t>(f.cli.removedShortCount));
+  return out;
+}
+
+bool decodeFindings(std::string_view data, PairFindings &f) {
+  Reader in {data};
+  f = PairFindings{};
+  const auto flags = in.get<std::uint8_t>();
+  f.shape.binary = flags & 1;
+  f.shape.hasHunks = flags & 2;
+  f.cli.apiBreaking = flags & 4;
+  f.shape.insertions = static_cast<int>(in.get<std::uint32_t>());
+  f.shape.deletions = static_cast<int>(in.get<std::uint32_t>());
+  for (std::uint32_t n = in.get<std::uint32_t>(); in.ok && n > 0; --n) {
+    const std::uint32_t i = in.get<std::uint32_t>();
+    const std::uint32_t v = in.get<std::uint32_t>();
+    if (i >= f.hits.hits.size()) return false;
+    f.hits.hits[i] = static_cast<int>(v);
+  }
+  for (auto *list : {&f.cli.removedLongFromStruct, &f.cli.addedLongFromStruct, &f.cli.removedLongManual,
+                     &f.cli.addedLongManual, &f.cli.removedCases, &f.cli.addedCases}) {
+    if (!getStrings(in, *list)) return false;
+  }
+  f.cli.removedShortCount = static_cast<int>(in.get<std::uint32_t>());
+  return in.ok && in.data.empty();
+}
+
+// A record: the length of its body, the body (key and findings) and a checksum of it.
+void putRecord(std::string &out, std::string_view key, std::string_view findings) {
+  std::string body;
+  putString(body, key);
+  putString(body, findings);
+  putU32(out, static_cast<std::uint32_t>(body.size()));
+  out += body;
+  putU64(out, hash64(body, 4));
+}
+
+std::string pairFileHeader() {
+  std::string out(kPairMagic, sizeof(kPairMagic));
+  putU32(out, PairCache::kFormatVersion);
+  return out;
+}
+
+bool writeAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+    const ssize_t n = ::write(fd, data.data(), data.size());
+    if (n < 0) return false;
+    data.remove_prefix(static_cast<std::size_t>(n));
+  }
+  return true;
+}
+
+bool readWhole(const fs::path &path, std::string &out) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) return false;
+  out.resize(static_cast<std::size_t>(in.tellg()));
+  in.seekg(0);
+  return static_cast<bool>(in.read(out.data(), static_cast<std::streamsize>(out.size())));
+}
+
+// A name beside path that no other thread or process of ours writes to:
+// the pid tells processes apart and the counter the threads of one process.
+fs::path tempSibling(const fs::path &path) {
+  static std::atomic<unsigned> counter{0};
+  fs::path tmp = path;
+  tmp += ".tmp." + std::to_string(::getpid()) + "." + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+  return tmp;
+}
+
+// data to path through a temporary file and a rename.
+bool replaceFile(const fs::path &path, std::string_view data) {
+  std::error_code ec;
+  fs::create_directories(path.parent_path(), ec);
+  const fs::path tmp = tempSibling(path);
+  ::unlink(tmp.c_str());   // left by a process of ours that died
+  const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+  if (fd < 0) return false;
+  const bool written = writeAll(fd, data);
+  if (::close(fd) != 0 || !written || ::rename(tmp.c_str(), path.c_str()) != 0) {
+    ::unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+// The first slot's worth of the table is its header; the slots follow.
+constexpr char kSharedMagic[4] = {'N', 'V', 'S', 'C'};
+constexpr std::size_t kStateOffset = 0;      // u32: 2 ready
+constexpr std::size_t kMagicOffset = 4;
+constexpr std::size_t kShapeOffset = 8;      // u32 slots, u32 slot bytes
+// In a slot
+constexpr std::size_t kTagOffset = 0;        // u64, 0 while the slot is free
+constexpr std::size_t kSeqOffset = 8;        // u32, odd while the entry is written
+constexpr std::size_t kLengthOffset = 12;    // u32
+constexpr std::size_t kSumOffset = 16;       // u64
+constexpr std::size_t kEntryOffset = 24;
+constexpr std::size_t kEntryBytes = SharedCache::kSlotBytes - kEntryOffset;
+constexpr std::size_t kTableBytes = (SharedCache::kSlots + 1) * SharedCache::kSlotBytes;
+
+template <class T>
+std::atomic_ref<T> field(unsigned char *base, std::size_t offset) {
+  return std::atomic_ref<T>(*reinterpret_cast<T *>(base + offset));
+}
+
+std::uint64_t sharedTag(std::string_view serializedKey) {
+  return hash64(serializedKey, 6) | 1;   // never the free tag
+}
+
+}
+
+std::string ResultCacheKey::serialize() const {
+  std::string out;
+  putU32(out, kAnalysisVersion);
+  putString(out, baseOid);
+  putString(out, targetOid);
+  putString(out, onlyPaths);
+  putString(out, pathPrefix);
+  putString(out, diffAlgorithm);
+  out.push_back(static_cast<char>(ignoreWhitespace | firstParent << 1 | noMergeBase << 2 | nativeGit << 3));
+  putU32(out, static_cast<std::uint32_t>(renameThreshold));
+  putU64(out, configHash);
+  return out;
+}
+
+std::uint64_t hashConfigValues(const ConfigValues &cfg) {
+  std::string bytes;
+  for (int v : {cfg.majorBonusThreshold, cfg.minorBonusThreshold, cfg.patchBonusThreshold, cfg.bonusBreakingCli,
+                cfg.bonusApiBreaking, cfg.bonusRemovedOption, cfg.bonusCliChanges, cfg.bonusManualCli, cfg.bonusNewSource,
+                cfg.bonusNewTest, cfg.bonusNewDoc, cfg.bonusSecurity, cfg.baseDeltaPatch, cfg.baseDeltaMinor,
+                cfg.baseDeltaMajor, cfg.locDivisorPatch, cfg.locDivisorMinor, cfg.locDivisorMajor}) {
+    putU32(bytes, static_cast<std::uint32_t>(v));
+  }
+  std::uint64_t cap;
+  std::memcpy(&cap, &cfg.bonusMultiplierCap, sizeof(cap));
+  putU64(bytes, cap);
+  return hash64(bytes, 0);
+}
+
+bool makeResultCacheKey(const RefResolution &ref, const Options &opts, const ConfigValues &cfg, ResultCacheKey &key) {
+  key.baseOid = ref.effectiveBaseSha.empty() ? ref.requestedBaseSha : ref.effectiveBaseSha;
+  key.targetOid = ref.targetSha;
+  if (key.baseOid.empty() || key.targetOid.empty()) return false;
+  key.onlyPaths = opts.onlyPaths;
+  // Pathspecs are relative to the directory git runs in
+  key.pathPrefix.clear();
+  if (!key.onlyPaths.empty()) {
+    if (runGitCapture({"rev-parse", "--show-prefix"}, opts.repoRoot, key.pathPrefix) != 0) return false;
+    key.pathPrefix = trim(key.pathPrefix);
+  }
+  key.diffAlgorithm.clear();
+  runGitCapture({"config", "--get", "diff.algorithm"}, opts.repoRoot, key.diffAlgorithm);
+  key.diffAlgorithm = trim(key.diffAlgorithm);
+  key.ignoreWhitespace = opts.ignoreWhitespace;
+  key.firstParent = opts.firstParent;
+  key.noMergeBase = opts.noMergeBase;
+  key.nativeGit = opts.nativeGit;
+  key.renameThreshold = opts.renameThreshold;
+  key.configHash = hashConfigValues(cfg);
+  return true;
+}
+
+ResultCache::ResultCache(fs::path dir, std::uintmax_t maxBytes) : dir_(std::move(dir)), maxBytes_(maxBytes) {}
+
+ResultCache ResultCache::forRepository(const std::string &repoRoot) {
+  const std::string common = gitCommonDir(repoRoot);
+  if (common.empty()) return ResultCache(fs::path());
+  return ResultCache(fs::path(common) / "next-version" / "cache");
+}
+
+fs::path ResultCache::entryPath(const std::string &serializedKey) const {
+  char name[40];
+  std::snprintf(name, sizeof(name), "%016llx%016llx", static_cast<unsigned long long>(hash64(serializedKey, 1)),
+                static_cast<unsigned long long>(hash64(serializedKey, 2)));
+  return dir_ / (std::string(name) + std::string(kEntrySuffix));
+}
+
+bool ResultCache::load(const ResultCacheKey &key, RangeAnalysis &out) const {
+  if (!enabled()) return false;
+  const std::string serialized = key.serialize();
+  const fs::path path = entryPath(serialized);
+  std::string data;
+  if (!readWhole(path, data)) return false;
+  if (data.size() < sizeof(kMagic) + 4 + 8 || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) return false;
+  const std::string_view body(data.data(), data.size() - 8);
+  std::uint64_t sum;
+  std::memcpy(&sum, data.data() + body.size(), sizeof(sum));
+  if (sum != hash64(body, 3)) return false;
+
+  Reader r {body.substr(sizeof(kMagic))};
+  if (r.get<std::uint32_t>() != kFormatVersion || r.string() != serialized) return false;
+  RangeAnalysis value;
+  if (!getAnalysis(r, value)) return false;
+  out = std::move(value);
+  std::error_code ec;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), ec);   // most recently used
+  return true;
+}
+
+bool ResultCache::store(const ResultCacheKey &key, const RangeAnalysis &value) const {
+  if (!enabled()) return false;
+  const std::string serialized = key.serialize();
+  std::string data(kMagic, sizeof(kMagic));
+  putU32(data, kFormatVersion);
+  putString(data, serialized);
+  putAnalysis(data, value);
+  putU64(data, hash64(data, 3));
+
+  if (!replaceFile(entryPath(serialized), data)) return false;
+  evict();
+  return true;
+}
+
+void ResultCache::evict() const {
+  struct Entry {
+    fs::file_time_type used;
+    std::uintmax_t bytes;
+    fs::path path;
+  };
+  std::vector<Entry> entries;
+  std::uintmax_t total = 0;
+  std::error_code ec;
+  for (fs::directory_iterator it(dir_, ec), end; !ec && it != end; it.increment(ec)) {
+    const fs::path &p = it->path();
+    if (p.extension() != kEntrySuffix) continue;
+    std::error_code fe;
+    const std::uintmax_t bytes = it->file_size(fe);
+    const fs::file_time_type used = it->last_write_time(fe);
+    if (fe) continue;
+    entries.push_back({used, bytes, p});
+    total += bytes;
+  }
+  if (total <= maxBytes_) return;
+  std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.used < b.used; });
+  for (const Entry &e : entries) {
+    if (total <= maxBytes_) break;
+    if (fs::remove(e.path, ec)) total -= e.bytes;
+  }
+}
+
+// A table is set up under a name of its own and linked into place whole, so
+// no process ever sees one half made. Returns the table's descriptor, or the
+// one another process linked first, or -1.
+static int createSharedTable(const fs::path &file) {
+  const fs::path tmp = tempSibling(file);
+  ::unlink(tmp.c_str());   // left by a process of ours that died
+  const int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+  if (fd < 0) return -1;
+  unsigned char header[16] = {};
+  const std::uint32_t ready = 2;
+  const std::uint32_t shape[2] = {static_cast<std::uint32_t>(SharedCache::kSlots), static_cast<std::uint32_t>(SharedCache::kSlotBytes)};
+  std::memcpy(header + kStateOffset, &ready, sizeof(ready));
+  std::memcpy(header + kMagicOffset, kSharedMagic, sizeof(kSharedMagic));
+  std::memcpy(header + kShapeOffset, shape, sizeof(shape));
+  const bool made = ::ftruncate(fd, kTableBytes) == 0 && ::pwrite(fd, header, sizeof(header), 0) == sizeof(header) &&
+                    ::link(tmp.c_str(), file.c_str()) == 0;
+  const bool raced = !made && errno == EEXIST;
+  ::unlink(tmp.c_str());
+  if (made) return fd;
+  ::close(fd);
+  return raced ? ::open(file.c_str(), O_RDWR | O_NOFOLLOW | O_CLOEXEC) : -1;
+}
+
+// Only a table of our own is read: anyone who can write it decides what we
+// read. It must be the file itself, not a link, with the exact size and a
+// ready header; a table is never resized or repaired in place.
+static bool usableSharedTable(int fd) {
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_uid != ::getuid() ||
+      static_cast<std::size_t>(st.st_size) != kTableBytes) {
+    return false;
+  }
+  unsigned char header[16];
+  if (::pread(fd, header, sizeof(header), 0) != sizeof(header)) return false;
+  std::uint32_t state, shape[2];
+  std::memcpy(&state, header + kStateOffset, sizeof(state));
+  std::memcpy(shape, header + kShapeOffset, sizeof(shape));
+  return state == 2 && std::memcmp(header + kMagicOffset, kSharedMagic, sizeof(kSharedMagic)) == 0 &&
+         shape[0] == SharedCache::kSlots && shape[1] == SharedCache::kSlotBytes;
+}
+
+SharedCache::SharedCache(const fs::path &dir) {
+  if (dir.empty()) return;
+  std::error_code ec;
+  fs::create_directories(dir, ec);
+  file_ = dir / ("next-version-" + std::to_string(::getuid()) + "-" + std::to_string(kFormatVersion) + "." +
+                 std::to_string(kAnalysisVersion) + ".table");
+  int fd = ::open(file_.c_str(), O_RDWR | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0 && errno == ENOENT) fd = createSharedTable(file_);
+  if (fd < 0) return;
+  void *p = usableSharedTable(fd) ? ::mmap(nullptr, kTableBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+  ::close(fd);
+  if (p != MAP_FAILED) map_ = static_cast<unsigned char *>(p);
+}
+
+SharedCache::~SharedCache() {
+  if (map_) ::munmap(map_, kTableBytes);
+}
+
+unsigned char *SharedCache::slot(std::size_t i) const {
+  return map_ + (1 + i % kSlots) * kSlotBytes;
+}
+
+bool SharedCache::load(const ResultCacheKey &key, RangeAnalysis &out) const {
+  if (!enabled()) return false;
+  const std::string serialized = key.serialize();
+  const std::uint64_t tag = sharedTag(serialized);
+  std::string entry;
+  for (std::size_t i = 0; i < kProbe; ++i) {
+    unsigned char *s = slot(tag + i);
+    const std::uint64_t found = field<std::uint64_t>(s, kTagOffset).load(std::memory_order_acquire);
+    if (found == 0) return false;   // slots are never freed, so the key is not further on
+    if (found != tag) continue;
+    // A slot being written, or left odd by a writer that died, is passed over:
+    // the key may have a copy further on
+    auto seq = field<std::uint32_t>(s, kSeqOffset);
+    const std::uint32_t before = seq.load(std::memory_order_acquire);
+    if (before & 1) continue;
+    const std::uint32_t length = field<std::uint32_t>(s, kLengthOffset).load(std::memory_order_relaxed);
+    const std::uint64_t sum = field<std::uint64_t>(s, kSumOffset).load(std::memory_order_relaxed);
+    if (length > kEntryBytes) continue;
+    entry.assign(reinterpret_cast<const char *>(s + kEntryOffset), length);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq.load(std::memory_order_relaxed) != before || sum != hash64(entry, 7)) continue;
+
+    Reader r {entry};
+    RangeAnalysis value;
+    if (r.string() != serialized || !getAnalysis(r, value)) continue;
+    out = std::move(value);
+    return true;
+  }
+  return false;
+}
+
+bool SharedCache::store(const ResultCacheKey &key, const RangeAnalysis &value) const {
+  if (!enabled()) return false;
+  const std::string serialized = key.serialize();
+  std::string entry;
+  putString(entry, serialized);
+  putAnalysis(entry, value);
+  if (entry.size() > kEntryBytes) return false;
+  const std::uint64_t tag = sharedTag(serialized);
+
+  // The key's slot, a free one, or else the last one probed. Writers take a
+  // slot by moving its sequence from even to odd; a slot another writer holds,
+  // or one left odd by a writer that died, is passed over for the next.
+  for (std::size_t i = 0; i < kProbe; ++i) {
+    unsigned char *s = slot(tag + i);
+    std::uint64_t found = 0;
+    const bool ours = field<std::uint64_t>(s, kTagOffset).compare_exchange_strong(found, tag) || found == tag;
+    if (!ours && i + 1 < kProbe) continue;
+    auto seq = field<std::uint32_t>(s, kSeqOffset);
+    std::uint32_t before = seq.load(std::memory_order_relaxed);
+    if ((before & 1) || !seq.compare_exchange_strong(before, before + 1, std::memory_order_relaxed)) continue;
+    std::atomic_thread_fence(std::memory_order_release);
+    field<std::uint64_t>(s, kTagOffset).store(tag, std::memory_order_relaxed);
+    field<std::uint32_t>(s, kLengthOffset).store(static_cast<std::uint32_t>(entry.size()), std::memory_order_relaxed);
+    field<std::uint64_t>(s, kSumOffset).store(hash64(entry, 7), std::memory_order_relaxed);
+    std::memcpy(s + kEntryOffset, entry.data(), entry.size());
+    seq.store(before + 2, std::memory_order_release);
+    return true;
+  }
+  return false;
+}
+
+PairCache::PairCache(fs::path file, std::uintmax_t maxBytes) : file_(std::move(file)), maxBytes_(maxBytes) {
+  if (!enabled() || !readWhole(file_, loaded_) || loaded_.empty()) return;
+  const std::string header = pairFileHeader();
+  if (loaded_.compare(0, header.size(), header) != 0) {
+    damaged_ = true;
+    return;
+  }
+  Reader in {std::string_view(loaded_).substr(header.size())};
+  while (!in.data.empty()) {
+    const std::string_view start = in.data;
+    const std::string_view body = in.string();
+    const auto sum = in.get<std::uint64_t>();
+    Reader fields {body};
+    const std::string_view key = fields.string();
+    const std::string_view findings = fields.string();
+    if (!in.ok || !fields.ok || !fields.data.empty() || sum != hash64(body, 4)) {
+      damaged_ = true;
+      break;
+    }
+    records_[key] = Record {start.substr(0, start.size() - in.data.size()), findings};
+  }
+}
+
+fs::path PairCache::pathFor(const std::string &repoRoot) {
+  const std::string common = gitCommonDir(repoRoot);
+  return common.empty() ? fs::path() : fs::path(common) / "next-version" / "pairs";
+}
+
+std::string PairCache::key(unsigned part, const TreeChange &change, const BlobDiffOptions &opts) {
+  std::string out;
+  putU32(out, kAnalysisVersion);
+  out.push_back(static_cast<char>(part));
+  out.push_back(static_cast<char>(opts.ignoreWhitespace | (opts.algorithm == DiffAlgorithm::Histogram) << 1));
+  // The sides a section reads (see appendPatchSplit)
+  for (const ObjectId *oid : {change.status == 'A' ? nullptr : &change.oldOid, change.status == 'D' ? nullptr : &change.newOid}) {
+    out.push_back(static_cast<char>(oid ? oid->size : 0));
+    if (oid) out.append(reinterpret_cast<const char *>(oid->bytes.data()), oid->size);
+  }
+  return out;
+}
+
+bool PairCache::find(const std::string &key, PairFindings &out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (const auto it = records_.find(key); it != records_.end() && decodeFindings(it->second.findings, out)) {
+    it->second.used = true;
+    ++hits_;
+    return true;
+  }
+  if (const auto it = added_.find(key); it != added_.end() && decodeFindings(it->second, out)) {
+    ++hits_;
+    return true;
+  }
+  ++misses_;
+  return false;
+}
+
+void PairCache::add(const std::string &key, const PairFindings &findings) {
+  std::string encoded = encodeFindings(findings);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!records_.count(key)) added_.emplace(key, std::move(encoded));
+}
+
+bool PairCache::save() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enabled() || (added_.empty() && !damaged_)) return true;
+  std::string fresh;
+  for (const auto &[key, findings] : added_) putRecord(fresh, key, findings);
+  if (!loaded_.empty() && !damaged_ && loaded_.size() + fresh.size() <= maxBytes_) {
+    // One write, so records of concurrent runs do not interleave
+    const int fd = ::open(file_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool ok = writeAll(fd, fresh);
+    ::close(fd);
+    return ok;
+  }
+  std::string data = pairFileHeader();
+  for (const auto &[key, record] : records_) {
+    if (record.used) data += record.bytes;
+  }
+  if (data.size() + fresh.size() > maxBytes_) data.resize(pairFileHeader().size());
+  data += fresh;
+  return replaceFile(file_, data);
+}
+
+std::size_t PairCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+std::size_t PairCache::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+CommitCache::CommitCache(fs::path file, PatternSet patterns) : file_(std::move(file)), patterns_(patterns) {
+  if (!enabled()) return;
+  const int fd = ::open(file_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+    void *p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+      map_ = static_cast<const unsigned char *>(p);
+      mapSize_ = static_cast<std::size_t>(st.st_size);
+    }
+  }
+  ::close(fd);
+  if (!map_) return;
+
+  Reader in {std::string_view(reinterpret_cast<const char *>(map_), mapSize_)};
+  const std::string_view magic = in.bytes(sizeof(kCommitMagic));
+  const auto format = in.get<std::uint32_t>();
+  const auto analysis = in.get<std::uint32_t>();
+  const auto patternsInFile = in.get<std::uint32_t>();
+  const auto idSize = in.get<std::uint32_t>();
+  if (!in.ok || magic != std::string_view(kCommitMagic, sizeof(kCommitMagic)) || format != kFormatVersion ||
+      analysis != kAnalysisVersion || patternsInFile != patterns_ || idSize == 0 || idSize > 32) {
+    rewrite_ = true;
+    return;
+  }
+  idSize_ = idSize;
+  while (!in.data.empty()) {
+    const auto count = in.get<std::uint32_t>();
+    const std::string_view entries = in.bytes(std::size_t(count) * entrySize());
+    const auto sum = in.get<std::uint64_t>();
+    if (!in.ok || sum != hash64(entries, 5 ^ count)) {
+      rewrite_ = true;
+      break;
+    }
+    blocks_.push_back({reinterpret_cast<const unsigned char *>(entries.data()), count});
+  }
+}
+
+CommitCache::~CommitCache() {
+  if (map_) ::munmap(const_cast<unsigned char *>(map_), mapSize_);
+}
+
+fs::path CommitCache::pathFor(const std::string &repoRoot) {
+  const std::string common = gitCommonDir(repoRoot);
+  return common.empty() ? fs::path() : fs::path(common) / "next-version" / "commits";
+}
+
+std::size_t CommitCache::entrySize() const {
+  return idSize_ + 4 * static_cast<std::size_t>(__builtin_popcount(patterns_));
+}
+
+const unsigned char *CommitCache::lookup(const ObjectId &id) const {
+  if (id.size != idSize_) return nullptr;
+  const std::size_t size = entrySize();
+  // Newer blocks first; a commit is in at most one unless runs raced
+  for (auto b = blocks_.rbegin(); b != blocks_.rend(); ++b) {
+    std::size_t lo = 0, hi = b->count;
+    while (lo < hi) {
+      const std::size_t mid = lo + (hi - lo) / 2;
+      const unsigned char *entry = b->entries + mid * size;
+      const int c = std::memcmp(entry, id.bytes.data(), idSize_);
+      if (c == 0) return entry;
+      if (c < 0) lo = mid + 1; else hi = mid;
+    }
+  }
+  return nullptr;
+}
+
+bool CommitCache::find(const ObjectId &id, PatternCounts &out) {
+  const unsigned char *entry = lookup(id);
+  if (!entry) {
+    ++misses_;
+    return false;
+  }
+  out = PatternCounts{};
+  const unsigned char *count = entry + idSize_;
+  for (std::size_t i = 0; i < out.hits.size(); ++i) {
+    if (!(patterns_ & (PatternSet(1) << i))) continue;
+    std::uint32_t n;
+    std::memcpy(&n, count, sizeof(n));
+    out.hits[i] = static_cast<int>(n);
+    count += sizeof(n);
+  }
+  ++hits_;
+  return true;
+}
+
+void CommitCache::add(const ObjectId &id, const PatternCounts &counts) {
+  if (id.empty() || lookup(id)) return;
+  added_.emplace_back(id, counts);
+}
+
+void CommitCache::appendEntry(std::string &out, const ObjectId &id, const PatternCounts &counts) const {
+  out.append(reinterpret_cast<const char *>(id.bytes.data()), idSize_);
+  for (std::size_t i = 0; i < counts.hits.size(); ++i) {
+    if (patterns_ & (PatternSet(1) << i)) putU32(out, static_cast<std::uint32_t>(counts.hits[i]));
+  }
+}
+
+bool CommitCache::save() {
+  if (!enabled() || (added_.empty() && !rewrite_)) return true;
+  std::error_code ec;
+  if (idSize_ == 0) {
+    if (added_.empty()) {
+      fs::remove(file_, ec);   // a stale file with nothing to replace it
+      return !ec;
+    }
+    idSize_ = added_.front().first.size;
+  }
+  std::stable_sort(added_.begin(), added_.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::string fresh;
+  std::uint32_t count = 0;
+  for (std::size_t i = 0; i < added_.size(); ++i) {
+    const ObjectId &id = added_[i].first;
+    if (id.size != idSize_ || (i > 0 && id == added_[i - 1].first)) continue;
+    appendEntry(fresh, id, added_[i].second);
+    ++count;
+  }
+  auto putBlock = [](std::string &out, std::uint32_t n, std::string_view entries) {
+    putU32(out, n);
+    out.append(entries);
+    putU64(out, hash64(entries, 5 ^ n));
+  };
+
+  if (map_ && !rewrite_ && blocks_.size() < kMaxBlocks) {
+    if (count == 0) return true;
+    std::string block;
+    putBlock(block, count, fresh);
+    // One write, so blocks of concurrent runs do not interleave
+    const int fd = ::open(file_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool ok = writeAll(fd, block);
+    ::close(fd);
+    return ok;
+  }
+
+  // Merge every block and the new entries into one
+  const std::size_t size = entrySize();
+  std::vector<std::string_view> entries;
+  for (const Block &b : blocks_) {
+    for (std::size_t i = 0; i < b.count; ++i) entries.emplace_back(reinterpret_cast<const char *>(b.entries + i * size), size);
+  }
+  for (std::size_t i = 0; i < count; ++i) entries.push_back(std::string_view(fresh).substr(i * size, size));
+  auto byId = [&](std::string_view a, std::string_view b) { return a.compare(0, idSize_, b, 0, idSize_) < 0; };
+  std::stable_sort(entries.begin(), entries.end(), byId);
+  entries.erase(std::unique(entries.begin(), entries.end(), [&](std::string_view a, std::string_view b) {
+    return a.compare(0, idSize_, b, 0, idSize_) == 0;
+  }), entries.end());
+  std::string all;
+  all.reserve(entries.size() * size);
+  for (std::string_view e : entries) all.append(e);
+
+  std::string data(kCommitMagic, sizeof(kCommitMagic));
+  putU32(data, kFormatVersion);
+  putU32(data, kAnalysisVersion);
+  putU32(data, patterns_);
+  putU32(data, static_cast<std::uint32_t>(idSize_));
+  putBlock(data, static_cast<std::uint32_t>(entries.size()), all);
+  return replaceFile(file_, data);
+}
+
+}
@@ -0,0 +1,343 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/security_tokens.h"
+#include "next_version/pattern_registry.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nv {
+
+namespace {
+
+constexpr std::size_t kNone = std::string_view::npos;
+constexpr std::size_t kMaxToken = 16;       // longest word or glued phrase
+constexpr std::size_t kMaxWords = 128;
+constexpr std::size_t kMaxSequences = 64;
+constexpr unsigned kSlotBits = 11;
+constexpr std::uint8_t kNoWord = 0xff;
+
+// Token bytes: ASCII letters and digits, lowercased; 0 for every other byte.
+constexpr std::array<unsigned char, 256> kFold = [] {
+  std::array<unsigned char, 256> t {};
+  for (unsigned c = '0'; c <= '9'; ++c) t[c] = static_cast<unsigned char>(c);
+  for (unsigned c = 'a'; c <= 'z'; ++c) t[c] = t[c - 32] = static_cast<unsigned char>(c);
+  return t;
+}();
+inline unsigned char fold(char c) { return kFold[static_cast<unsigned char>(c)]; }
+// Letters a..z (either case) as 1..26, then three of them as one index.
+constexpr unsigned letter(unsigned char c) { return (c | 32u) >= 'a' && (c | 32u) <= 'z' ? (c | 32u) - 'a' + 1 : 0; }
+constexpr std::size_t prefixIndex(unsigned char a, unsigned char b, unsigned char c) {
+  return (letter(a) * 27 + letter(b)) * 27 + letter(c);
+}
+// Tokens are maximal alphanumeric runs, so \b at their edges only has to rule out '_'.
+inline bool boundaryBefore(std::string_view text, std::size_t pos) { return pos == 0 || text[pos - 1] != '_'; }
+inline bool boundaryAt(std::string_view text, std::size_t pos) { return pos == text.size() || (text[pos] != '_' && !fold(text[pos])); }
+inline bool isSpace(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }   // \s
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Tokens are hashed on their length and their first and last two letters,
+// which already tell every word apart (buildTables checks that).
+constexpr std::uint64_t tokenKey(std::size_t length, unsigned char a, unsigned char b, unsigned char y, unsigned char z) {
+  return std::uint64_t(length) << 32 | std::uint64_t(a) << 24 | std::uint64_t(b) << 16 | std::uint64_t(y) << 8 | z;
+}
+constexpr std::size_t slotOf(std::uint64_t key, std::uint64_t seed) {
+  return static_cast<std::size_t>(((key ^ (key >> 29)) * seed) >> (64 - kSlotBits));
+}
+
+struct Word {
+  std::array<char, kMaxToken> text {};
+  std::uint8_t length {0};
+  bool securityWord {false};
+  std::uint64_t key {0};
+
+  constexpr std::string_view view() const { return {text.data(), length}; }
+  constexpr void append(std::string_view s) {
+    if (length + s.size() > kMaxToken) throw "token longer than kMaxToken";
+    for (char c : s) text[length++] = c;
+  }
+};
+
+// A phrase alternative as tokens: the first one at a boundary, the others
+// after one [- _] (MemorySafety) or after \s+ (Crash), the last one followed
+// by a boundary.
+struct Sequence {
+  Pattern pattern {Pattern::Count};
+  std::uint8_t length {0};
+  std::array<std::uint8_t, 3> words {};
+};
+
+struct Tables {
+  std::array<Word, kMaxWords> words {};
+  std::size_t wordCount {0};
+  std::array<Sequence, kMaxSequences> sequences {};     // ordered by first word
+  std::size_t sequenceCount {0};
+  std::array<std::uint8_t, kMaxWords + 1> firstSequence {};   // sequences of word w: [firstSequence[w], firstSequence[w + 1])
+  std::array<std::uint8_t, std::size_t(1) << kSlotBits> slots {};
+  std::uint64_t seed {0};
+  std::uint8_t cve {kNoWord};
+  std::array<std::uint64_t, (27 * 27 * 27 + 63) / 64> leadPrefix {};   // first three letters of the words that start a match
+
+  constexpr std::uint8_t add(const Word &w) {
+    for (std::size_t i = 0; i < wordCount; ++i) {
+      if (words[i].view() == w.view()) return static_cast<std::uint8_t>(i);
+    }
+    if (wordCount == kMaxWords) throw "too many words";
+    words[wordCount] = w;
+    words[wordCount].key = key(w);
+    return static_cast<std::uint8_t>(wordCount++);
+  }
+  constexpr std::uint8_t add(std::string_view s) {
+    Word w;
+    w.append(s);
+    return add(w);
+  }
+
+  // Every way of gluing the phrase's words: bit k of `glue` joins word k + 1
+  // to word k without a separator.
+  constexpr void addPhrase(const patterns::Phrase &ph, Pattern p, bool glued) {
+    std::size_t n = 0;
+    while (n < ph.words.size() && !ph.words[n].empty()) ++n;
+    for (unsigned glue = 0; glue < (glued ? 1u << (n - 1) : 1u); ++glue) {
+      Sequence seq;
+      seq.pattern = p;
+      Word token;
+      for (std::size_t k = 0; k < n; ++k) {
+        token.append(ph.words[k]);
+        if (k + 1 < n && (glue >> k & 1u)) continue;
+        seq.words[seq.length++] = add(token);
+        token = Word {};
+      }
+      if (sequenceCount == kMaxSequences) throw "too many sequences";
+      sequences[sequenceCount++] = seq;
+    }
+  }
+
+  static constexpr std::uint64_t key(const Word &w) {
+    const auto at = [&](std::size_t i) { return static_cast<unsigned char>(w.text[i]); };
+    return tokenKey(w.length, at(0), at(1), at(w.length - 2u), at(w.length - 1u));
+  }
+
+  constexpr bool place(std::uint64_t trial) {
+    slots.fill(kNoWord);
+    for (std::size_t i = 0; i < wordCount; ++i) {
+      std::uint8_t &slot = slots[slotOf(key(words[i]), trial)];
+      if (slot != kNoWord) return false;
+      slot = static_cast<std::uint8_t>(i);
+    }
+    seed = trial;
+    return true;
+  }
+};
+
+constexpr Tables buildTables() {
+  Tables t;
+  for (std::string_view w : patterns::kSecurityWords) t.words[t.add(w)].securityWord = true;
+  t.cve = t.add("cve");
+  for (const auto &ph : patterns::kMemoryPhrases) t.addPhrase(ph, Pattern::MemorySafety, true);
+  for (const auto &ph : patterns::kCrashPhrases) t.addPhrase(ph, Pattern::Crash, false);
+
+  // Stable insertion sort by first word, then the start of each word's run.
+  for (std::size_t i = 1; i < t.sequenceCount; ++i) {
+    for (std::size_t j = i; j > 0 && t.sequences[j - 1].words[0] > t.sequences[j].words[0]; --j) {
+      const Sequence tmp = t.sequences[j];
+      t.sequences[j] = t.sequences[j - 1];
+      t.sequences[j - 1] = tmp;
+    }
+  }
+  for (std::size_t w = 0, s = 0; w <= kMaxWords; ++w) {
+    while (s < t.sequenceCount && t.sequences[s].words[0] < w) ++s;
+    t.firstSequence[w] = static_cast<std::uint8_t>(s);
+  }
+
+  for (std::size_t w = 0; w < t.wordCount; ++w) {
+    const Word &word = t.words[w];
+    if (!word.securityWord && w != t.cve && t.firstSequence[w] == t.firstSequence[w + 1]) continue;
+    const auto at = [&](std::size_t i) { return static_cast<unsigned char>(word.text[i]); };
+    if (word.length < 3 || !letter(at(0)) || !letter(at(1)) || !letter(at(2))) throw "a leading word needs three letters";
+    const std::size_t i = prefixIndex(at(0), at(1), at(2));
+    t.leadPrefix[i / 64] |= std::uint64_t(1) << (i % 64);
+  }
+  for (std::size_t i = 0; i < t.wordCount; ++i) {
+    if (t.words[i].length < 2) throw "one-letter word";
+    for (std::size_t j = 0; j < i; ++j) {
+      if (Tables::key(t.words[i]) == Tables::key(t.words[j])) throw "two words share a key";
+    }
+  }
+  // The first multiplier, drawn from an LCG, that places every word in its
+  // own slot.
+  std::uint64_t state = 0x9e3779b97f4a7c15ull;
+  for (unsigned tries = 0; !t.place(state | 1u); ++tries, state = state * 6364136223846793005ull + 1442695040888963407ull) {
+    if (tries == 100000) throw "no collision-free seed";
+  }
+  return t;
+}
+
+constexpr Tables kTables = buildTables();
+static_assert(kTables.wordCount < kNoWord, "word ids fit in a byte with kNoWord to spare");
+
+struct Token {
+  std::size_t start, end;
+  std::uint8_t word;
+};
+
+// The word spelled by text[pos, end), or kNoWord.
+std::uint8_t lookup(std::string_view text, std::size_t pos, std::size_t end) {
+  const std::size_t length = end - pos;
+  if (length < 2 || length > kMaxToken) return kNoWord;
+  const std::uint64_t key = tokenKey(length, fold(text[pos]), fold(text[pos + 1]), fold(text[end - 2]), fold(text[end - 1]));
+  const std::uint8_t w = kTables.slots[slotOf(key, kTables.seed)];
+  if (w == kNoWord) return w;
+  const Word &word = kTables.words[w];
+  if (word.key != key) return kNoWord;
+  for (std::size_t i = 2; i + 2 < length; ++i) {
+    if (fold(text[pos + i]) != static_cast<unsigned char>(word.text[i])) return kNoWord;
+  }
+  return w;
+}
+
+// The alphanumeric run at `pos`, which holds one.
+Token readToken(std::string_view text, std::size_t pos) {
+  std::size_t end = pos + 1;
+  while (end < text.size() && fold(text[end])) ++end;
+  return {pos, end, lookup(text, pos, end)};
+}
+
+// End of the sequence whose first token ends at `pos`, or kNone.
+std::size_t matchSequence(std::string_view text, std::size_t pos, const Sequence &seq) {
+  for (std::size_t k = 1; k < seq.length; ++k) {
+    std::size_t next = pos;
+    if (seq.pattern == Pattern::Crash) {
+      while (next < text.size() && isSpace(text[next])) ++next;
+      if (next == pos) return kNone;
+    } else {
+      if (pos >= text.size() || (text[pos] != '-' && text[pos] != ' ' && text[pos] != '_')) return kNone;
+      ++next;
+    }
+    if (next >= text.size() || !fold(text[next])) return kNone;
+    const Token t = readToken(text, next);
+    if (t.word != seq.words[k]) return kNone;
+    pos = t.end;
+  }
+  return boundaryAt(text, pos) ? pos : kNone;
+}
+
+// -[0-9]{4}-[0-9]{4,7}\b after "CVE"; returns the end or kNone.
+std::size_t matchCveId(std::string_view text, std::size_t pos) {
+  if (text.size() - pos < 10 || text[pos] != '-' || text[pos + 5] != '-') return kNone;
+  for (std::size_t i = pos + 1; i < pos + 5; ++i) {
+    if (!isDigit(text[i])) return kNone;
+  }
+  std::size_t end = pos + 6;
+  while (end < text.size() && isDigit(text[end])) ++end;
+  const std::size_t digits = end - (pos + 6);
+  return digits >= 4 && digits <= 7 && boundaryAt(text, end) ? end : kNone;
+}
+
+struct Scan {
+  std::string_view text;
+  PatternSet patterns;
+  PatternCounts &counts;
+  // Iterating each regex resumes after its previous match.
+  std::array<std::size_t, static_cast<std::size_t>(Pattern::Count)> lastEnd {};
+
+  void found(Pattern p, std::size_t start, std::size_t end) {
+    std::size_t &last = lastEnd[static_cast<std::size_t>(p)];
+    if (start < last) return;
+    last = end;
+    ++counts[p];
+  }
+
+  // Every match the token can start; it follows a boundary.
+  void token(const Token &t) {
+    if (kTables.words[t.word].securityWord && (patterns & patternBit(Pattern::SecurityWord)) && boundaryAt(text, t.end)) {
+      found(Pattern::SecurityWord, t.start, t.end);
+    }
+    if (t.word == kTables.cve && (patterns & patternBit(Pattern::CveId))) {
+      const std::size_t end = matchCveId(text, t.end);
+      if (end != kNone) found(Pattern::CveId, t.start, end);
+    }
+    for (std::size_t s = kTables.firstSequence[t.word]; s < kTables.firstSequence[t.word + 1u]; ++s) {
+      const Sequence &seq = kTables.sequences[s];
+      if (!(patterns & patternBit(seq.pattern)) || t.start < lastEnd[static_cast<std::size_t>(seq.pattern)]) continue;
+      const std::size_t end = matchSequence(text, t.end, seq);
+      if (end != kNone) found(seq.pattern, t.start, end);
+    }
+  }
+};
+
+}
+
+const SecurityTokenScanner &SecurityTokenScanner::get() {
+  static const SecurityTokenScanner scanner;
+  return scanner;
+}
+
+SecurityTokenScanner::SecurityTokenScanner() {
+  // Glued phrases begin with their first word, which is enough for the
+  // prefilter and keeps its buckets less crowded.
+  std::vector<std::string> leads;
+  for (std::size_t w = 0; w < kTables.wordCount; ++w) {
+    if (kTables.words[w].securityWord || w == kTables.cve || kTables.firstSequence[w] != kTables.firstSequence[w + 1]) {
+      leads.emplace_back(kTables.words[w].view());
+    }
+  }
+  std::sort(leads.begin(), leads.end());
+  leads.erase(std::unique(leads.begin(), leads.end(), [](const std::string &a, const std::string &b) { return b.rfind(a, 0) == 0; }),
+              leads.end());
+  prefilter_ = LiteralPrefilter(leads);
+  level_ = detectSimdLevel();
+}
+
+void SecurityTokenScanner::count(std::string_view text, PatternSet patterns, PatternCounts &counts) const {
+  count(text, patterns, counts, level_);
+}
+
+void SecurityTokenScanner::count(std::string_view text, PatternSet patterns, PatternCounts &counts, SimdLevel level) const {
+  Scan scan {text, patterns & kPatterns, counts};
+  if (!scan.patterns) return;
+
+  if (level == SimdLevel::Scalar) {
+    std::size_t pos = 0;
+    for (;;) {
+      while (pos < text.size() && !fold(text[pos])) ++pos;
+      if (pos == text.size()) break;
+      const Token t = readToken(text, pos);
+      pos = t.end;
+      if (t.word != kNoWord && boundaryBefore(text, t.start)) scan.token(t);
+    }
+    return;
+  }
+
+  // Only tokens that begin like a leading word can start a match; the
+  // prefilter finds those, and candidates inside a longer token are skipped.
+  std::uint32_t mask = 0;
+  std::size_t resume = 0;
+  for (std::size_t pos = 0; (pos = prefilter_.nextBlock(text, pos, mask, level)) != kNone; pos += LiteralPrefilter::kBlock) {
+    for (; mask; mask &= mask - 1) {
+      const std::size_t at = pos + static_cast<std::size_t>(__builtin_ctz(mask));
+      if (at < resume || text.size() - at < 3 || (at > 0 && (fold(text[at - 1]) || text[at - 1] == '_'))) continue;
+      const std::size_t i = prefixIndex(static_cast<unsigned char>(text[at]), static_cast<unsigned char>(text[at + 1]),
+                                        static_cast<unsigned char>(text[at + 2]));
+      if (!(kTables.leadPrefix[i / 64] >> (i % 64) & 1u)) continue;
+      const Token t = readToken(text, at);
+      resume = t.end;
+      if (t.word != kNoWord) scan.token(t);
+    }
+  }
+}
+
+void countPatterns(std::string_view text, PatternSet patterns, PatternCounts &counts) {
+  if (patterns & ~SecurityTokenScanner::kPatterns) PatternMatcher::get().count(text, patterns, counts);
+  else SecurityTokenScanner::get().count(text, patterns, counts);
+}
+
+}
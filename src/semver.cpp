@@ -6,15 +6,14 @@
 // See the LICENSE file in the project root for details.
 
 #include "next_version/semver.h"
-#include <regex>
+#include "next_version/pattern_registry.h"
 #include <sstream>
 #include <vector>
 
 namespace nv {
 
 bool isSemverCore(const std::string &v) {
-  static const std::regex re(R"((0|[1-9][0-9]*)\.(0|[1-9][0-9]*)\.(0|[1-9][0-9]*))");
-  return std::regex_match(v, re);
+  return patterns::SemverCore::match(v);
 }
 
 bool isPrerelease(const std::string &v) {
@@ -61,8 +60,7 @@ static int comparePrerelease(const std::string &a, const std::string &b) {
 }
 
 bool isSemverWithPrerelease(const std::string &v) {
-  static const std::regex re(R"((0|[1-9][0-9]*)\.(0|[1-9][0-9]*)\.(0|[1-9][0-9]*)(\-[0-9A-Za-z-]+(\.[0-9A-Za-z-]+)*)?(\+[0-9A-Za-z-]+(\.[0-9A-Za-z-]+)*)?)");
-  return std::regex_match(v, re);
+  return patterns::SemverFull::match(v);
 }
 
 int semverCompare(const std::string &a, const std::string &b) {
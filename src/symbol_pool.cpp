@@ -0,0 +1,119 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/symbol_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace nv {
+
+namespace {
+
+constexpr std::uint64_t kHashMul = 0x9e3779b97f4a7c15ULL;
+constexpr std::size_t kInitialSlots = 16;
+
+// Eight bytes per step, folded to 32 bits; option names and case labels are short.
+std::uint32_t hashString(std::string_view s) {
+  std::uint64_t h = 0x243f6a8885a308d3ULL ^ s.size();
+  std::size_t i = 0;
+  for (; i + 8 <= s.size(); i += 8) {
+    std::uint64_t w;
+    std::memcpy(&w, s.data() + i, 8);
+    h = (h ^ w) * kHashMul;
+    h ^= h >> 29;
+  }
+  std::uint64_t tail = 0;
+  if (i < s.size()) std::memcpy(&tail, s.data() + i, s.size() - i);
+  h = (h ^ tail) * kHashMul;
+  return static_cast<std::uint32_t>(h >> 32);
+}
+
+inline std::size_t slotOf(Symbol s, std::size_t mask) {
+  return static_cast<std::size_t>((std::uint64_t{s} * kHashMul) >> 32) & mask;
+}
+
+}
+
+Symbol SymbolPool::intern(std::string_view s) {
+  if (slots_.empty()) slots_.assign(kInitialSlots, 0);
+  const std::uint32_t h = hashString(s);
+  const std::size_t mask = slots_.size() - 1;
+  std::size_t i = h & mask;
+  for (; slots_[i]; i = (i + 1) & mask) {
+    const Symbol sym = slots_[i] - 1;
+    if (hashes_[sym] == h && view(sym) == s) return sym;
+  }
+  const Symbol sym = static_cast<Symbol>(size());
+  text_.append(s);
+  starts_.push_back(static_cast<std::uint32_t>(text_.size()));
+  hashes_.push_back(h);
+  slots_[i] = sym + 1;
+  if (2 * size() > slots_.size()) grow();
+  return sym;
+}
+
+void SymbolPool::grow() {
+  slots_.assign(2 * slots_.size(), 0);
+  const std::size_t mask = slots_.size() - 1;
+  for (Symbol sym = 0; sym < size(); ++sym) {
+    std::size_t i = hashes_[sym] & mask;
+    while (slots_[i]) i = (i + 1) & mask;
+    slots_[i] = sym + 1;
+  }
+}
+
+bool SymbolSet::insert(Symbol s) {
+  if (slots_.empty()) slots_.assign(kInitialSlots, kEmpty);
+  std::size_t mask = slots_.size() - 1;
+  std::size_t i = slotOf(s, mask);
+  for (; slots_[i] != kEmpty; i = (i + 1) & mask) {
+    if (slots_[i] == s) return false;
+  }
+  slots_[i] = s;
+  if (2 * ++size_ <= slots_.size()) return true;
+  std::vector<Symbol> old(2 * slots_.size(), kEmpty);
+  old.swap(slots_);
+  mask = slots_.size() - 1;
+  for (Symbol t : old) {
+    if (t == kEmpty) continue;
+    for (i = slotOf(t, mask); slots_[i] != kEmpty; i = (i + 1) & mask) {}
+    slots_[i] = t;
+  }
+  return true;
+}
+
+bool SymbolSet::contains(Symbol s) const {
+  if (slots_.empty()) return false;
+  const std::size_t mask = slots_.size() - 1;
+  for (std::size_t i = slotOf(s, mask); slots_[i] != kEmpty; i = (i + 1) & mask) {
+    if (slots_[i] == s) return true;
+  }
+  return false;
+}
+
+std::vector<Symbol> SymbolSet::sorted() const {
+  std::vector<Symbol> out;
+  out.reserve(size_);
+  forEach([&](Symbol s) { out.push_back(s); });
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+bool hasMissing(const SymbolSet &a, const SymbolSet &b) {
+  if (a.size() > b.size()) return true;
+  const std::vector<Symbol> sa = a.sorted(), sb = b.sorted();
+  auto ib = sb.begin();
+  for (Symbol s : sa) {
+    while (ib != sb.end() && *ib < s) ++ib;
+    if (ib == sb.end() || *ib != s) return true;
+    ++ib;
+  }
+  return false;
+}
+
+}
@@ -0,0 +1,287 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/task_graph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sched.h>
+#include <sstream>
+
+namespace nv {
+
+namespace {
+
+// Which pool the current thread works for, and its deque there.
+thread_local const ThreadPool *currentPool = nullptr;
+thread_local unsigned currentWorker = 0;
+
+std::string readSmallFile(const std::filesystem::path &path) {
+  std::ifstream in(path);
+  if (!in) return {};
+  std::ostringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+// ceil(quota / period) for positive values, 0 for "max", -1 or malformed input.
+unsigned cpusForQuota(long long quota, long long period) {
+  if (quota <= 0 || period <= 0) return 0;
+  return static_cast<unsigned>((quota + period - 1) / period);
+}
+
+unsigned tighter(unsigned a, unsigned b) {
+  if (a == 0) return b;
+  if (b == 0) return a;
+  return std::min(a, b);
+}
+
+// cgroup v2: "<quota> <period>" or "max <period>".
+unsigned cpuMaxLimit(const std::filesystem::path &dir) {
+  std::istringstream in(readSmallFile(dir / "cpu.max"));
+  std::string quota;
+  long long period = 0;
+  if (!(in >> quota >> period) || quota == "max") return 0;
+  try { return cpusForQuota(std::stoll(quota), period); } catch (...) { return 0; }
+}
+
+// cgroup v1: cpu.cfs_quota_us is -1 when unlimited.
+unsigned cfsQuotaLimit(const std::filesystem::path &dir) {
+  long long quota = 0, period = 0;
+  std::istringstream q(readSmallFile(dir / "cpu.cfs_quota_us")), p(readSmallFile(dir / "cpu.cfs_period_us"));
+  if (!(q >> quota) || !(p >> period)) return 0;
+  return cpusForQuota(quota, period);
+}
+
+}
+
+ThreadPool::ThreadPool(unsigned workers) {
+  workers = std::max(workers, 1u);
+  for (unsigned i = 0; i < workers; ++i) queues_.push_back(std::make_unique<Queue>());
+  for (unsigned i = 0; i < workers; ++i) workers_.emplace_back([this, i]() { work(i); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto &t : workers_) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  const unsigned target = currentPool == this ? currentWorker
+                                              : nextQueue_.fetch_add(1, std::memory_order_relaxed) % size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+    queues_[target]->tasks.push_back(std::move(task));
+  }
+  {
+    // Counted under wakeMutex_ so a worker about to sleep cannot miss it.
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    queued_.fetch_add(1, std::memory_order_relaxed);
+  }
+  wake_.notify_one();
+}
+
+// Own deque from the back (newest first), then the others from the front.
+bool ThreadPool::take(unsigned self, std::function<void()> &task) {
+  const unsigned n = size();
+  for (unsigned k = 0; k < n; ++k) {
+    Queue &q = *queues_[(self + k) % n];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) continue;
+    if (k == 0) {
+      task = std::move(q.tasks.back());
+      q.tasks.pop_back();
+    } else {
+      task = std::move(q.tasks.front());
+      q.tasks.pop_front();
+    }
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::work(unsigned self) {
+  currentPool = this;
+  currentWorker = self;
+  std::function<void()> task;
+  while (true) {
+    if (take(self, task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    wake_.wait(lock, [this]() { return queued_.load(std::memory_order_relaxed) > 0 || stopping_; });
+    if (stopping_ && queued_.load(std::memory_order_relaxed) == 0) return;
+  }
+}
+
+namespace {
+
+// Shared with helper tasks that may only start after parallelFor returned;
+// those find no index left and never touch fn.
+struct ForState {
+  std::size_t n {0};
+  std::atomic<std::size_t> next {0};
+  std::atomic<std::size_t> finished {0};
+  std::mutex mutex;
+  std::condition_variable done;
+  std::exception_ptr failure;
+};
+
+void drain(ForState &st, const std::function<void(std::size_t)> &fn) {
+  for (std::size_t i; (i = st.next.fetch_add(1, std::memory_order_relaxed)) < st.n;) {
+    try {
+      fn(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(st.mutex);
+      if (!st.failure) st.failure = std::current_exception();
+    }
+    if (st.finished.fetch_add(1, std::memory_order_acq_rel) + 1 == st.n) {
+      std::lock_guard<std::mutex> lock(st.mutex);
+      st.done.notify_all();
+    }
+  }
+}
+
+}
+
+void parallelFor(ThreadPool *pool, std::size_t n, const std::function<void(std::size_t)> &fn) {
+  auto st = std::make_shared<ForState>();
+  st->n = n;
+  const std::size_t helpers = pool && n > 1 ? std::min<std::size_t>(pool->size(), n - 1) : 0;
+  for (std::size_t h = 0; h < helpers; ++h) pool->submit([st, &fn]() { drain(*st, fn); });
+  drain(*st, fn);
+  std::unique_lock<std::mutex> lock(st->mutex);
+  st->done.wait(lock, [&]() { return st->finished.load(std::memory_order_acquire) == n; });
+  if (st->failure) std::rethrow_exception(st->failure);
+}
+
+TaskGraph::TaskId TaskGraph::add(std::string name, std::function<void()> fn, const std::vector<TaskId> &deps) {
+  const TaskId id = tasks_.size();
+  Task t;
+  t.name = std::move(name);
+  t.fn = std::move(fn);
+  for (TaskId d : deps) {
+    if (d >= id) continue;   // only earlier tasks can be dependencies
+    tasks_[d].dependents.push_back(id);
+    ++t.deps;
+  }
+  tasks_.push_back(std::move(t));
+  return id;
+}
+
+void TaskGraph::execute(TaskId id) {
+  Task &t = tasks_[id];
+  if (failed_.load(std::memory_order_acquire)) return;
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    t.fn();
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(failureMutex_);
+    if (!failure_) failure_ = std::current_exception();
+    failed_.store(true, std::memory_order_release);
+  }
+  t.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void TaskGraph::run(unsigned jobs) {
+  if (jobs <= 1 || tasks_.size() <= 1) {
+    failure_ = nullptr;
+    failed_.store(false);
+    for (TaskId id = 0; id < tasks_.size(); ++id) execute(id);
+    if (failure_) std::rethrow_exception(failure_);
+    return;
+  }
+  ThreadPool pool(static_cast<unsigned>(std::min<std::size_t>(jobs, tasks_.size())));
+  run(pool);
+}
+
+void TaskGraph::run(ThreadPool &pool) {
+  failure_ = nullptr;
+  failed_.store(false);
+  const std::size_t n = tasks_.size();
+  std::unique_ptr<std::atomic<std::size_t>[]> waiting(new std::atomic<std::size_t>[n]);
+  for (std::size_t i = 0; i < n; ++i) waiting[i].store(tasks_[i].deps, std::memory_order_relaxed);
+  std::size_t left = n;   // guarded by doneMutex, so run() cannot return while a task still holds it
+  std::mutex doneMutex;
+  std::condition_variable done;
+
+  std::function<void(TaskId)> schedule = [&](TaskId id) {
+    pool.submit([&, id]() {
+      execute(id);
+      for (TaskId d : tasks_[id].dependents) {
+        if (waiting[d].fetch_sub(1, std::memory_order_acq_rel) == 1) schedule(d);
+      }
+      std::lock_guard<std::mutex> lock(doneMutex);
+      if (--left == 0) done.notify_all();
+    });
+  };
+  for (TaskId id = 0; id < n; ++id) {
+    if (tasks_[id].deps == 0) schedule(id);
+  }
+  {
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [&]() { return left == 0; });
+  }
+  if (failure_) std::rethrow_exception(failure_);
+}
+
+unsigned cgroupCpuLimit(const std::string &cgroupRoot, const std::string &selfCgroup) {
+  namespace fs = std::filesystem;
+  const fs::path root(cgroupRoot);
+  std::istringstream lines(readSmallFile(selfCgroup));
+  std::string line;
+  unsigned limit = 0;
+  bool sawV2 = false;
+  while (std::getline(lines, line)) {
+    // "<id>:<controllers>:<path>"
+    const auto a = line.find(':'), b = a == std::string::npos ? a : line.find(':', a + 1);
+    if (b == std::string::npos) continue;
+    const std::string controllers = line.substr(a + 1, b - a - 1);
+    const fs::path rel = fs::path(line.substr(b + 1)).relative_path();
+    std::error_code ec;
+    if (controllers.empty()) {
+      // v2: every level of the hierarchy may set its own cpu.max; the tightest one wins.
+      sawV2 = true;
+      fs::path dir = rel.empty() ? root : root / rel;
+      if (!fs::exists(dir, ec)) dir = root;   // cgroup namespaces mount the own cgroup at the root
+      for (fs::path d = dir;; d = d.parent_path()) {
+        limit = tighter(limit, cpuMaxLimit(d));
+        if (d == root || d.parent_path() == d || d.string().size() <= root.string().size()) break;
+      }
+    } else if (("," + controllers + ",").find(",cpu,") != std::string::npos) {
+      for (const char *mount : {"cpu,cpuacct", "cpu"}) {
+        fs::path dir = root / mount / rel;
+        if (!fs::exists(dir, ec)) dir = root / mount;
+        limit = tighter(limit, cfsQuotaLimit(dir));
+      }
+    }
+  }
+  if (!sawV2 && limit == 0) limit = cpuMaxLimit(root);   // no /proc/self/cgroup entry: try the root
+  return limit;
+}
+
+unsigned effectiveJobs(int requested) {
+  unsigned cpus = 0;
+  cpu_set_t set;
+  if (::sched_getaffinity(0, sizeof(set), &set) == 0) cpus = static_cast<unsigned>(CPU_COUNT(&set));
+  if (cpus == 0) cpus = std::max(std::thread::hardware_concurrency(), 1u);
+  unsigned jobs = requested > 0 ? static_cast<unsigned>(requested) : cpus;
+  const unsigned quota = cgroupCpuLimit();
+  if (quota > 0) jobs = std::min(jobs, quota);
+  return std::max(jobs, 1u);
+}
+
+}
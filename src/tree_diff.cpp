@@ -0,0 +1,639 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of nextVersion and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "next_version/tree_diff.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+namespace nv {
+
+static constexpr std::uint32_t kTypeMask = 0170000u;
+static constexpr std::uint32_t kGitlink = 0160000u;
+
+// Git's tree order: names compare bytewise, with a tree's name followed by '/'.
+static int compareEntries(const TreeEntry &a, const TreeEntry &b) {
+  const std::size_t len = std::min(a.name.size(), b.name.size());
+  if (int c = std::memcmp(a.name.data(), b.name.data(), len)) return c;
+  const unsigned char ca = a.name.size() > len ? static_cast<unsigned char>(a.name[len]) : (a.isTree() ? '/' : 0);
+  const unsigned char cb = b.name.size() > len ? static_cast<unsigned char>(b.name[len]) : (b.isTree() ? '/' : 0);
+  return int{ca} - int{cb};
+}
+
+static bool readTree(ObjectStore &store, const ObjectId &id, Object &obj) {
+  if (id.empty()) return true;
+  return store.read(id, obj) && obj.type() == ObjectType::Tree;
+}
+
+static bool walk(ObjectStore &store, const ObjectId &oldTree, const ObjectId &newTree,
+                 const std::string &prefix, const PathFilter &filter, std::vector<TreeChange> &out) {
+  Object oldObj, newObj;
+  if (!readTree(store, oldTree, oldObj) || !readTree(store, newTree, newObj)) return false;
+  TreeIterator a(oldObj.data(), store.hashSize()), b(newObj.data(), store.hashSize());
+  TreeEntry ea, eb;
+  bool ha = a.next(ea), hb = b.next(eb);
+
+  auto emitOneSide = [&](const TreeEntry &e, bool added) {
+    const std::string path = prefix + std::string(e.name);
+    if (e.isTree()) {
+      if (!filter.mayMatchUnder(path)) return true;
+      return added ? walk(store, ObjectId{}, e.oid, path + "/", filter, out)
+                   : walk(store, e.oid, ObjectId{}, path + "/", filter, out);
+    }
+    if (!filter.matches(path)) return true;
+    TreeChange c;
+    c.status = added ? 'A' : 'D';
+    (added ? c.newPath : c.oldPath) = path;
+    (added ? c.newOid : c.oldOid) = e.oid;
+    (added ? c.newMode : c.oldMode) = e.mode;
+    out.push_back(std::move(c));
+    return true;
+  };
+
+  while (ha || hb) {
+    const int cmp = !ha ? 1 : !hb ? -1 : compareEntries(ea, eb);
+    if (cmp < 0) {
+      if (!emitOneSide(ea, false)) return false;
+      ha = a.next(ea);
+    } else if (cmp > 0) {
+      if (!emitOneSide(eb, true)) return false;
+      hb = b.next(eb);
+    } else {
+      if (ea.oid != eb.oid || ea.mode != eb.mode) {
+        const std::string path = prefix + std::string(ea.name);
+        if (ea.isTree()) {
+          if (filter.mayMatchUnder(path) && !walk(store, ea.oid, eb.oid, path + "/", filter, out)) return false;
+        } else if (filter.matches(path)) {
+          TreeChange c;
+          c.status = (ea.mode & kTypeMask) == (eb.mode & kTypeMask) ? 'M' : 'T';
+          c.oldPath = path; c.newPath = path;
+          c.oldOid = ea.oid; c.newOid = eb.oid;
+          c.oldMode = ea.mode; c.newMode = eb.mode;
+          out.push_back(std::move(c));
+        }
+      }
+      ha = a.next(ea);
+      hb = b.next(eb);
+    }
+  }
+  return !a.malformed() && !b.malformed();
+}
+
+bool diffTrees(ObjectStore &store, const ObjectId &oldTree, const ObjectId &newTree,
+               const PathFilter &filter, std::vector<TreeChange> &out) {
+  if (oldTree == newTree) return true;
+  return walk(store, oldTree, newTree, std::string(), filter, out);
+}
+
+static std::string_view baseName(std::string_view path) {
+  const auto slash = path.rfind('/');
+  return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+static bool looksBinary(std::string_view content) {
+  return content.substr(0, 8000).find('\0') != std::string_view::npos;
+}
+
+// ---- rename and copy detection (git's diffcore-rename) ----
+
+namespace {
+
+constexpr int kMaxScore = 60000;            // git's MAX_SCORE; a score is a fraction of it
+constexpr std::size_t kCandidatesPerDst = 4;
+constexpr unsigned kSpanHashBase = 107927;
+constexpr std::uint32_t kRegular = 0100000u;
+constexpr std::size_t kSketchSize = 32;
+constexpr std::size_t kSketchRows = 2;      // rows per LSH band
+constexpr std::size_t kMaxBucketScan = 256;
+
+bool isRegular(std::uint32_t mode) { return (mode & kTypeMask) == kRegular; }
+
+// Byte counts per span hash, sorted by hash: git splits content into chunks
+// ending at '\n' or after 64 bytes and measures similarity on those. Like
+// git, an unterminated tail shorter than 64 bytes is not counted.
+using SpanCounts = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+void countSpans(std::string_view data, bool text, SpanCounts &out) {
+  out.clear();
+  unsigned accum1 = 0, accum2 = 0, n = 0;
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    const unsigned c = static_cast<unsigned char>(data[i]);
+    // CR of a CRLF pair does not count in text
+    if (text && c == '\r' && i + 1 < data.size() && data[i + 1] == '\n') continue;
+    const unsigned old1 = accum1;
+    accum1 = (accum1 << 7) ^ (accum2 >> 25);
+    accum2 = (accum2 << 7) ^ (old1 >> 25);
+    accum1 += c;
+    if (++n < 64 && c != '\n') continue;
+    out.emplace_back((accum1 + accum2 * 0x61u) % kSpanHashBase, n);
+    n = 0;
+    accum1 = accum2 = 0;
+  }
+  std::sort(out.begin(), out.end());
+  std::size_t w = 0;
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    if (w > 0 && out[w - 1].first == out[i].first) out[w - 1].second += out[i].second;
+    else out[w++] = out[i];
+  }
+  out.resize(w);
+}
+
+std::uint64_t copiedBytes(const SpanCounts &src, const SpanCounts &dst) {
+  std::uint64_t copied = 0;
+  std::size_t i = 0, j = 0;
+  while (i < src.size() && j < dst.size()) {
+    if (src[i].first < dst[j].first) ++i;
+    else if (dst[j].first < src[i].first) ++j;
+    else { copied += std::min(src[i].second, dst[j].second); ++i; ++j; }
+  }
+  return copied;
+}
+
+std::uint64_t mix64(std::uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  return x ^ (x >> 33);
+}
+
+// One side of a rename candidate with its lazily loaded content fingerprint.
+struct RenameSide {
+  RenameSide(std::size_t changeIndex, const ObjectId &id, std::uint32_t m, std::string_view p)
+      : change(changeIndex), oid(id), mode(m), path(p) {}
+
+  std::size_t change;       // index into the change list
+  ObjectId oid;
+  std::uint32_t mode;
+  std::string_view path;
+  std::size_t size {0};
+  bool loaded {false};
+  SpanCounts spans;
+  std::array<std::uint64_t, kSketchSize> sketch {};
+};
+
+struct Candidate {
+  long dst {-1};
+  long src {-1};
+  int score {0};
+  int nameScore {0};
+};
+
+// git's score_compare: unused slots sink, then higher score, then same basename.
+int compareCandidates(const Candidate &a, const Candidate &b) {
+  if (a.dst < 0) return b.dst >= 0 ? 1 : 0;
+  if (b.dst < 0) return -1;
+  if (a.score == b.score) return b.nameScore - a.nameScore;
+  return b.score - a.score;
+}
+
+void recordIfBetter(Candidate *slots, const Candidate &c) {
+  std::size_t worst = 0;
+  for (std::size_t i = 1; i < kCandidatesPerDst; ++i) {
+    if (compareCandidates(slots[i], slots[worst]) > 0) worst = i;
+  }
+  if (compareCandidates(slots[worst], c) > 0) slots[worst] = c;
+}
+
+class RenameScorer {
+public:
+  RenameScorer(ObjectStore &store, int minScore) : store_(store), minScore_(minScore) {}
+
+  bool load(RenameSide &side) {
+    if (side.loaded) return true;
+    Object obj;
+    if (!store_.read(side.oid, obj) || obj.type() != ObjectType::Blob) return false;
+    side.size = obj.data().size();
+    countSpans(obj.data(), !looksBinary(obj.data()), side.spans);
+    side.loaded = true;
+    return true;
+  }
+
+  // git's estimate_similarity: share of the larger blob made of spans copied from the source.
+  bool score(RenameSide &src, RenameSide &dst, int &out) {
+    out = 0;
+    if (!isRegular(src.mode) || !isRegular(dst.mode)) return true;
+    if (!load(src) || !load(dst)) return false;
+    const std::uint64_t maxSize = std::max(src.size, dst.size);
+    const std::uint64_t delta = maxSize - std::min(src.size, dst.size);
+    if (maxSize * static_cast<std::uint64_t>(kMaxScore - minScore_) < delta * kMaxScore) return true;
+    if (dst.size == 0) return true;
+    out = static_cast<int>(copiedBytes(src.spans, dst.spans) * kMaxScore / maxSize);
+    return true;
+  }
+
+private:
+  ObjectStore &store_;
+  int minScore_;
+};
+
+// MinHash over span hashes, leaving out spans so common they say nothing
+// about where a file came from (blank lines, closing braces).
+void buildSketch(RenameSide &side, const std::vector<std::uint32_t> &docFreq, std::uint32_t commonLimit) {
+  side.sketch.fill(~std::uint64_t{0});
+  for (const auto &span : side.spans) {
+    if (docFreq[span.first] > commonLimit) continue;
+    for (std::size_t k = 0; k < kSketchSize; ++k) {
+      const std::uint64_t h = mix64(span.first * 0x9e3779b97f4a7c15ULL + k);
+      side.sketch[k] = std::min(side.sketch[k], h);
+    }
+  }
+}
+
+std::uint64_t bandKey(const RenameSide &side, std::size_t band) {
+  std::uint64_t key = band;
+  for (std::size_t r = 0; r < kSketchRows; ++r) key = mix64(key ^ side.sketch[band * kSketchRows + r]);
+  return key;
+}
+
+}  // namespace
+
+bool detectRenames(ObjectStore &store, std::vector<TreeChange> &changes, const RenameOptions &opts) {
+  // Deleted files and, for copies, the preimages of modified files are
+  // sources; added files are destinations.
+  std::vector<RenameSide> srcs, dsts;
+  std::vector<int> used;
+  for (std::size_t i = 0; i < changes.size(); ++i) {
+    const TreeChange &c = changes[i];
+    if (c.status == 'A') {
+      dsts.emplace_back(i, c.newOid, c.newMode, c.newPath);
+    } else {
+      srcs.emplace_back(i, c.oldOid, c.oldMode, c.oldPath);
+      used.push_back(c.status == 'D' ? 0 : 1);
+    }
+  }
+  if (dsts.empty() || srcs.empty()) return true;
+
+  std::vector<long> pairedWith(dsts.size(), -1);
+  std::vector<int> pairScore(dsts.size(), 0);
+  auto record = [&](std::size_t dst, std::size_t src, int score) {
+    pairedWith[dst] = static_cast<long>(src);
+    pairScore[dst] = score;
+    ++used[src];
+  };
+  auto sameBase = [&](const RenameSide &a, const RenameSide &b) {
+    return baseName(a.path) == baseName(b.path) ? 1 : 0;
+  };
+
+  // Exact matches first: prefer a source not yet used, then one with the same file name.
+  std::unordered_map<ObjectId, std::vector<std::size_t>, ObjectIdHash> byOid;
+  for (std::size_t s = 0; s < srcs.size(); ++s) byOid[srcs[s].oid].push_back(s);
+  for (std::size_t d = 0; d < dsts.size(); ++d) {
+    auto it = byOid.find(dsts[d].oid);
+    if (it == byOid.end()) continue;
+    long best = -1;
+    int bestScore = -1;
+    int alternatives = 100;
+    for (std::size_t s : it->second) {
+      if ((!isRegular(srcs[s].mode) || !isRegular(dsts[d].mode)) && srcs[s].mode != dsts[d].mode) continue;
+      const int score = (used[s] == 0 ? 1 : 0) + sameBase(srcs[s], dsts[d]);
+      if (score > bestScore) {
+        best = static_cast<long>(s);
+        bestScore = score;
+        if (score == 2) break;
+      }
+      if (!--alternatives) break;
+    }
+    if (best >= 0) record(d, static_cast<std::size_t>(best), kMaxScore);
+  }
+
+  std::vector<std::size_t> pending;
+  for (std::size_t d = 0; d < dsts.size(); ++d) {
+    if (pairedWith[d] < 0) pending.push_back(d);
+  }
+  const int minScore = opts.minSimilarity >= 100 ? kMaxScore : kMaxScore * std::max(opts.minSimilarity, 0) / 100;
+  RenameScorer scorer(store, minScore);
+
+  // Up to four best-scoring sources per destination, from every pair when the
+  // matrix is small and from MinHash LSH buckets when it is not.
+  std::vector<Candidate> matrix(pending.size() * kCandidatesPerDst);
+  const bool exhaustive = pending.size() * srcs.size() <= opts.exhaustiveLimit;
+  std::unordered_map<std::uint64_t, std::vector<std::size_t>> buckets;
+  if (!pending.empty() && !exhaustive) {
+    std::vector<std::uint32_t> docFreq(kSpanHashBase, 0);
+    auto addFreq = [&](RenameSide &side) {
+      if (!isRegular(side.mode)) return true;
+      if (!scorer.load(side)) return false;
+      for (const auto &span : side.spans) ++docFreq[span.first];
+      return true;
+    };
+    for (auto &s : srcs) if (!addFreq(s)) return false;
+    for (std::size_t d : pending) if (!addFreq(dsts[d])) return false;
+    const auto commonLimit = static_cast<std::uint32_t>(std::max<std::size_t>(16, (srcs.size() + pending.size()) / 20));
+    for (std::size_t s = 0; s < srcs.size(); ++s) {
+      if (!isRegular(srcs[s].mode)) continue;
+      buildSketch(srcs[s], docFreq, commonLimit);
+      for (std::size_t band = 0; band < kSketchSize / kSketchRows; ++band) buckets[bandKey(srcs[s], band)].push_back(s);
+    }
+    for (std::size_t d : pending) if (isRegular(dsts[d].mode)) buildSketch(dsts[d], docFreq, commonLimit);
+  }
+
+  std::vector<std::size_t> candidates;
+  for (std::size_t p = 0; p < pending.size(); ++p) {
+    RenameSide &dst = dsts[pending[p]];
+    Candidate *slots = &matrix[p * kCandidatesPerDst];
+    candidates.clear();
+    if (exhaustive) {
+      for (std::size_t s = 0; s < srcs.size(); ++s) candidates.push_back(s);
+    } else if (isRegular(dst.mode)) {
+      for (std::size_t band = 0; band < kSketchSize / kSketchRows; ++band) {
+        auto it = buckets.find(bandKey(dst, band));
+        if (it == buckets.end()) continue;
+        const std::size_t n = std::min(it->second.size(), kMaxBucketScan);
+        candidates.insert(candidates.end(), it->second.begin(), it->second.begin() + static_cast<std::ptrdiff_t>(n));
+      }
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+    for (std::size_t s : candidates) {
+      Candidate c;
+      c.dst = static_cast<long>(pending[p]);
+      c.src = static_cast<long>(s);
+      if (!scorer.score(srcs[s], dst, c.score)) return false;
+      c.nameScore = sameBase(srcs[s], dst);
+      recordIfBetter(slots, c);
+    }
+  }
+  std::stable_sort(matrix.begin(), matrix.end(), [](const Candidate &a, const Candidate &b) {
+    return compareCandidates(a, b) < 0;
+  });
+  // Renames take unused sources first; copies may then reuse any source.
+  for (int copies = 0; copies < 2; ++copies) {
+    for (const Candidate &c : matrix) {
+      if (c.dst < 0 || c.score < minScore) break;
+      const auto d = static_cast<std::size_t>(c.dst), s = static_cast<std::size_t>(c.src);
+      if (pairedWith[d] >= 0) continue;
+      if (!copies && used[s]) continue;
+      record(d, s, c.score);
+    }
+  }
+
+  // Rewrite destinations as pairs, drop deletions that moved somewhere and
+  // name the last user of each source the rename, earlier ones copies.
+  std::vector<long> dstOfChange(changes.size(), -1);
+  for (std::size_t d = 0; d < dsts.size(); ++d) dstOfChange[dsts[d].change] = static_cast<long>(d);
+  std::vector<bool> moved(changes.size(), false);
+  for (std::size_t s = 0; s < srcs.size(); ++s) moved[srcs[s].change] = changes[srcs[s].change].status == 'D' && used[s] > 0;
+  for (std::size_t d = 0; d < dsts.size(); ++d) {
+    if (pairedWith[d] < 0) continue;
+    const auto s = static_cast<std::size_t>(pairedWith[d]);
+    const TreeChange &source = changes[srcs[s].change];
+    TreeChange &c = changes[dsts[d].change];
+    c.oldPath = source.oldPath;
+    c.oldOid = source.oldOid;
+    c.oldMode = source.oldMode;
+    c.similarity = static_cast<int>(static_cast<long>(pairScore[d]) * 100 / kMaxScore);
+  }
+  std::vector<TreeChange> out;
+  out.reserve(changes.size());
+  for (std::size_t i = 0; i < changes.size(); ++i) {
+    TreeChange &c = changes[i];
+    if (moved[i]) continue;
+    if (dstOfChange[i] >= 0 && pairedWith[static_cast<std::size_t>(dstOfChange[i])] >= 0) {
+      c.status = --used[static_cast<std::size_t>(pairedWith[static_cast<std::size_t>(dstOfChange[i])])] > 0 ? 'C' : 'R';
+    }
+    out.push_back(std::move(c));
+  }
+  changes = std::move(out);
+  return true;
+}
+
+static bool sideContent(ObjectStore &store, const ObjectId &oid, std::uint32_t mode, Object &obj, std::string &gitlink,
+                        std::string_view &content) {
+  content = {};
+  if (oid.empty()) return true;
+  if ((mode & kTypeMask) == kGitlink) {
+    gitlink = "Subproject commit " + oid.hex() + "\n";
+    content = gitlink;
+    return true;
+  }
+  if (!store.read(oid, obj) || obj.type() != ObjectType::Blob) return false;
+  content = obj.data();
+  return true;
+}
+
+bool computeLineStats(ObjectStore &store, std::vector<TreeChange> &changes, const BlobDiffOptions &opts) {
+  for (auto &c : changes) {
+    c.insertions = c.deletions = 0;
+    c.binary = false;
+    if (c.oldOid == c.newOid) continue;
+    Object oldObj, newObj;
+    std::string oldLink, newLink;
+    std::string_view oldText, newText;
+    if (!sideContent(store, c.oldOid, c.oldMode, oldObj, oldLink, oldText)) return false;
+    if (!sideContent(store, c.newOid, c.newMode, newObj, newLink, newText)) return false;
+    if (looksBinary(oldText) || looksBinary(newText)) { c.binary = true; continue; }
+    BlobDiff diff;
+    diffBlobs(oldText, newText, opts, diff);
+    c.insertions = diff.insertions;
+    c.deletions = diff.deletions;
+  }
+  return true;
+}
+
+// git quotes a path when it holds control characters, '"', '\\' or non-ASCII bytes (core.quotePath).
+static bool needsQuoting(std::string_view path) {
+  return std::any_of(path.begin(), path.end(), [](char ch) {
+    const auto c = static_cast<unsigned char>(ch);
+    return c < 0x20 || c >= 0x7f || c == '"' || c == '\\';
+  });
+}
+
+static void appendEscaped(std::string &out, std::string_view path) {
+  for (char ch : path) {
+    const auto c = static_cast<unsigned char>(ch);
+    switch (c) {
+      case '\a': out += "\\a"; break;
+      case '\b': out += "\\b"; break;
+      case '\t': out += "\\t"; break;
+      case '\n': out += "\\n"; break;
+      case '\v': out += "\\v"; break;
+      case '\f': out += "\\f"; break;
+      case '\r': out += "\\r"; break;
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      default:
+        if (c < 0x20 || c >= 0x7f) {
+          char buf[8];
+          std::snprintf(buf, sizeof buf, "\\%03o", static_cast<unsigned>(c));
+          out += buf;
+        } else {
+          out.push_back(ch);
+        }
+    }
+  }
+}
+
+// "a/path", or "\"a/pa\\tth\"" when the path needs quoting.
+static std::string prefixedPath(std::string_view prefix, std::string_view path) {
+  std::string out;
+  if (!needsQuoting(path)) {
+    out.append(prefix).append(path);
+    return out;
+  }
+  out.push_back('"');
+  out.append(prefix);
+  appendEscaped(out, path);
+  out.push_back('"');
+  return out;
+}
+
+static std::string quotedPath(std::string_view path) {
+  return prefixedPath("", path);
+}
+
+static std::string octalMode(std::uint32_t mode) {
+  char buf[16];
+  std::snprintf(buf, sizeof buf, "%06o", static_cast<unsigned>(mode));
+  return buf;
+}
+
+// Index lines use git's minimum abbreviation; nothing downstream reads the hex.
+static std::string abbrev(const ObjectId &oid) {
+  return oid.empty() ? std::string(7, '0') : oid.hex().substr(0, 7);
+}
+
+// One `diff --git` section, its header lines to header and its hunks to
+// hunks (the two may be the same string). 'A' and 'D' sections have one side
+// missing; a type change is rendered by the caller as a deletion followed by
+// an addition. With known set the shape is taken as given and no blob is read.
+static bool appendSection(ObjectStore &store, const TreeChange &c, const BlobDiffOptions &opts, bool known,
+                          HunkShape &shape, std::string &header, std::string &hunks) {
+  const bool hasOld = c.status != 'A';
+  const bool hasNew = c.status != 'D';
+  const std::string &nameA = hasOld ? c.oldPath : c.newPath;
+  const std::string &nameB = hasNew ? c.newPath : c.oldPath;
+
+  std::string head = "diff --git " + prefixedPath("a/", nameA) + " " + prefixedPath("b/", nameB) + "\n";
+  bool mustShowHeader = true;
+  if (!hasOld) {
+    head += "new file mode " + octalMode(c.newMode) + "\n";
+  } else if (!hasNew) {
+    head += "deleted file mode " + octalMode(c.oldMode) + "\n";
+  } else if (c.oldMode != c.newMode) {
+    head += "old mode " + octalMode(c.oldMode) + "\nnew mode " + octalMode(c.newMode) + "\n";
+  } else {
+    mustShowHeader = false;
+  }
+  if (c.status == 'R' || c.status == 'C') {
+    const char *verb = c.status == 'R' ? "rename" : "copy";
+    head += "similarity index " + std::to_string(c.similarity) + "%\n";
+    head += std::string(verb) + " from " + quotedPath(c.oldPath) + "\n";
+    head += std::string(verb) + " to " + quotedPath(c.newPath) + "\n";
+    mustShowHeader = true;
+  }
+  const ObjectId oldOid = hasOld ? c.oldOid : ObjectId{};
+  const ObjectId newOid = hasNew ? c.newOid : ObjectId{};
+  if (oldOid != newOid) {
+    head += "index " + abbrev(oldOid) + ".." + abbrev(newOid);
+    if (hasOld && hasNew && c.oldMode == c.newMode) head += " " + octalMode(c.oldMode);
+    head += "\n";
+  }
+
+  if (oldOid == newOid) {
+    shape = HunkShape{};
+    header += head;
+    return true;
+  }
+
+  BlobDiff diff;
+  Object oldObj, newObj;
+  std::string oldLink, newLink;
+  if (!known) {
+    std::string_view oldText, newText;
+    if (hasOld && !sideContent(store, c.oldOid, c.oldMode, oldObj, oldLink, oldText)) return false;
+    if (hasNew && !sideContent(store, c.newOid, c.newMode, newObj, newLink, newText)) return false;
+    shape = HunkShape{};
+    shape.binary = looksBinary(oldText) || looksBinary(newText);
+    if (!shape.binary) {
+      diffBlobs(oldText, newText, opts, diff);
+      shape.hasHunks = !diff.hunks.empty();
+      shape.insertions = diff.insertions;
+      shape.deletions = diff.deletions;
+    }
+  }
+
+  const std::string labelA = hasOld ? prefixedPath("a/", nameA) : std::string("/dev/null");
+  const std::string labelB = hasNew ? prefixedPath("b/", nameB) : std::string("/dev/null");
+  if (shape.binary) {
+    header += head + "Binary files " + labelA + " and " + labelB + " differ\n";
+    return true;
+  }
+  if (!shape.hasHunks) {
+    // Under -w a section with nothing but whitespace edits disappears entirely
+    if (!opts.ignoreWhitespace || mustShowHeader) header += head;
+    return true;
+  }
+  header += head;
+  header += "--- " + labelA + (labelA.find(' ') != std::string::npos ? "\t" : "") + "\n";
+  header += "+++ " + labelB + (labelB.find(' ') != std::string::npos ? "\t" : "") + "\n";
+  if (!known) appendUnifiedHunks(diff, hunks);
+  return true;
+}
+
+static void setLineStats(TreeChange &change, const HunkShape &shape) {
+  change.binary = shape.binary;
+  change.insertions = shape.binary ? 0 : shape.insertions;
+  change.deletions = shape.binary ? 0 : shape.deletions;
+}
+
+bool appendPatch(ObjectStore &store, TreeChange &change, const BlobDiffOptions &opts, std::string &out) {
+  HunkShape shape;
+  if (change.status == 'T') {
+    TreeChange removed = change, added = change;
+    removed.status = 'D';
+    added.status = 'A';
+    if (!appendSection(store, removed, opts, false, shape, out, out)) return false;
+    if (!appendSection(store, added, opts, false, shape, out, out)) return false;
+    std::vector<TreeChange> one {change};
+    if (!computeLineStats(store, one, opts)) return false;
+    change = std::move(one.front());
+    return true;
+  }
+  if (!appendSection(store, change, opts, false, shape, out, out)) return false;
+  setLineStats(change, shape);
+  return true;
+}
+
+bool hunksByBlobs(const TreeChange &change) {
+  auto blob = [](const ObjectId &oid, std::uint32_t mode) { return oid.empty() || (mode & kTypeMask) != kGitlink; };
+  return change.status != 'T' && change.oldOid != change.newOid && blob(change.oldOid, change.oldMode) &&
+         blob(change.newOid, change.newMode);
+}
+
+bool appendPatchSplit(ObjectStore &store, TreeChange &change, const BlobDiffOptions &opts, bool known, HunkShape &shape,
+                      std::string &header, std::string &hunks) {
+  if (!appendSection(store, change, opts, known, shape, header, hunks)) return false;
+  setLineStats(change, shape);
+  return true;
+}
+
+bool commitTree(ObjectStore &store, const ObjectId &commitOrTag, ObjectId &tree) {
+  ObjectId id = commitOrTag;
+  for (int depth = 0; depth < 16; ++depth) {
+    Object obj;
+    if (!store.read(id, obj)) return false;
+    if (obj.type() == ObjectType::Tree) { tree = id; return true; }
+    if (obj.type() == ObjectType::Commit) {
+      CommitView view;
+      if (!parseCommit(obj.data(), view)) return false;
+      tree = view.tree;
+      return true;
+    }
+    if (obj.type() != ObjectType::Tag) return false;
+    const std::string_view data = obj.data();
+    if (data.rfind("object ", 0) != 0) return false;
+    id = ObjectId::fromHex(data.substr(7, data.find('\n') - 7));
+    if (id.empty()) return false;
+  }
+  return false;
+}
+
+}